@@ -345,6 +345,18 @@ bool Camera::isVisibleInFrustum(const AABB* aabb) const
     return !_frustum.isOutOfFrustum(*aabb);
 }
 
+const Frustum& Camera::getFrustum() const
+{
+    // flags the frustum dirty if the camera moved since the view matrix was last asked for
+    getViewMatrix();
+    if (_frustumDirty)
+    {
+        _frustum.initFrustum(this);
+        _frustumDirty = false;
+    }
+    return _frustum;
+}
+
 float Camera::getDepthInView(const Mat4& transform) const
 {
     Mat4 camWorldMat = getNodeToWorldTransform();
@@ -206,6 +206,12 @@ public:
      * Is this aabb visible in frustum
      */
     bool isVisibleInFrustum(const AABB* aabb) const;
+
+    /**
+     * Get the frustum of the camera, updated if the camera moved.
+     * @since v3.18
+     */
+    const Frustum& getFrustum() const;
     
     /**
      * Get object depth towards camera
@@ -0,0 +1,486 @@
+/****************************************************************************
+ Copyright (c) 2013-2017 Chukong Technologies
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+ 
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "2d/CCDynamicAtlasCache.h"
+#include <algorithm>
+#include <climits>
+#include <iterator>
+#include "2d/CCSpriteFrame.h"
+#include "base/CCConfiguration.h"
+#include "base/CCDirector.h"
+#include "base/ccMacros.h"
+#include "platform/CCFileUtils.h"
+#include "platform/CCImage.h"
+#include "renderer/CCTexture2D.h"
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+#include "base/CCEventDispatcher.h"
+#include "base/CCEventListenerCustom.h"
+#include "base/CCEventType.h"
+#endif
+
+NS_CC_BEGIN
+
+namespace {
+
+// every slot gets a border of extruded edge pixels, so bilinear filtering at
+// the frame edges never samples the neighbouring image
+const int SLOT_PADDING = 1;
+
+// Converts the image to premultiplied RGBA8888 with padding around it.
+bool buildSlotPixels(Image* image, std::vector<unsigned char>& pixels)
+{
+    int bytesPerPixel = 0;
+    switch (image->getRenderFormat())
+    {
+    case Texture2D::PixelFormat::RGBA8888:
+        bytesPerPixel = 4;
+        break;
+    case Texture2D::PixelFormat::RGB888:
+        bytesPerPixel = 3;
+        break;
+    default:
+        return false;
+    }
+
+    const int width = image->getWidth();
+    const int height = image->getHeight();
+    const int slotWidth = width + SLOT_PADDING * 2;
+    const int slotHeight = height + SLOT_PADDING * 2;
+    const bool premultiply = bytesPerPixel == 4 && !image->hasPremultipliedAlpha();
+    const unsigned char* src = image->getData();
+
+    pixels.resize(slotWidth * slotHeight * 4);
+    for (int y = 0; y < slotHeight; ++y)
+    {
+        int srcY = std::min(std::max(y - SLOT_PADDING, 0), height - 1);
+        for (int x = 0; x < slotWidth; ++x)
+        {
+            int srcX = std::min(std::max(x - SLOT_PADDING, 0), width - 1);
+            const unsigned char* in = src + (srcY * width + srcX) * bytesPerPixel;
+            unsigned char* out = &pixels[(y * slotWidth + x) * 4];
+            unsigned int alpha = bytesPerPixel == 4 ? in[3] : 255;
+            if (premultiply)
+            {
+                // same rounding as CC_RGB_PREMULTIPLY_ALPHA, so packed sprites match the textures they replace
+                out[0] = static_cast<unsigned char>((in[0] * (alpha + 1)) >> 8);
+                out[1] = static_cast<unsigned char>((in[1] * (alpha + 1)) >> 8);
+                out[2] = static_cast<unsigned char>((in[2] * (alpha + 1)) >> 8);
+            }
+            else
+            {
+                out[0] = in[0];
+                out[1] = in[1];
+                out[2] = in[2];
+            }
+            out[3] = static_cast<unsigned char>(alpha);
+        }
+    }
+    return true;
+}
+
+// rows of an odd width slot are not a multiple of 8 bytes, the alignment a page upload may have left
+void uploadSlotPixels(Texture2D* texture, const std::vector<unsigned char>& pixels, int x, int y, int width, int height)
+{
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    texture->updateWithData(pixels.data(), x, y, width, height);
+}
+
+// loads an image file into slot pixels, returning false if it can't be packed
+bool loadSlotPixels(const std::string& fullpath, int maxSize, std::vector<unsigned char>& pixels, int* width, int* height)
+{
+    Image* image = new (std::nothrow) Image();
+    bool ret = image
+        && image->initWithImageFile(fullpath)
+        && !image->isCompressed()
+        && image->getWidth() <= maxSize
+        && image->getHeight() <= maxSize
+        && buildSlotPixels(image, pixels);
+    if (ret)
+    {
+        *width = image->getWidth();
+        *height = image->getHeight();
+    }
+    CC_SAFE_RELEASE(image);
+    return ret;
+}
+
+} // namespace
+
+static DynamicAtlasCache* s_sharedDynamicAtlasCache = nullptr;
+
+DynamicAtlasCache* DynamicAtlasCache::getInstance()
+{
+    if (!s_sharedDynamicAtlasCache)
+    {
+        s_sharedDynamicAtlasCache = new (std::nothrow) DynamicAtlasCache();
+    }
+    return s_sharedDynamicAtlasCache;
+}
+
+void DynamicAtlasCache::destroyInstance()
+{
+    CC_SAFE_RELEASE_NULL(s_sharedDynamicAtlasCache);
+}
+
+DynamicAtlasCache::DynamicAtlasCache()
+: _enabled(false)
+, _pageSize(1024)
+, _maxSpriteSize(256)
+{
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    _rendererRecreatedListener = EventListenerCustom::create(EVENT_RENDERER_RECREATED, CC_CALLBACK_1(DynamicAtlasCache::listenRendererRecreated, this));
+    Director::getInstance()->getEventDispatcher()->addEventListenerWithFixedPriority(_rendererRecreatedListener, 1);
+#endif
+}
+
+DynamicAtlasCache::~DynamicAtlasCache()
+{
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    Director::getInstance()->getEventDispatcher()->removeEventListener(_rendererRecreatedListener);
+#endif
+    removeAllSpriteFrames();
+}
+
+void DynamicAtlasCache::setPageSize(int size)
+{
+    _pageSize = MIN(size, Configuration::getInstance()->getMaxTextureSize());
+}
+
+SpriteFrame* DynamicAtlasCache::getSpriteFrame(const std::string& filename)
+{
+    std::string fullpath = FileUtils::getInstance()->fullPathForFilename(filename);
+    if (fullpath.empty())
+    {
+        return nullptr;
+    }
+
+    auto it = _entries.find(fullpath);
+    if (it != _entries.end())
+    {
+        return it->second.frame;
+    }
+    if (_rejectedFiles.find(fullpath) != _rejectedFiles.end())
+    {
+        return nullptr;
+    }
+
+    std::vector<unsigned char> pixels;
+    int width = 0;
+    int height = 0;
+    if (!loadSlotPixels(fullpath, MIN(_maxSpriteSize, _pageSize - SLOT_PADDING * 2), pixels, &width, &height))
+    {
+        _rejectedFiles.insert(fullpath);
+        return nullptr;
+    }
+
+    FreeRect slot = { 0, 0, width + SLOT_PADDING * 2, height + SLOT_PADDING * 2 };
+    Page* page = nullptr;
+    for (auto candidate : _pages)
+    {
+        if (allocate(candidate, slot.width, slot.height, &slot.x, &slot.y))
+        {
+            page = candidate;
+            break;
+        }
+    }
+    if (page == nullptr)
+    {
+        page = createPage();
+        if (page == nullptr || !allocate(page, slot.width, slot.height, &slot.x, &slot.y))
+        {
+            return nullptr;
+        }
+    }
+
+    uploadSlotPixels(page->texture, pixels, slot.x, slot.y, slot.width, slot.height);
+
+    Rect rect(slot.x + SLOT_PADDING, slot.y + SLOT_PADDING, width, height);
+    SpriteFrame* frame = SpriteFrame::createWithTexture(page->texture, CC_RECT_PIXELS_TO_POINTS(rect));
+    frame->retain();
+    ++page->frames;
+
+    Entry& entry = _entries[fullpath];
+    entry.frame = frame;
+    entry.page = page;
+    entry.slot = slot;
+    return frame;
+}
+
+bool DynamicAtlasCache::hasSpriteFrame(const std::string& filename) const
+{
+    return _entries.find(FileUtils::getInstance()->fullPathForFilename(filename)) != _entries.end();
+}
+
+void DynamicAtlasCache::removeSpriteFrame(const std::string& filename)
+{
+    auto it = _entries.find(FileUtils::getInstance()->fullPathForFilename(filename));
+    if (it != _entries.end())
+    {
+        removeEntry(it);
+    }
+}
+
+void DynamicAtlasCache::removeUnusedSpriteFrames()
+{
+    for (auto it = _entries.begin(); it != _entries.end(); )
+    {
+        if (it->second.frame->getReferenceCount() == 1)
+        {
+            CCLOG("cocos2d: DynamicAtlasCache: removing unused frame: %s", it->first.c_str());
+            auto next = std::next(it);
+            removeEntry(it);
+            it = next;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void DynamicAtlasCache::removeAllSpriteFrames()
+{
+    for (auto& entry : _entries)
+    {
+        entry.second.frame->release();
+    }
+    _entries.clear();
+    _rejectedFiles.clear();
+
+    for (auto page : _pages)
+    {
+        page->texture->release();
+        delete page;
+    }
+    _pages.clear();
+}
+
+void DynamicAtlasCache::removeEntry(std::unordered_map<std::string, Entry>::iterator it)
+{
+    Page* page = it->second.page;
+    it->second.frame->release();
+    FreeRect slot = it->second.slot;
+    _entries.erase(it);
+
+    freeSlot(page, slot);
+}
+
+DynamicAtlasCache::Page* DynamicAtlasCache::createPage()
+{
+    Texture2D* texture = new (std::nothrow) Texture2D();
+    if (texture == nullptr || !initPageTexture(texture, _pageSize))
+    {
+        CC_SAFE_RELEASE(texture);
+        return nullptr;
+    }
+
+    Page* page = new (std::nothrow) Page();
+    page->texture = texture;
+    page->packer.reset(_pageSize, _pageSize);
+    page->frames = 0;
+    _pages.push_back(page);
+    return page;
+}
+
+bool DynamicAtlasCache::initPageTexture(Texture2D* texture, int size)
+{
+    // going through Image marks the page as premultiplied, which is what every slot holds
+    std::vector<unsigned char> blank(size * size * 4, 0);
+    Image* image = new (std::nothrow) Image();
+    bool ret = image
+        && image->initWithRawData(blank.data(), blank.size(), size, size, 8, true)
+        && texture->initWithImage(image, Texture2D::PixelFormat::RGBA8888);
+    CC_SAFE_RELEASE(image);
+    return ret;
+}
+
+bool DynamicAtlasCache::allocate(Page* page, int width, int height, int* x, int* y)
+{
+    // reuse the tightest freed slot first, then grow the skyline
+    int best = -1;
+    int bestWaste = 0;
+    for (size_t i = 0; i < page->freeRects.size(); ++i)
+    {
+        const FreeRect& rect = page->freeRects[i];
+        if (rect.width < width || rect.height < height)
+            continue;
+
+        int waste = rect.width * rect.height - width * height;
+        if (best < 0 || waste < bestWaste)
+        {
+            best = static_cast<int>(i);
+            bestWaste = waste;
+        }
+    }
+
+    if (best >= 0)
+    {
+        FreeRect rect = page->freeRects[best];
+        page->freeRects.erase(page->freeRects.begin() + best);
+
+        // guillotine split along the shorter leftover axis
+        FreeRect right, bottom;
+        if (rect.width - width < rect.height - height)
+        {
+            right = { rect.x + width, rect.y, rect.width - width, height };
+            bottom = { rect.x, rect.y + height, rect.width, rect.height - height };
+        }
+        else
+        {
+            right = { rect.x + width, rect.y, rect.width - width, rect.height };
+            bottom = { rect.x, rect.y + height, width, rect.height - height };
+        }
+        if (right.width > 0 && right.height > 0)
+            page->freeRects.push_back(right);
+        if (bottom.width > 0 && bottom.height > 0)
+            page->freeRects.push_back(bottom);
+
+        *x = rect.x;
+        *y = rect.y;
+        return true;
+    }
+
+    return page->packer.insert(width, height, x, y);
+}
+
+void DynamicAtlasCache::freeSlot(Page* page, const FreeRect& slot)
+{
+    if (--page->frames > 0)
+    {
+        page->freeRects.push_back(slot);
+        return;
+    }
+
+    // empty pages start over; keep one around so the next image doesn't reallocate
+    if (_pages.size() > 1)
+    {
+        releasePage(page);
+    }
+    else
+    {
+        page->packer.reset(page->packer.getWidth(), page->packer.getHeight());
+        page->freeRects.clear();
+    }
+}
+
+void DynamicAtlasCache::releasePage(Page* page)
+{
+    auto it = std::find(_pages.begin(), _pages.end(), page);
+    if (it != _pages.end())
+    {
+        _pages.erase(it);
+    }
+    page->texture->release();
+    delete page;
+}
+
+DynamicAtlasCache::Stats DynamicAtlasCache::getStats() const
+{
+    Stats stats;
+    stats.pages = static_cast<int>(_pages.size());
+    stats.frames = static_cast<int>(_entries.size());
+    stats.rejectedFiles = static_cast<int>(_rejectedFiles.size());
+    stats.usedPixels = 0;
+    stats.pagePixels = 0;
+    for (auto& entry : _entries)
+    {
+        stats.usedPixels += entry.second.slot.width * entry.second.slot.height;
+    }
+    for (auto page : _pages)
+    {
+        stats.pagePixels += page->packer.getWidth() * page->packer.getHeight();
+    }
+    return stats;
+}
+
+std::string DynamicAtlasCache::getCachedAtlasInfo() const
+{
+    std::string buffer;
+    char buftmp[4096];
+
+    for (size_t i = 0; i < _pages.size(); ++i)
+    {
+        const Page* page = _pages[i];
+        snprintf(buftmp, sizeof(buftmp) - 1, "page %lu id=%lu %d x %d frames=%d skyline=%.1f%% freed slots=%lu\n",
+            (unsigned long)i,
+            (unsigned long)page->texture->getName(),
+            page->packer.getWidth(),
+            page->packer.getHeight(),
+            page->frames,
+            page->packer.getOccupancy() * 100.0f,
+            (unsigned long)page->freeRects.size());
+        buffer += buftmp;
+    }
+
+    for (auto& entry : _entries)
+    {
+        const FreeRect& slot = entry.second.slot;
+        snprintf(buftmp, sizeof(buftmp) - 1, "\"%s\" rc=%lu %d x %d at %d,%d\n",
+            entry.first.c_str(),
+            (unsigned long)entry.second.frame->getReferenceCount(),
+            slot.width - SLOT_PADDING * 2,
+            slot.height - SLOT_PADDING * 2,
+            slot.x,
+            slot.y);
+        buffer += buftmp;
+    }
+
+    Stats stats = getStats();
+    snprintf(buftmp, sizeof(buftmp) - 1, "DynamicAtlasCache: %d pages, %d frames, %.1f%% used, %d rejected files\n",
+        stats.pages,
+        stats.frames,
+        stats.pagePixels > 0 ? stats.usedPixels * 100.0f / stats.pagePixels : 0.0f,
+        stats.rejectedFiles);
+    buffer += buftmp;
+
+    return buffer;
+}
+
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+void DynamicAtlasCache::listenRendererRecreated(EventCustom* /*event*/)
+{
+    // the page contents are gone with the GL context, upload every packed image again
+    for (auto page : _pages)
+    {
+        initPageTexture(page->texture, page->packer.getWidth());
+    }
+
+    std::vector<unsigned char> pixels;
+    for (auto& entry : _entries)
+    {
+        int width = 0;
+        int height = 0;
+        const FreeRect& slot = entry.second.slot;
+        if (loadSlotPixels(entry.first, INT_MAX, pixels, &width, &height)
+            && width + SLOT_PADDING * 2 == slot.width
+            && height + SLOT_PADDING * 2 == slot.height)
+        {
+            uploadSlotPixels(entry.second.page->texture, pixels, slot.x, slot.y, slot.width, slot.height);
+        }
+    }
+}
+#endif
+
+NS_CC_END
@@ -0,0 +1,187 @@
+/****************************************************************************
+ Copyright (c) 2013-2017 Chukong Technologies
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+ 
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __2D_CCDYNAMIC_ATLAS_CACHE_H__
+#define __2D_CCDYNAMIC_ATLAS_CACHE_H__
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "2d/CCSkylinePacker.h"
+#include "base/CCRef.h"
+#include "base/ccConfig.h"
+
+NS_CC_BEGIN
+
+class SpriteFrame;
+class Texture2D;
+class Image;
+class EventCustom;
+class EventListenerCustom;
+
+/**
+ * @addtogroup _2d
+ * @{
+ */
+
+/** @class DynamicAtlasCache
+ * @brief Singleton that packs small loose images into shared atlas pages at load time.
+ *
+ * Sprites created from separate image files each have their own texture, which breaks
+ * batching in the Renderer. When enabled, Sprite::create(filename) asks this cache for a
+ * SpriteFrame first: images no larger than the max sprite size are copied into a shared
+ * RGBA8888 page, so sprites sharing a page also share a texture and batch together.
+ *
+ * Frames only referenced by the cache can be removed with removeUnusedSpriteFrames().
+ * Their slots are reused by later images, and pages that become empty are released.
+ * Frames that are still in use are never moved.
+ * @since v3.18
+ */
+class CC_DLL DynamicAtlasCache : public Ref
+{
+public:
+    struct Stats
+    {
+        /** Number of atlas pages. */
+        int pages;
+        /** Number of packed images. */
+        int frames;
+        /** Number of files that were looked up but could not be packed. */
+        int rejectedFiles;
+        /** Pixels covered by packed images, padding included. */
+        size_t usedPixels;
+        /** Pixels in all pages. */
+        size_t pagePixels;
+    };
+
+    /** Returns the shared instance of the cache. */
+    static DynamicAtlasCache* getInstance();
+
+    /** Releases the shared instance, its pages and its frames. */
+    static void destroyInstance();
+
+    /** Whether Sprite::create(filename) packs images into the atlas. Disabled by default. */
+    void setEnabled(bool enabled) { _enabled = enabled; }
+    bool isEnabled() const { return _enabled; }
+
+    /** Size in pixels of the atlas pages created from now on. Defaults to 1024. */
+    void setPageSize(int size);
+    int getPageSize() const { return _pageSize; }
+
+    /** Images wider or taller than this, in pixels, are not packed. Defaults to 256. */
+    void setMaxSpriteSize(int size) { _maxSpriteSize = size; }
+    int getMaxSpriteSize() const { return _maxSpriteSize; }
+
+    /** Returns a SpriteFrame for the whole image, packing it into a page if needed.
+     *
+     * @param filename The image file.
+     * @return The frame, or nullptr if the image is too large, not RGB(A)8888 or can't be read.
+     */
+    SpriteFrame* getSpriteFrame(const std::string& filename);
+
+    /** Whether the image has already been packed. */
+    bool hasSpriteFrame(const std::string& filename) const;
+
+    /** Removes the frame of an image and frees its slot.
+     * Sprites still using the frame keep drawing it until the slot is reused, so only
+     * call this for images that are no longer displayed.
+     */
+    void removeSpriteFrame(const std::string& filename);
+
+    /** Removes the frames only referenced by the cache, freeing their slots.
+     * It is convenient to call this method when starting a new Scene.
+     */
+    void removeUnusedSpriteFrames();
+
+    /** Removes every frame and page. Sprites keep their frames and textures alive. */
+    void removeAllSpriteFrames();
+
+    /** Returns packing statistics. */
+    Stats getStats() const;
+
+    /** Outputs the pages, their occupancy and the packed images. */
+    std::string getCachedAtlasInfo() const;
+
+    /**
+     * @js ctor
+     */
+    DynamicAtlasCache();
+    /**
+     * @js NA
+     * @lua NA
+     */
+    virtual ~DynamicAtlasCache();
+
+protected:
+    struct FreeRect
+    {
+        int x;
+        int y;
+        int width;
+        int height;
+    };
+
+    struct Page
+    {
+        Texture2D* texture;
+        SkylinePacker packer;
+        std::vector<FreeRect> freeRects;
+        int frames;
+    };
+
+    struct Entry
+    {
+        SpriteFrame* frame;
+        Page* page;
+        // slot in the page, padding included
+        FreeRect slot;
+    };
+
+    Page* createPage();
+    bool initPageTexture(Texture2D* texture, int size);
+    bool allocate(Page* page, int width, int height, int* x, int* y);
+    void freeSlot(Page* page, const FreeRect& slot);
+    void removeEntry(std::unordered_map<std::string, Entry>::iterator it);
+    void releasePage(Page* page);
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    void listenRendererRecreated(EventCustom* event);
+    EventListenerCustom* _rendererRecreatedListener;
+#endif
+
+    std::unordered_map<std::string, Entry> _entries;
+    std::unordered_set<std::string> _rejectedFiles;
+    std::vector<Page*> _pages;
+    bool _enabled;
+    int _pageSize;
+    int _maxSpriteSize;
+};
+
+// end of _2d group
+/// @}
+
+NS_CC_END
+
+#endif //__2D_CCDYNAMIC_ATLAS_CACHE_H__
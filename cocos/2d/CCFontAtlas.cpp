@@ -31,11 +31,22 @@
 #include "platform/android/jni/Java_org_cocos2dx_lib_Cocos2dxHelper.h"
 #endif
 #include "2d/CCFontFreeType.h"
+#include "2d/CCTextShaper.h"
 #include "base/ccUTF8.h"
 #include "base/CCDirector.h"
 #include "base/CCEventListenerCustom.h"
 #include "base/CCEventDispatcher.h"
 #include "base/CCEventType.h"
+#include "base/CCAsyncTaskPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 NS_CC_BEGIN
 
@@ -44,15 +55,36 @@ const int FontAtlas::CacheTextureHeight = 512;
 const char* FontAtlas::CMD_PURGE_FONTATLAS = "__cc_PURGE_FONTATLAS";
 const char* FontAtlas::CMD_RESET_FONTATLAS = "__cc_RESET_FONTATLAS";
 
+int FontAtlas::s_defaultPageWidth = FontAtlas::CacheTextureWidth;
+int FontAtlas::s_defaultPageHeight = FontAtlas::CacheTextureHeight;
+
+namespace {
+
+struct PrewarmGlyph
+{
+    char32_t utf32Char;
+    unsigned int charCode;
+    GlyphBitmap glyph;
+    bool valid;
+};
+
+} // namespace
+
 FontAtlas::FontAtlas(Font &theFont) 
 : _font(&theFont)
 , _fontFreeType(nullptr)
 , _iconv(nullptr)
 , _currentPageData(nullptr)
+, _pageWidth(s_defaultPageWidth)
+, _pageHeight(s_defaultPageHeight)
+, _dirtyMinX(INT_MAX)
+, _dirtyMinY(INT_MAX)
+, _dirtyMaxX(0)
+, _dirtyMaxY(0)
+, _generation(0)
 , _fontAscender(0)
 , _rendererRecreatedListener(nullptr)
 , _antialiasEnabled(true)
-, _currLineHeight(0)
 {
     _font->retain();
 
@@ -62,8 +94,6 @@ FontAtlas::FontAtlas(Font &theFont)
         _lineHeight = _font->getFontMaxHeight();
         _fontAscender = _fontFreeType->getFontAscender();
         _currentPage = 0;
-        _currentPageOrigX = 0;
-        _currentPageOrigY = 0;
         _letterEdgeExtend = 2;
         _letterPadding = 0;
 
@@ -71,6 +101,10 @@ FontAtlas::FontAtlas(Font &theFont)
         {
             _letterPadding += 2 * FontFreeType::DistanceMapSpread;    
         }
+        else if (_fontFreeType->isMSDFEnabled())
+        {
+            _letterPadding += 2 * FontFreeType::MSDFSpread;
+        }
 
 #if CC_ENABLE_CACHE_TEXTURE_DATA
         auto eventDispatcher = Director::getInstance()->getEventDispatcher();
@@ -91,21 +125,21 @@ void FontAtlas::reinit()
     
     auto texture = new (std::nothrow) Texture2D;
     
-    _currentPageDataSize = CacheTextureWidth * CacheTextureHeight;
+    _currentPageDataSize = _pageWidth * _pageHeight * getPageBytesPerPixel();
+    _packer.reset(_pageWidth, _pageHeight);
     
     auto outlineSize = _fontFreeType->getOutlineSize();
     if(outlineSize > 0)
     {
         _lineHeight += 2 * outlineSize;
-        _currentPageDataSize *= 2;
     }
     
     _currentPageData = new (std::nothrow) unsigned char[_currentPageDataSize];
     memset(_currentPageData, 0, _currentPageDataSize);
     
-    auto  pixelFormat = outlineSize > 0 ? Texture2D::PixelFormat::AI88 : Texture2D::PixelFormat::A8;
+    auto  pixelFormat = getPagePixelFormat();
     texture->initWithData(_currentPageData, _currentPageDataSize,
-                          pixelFormat, CacheTextureWidth, CacheTextureHeight, Size(CacheTextureWidth,CacheTextureHeight) );
+                          pixelFormat, _pageWidth, _pageHeight, Size(_pageWidth, _pageHeight) );
     
     addTexture(texture,0);
     texture->release();
@@ -122,6 +156,7 @@ FontAtlas::~FontAtlas()
     }
 #endif
 
+    TextShaper::removeFont(_font);
     _font->release();
     releaseTextures();
 
@@ -140,11 +175,12 @@ void FontAtlas::reset()
 {
     releaseTextures();
     
-    _currLineHeight = 0;
     _currentPage = 0;
-    _currentPageOrigX = 0;
-    _currentPageOrigY = 0;
+    _dirtyMinX = _dirtyMinY = INT_MAX;
+    _dirtyMaxX = _dirtyMaxY = 0;
     _letterDefinitions.clear();
+    _pendingGlyphs.clear();
+    ++_generation;
     
     reinit();
 }
@@ -352,119 +388,296 @@ bool FontAtlas::prepareLetterDefinitions(const std::u32string& utf32Text)
         return false;
     }
 
-    int adjustForDistanceMap = _letterPadding / 2;
-    int adjustForExtend = _letterEdgeExtend / 2;
-    long bitmapWidth;
-    long bitmapHeight;
-    int glyphHeight;
-    Rect tempRect;
-    FontLetterDefinition tempDef;
+    if (_fontFreeType->isMSDFEnabled() && codeMapOfNewChar.size() >= 4)
+    {
+        renderGlyphsInParallel(codeMapOfNewChar);
+    }
+    else
+    {
+        GlyphBitmap glyph;
+        for (auto&& it : codeMapOfNewChar)
+        {
+            bool valid = _fontFreeType->renderGlyph(it.second, glyph);
+            addGlyph(it.first, glyph, valid);
+        }
+    }
+
+    flushDirtyRegion();
+
+    return true;
+}
+
+void FontAtlas::renderGlyphsInParallel(const std::unordered_map<unsigned int, unsigned int>& codeMapOfNewChar)
+{
+    // distance fields take much longer than the FreeType calls renderGlyph serializes,
+    // so the glyphs are generated on the compute threads and added to the page in order afterwards
+    struct RenderJob
+    {
+        std::vector<std::pair<unsigned int, unsigned int>> chars;
+        std::vector<GlyphBitmap> glyphs;
+        std::vector<char> valid;
+        std::atomic<size_t> next;
+        size_t rendered;
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+
+    // helpers only reach the job through the shared pointer, one that starts after all glyphs
+    // are rendered finds nothing left to do
+    auto job = std::make_shared<RenderJob>();
+    job->chars.assign(codeMapOfNewChar.begin(), codeMapOfNewChar.end());
+    job->glyphs.resize(job->chars.size());
+    job->valid.resize(job->chars.size(), 0);
+    job->next = 0;
+    job->rendered = 0;
+
+    auto font = _fontFreeType;
+    auto work = [job, font]() {
+        size_t count = 0;
+        for (size_t index = job->next++; index < job->chars.size(); index = job->next++)
+        {
+            job->valid[index] = font->renderGlyph(job->chars[index].second, job->glyphs[index]);
+            ++count;
+        }
+        if (count > 0)
+        {
+            std::lock_guard<std::mutex> lock(job->mutex);
+            job->rendered += count;
+            if (job->rendered == job->chars.size())
+                job->finished.notify_all();
+        }
+    };
+
+    size_t helperCount = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()) - 1, job->chars.size() - 1);
+    for (size_t index = 0; index < helperCount; ++index)
+    {
+        AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_COMPUTE, work);
+    }
+    // the main thread works too, so this finishes even when the compute threads are busy
+    work();
+    {
+        std::unique_lock<std::mutex> lock(job->mutex);
+        job->finished.wait(lock, [&job]() { return job->rendered == job->chars.size(); });
+    }
+
+    for (size_t index = 0; index < job->chars.size(); ++index)
+    {
+        addGlyph(job->chars[index].first, job->glyphs[index], job->valid[index] != 0);
+    }
+}
+
+void FontAtlas::prewarm(const std::string& utf8Characters)
+{
+    std::u32string utf32;
+    if (StringUtils::UTF8ToUTF32(utf8Characters, utf32))
+    {
+        prewarm(utf32);
+    }
+}
 
-    auto scaleFactor = CC_CONTENT_SCALE_FACTOR();
-    auto  pixelFormat = _fontFreeType->getOutlineSize() > 0 ? Texture2D::PixelFormat::AI88 : Texture2D::PixelFormat::A8;
+void FontAtlas::prewarm(const std::u32string& characters)
+{
+    if (_fontFreeType == nullptr)
+    {
+        return;
+    }
 
-    float startY = _currentPageOrigY;
+    if (!_currentPageData)
+        reinit();
 
+    std::unordered_map<unsigned int, unsigned int> codeMapOfNewChar;
+    findNewCharacters(characters, codeMapOfNewChar);
+
+    auto batch = std::make_shared<std::vector<PrewarmGlyph>>();
     for (auto&& it : codeMapOfNewChar)
     {
-        auto bitmap = _fontFreeType->getGlyphBitmap(it.second, bitmapWidth, bitmapHeight, tempRect, tempDef.xAdvance);
-        if (bitmap && bitmapWidth > 0 && bitmapHeight > 0)
+        if (_pendingGlyphs.insert(it.first).second)
         {
-            tempDef.validDefinition = true;
-            tempDef.width = tempRect.size.width + _letterPadding + _letterEdgeExtend;
-            tempDef.height = tempRect.size.height + _letterPadding + _letterEdgeExtend;
-            tempDef.offsetX = tempRect.origin.x - adjustForDistanceMap - adjustForExtend;
-            tempDef.offsetY = _fontAscender + tempRect.origin.y - adjustForDistanceMap - adjustForExtend;
+            PrewarmGlyph item;
+            item.utf32Char = it.first;
+            item.charCode = it.second;
+            item.valid = false;
+            batch->push_back(item);
+        }
+    }
+    if (batch->empty())
+    {
+        return;
+    }
 
-            if (_currentPageOrigX + tempDef.width > CacheTextureWidth)
+    // the atlas, and through it the font, stays alive until the callback ran
+    retain();
+    auto font = _fontFreeType;
+    auto generation = _generation;
+    AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_OTHER, [this, batch, generation](void*) {
+        if (generation == _generation)
+        {
+            for (auto&& item : *batch)
             {
-                _currentPageOrigY += _currLineHeight;
-                _currLineHeight = 0;
-                _currentPageOrigX = 0;
-                if (_currentPageOrigY + _lineHeight + _letterPadding + _letterEdgeExtend >= CacheTextureHeight)
+                _pendingGlyphs.erase(item.utf32Char);
+                // prepareLetterDefinitions may have needed it before the worker was done
+                if (_letterDefinitions.find(item.utf32Char) == _letterDefinitions.end())
                 {
-                    unsigned char *data = nullptr;
-                    if (pixelFormat == Texture2D::PixelFormat::AI88)
-                    {
-                        data = _currentPageData + CacheTextureWidth * (int)startY * 2;
-                    }
-                    else
-                    {
-                        data = _currentPageData + CacheTextureWidth * (int)startY;
-                    }
-                    _atlasTextures[_currentPage]->updateWithData(data, 0, startY,
-                        CacheTextureWidth, CacheTextureHeight - startY);
-
-                    startY = 0.0f;
-
-                    _currentPageOrigY = 0;
-                    memset(_currentPageData, 0, _currentPageDataSize);
-                    _currentPage++;
-                    auto tex = new (std::nothrow) Texture2D;
-                    if (_antialiasEnabled)
-                    {
-                        tex->setAntiAliasTexParameters();
-                    }
-                    else
-                    {
-                        tex->setAliasTexParameters();
-                    }
-                    tex->initWithData(_currentPageData, _currentPageDataSize,
-                        pixelFormat, CacheTextureWidth, CacheTextureHeight, Size(CacheTextureWidth, CacheTextureHeight));
-                    addTexture(tex, _currentPage);
-                    tex->release();
+                    addGlyph(item.utf32Char, item.glyph, item.valid);
                 }
             }
-            glyphHeight = static_cast<int>(bitmapHeight) + _letterPadding + _letterEdgeExtend;
-            if (glyphHeight > _currLineHeight)
+            flushDirtyRegion();
+        }
+        release();
+    }, nullptr, [font, batch]() {
+        for (auto&& item : *batch)
+        {
+            item.valid = font->renderGlyph(item.charCode, item.glyph);
+        }
+    });
+}
+
+void FontAtlas::addGlyph(char32_t utf32Char, const GlyphBitmap& glyph, bool valid)
+{
+    FontLetterDefinition tempDef;
+    tempDef.xAdvance = glyph.xAdvance;
+
+    if (valid && !glyph.data.empty())
+    {
+        int adjustForDistanceMap = _letterPadding / 2;
+        int adjustForExtend = _letterEdgeExtend / 2;
+        auto scaleFactor = CC_CONTENT_SCALE_FACTOR();
+
+        tempDef.validDefinition = true;
+        tempDef.width = glyph.rect.size.width + _letterPadding + _letterEdgeExtend;
+        tempDef.height = glyph.rect.size.height + _letterPadding + _letterEdgeExtend;
+        tempDef.offsetX = glyph.rect.origin.x - adjustForDistanceMap - adjustForExtend;
+        tempDef.offsetY = _fontAscender + glyph.rect.origin.y - adjustForDistanceMap - adjustForExtend;
+
+        // one pixel gap between glyphs so linear filtering doesn't pick up the neighbours
+        int slotWidth = std::max(static_cast<int>(tempDef.width), static_cast<int>(glyph.width) + _letterEdgeExtend) + 1;
+        int slotHeight = std::max(static_cast<int>(tempDef.height), static_cast<int>(glyph.height) + _letterEdgeExtend) + 1;
+        int x = 0;
+        int y = 0;
+        if (!_packer.insert(slotWidth, slotHeight, &x, &y))
+        {
+            flushDirtyRegion();
+            addPage();
+            if (!_packer.insert(slotWidth, slotHeight, &x, &y))
             {
-                _currLineHeight = glyphHeight;
+                CCLOG("FontAtlas: glyph %u (%d x %d) doesn't fit in a %d x %d page", (unsigned int)utf32Char, slotWidth, slotHeight, _pageWidth, _pageHeight);
+                tempDef.validDefinition = false;
+                _letterDefinitions[utf32Char] = tempDef;
+                return;
             }
-            _fontFreeType->renderCharAt(_currentPageData, _currentPageOrigX + adjustForExtend, _currentPageOrigY + adjustForExtend, bitmap, bitmapWidth, bitmapHeight);
-
-            tempDef.U = _currentPageOrigX;
-            tempDef.V = _currentPageOrigY;
-            tempDef.textureID = _currentPage;
-            _currentPageOrigX += tempDef.width + 1;
-            // take from pixels to points
-            tempDef.width = tempDef.width / scaleFactor;
-            tempDef.height = tempDef.height / scaleFactor;
-            tempDef.U = tempDef.U / scaleFactor;
-            tempDef.V = tempDef.V / scaleFactor;
         }
-        else{
-            if(bitmap)
-                delete[] bitmap;
-            if (tempDef.xAdvance)
-                tempDef.validDefinition = true;
-            else
-                tempDef.validDefinition = false;
 
-            tempDef.width = 0;
-            tempDef.height = 0;
-            tempDef.U = 0;
-            tempDef.V = 0;
-            tempDef.offsetX = 0;
-            tempDef.offsetY = 0;
-            tempDef.textureID = 0;
-            _currentPageOrigX += 1;
-        }
+        _fontFreeType->renderCharAt(_currentPageData, _pageWidth, x + adjustForExtend, y + adjustForExtend, glyph);
+
+        _dirtyMinX = std::min(_dirtyMinX, x);
+        _dirtyMinY = std::min(_dirtyMinY, y);
+        _dirtyMaxX = std::max(_dirtyMaxX, x + slotWidth);
+        _dirtyMaxY = std::max(_dirtyMaxY, y + slotHeight);
+
+        tempDef.textureID = _currentPage;
+        // take from pixels to points
+        tempDef.width = tempDef.width / scaleFactor;
+        tempDef.height = tempDef.height / scaleFactor;
+        tempDef.U = x / scaleFactor;
+        tempDef.V = y / scaleFactor;
+    }
+    else
+    {
+        tempDef.validDefinition = tempDef.xAdvance != 0;
+        tempDef.width = 0;
+        tempDef.height = 0;
+        tempDef.U = 0;
+        tempDef.V = 0;
+        tempDef.offsetX = 0;
+        tempDef.offsetY = 0;
+        tempDef.textureID = 0;
+    }
+
+    _letterDefinitions[utf32Char] = tempDef;
+}
+
+void FontAtlas::addPage()
+{
+    auto pixelFormat = getPagePixelFormat();
+
+    memset(_currentPageData, 0, _currentPageDataSize);
+    _currentPage++;
+    _packer.reset(_pageWidth, _pageHeight);
 
-        _letterDefinitions[it.first] = tempDef;
+    auto tex = new (std::nothrow) Texture2D;
+    if (_antialiasEnabled)
+    {
+        tex->setAntiAliasTexParameters();
     }
+    else
+    {
+        tex->setAliasTexParameters();
+    }
+    tex->initWithData(_currentPageData, _currentPageDataSize,
+        pixelFormat, _pageWidth, _pageHeight, Size(_pageWidth, _pageHeight));
+    addTexture(tex, _currentPage);
+    tex->release();
+}
 
-    unsigned char *data = nullptr;
-    if (pixelFormat == Texture2D::PixelFormat::AI88)
+void FontAtlas::flushDirtyRegion()
+{
+    if (_dirtyMaxX <= _dirtyMinX || _dirtyMaxY <= _dirtyMinY)
     {
-        data = _currentPageData + CacheTextureWidth * (int)startY * 2;
+        return;
+    }
+
+    int minX = _dirtyMinX;
+    int maxX = std::min(_dirtyMaxX, _pageWidth);
+    int minY = _dirtyMinY;
+    int maxY = std::min(_dirtyMaxY, _pageHeight);
+    int bytesPerPixel = getPageBytesPerPixel();
+    int width = maxX - minX;
+    int height = maxY - minY;
+
+    // rows are tightly packed, and the unpack alignment is whatever the last texture upload left
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    if (width == _pageWidth)
+    {
+        _atlasTextures[_currentPage]->updateWithData(_currentPageData + minY * _pageWidth * bytesPerPixel, 0, minY, width, height);
     }
     else
     {
-        data = _currentPageData + CacheTextureWidth * (int)startY;
+        std::vector<unsigned char> region(width * height * bytesPerPixel);
+        for (int y = 0; y < height; ++y)
+        {
+            memcpy(&region[y * width * bytesPerPixel],
+                   _currentPageData + ((minY + y) * _pageWidth + minX) * bytesPerPixel,
+                   width * bytesPerPixel);
+        }
+        _atlasTextures[_currentPage]->updateWithData(region.data(), minX, minY, width, height);
     }
-    _atlasTextures[_currentPage]->updateWithData(data, 0, startY, CacheTextureWidth, _currentPageOrigY - startY + _currLineHeight);
 
-    return true;
+    _dirtyMinX = _dirtyMinY = INT_MAX;
+    _dirtyMaxX = _dirtyMaxY = 0;
+}
+
+Texture2D::PixelFormat FontAtlas::getPagePixelFormat() const
+{
+    if (_fontFreeType->isMSDFEnabled())
+    {
+        return Texture2D::PixelFormat::RGB888;
+    }
+    return _fontFreeType->getOutlineSize() > 0 ? Texture2D::PixelFormat::AI88 : Texture2D::PixelFormat::A8;
+}
+
+int FontAtlas::getPageBytesPerPixel() const
+{
+    if (_fontFreeType->isMSDFEnabled())
+    {
+        return 3;
+    }
+    return _fontFreeType->getOutlineSize() > 0 ? 2 : 1;
+}
+
+void FontAtlas::setDefaultPageSize(int width, int height)
+{
+    s_defaultPageWidth = (width + 3) & ~3;
+    s_defaultPageHeight = height;
 }
 
 void FontAtlas::addTexture(Texture2D *texture, int slot)
@@ -31,18 +31,21 @@
 
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "platform/CCPlatformMacros.h"
 #include "base/CCRef.h"
 #include "platform/CCStdC.h" // ssize_t on windows
+#include "2d/CCSkylinePacker.h"
+#include "renderer/CCTexture2D.h"
 
 NS_CC_BEGIN
 
 class Font;
-class Texture2D;
 class EventCustom;
 class EventListenerCustom;
 class FontFreeType;
+struct GlyphBitmap;
 
 struct FontLetterDefinition
 {
@@ -79,6 +82,31 @@ public:
     
     bool prepareLetterDefinitions(const std::u32string& utf16String);
 
+    /** Rasterizes characters on a worker thread and adds them to the atlas once done,
+     so labels showing them later don't stall the frame. Characters that are already in
+     the atlas or still in flight are skipped.
+     @since v3.18
+     */
+    void prewarm(const std::u32string& characters);
+    void prewarm(const std::string& utf8Characters);
+
+    /** Whether prewarmed characters are still being rasterized. */
+    bool isPrewarming() const { return !_pendingGlyphs.empty(); }
+
+    /** Changes whenever the atlas is reset and every letter definition is rebuilt. */
+    unsigned int getGeneration() const { return _generation; }
+
+    /** Sets the size of the glyph pages of atlases created from now on.
+     The width is rounded up to a multiple of 4. Defaults to CacheTextureWidth x CacheTextureHeight.
+     @since v3.18
+     */
+    static void setDefaultPageSize(int width, int height);
+    static int getDefaultPageWidth() { return s_defaultPageWidth; }
+    static int getDefaultPageHeight() { return s_defaultPageHeight; }
+
+    int getPageWidth() const { return _pageWidth; }
+    int getPageHeight() const { return _pageHeight; }
+
     const std::unordered_map<ssize_t, Texture2D*>& getTextures() const { return _atlasTextures; }
     void  addTexture(Texture2D *texture, int slot);
     float getLineHeight() const { return _lineHeight; }
@@ -122,6 +150,14 @@ protected:
 
     void conversionU32TOGB2312(const std::u32string& u32Text, std::unordered_map<unsigned int, unsigned int>& charCodeMap);
 
+    void addGlyph(char32_t utf32Char, const GlyphBitmap& glyph, bool valid);
+    void renderGlyphsInParallel(const std::unordered_map<unsigned int, unsigned int>& codeMapOfNewChar);
+    void addPage();
+    void flushDirtyRegion();
+    // A8 glyphs, AI88 (outline, glyph) pairs or RGB888 multi-channel distance fields
+    Texture2D::PixelFormat getPagePixelFormat() const;
+    int getPageBytesPerPixel() const;
+
     /**
      * Scale each font letter by scaleFactor.
      *
@@ -140,15 +176,26 @@ protected:
     int _currentPage;
     unsigned char *_currentPageData;
     int _currentPageDataSize;
-    float _currentPageOrigX;
-    float _currentPageOrigY;
+    int _pageWidth;
+    int _pageHeight;
+    SkylinePacker _packer;
+    // region of the current page written since the last upload
+    int _dirtyMinX;
+    int _dirtyMinY;
+    int _dirtyMaxX;
+    int _dirtyMaxY;
+    std::unordered_set<char32_t> _pendingGlyphs;
+    // bumped on reset so prewarm results for the old pages are dropped
+    unsigned int _generation;
     int _letterPadding;
     int _letterEdgeExtend;
 
     int _fontAscender;
     EventListenerCustom* _rendererRecreatedListener;
     bool _antialiasEnabled;
-    int _currLineHeight;
+
+    static int s_defaultPageWidth;
+    static int s_defaultPageHeight;
 
     friend class Label;
 };
@@ -62,7 +62,15 @@ FontAtlas* FontAtlasCache::getFontAtlasTTF(const _ttfConfig* config)
 
     std::string key;
     char keyPrefix[ATLAS_MAP_KEY_PREFIX_BUFFER_SIZE];
-    snprintf(keyPrefix, ATLAS_MAP_KEY_PREFIX_BUFFER_SIZE, useDistanceField ? "df %.2f %d " : "%.2f %d ", config->fontSize, config->outlineSize);
+    if (config->msdfEnabled)
+    {
+        // one atlas per file, generated at a fixed size and scaled by the label
+        snprintf(keyPrefix, ATLAS_MAP_KEY_PREFIX_BUFFER_SIZE, "msdf ");
+    }
+    else
+    {
+        snprintf(keyPrefix, ATLAS_MAP_KEY_PREFIX_BUFFER_SIZE, useDistanceField ? "df %.2f %d " : "%.2f %d ", config->fontSize, config->outlineSize);
+    }
     std::string atlasName(keyPrefix);
     atlasName += realFontFilename;
 
@@ -70,8 +78,17 @@ FontAtlas* FontAtlasCache::getFontAtlasTTF(const _ttfConfig* config)
 
     if ( it == _atlasMap.end() )
     {
-        auto font = FontFreeType::create(realFontFilename, config->fontSize, config->glyphs,
-            config->customGlyphs, useDistanceField, config->outlineSize);
+        FontFreeType* font = nullptr;
+        if (config->msdfEnabled)
+        {
+            font = FontFreeType::create(realFontFilename, FontFreeType::MSDFFontSize, config->glyphs,
+                config->customGlyphs, false, 0, true);
+        }
+        else
+        {
+            font = FontFreeType::create(realFontFilename, config->fontSize, config->glyphs,
+                config->customGlyphs, useDistanceField, config->outlineSize);
+        }
         if (font)
         {
             auto tempAtlas = font->createFontAtlas();
@@ -88,6 +105,15 @@ FontAtlas* FontAtlasCache::getFontAtlasTTF(const _ttfConfig* config)
     return nullptr;
 }
 
+void FontAtlasCache::prewarmFontAtlasTTF(const _ttfConfig* config, const std::string& characters)
+{
+    auto atlas = getFontAtlasTTF(config);
+    if (atlas)
+    {
+        atlas->prewarm(characters);
+    }
+}
+
 FontAtlas* FontAtlasCache::getFontAtlasFNT(const std::string& fontFileName, const Vec2& imageOffset /* = Vec2::ZERO */)
 {
     auto realFontFilename = FileUtils::getInstance()->getNewFilename(fontFileName);  // resolves real file path, to prevent storing multiple atlases for the same file.
@@ -50,6 +50,13 @@ public:
     
     static bool releaseFontAtlas(FontAtlas *atlas);
 
+    /** Rasterizes characters of a TTF font on a worker thread ahead of time.
+     The atlas stays cached until purgeCachedData(), so labels created later with
+     the same config find the glyphs ready.
+     @since v3.18
+     */
+    static void prewarmFontAtlasTTF(const _ttfConfig* config, const std::string& characters);
+
     /** Removes cached data.
      It will purge the textures atlas and if multiple texture exist in one FontAtlas.
      */
@@ -25,9 +25,13 @@ THE SOFTWARE.
 ****************************************************************************/
 
 #include "2d/CCFontFreeType.h"
+#include <mutex>
 #include FT_BBOX_H
+#include FT_OUTLINE_H
 #include "edtaa3func.h"
 #include "2d/CCFontAtlas.h"
+#include "2d/CCFontGlyphCache.h"
+#include "2d/CCFontMSDF.h"
 #include "base/CCDirector.h"
 #include "base/ccUTF8.h"
 #include "platform/CCFileUtils.h"
@@ -38,6 +42,8 @@ NS_CC_BEGIN
 FT_Library FontFreeType::_FTlibrary;
 bool       FontFreeType::_FTInitialized = false;
 const int  FontFreeType::DistanceMapSpread = 3;
+const int  FontFreeType::MSDFSpread = 4;
+const float FontFreeType::MSDFFontSize = 32.0f;
 
 const char* FontFreeType::_glyphASCII = "\"!#$%&'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~¡¢£¤¥¦§¨©ª«¬­®¯°±²³´µ¶·¸¹º»¼½¾¿ÀÁÂÃÄÅÆÇÈÉÊËÌÍÎÏÐÑÒÓÔÕÖ×ØÙÚÛÜÝÞßàáâãäåæçèéêëìíîïðñòóôõö÷øùúûüýþ ";
 const char* FontFreeType::_glyphNEHE = "!\"#$%&'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~ ";
@@ -50,9 +56,13 @@ typedef struct _DataRef
 
 static std::unordered_map<std::string, DataRef> s_cacheFontData;
 
-FontFreeType * FontFreeType::create(const std::string &fontName, float fontSize, GlyphCollection glyphs, const char *customGlyphs,bool distanceFieldEnabled /* = false */,float outline /* = 0 */)
+// FreeType objects aren't thread safe; every call that may run while glyphs
+// are rasterized on a worker thread goes through this lock
+static std::mutex s_freeTypeMutex;
+
+FontFreeType * FontFreeType::create(const std::string &fontName, float fontSize, GlyphCollection glyphs, const char *customGlyphs,bool distanceFieldEnabled /* = false */,float outline /* = 0 */, bool msdfEnabled /* = false */)
 {
-    FontFreeType *tempFont =  new (std::nothrow) FontFreeType(distanceFieldEnabled,outline);
+    FontFreeType *tempFont =  new (std::nothrow) FontFreeType(distanceFieldEnabled,outline,msdfEnabled);
 
     if (!tempFont)
         return nullptr;
@@ -98,18 +108,22 @@ FT_Library FontFreeType::getFTLibrary()
     return _FTlibrary;
 }
 
-FontFreeType::FontFreeType(bool distanceFieldEnabled /* = false */, float outline /* = 0 */)
+FontFreeType::FontFreeType(bool distanceFieldEnabled /* = false */, float outline /* = 0 */, bool msdfEnabled /* = false */)
 : _fontRef(nullptr)
 , _stroker(nullptr)
 , _encoding(FT_ENCODING_UNICODE)
-, _distanceFieldEnabled(distanceFieldEnabled)
+, _distanceFieldEnabled(distanceFieldEnabled && !msdfEnabled)
+, _msdfEnabled(msdfEnabled)
 , _outlineSize(0.0f)
 , _lineHeight(0)
 , _fontAtlas(nullptr)
+, _glyphCache(nullptr)
 , _usedGlyphs(GlyphCollection::ASCII)
 {
-    if (outline > 0.0f)
+    // multi-channel distance fields draw their outline in the shader
+    if (outline > 0.0f && !_msdfEnabled)
     {
+        std::lock_guard<std::mutex> lock(s_freeTypeMutex);
         _outlineSize = outline * CC_CONTENT_SCALE_FACTOR();
         FT_Stroker_New(FontFreeType::getFTLibrary(), &_stroker);
         FT_Stroker_Set(_stroker,
@@ -142,6 +156,7 @@ bool FontFreeType::createFontObject(const std::string &fontName, float fontSize)
         }
     }
 
+    std::lock_guard<std::mutex> lock(s_freeTypeMutex);
     if (FT_New_Memory_Face(getFTLibrary(), s_cacheFontData[fontName].data.getBytes(), s_cacheFontData[fontName].data.getSize(), 0, &face ))
         return false;
 
@@ -178,6 +193,12 @@ bool FontFreeType::createFontObject(const std::string &fontName, float fontSize)
     // store the face globally
     _fontRef = face;
     _lineHeight = static_cast<int>((_fontRef->size->metrics.ascender - _fontRef->size->metrics.descender) >> 6);
+
+    if (FontGlyphCache::isEnabled())
+    {
+        _glyphCache = FontGlyphCache::getOrCreate(s_cacheFontData[fontName].data, fontSize * CC_CONTENT_SCALE_FACTOR(), _outlineSize, _distanceFieldEnabled, _msdfEnabled);
+        CC_SAFE_RETAIN(_glyphCache);
+    }
     
     // done and good
     return true;
@@ -185,8 +206,11 @@ bool FontFreeType::createFontObject(const std::string &fontName, float fontSize)
 
 FontFreeType::~FontFreeType()
 {
+    CC_SAFE_RELEASE(_glyphCache);
+
     if (_FTInitialized)
     {
+        std::lock_guard<std::mutex> lock(s_freeTypeMutex);
         if (_stroker)
         {
             FT_Stroker_Done(_stroker);
@@ -245,9 +269,17 @@ int * FontFreeType::getHorizontalKerningForTextUTF32(const std::u32string& text,
     bool hasKerning = FT_HAS_KERNING( _fontRef ) != 0;
     if (hasKerning)
     {
+        std::lock_guard<std::mutex> lock(s_freeTypeMutex);
         for (int c = 1; c < outNumLetters; ++c)
         {
+            if (_glyphCache && _glyphCache->getKerning(text[c-1], text[c], sizes[c]))
+                continue;
+
             sizes[c] = getHorizontalKerningForChars(text[c-1], text[c]);
+            if (_glyphCache)
+            {
+                _glyphCache->addKerning(text[c-1], text[c], sizes[c]);
+            }
         }
     }
     
@@ -276,6 +308,12 @@ int  FontFreeType::getHorizontalKerningForChars(uint64_t firstChar, uint64_t sec
     return (static_cast<int>(kerning.x >> 6));
 }
 
+bool FontFreeType::hasGlyph(char32_t character) const
+{
+    std::lock_guard<std::mutex> lock(s_freeTypeMutex);
+    return _fontRef && FT_Get_Char_Index(_fontRef, character) != 0;
+}
+
 int FontFreeType::getFontAscender() const
 {
     return (static_cast<int>(_fontRef->size->metrics.ascender >> 6));
@@ -621,6 +659,152 @@ void FontFreeType::renderCharAt(unsigned char *dest,int posX, int posY, unsigned
     } 
 }
 
+bool FontFreeType::renderGlyph(uint64_t theChar, GlyphBitmap& glyph)
+{
+    bool valid = false;
+    if (_glyphCache && _glyphCache->getGlyph(theChar, glyph, valid))
+        return valid;
+
+    valid = rasterizeGlyph(theChar, glyph);
+    if (_glyphCache)
+    {
+        _glyphCache->addGlyph(theChar, glyph, valid);
+    }
+    return valid;
+}
+
+bool FontFreeType::rasterizeGlyph(uint64_t theChar, GlyphBitmap& glyph)
+{
+    if (_msdfEnabled)
+    {
+        return rasterizeMSDFGlyph(theChar, glyph);
+    }
+
+    glyph.data.clear();
+    {
+        std::lock_guard<std::mutex> lock(s_freeTypeMutex);
+        auto bitmap = getGlyphBitmap(theChar, glyph.width, glyph.height, glyph.rect, glyph.xAdvance);
+        if (bitmap && glyph.width > 0 && glyph.height > 0)
+        {
+            // the plain bitmap lives in the glyph slot and is overwritten by the next glyph
+            auto bytesPerPixel = _outlineSize > 0 ? 2 : 1;
+            glyph.data.assign(bitmap, bitmap + glyph.width * glyph.height * bytesPerPixel);
+            if (_outlineSize > 0)
+            {
+                delete [] bitmap;
+            }
+        }
+    }
+
+    if (glyph.data.empty())
+    {
+        glyph.width = 0;
+        glyph.height = 0;
+        return glyph.xAdvance != 0;
+    }
+
+    if (_distanceFieldEnabled)
+    {
+        auto distanceMap = makeDistanceMap(glyph.data.data(), glyph.width, glyph.height);
+        glyph.width += 2 * DistanceMapSpread;
+        glyph.height += 2 * DistanceMapSpread;
+        glyph.data.assign(distanceMap, distanceMap + glyph.width * glyph.height);
+        free(distanceMap);
+    }
+
+    return true;
+}
+
+namespace
+{
+    int msdfMoveTo(const FT_Vector* to, void* user)
+    {
+        static_cast<MSDFGenerator*>(user)->moveTo(to->x / 64.0, to->y / 64.0);
+        return 0;
+    }
+
+    int msdfLineTo(const FT_Vector* to, void* user)
+    {
+        static_cast<MSDFGenerator*>(user)->lineTo(to->x / 64.0, to->y / 64.0);
+        return 0;
+    }
+
+    int msdfConicTo(const FT_Vector* control, const FT_Vector* to, void* user)
+    {
+        static_cast<MSDFGenerator*>(user)->quadTo(control->x / 64.0, control->y / 64.0, to->x / 64.0, to->y / 64.0);
+        return 0;
+    }
+
+    int msdfCubicTo(const FT_Vector* control1, const FT_Vector* control2, const FT_Vector* to, void* user)
+    {
+        static_cast<MSDFGenerator*>(user)->cubicTo(control1->x / 64.0, control1->y / 64.0,
+            control2->x / 64.0, control2->y / 64.0, to->x / 64.0, to->y / 64.0);
+        return 0;
+    }
+}
+
+bool FontFreeType::rasterizeMSDFGlyph(uint64_t theChar, GlyphBitmap& glyph)
+{
+    glyph.data.clear();
+    glyph.width = 0;
+    glyph.height = 0;
+
+    MSDFGenerator generator;
+    FT_BBox bbox;
+    {
+        std::lock_guard<std::mutex> lock(s_freeTypeMutex);
+        if (_fontRef == nullptr
+            || FT_Load_Char(_fontRef, theChar, FT_LOAD_NO_BITMAP | FT_LOAD_NO_HINTING | FT_LOAD_NO_AUTOHINT))
+        {
+            return false;
+        }
+
+        auto slot = _fontRef->glyph;
+        glyph.xAdvance = static_cast<int>(slot->metrics.horiAdvance >> 6);
+        if (slot->format != FT_GLYPH_FORMAT_OUTLINE)
+        {
+            return glyph.xAdvance != 0;
+        }
+
+        // only the outline is needed, the field itself is computed without the lock
+        FT_Outline_Funcs funcs = { msdfMoveTo, msdfLineTo, msdfConicTo, msdfCubicTo, 0, 0 };
+        FT_Outline_Decompose(&slot->outline, &funcs, &generator);
+        FT_Outline_Get_CBox(&slot->outline, &bbox);
+    }
+
+    if (generator.isEmpty())
+    {
+        return glyph.xAdvance != 0;
+    }
+
+    // whole pixels around the outline, the spread is added on every side like DistanceMapSpread
+    long xMin = bbox.xMin >> 6;
+    long yMin = bbox.yMin >> 6;
+    long xMax = (bbox.xMax + 63) >> 6;
+    long yMax = (bbox.yMax + 63) >> 6;
+    glyph.rect.origin.x = xMin;
+    glyph.rect.origin.y = -yMax;
+    glyph.rect.size.width = xMax - xMin;
+    glyph.rect.size.height = yMax - yMin;
+    glyph.width = xMax - xMin + 2 * MSDFSpread;
+    glyph.height = yMax - yMin + 2 * MSDFSpread;
+    glyph.data.resize(glyph.width * glyph.height * 3);
+    generator.generate(glyph.data.data(), glyph.width, glyph.height,
+        xMin - MSDFSpread, yMax + MSDFSpread, 2.0 * MSDFSpread);
+
+    return true;
+}
+
+void FontFreeType::renderCharAt(unsigned char *dest, int destWidth, int posX, int posY, const GlyphBitmap& glyph)
+{
+    const long bytesPerPixel = _msdfEnabled ? 3 : ((_outlineSize > 0 && !_distanceFieldEnabled) ? 2 : 1);
+    const long rowSize = glyph.width * bytesPerPixel;
+    for (long y = 0; y < glyph.height; ++y)
+    {
+        memcpy(dest + ((posY + y) * destWidth + posX) * bytesPerPixel, glyph.data.data() + y * rowSize, rowSize);
+    }
+}
+
 void FontFreeType::setGlyphCollection(GlyphCollection glyphs, const char* customGlyphs /* = nullptr */)
 {
     _usedGlyphs = glyphs;
@@ -32,6 +32,7 @@
 #include "2d/CCFont.h"
 
 #include <string>
+#include <vector>
 #include "ft2build.h"
 
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_WINRT)
@@ -49,28 +50,63 @@
 
 NS_CC_BEGIN
 
+class FontGlyphCache;
+
+/** A rasterized glyph that owns its pixels, see FontFreeType::renderGlyph. */
+struct GlyphBitmap
+{
+    /** One byte per pixel, (outline, glyph) pairs for outlined fonts, or RGB triplets
+     for multi-channel distance field fonts. */
+    std::vector<unsigned char> data;
+    long width = 0;
+    long height = 0;
+    Rect rect;
+    int xAdvance = 0;
+};
+
 class CC_DLL FontFreeType : public Font
 {
 public:
     static const int DistanceMapSpread;
+    /** Distance in pixels covered on each side of the outline by multi-channel distance fields. */
+    static const int MSDFSpread;
+    /** Font size multi-channel distance field glyphs are generated at, whatever size they are drawn at. */
+    static const float MSDFFontSize;
 
     static FontFreeType* create(const std::string &fontName, float fontSize, GlyphCollection glyphs,
-        const char *customGlyphs,bool distanceFieldEnabled = false, float outline = 0);
+        const char *customGlyphs,bool distanceFieldEnabled = false, float outline = 0, bool msdfEnabled = false);
 
     static void shutdownFreeType();
 
     bool isDistanceFieldEnabled() const { return _distanceFieldEnabled;}
 
+    /** Whether glyphs are rendered as RGB multi-channel signed distance fields. */
+    bool isMSDFEnabled() const { return _msdfEnabled; }
+
     float getOutlineSize() const { return _outlineSize; }
 
     void renderCharAt(unsigned char *dest,int posX, int posY, unsigned char* bitmap,long bitmapWidth,long bitmapHeight); 
 
+    /** Copies a glyph made by renderGlyph into a page that is destWidth pixels wide. */
+    void renderCharAt(unsigned char *dest, int destWidth, int posX, int posY, const GlyphBitmap& glyph);
+
     FT_Encoding getEncoding() const { return _encoding; }
 
     int* getHorizontalKerningForTextUTF32(const std::u32string& text, int &outNumLetters) const override;
     
     unsigned char* getGlyphBitmap(uint64_t theChar, long &outWidth, long &outHeight, Rect &outRect,int &xAdvance);
+
+    /** Rasterizes a glyph into an owned buffer, outline and distance field included.
+     It may be called from any thread: FreeType calls are serialized, and distance
+     fields are computed outside of the lock. Glyphs found in the on-disk cache skip
+     FreeType entirely, see FontGlyphCache.
+     @return false if the font has no such glyph.
+     */
+    bool renderGlyph(uint64_t theChar, GlyphBitmap& glyph);
     
+    /** Whether the font has a glyph for the character. Thread safe. */
+    bool hasGlyph(char32_t character) const;
+
     int getFontAscender() const;
     const char* getFontFamily() const;
     std::string getFontName() const { return _fontName; }
@@ -80,13 +116,16 @@ public:
 
     static void releaseFont(const std::string &fontName);
 
+    /** The on-disk cache used by this font, nullptr unless FontGlyphCache is enabled. */
+    FontGlyphCache* getGlyphCache() const { return _glyphCache; }
+
 private:
     static const char* _glyphASCII;
     static const char* _glyphNEHE;
     static FT_Library _FTlibrary;
     static bool _FTInitialized;
 
-    FontFreeType(bool distanceFieldEnabled = false, float outline = 0);
+    FontFreeType(bool distanceFieldEnabled = false, float outline = 0, bool msdfEnabled = false);
     virtual ~FontFreeType();
 
     bool createFontObject(const std::string &fontName, float fontSize);
@@ -96,6 +135,8 @@ private:
     
     int getHorizontalKerningForChars(uint64_t firstChar, uint64_t secondChar) const;
     unsigned char* getGlyphBitmapWithOutline(uint64_t code, FT_BBox &bbox);
+    bool rasterizeGlyph(uint64_t theChar, GlyphBitmap& glyph);
+    bool rasterizeMSDFGlyph(uint64_t theChar, GlyphBitmap& glyph);
 
     void setGlyphCollection(GlyphCollection glyphs, const char* customGlyphs = nullptr);
     const char* getGlyphCollection() const;
@@ -106,9 +147,11 @@ private:
 
     std::string _fontName;
     bool _distanceFieldEnabled;
+    bool _msdfEnabled;
     float _outlineSize;
     int _lineHeight;
     FontAtlas* _fontAtlas;
+    FontGlyphCache* _glyphCache;
 
     GlyphCollection _usedGlyphs;
     std::string _customGlyphs;
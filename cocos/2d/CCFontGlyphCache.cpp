@@ -0,0 +1,470 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "2d/CCFontGlyphCache.h"
+#include "2d/CCFontAtlas.h"
+#include "2d/CCFontFreeType.h"
+#include "base/CCDirector.h"
+#include "base/CCEventDispatcher.h"
+#include "base/CCEventListenerCustom.h"
+#include "base/CCEventType.h"
+#include "platform/CCFileUtils.h"
+#include "xxhash.h"
+
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32) && (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CC_GLYPH_CACHE_USE_MMAP 1
+#else
+#define CC_GLYPH_CACHE_USE_MMAP 0
+#endif
+
+NS_CC_BEGIN
+
+namespace
+{
+    // bump when the layout below or the way glyphs are rasterized changes
+    const uint32_t kCacheVersion = 1;
+    const char kCacheMagic[4] = { 'C', 'C', 'G', 'C' };
+    const char* kCacheFolder = "glyphcache/";
+
+    struct FileHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t glyphCount;
+        uint32_t kerningCount;
+    };
+
+    struct GlyphRecord
+    {
+        uint32_t codeLow;
+        uint32_t codeHigh;
+        int32_t xAdvance;
+        float rect[4];
+        int32_t width;
+        int32_t height;
+        uint32_t valid;
+        uint32_t offset;
+        uint32_t size;
+    };
+
+    struct KerningRecord
+    {
+        uint32_t first;
+        uint32_t second;
+        int32_t kerning;
+    };
+
+    static_assert(sizeof(FileHeader) == 16, "unexpected padding in FileHeader");
+    static_assert(sizeof(GlyphRecord) == 48, "unexpected padding in GlyphRecord");
+    static_assert(sizeof(KerningRecord) == 12, "unexpected padding in KerningRecord");
+
+    std::unordered_map<std::string, FontGlyphCache*> s_caches;
+    EventListenerCustom* s_backgroundListener = nullptr;
+
+    uint64_t kerningKey(uint64_t firstChar, uint64_t secondChar)
+    {
+        return ((firstChar & 0xffffffff) << 32) | (secondChar & 0xffffffff);
+    }
+
+    std::string getCacheFolder()
+    {
+        return FileUtils::getInstance()->getWritablePath() + kCacheFolder;
+    }
+
+    template <typename T>
+    void appendPod(std::vector<unsigned char>& buffer, const T& value)
+    {
+        auto bytes = reinterpret_cast<const unsigned char*>(&value);
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+    }
+}
+
+bool FontGlyphCache::s_enabled = false;
+
+void FontGlyphCache::setEnabled(bool enabled)
+{
+    if (s_enabled == enabled)
+        return;
+
+    s_enabled = enabled;
+    auto dispatcher = Director::getInstance()->getEventDispatcher();
+    if (enabled)
+    {
+        // mobile systems may kill a backgrounded application without warning
+        s_backgroundListener = dispatcher->addCustomEventListener(EVENT_COME_TO_BACKGROUND, [](EventCustom*) {
+            FontGlyphCache::saveAll();
+        });
+    }
+    else if (s_backgroundListener)
+    {
+        dispatcher->removeEventListener(s_backgroundListener);
+        s_backgroundListener = nullptr;
+    }
+}
+
+FontGlyphCache* FontGlyphCache::getOrCreate(const Data& fontData, float fontSize, float outlineSize, bool distanceField, bool msdf /* = false */)
+{
+    if (fontData.isNull())
+        return nullptr;
+
+    auto fontHash = XXH32(fontData.getBytes(), static_cast<size_t>(fontData.getSize()), 0);
+    char fileName[64];
+    snprintf(fileName, sizeof(fileName), "%08x_%d_%d_%d.glyphs", fontHash,
+        (int)(fontSize * 100), (int)(outlineSize * 100), distanceField ? 1 : (msdf ? 2 : 0));
+
+    auto filePath = getCacheFolder() + fileName;
+    auto it = s_caches.find(filePath);
+    if (it != s_caches.end())
+        return it->second;
+
+    // matches the bitmaps FontFreeType renders for this configuration
+    int bytesPerPixel = msdf ? 3 : ((outlineSize > 0 && !distanceField) ? 2 : 1);
+    auto cache = new (std::nothrow) FontGlyphCache(filePath, bytesPerPixel);
+    if (cache)
+    {
+        cache->load();
+        cache->autorelease();
+        s_caches[filePath] = cache;
+    }
+    return cache;
+}
+
+void FontGlyphCache::saveAll()
+{
+    for (auto& item : s_caches)
+    {
+        item.second->save();
+    }
+}
+
+void FontGlyphCache::removeAllCacheFiles()
+{
+    for (auto& item : s_caches)
+    {
+        auto cache = item.second;
+        std::lock_guard<std::mutex> lock(cache->_mutex);
+        cache->_glyphs.clear();
+        cache->_kernings.clear();
+        cache->_pendingData.clear();
+        cache->_diskGlyphCount = 0;
+        cache->_unsavedGlyphCount = 0;
+        cache->_dirty = false;
+        cache->unmap();
+    }
+
+    auto folder = getCacheFolder();
+    auto fileUtils = FileUtils::getInstance();
+    if (fileUtils->isDirectoryExist(folder))
+    {
+        fileUtils->removeDirectory(folder);
+    }
+}
+
+FontGlyphCache::FontGlyphCache(const std::string& filePath, int bytesPerPixel)
+: _filePath(filePath)
+, _bytesPerPixel(bytesPerPixel)
+, _diskGlyphCount(0)
+, _unsavedGlyphCount(0)
+, _dirty(false)
+, _mappedBytes(nullptr)
+, _mappedSize(0)
+{
+}
+
+FontGlyphCache::~FontGlyphCache()
+{
+    save();
+    s_caches.erase(_filePath);
+    unmap();
+}
+
+bool FontGlyphCache::load()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto fileUtils = FileUtils::getInstance();
+    if (!fileUtils->isFileExist(_filePath))
+        return false;
+
+#if CC_GLYPH_CACHE_USE_MMAP
+    int fd = open(_filePath.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+        void* mapped = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED)
+        {
+            _mappedBytes = static_cast<const unsigned char*>(mapped);
+            _mappedSize = static_cast<size_t>(st.st_size);
+        }
+    }
+    close(fd);
+#else
+    _fileData = fileUtils->getDataFromFile(_filePath);
+    _mappedBytes = _fileData.getBytes();
+    _mappedSize = static_cast<size_t>(_fileData.getSize());
+#endif
+
+    bool ret = false;
+    do
+    {
+        CC_BREAK_IF(_mappedBytes == nullptr || _mappedSize < sizeof(FileHeader));
+
+        FileHeader header;
+        memcpy(&header, _mappedBytes, sizeof(header));
+        CC_BREAK_IF(memcmp(header.magic, kCacheMagic, sizeof(kCacheMagic)) != 0);
+        CC_BREAK_IF(header.version != kCacheVersion);
+
+        size_t tableSize = sizeof(FileHeader)
+            + (size_t)header.glyphCount * sizeof(GlyphRecord)
+            + (size_t)header.kerningCount * sizeof(KerningRecord);
+        CC_BREAK_IF(tableSize > _mappedSize);
+
+        const unsigned char* blob = _mappedBytes + tableSize;
+        const size_t blobSize = _mappedSize - tableSize;
+
+        // a glyph bigger than an atlas page can't be used anyway
+        const int64_t maxWidth = std::max(FontAtlas::getDefaultPageWidth(), FontAtlas::CacheTextureWidth);
+        const int64_t maxHeight = std::max(FontAtlas::getDefaultPageHeight(), FontAtlas::CacheTextureHeight);
+
+        auto cursor = _mappedBytes + sizeof(FileHeader);
+        bool corrupted = false;
+        for (uint32_t i = 0; i < header.glyphCount; ++i, cursor += sizeof(GlyphRecord))
+        {
+            GlyphRecord record;
+            memcpy(&record, cursor, sizeof(record));
+            // the bitmap must hold exactly width * height pixels, so empty glyphs carry no bytes
+            const int64_t expectedSize = (int64_t)record.width * record.height * _bytesPerPixel;
+            if (record.offset > blobSize || record.size > blobSize - record.offset
+                || record.width < 0 || record.height < 0
+                || record.width > maxWidth || record.height > maxHeight
+                || (int64_t)record.size != expectedSize)
+            {
+                corrupted = true;
+                break;
+            }
+
+            Entry entry;
+            entry.xAdvance = record.xAdvance;
+            memcpy(entry.rect, record.rect, sizeof(entry.rect));
+            entry.width = record.width;
+            entry.height = record.height;
+            entry.valid = record.valid != 0;
+            entry.bytes = blob + record.offset;
+            entry.size = record.size;
+            _glyphs[((uint64_t)record.codeHigh << 32) | record.codeLow] = entry;
+        }
+        CC_BREAK_IF(corrupted);
+
+        for (uint32_t i = 0; i < header.kerningCount; ++i, cursor += sizeof(KerningRecord))
+        {
+            KerningRecord record;
+            memcpy(&record, cursor, sizeof(record));
+            _kernings[kerningKey(record.first, record.second)] = record.kerning;
+        }
+
+        _diskGlyphCount = _glyphs.size();
+        ret = true;
+    } while (0);
+
+    if (!ret)
+    {
+        CCLOG("FontGlyphCache: ignoring invalid cache file %s", _filePath.c_str());
+        _glyphs.clear();
+        _kernings.clear();
+        unmap();
+    }
+    return ret;
+}
+
+void FontGlyphCache::unmap()
+{
+#if CC_GLYPH_CACHE_USE_MMAP
+    if (_mappedBytes)
+    {
+        munmap(const_cast<unsigned char*>(_mappedBytes), _mappedSize);
+    }
+#else
+    _fileData.clear();
+#endif
+    _mappedBytes = nullptr;
+    _mappedSize = 0;
+}
+
+bool FontGlyphCache::getGlyph(uint64_t charCode, GlyphBitmap& glyph, bool& valid) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _glyphs.find(charCode);
+    if (it == _glyphs.end())
+        return false;
+
+    auto& entry = it->second;
+    glyph.data.assign(entry.bytes, entry.bytes + entry.size);
+    glyph.width = entry.width;
+    glyph.height = entry.height;
+    glyph.rect.setRect(entry.rect[0], entry.rect[1], entry.rect[2], entry.rect[3]);
+    glyph.xAdvance = entry.xAdvance;
+    valid = entry.valid;
+    return true;
+}
+
+void FontGlyphCache::addGlyph(uint64_t charCode, const GlyphBitmap& glyph, bool valid)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_glyphs.find(charCode) != _glyphs.end())
+        return;
+
+    // node based maps keep the vector, and so its buffer, in place when they grow
+    auto& data = _pendingData[charCode];
+    data = glyph.data;
+
+    Entry entry;
+    entry.xAdvance = glyph.xAdvance;
+    entry.rect[0] = glyph.rect.origin.x;
+    entry.rect[1] = glyph.rect.origin.y;
+    entry.rect[2] = glyph.rect.size.width;
+    entry.rect[3] = glyph.rect.size.height;
+    entry.width = static_cast<int>(glyph.width);
+    entry.height = static_cast<int>(glyph.height);
+    entry.valid = valid;
+    entry.bytes = data.data();
+    entry.size = data.size();
+    _glyphs[charCode] = entry;
+    ++_unsavedGlyphCount;
+    _dirty = true;
+}
+
+bool FontGlyphCache::getKerning(uint64_t firstChar, uint64_t secondChar, int& kerning) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _kernings.find(kerningKey(firstChar, secondChar));
+    if (it == _kernings.end())
+        return false;
+
+    kerning = it->second;
+    return true;
+}
+
+void FontGlyphCache::addKerning(uint64_t firstChar, uint64_t secondChar, int kerning)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_kernings.emplace(kerningKey(firstChar, secondChar), kerning).second)
+    {
+        _dirty = true;
+    }
+}
+
+bool FontGlyphCache::save()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (!_dirty)
+        return true;
+
+    std::vector<unsigned char> blob;
+    std::vector<unsigned char> buffer;
+    buffer.reserve(sizeof(FileHeader) + _glyphs.size() * sizeof(GlyphRecord) + _kernings.size() * sizeof(KerningRecord));
+
+    FileHeader header;
+    memcpy(header.magic, kCacheMagic, sizeof(kCacheMagic));
+    header.version = kCacheVersion;
+    header.glyphCount = static_cast<uint32_t>(_glyphs.size());
+    header.kerningCount = static_cast<uint32_t>(_kernings.size());
+    appendPod(buffer, header);
+
+    for (auto& item : _glyphs)
+    {
+        auto& entry = item.second;
+        GlyphRecord record;
+        record.codeLow = static_cast<uint32_t>(item.first & 0xffffffff);
+        record.codeHigh = static_cast<uint32_t>(item.first >> 32);
+        record.xAdvance = entry.xAdvance;
+        memcpy(record.rect, entry.rect, sizeof(record.rect));
+        record.width = entry.width;
+        record.height = entry.height;
+        record.valid = entry.valid ? 1 : 0;
+        record.offset = static_cast<uint32_t>(blob.size());
+        record.size = static_cast<uint32_t>(entry.size);
+        blob.insert(blob.end(), entry.bytes, entry.bytes + entry.size);
+        appendPod(buffer, record);
+    }
+
+    for (auto& item : _kernings)
+    {
+        KerningRecord record;
+        record.first = static_cast<uint32_t>(item.first >> 32);
+        record.second = static_cast<uint32_t>(item.first & 0xffffffff);
+        record.kerning = item.second;
+        appendPod(buffer, record);
+    }
+    buffer.insert(buffer.end(), blob.begin(), blob.end());
+
+    // write next to the old file and swap, so a crash never leaves a truncated cache;
+    // an existing mapping keeps reading the old file until it's unmapped
+    auto fileUtils = FileUtils::getInstance();
+    auto folder = getCacheFolder();
+    if (!fileUtils->isDirectoryExist(folder) && !fileUtils->createDirectory(folder))
+        return false;
+
+    auto fileName = _filePath.substr(folder.length());
+    Data data;
+    data.fastSet(buffer.data(), static_cast<ssize_t>(buffer.size()));
+    bool ret = fileUtils->writeDataToFile(data, _filePath + ".tmp");
+    data.takeBuffer(nullptr);
+
+    if (ret && fileUtils->isFileExist(_filePath))
+    {
+        fileUtils->removeFile(_filePath);
+    }
+    ret = ret && fileUtils->renameFile(folder, fileName + ".tmp", fileName);
+    if (ret)
+    {
+        _unsavedGlyphCount = 0;
+        _dirty = false;
+    }
+    else
+    {
+        CCLOG("FontGlyphCache: failed to write %s", _filePath.c_str());
+    }
+    return ret;
+}
+
+size_t FontGlyphCache::getDiskGlyphCount() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _diskGlyphCount;
+}
+
+size_t FontGlyphCache::getPendingGlyphCount() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _unsavedGlyphCount;
+}
+
+NS_CC_END
@@ -0,0 +1,154 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __2D_CCFONT_GLYPH_CACHE_H__
+#define __2D_CCFONT_GLYPH_CACHE_H__
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "base/CCRef.h"
+#include "base/CCData.h"
+
+NS_CC_BEGIN
+
+struct GlyphBitmap;
+
+/**
+ * @addtogroup _2d
+ * @{
+ */
+
+/** @class FontGlyphCache
+ * @brief Keeps rasterized TTF glyphs on disk so they survive a restart.
+ *
+ * One cache file exists per (font data hash, font size, outline size, distance field kind)
+ * tuple under FileUtils::getWritablePath(). It stores the final glyph bitmaps, distance
+ * fields included, their metrics and the kerning pairs that were looked up. The file is
+ * memory mapped when the platform supports it and read in one go otherwise; glyphs
+ * rasterized during the session are written back by save(), which runs when the font is
+ * released, when the application goes to background and from saveAll().
+ *
+ * The cache is disabled by default, see setEnabled().
+ * @since v3.18
+ */
+class CC_DLL FontGlyphCache : public Ref
+{
+public:
+    /** Turns the on-disk glyph cache on or off for fonts created afterwards. */
+    static void setEnabled(bool enabled);
+    static bool isEnabled() { return s_enabled; }
+
+    /** Returns the cache matching a font configuration, loading its file on first use.
+     *
+     * @param fontData The bytes of the font file, hashed to detect a changed font.
+     * @param fontSize Font size in pixels, content scale factor applied.
+     * @param outlineSize Outline size in pixels, content scale factor applied.
+     * @param distanceField Whether glyphs are stored as distance fields.
+     * @param msdf Whether glyphs are stored as multi-channel distance fields.
+     * @return An autoreleased cache, shared between fonts with the same configuration.
+     */
+    static FontGlyphCache* getOrCreate(const Data& fontData, float fontSize, float outlineSize, bool distanceField, bool msdf = false);
+
+    /** Writes every cache that has new glyphs. */
+    static void saveAll();
+
+    /** Deletes all cache files from the writable path. Caches in use start empty. */
+    static void removeAllCacheFiles();
+
+    /** Looks a glyph up. Thread safe.
+     *
+     * @param charCode The character code given to FontFreeType::renderGlyph.
+     * @param glyph Receives the bitmap and metrics.
+     * @param valid Receives the result renderGlyph returned for the character.
+     * @return False if the glyph isn't cached.
+     */
+    bool getGlyph(uint64_t charCode, GlyphBitmap& glyph, bool& valid) const;
+
+    /** Remembers a freshly rasterized glyph. Thread safe. */
+    void addGlyph(uint64_t charCode, const GlyphBitmap& glyph, bool valid);
+
+    /** Looks a kerning pair up. Thread safe. */
+    bool getKerning(uint64_t firstChar, uint64_t secondChar, int& kerning) const;
+
+    /** Remembers a kerning pair. Thread safe. */
+    void addKerning(uint64_t firstChar, uint64_t secondChar, int kerning);
+
+    /** Writes the cache file if glyphs were added since it was loaded. */
+    bool save();
+
+    /** Number of glyphs read from disk. */
+    size_t getDiskGlyphCount() const;
+    /** Number of glyphs rasterized during this session and not saved yet. */
+    size_t getPendingGlyphCount() const;
+
+    const std::string& getFilePath() const { return _filePath; }
+
+CC_CONSTRUCTOR_ACCESS:
+    FontGlyphCache(const std::string& filePath, int bytesPerPixel);
+    virtual ~FontGlyphCache();
+
+protected:
+    struct Entry
+    {
+        int xAdvance;
+        float rect[4];
+        int width;
+        int height;
+        bool valid;
+        // either points into the mapped file or into _pendingData
+        const unsigned char* bytes;
+        size_t size;
+    };
+
+    bool load();
+    void unmap();
+
+    std::string _filePath;
+    // bitmap bytes per pixel of the font configuration, used to validate loaded records
+    int _bytesPerPixel;
+    mutable std::mutex _mutex;
+
+    std::unordered_map<uint64_t, Entry> _glyphs;
+    std::unordered_map<uint64_t, int> _kernings;
+    std::unordered_map<uint64_t, std::vector<unsigned char>> _pendingData;
+    size_t _diskGlyphCount;
+    size_t _unsavedGlyphCount;
+    bool _dirty;
+
+    // the mapped file, or the file contents when mapping isn't available
+    const unsigned char* _mappedBytes;
+    size_t _mappedSize;
+    Data _fileData;
+
+    static bool s_enabled;
+};
+
+// end of _2d group
+/// @}
+
+NS_CC_END
+
+#endif // __2D_CCFONT_GLYPH_CACHE_H__
@@ -0,0 +1,644 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "2d/CCFontMSDF.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+NS_CC_BEGIN
+
+namespace
+{
+    enum EdgeColor
+    {
+        BLACK = 0,
+        RED = 1,
+        GREEN = 2,
+        YELLOW = 3,
+        BLUE = 4,
+        MAGENTA = 5,
+        CYAN = 6,
+        WHITE = 7
+    };
+
+    // corners sharper than about 3 radians of turning split the edge colors
+    const double kCornerCrossThreshold = 0.1411200080598672; // sin(3)
+    const int kCubicSearchStarts = 4;
+    const int kCubicSearchSteps = 4;
+    // neighbours whose channels jump by more than this many ranges are clashes
+    const double kErrorCorrectionThreshold = 1.001;
+    const double kPi = 3.14159265358979323846;
+
+    struct Vec
+    {
+        double x, y;
+
+        Vec() : x(0), y(0) {}
+        Vec(double ax, double ay) : x(ax), y(ay) {}
+        explicit Vec(const double* p) : x(p[0]), y(p[1]) {}
+
+        Vec operator+(const Vec& o) const { return Vec(x + o.x, y + o.y); }
+        Vec operator-(const Vec& o) const { return Vec(x - o.x, y - o.y); }
+        Vec operator*(double s) const { return Vec(x * s, y * s); }
+        bool isZero() const { return x == 0 && y == 0; }
+        double length() const { return std::sqrt(x * x + y * y); }
+        Vec normalize() const
+        {
+            double len = length();
+            return len == 0 ? Vec(0, 1) : Vec(x / len, y / len);
+        }
+    };
+
+    inline Vec operator*(double s, const Vec& v) { return v * s; }
+    inline double dot(const Vec& a, const Vec& b) { return a.x * b.x + a.y * b.y; }
+    inline double cross(const Vec& a, const Vec& b) { return a.x * b.y - a.y * b.x; }
+    inline Vec mix(const Vec& a, const Vec& b, double t) { return a + (b - a) * t; }
+    inline int nonZeroSign(double v) { return v > 0 ? 1 : -1; }
+
+    struct SignedDistance
+    {
+        double distance;
+        double dot;
+
+        SignedDistance() : distance(-DBL_MAX), dot(1) {}
+        SignedDistance(double d, double o) : distance(d), dot(o) {}
+
+        // closer wins, ties go to the edge the point faces more squarely
+        bool operator<(const SignedDistance& o) const
+        {
+            return std::fabs(distance) < std::fabs(o.distance)
+                || (std::fabs(distance) == std::fabs(o.distance) && dot < o.dot);
+        }
+    };
+
+    template <typename E>
+    Vec direction(const E& e, double t)
+    {
+        Vec p0(e.p[0]), p1(e.p[1]);
+        if (e.degree == 1)
+            return p1 - p0;
+
+        Vec p2(e.p[2]);
+        if (e.degree == 2)
+        {
+            Vec tangent = mix(p1 - p0, p2 - p1, t);
+            return tangent.isZero() ? p2 - p0 : tangent;
+        }
+
+        Vec p3(e.p[3]);
+        Vec tangent = mix(mix(p1 - p0, p2 - p1, t), mix(p2 - p1, p3 - p2, t), t);
+        if (tangent.isZero())
+        {
+            if (t == 0) return p2 - p0;
+            if (t == 1) return p3 - p1;
+        }
+        return tangent;
+    }
+
+    // control points of the part of the edge between the parameters a and b, by blossoming
+    template <typename E>
+    E subEdge(const E& e, double a, double b)
+    {
+        E out = e;
+        for (int j = 0; j <= e.degree; ++j)
+        {
+            Vec p[4];
+            for (int i = 0; i <= e.degree; ++i)
+                p[i] = Vec(e.p[i]);
+            for (int level = 0; level < e.degree; ++level)
+            {
+                double t = level < e.degree - j ? a : b;
+                for (int i = 0; i < e.degree - level; ++i)
+                    p[i] = mix(p[i], p[i + 1], t);
+            }
+            out.p[j][0] = p[0].x;
+            out.p[j][1] = p[0].y;
+        }
+        return out;
+    }
+
+    int solveQuadratic(double x[2], double a, double b, double c)
+    {
+        if (std::fabs(a) < 1e-14)
+        {
+            if (std::fabs(b) < 1e-14)
+                return c == 0 ? -1 : 0;
+            x[0] = -c / b;
+            return 1;
+        }
+        double dscr = b * b - 4 * a * c;
+        if (dscr > 0)
+        {
+            dscr = std::sqrt(dscr);
+            x[0] = (-b + dscr) / (2 * a);
+            x[1] = (-b - dscr) / (2 * a);
+            return 2;
+        }
+        else if (dscr == 0)
+        {
+            x[0] = -b / (2 * a);
+            return 1;
+        }
+        return 0;
+    }
+
+    int solveCubicNormed(double x[3], double a, double b, double c)
+    {
+        double a2 = a * a;
+        double q = (a2 - 3 * b) / 9;
+        double r = (a * (2 * a2 - 9 * b) + 27 * c) / 54;
+        double r2 = r * r;
+        double q3 = q * q * q;
+        a /= 3;
+        if (r2 < q3)
+        {
+            double t = r / std::sqrt(q3);
+            t = std::max(-1.0, std::min(1.0, t));
+            t = std::acos(t);
+            q = -2 * std::sqrt(q);
+            x[0] = q * std::cos(t / 3) - a;
+            x[1] = q * std::cos((t + 2 * kPi) / 3) - a;
+            x[2] = q * std::cos((t - 2 * kPi) / 3) - a;
+            return 3;
+        }
+        double A = -std::pow(std::fabs(r) + std::sqrt(r2 - q3), 1 / 3.0);
+        if (r < 0)
+            A = -A;
+        double B = A == 0 ? 0 : q / A;
+        x[0] = (A + B) - a;
+        x[1] = -0.5 * (A + B) - a;
+        x[2] = 0.5 * std::sqrt(3.0) * (A - B);
+        if (std::fabs(x[2]) < 1e-14)
+            return 2;
+        return 1;
+    }
+
+    int solveCubic(double x[3], double a, double b, double c, double d)
+    {
+        if (std::fabs(a) < 1e-14)
+            return solveQuadratic(x, b, c, d);
+        return solveCubicNormed(x, b / a, c / a, d / a);
+    }
+
+    template <typename E>
+    SignedDistance signedDistance(const E& e, const Vec& origin, double& param)
+    {
+        Vec p0(e.p[0]), p1(e.p[1]);
+        if (e.degree == 1)
+        {
+            Vec aq = origin - p0;
+            Vec ab = p1 - p0;
+            param = dot(aq, ab) / dot(ab, ab);
+            Vec eq = (param > 0.5 ? p1 : p0) - origin;
+            double endpointDistance = eq.length();
+            if (param > 0 && param < 1)
+            {
+                Vec n = Vec(ab.y, -ab.x).normalize();
+                double orthoDistance = dot(n, aq);
+                if (std::fabs(orthoDistance) < endpointDistance)
+                    return SignedDistance(orthoDistance, 0);
+            }
+            return SignedDistance(nonZeroSign(cross(aq, ab)) * endpointDistance,
+                                  std::fabs(dot(ab.normalize(), eq.normalize())));
+        }
+
+        Vec last(e.p[e.degree]);
+        Vec qa = p0 - origin;
+        Vec epDir = direction(e, 0);
+        double minDistance = nonZeroSign(cross(epDir, qa)) * qa.length();
+        param = -dot(qa, epDir) / dot(epDir, epDir);
+        {
+            epDir = direction(e, 1);
+            double distance = (last - origin).length();
+            if (distance < std::fabs(minDistance))
+            {
+                minDistance = nonZeroSign(cross(epDir, last - origin)) * distance;
+                param = dot(origin - last, epDir) / dot(epDir, epDir) + 1;
+            }
+        }
+
+        Vec ab = p1 - p0;
+        Vec br = Vec(e.p[2]) - p1 - ab;
+        if (e.degree == 2)
+        {
+            double t[3];
+            int solutions = solveCubic(t, dot(br, br), 3 * dot(ab, br), 2 * dot(ab, ab) + dot(qa, br), dot(qa, ab));
+            for (int i = 0; i < solutions; ++i)
+            {
+                if (t[i] > 0 && t[i] < 1)
+                {
+                    Vec qe = qa + 2 * t[i] * ab + t[i] * t[i] * br;
+                    double distance = qe.length();
+                    if (distance <= std::fabs(minDistance))
+                    {
+                        minDistance = nonZeroSign(cross(ab + t[i] * br, qe)) * distance;
+                        param = t[i];
+                    }
+                }
+            }
+        }
+        else
+        {
+            Vec as = (last - Vec(e.p[2])) - (Vec(e.p[2]) - p1) - br;
+            for (int i = 0; i <= kCubicSearchStarts; ++i)
+            {
+                double t = (double)i / kCubicSearchStarts;
+                Vec qe = qa + 3 * t * ab + 3 * t * t * br + t * t * t * as;
+                for (int step = 0; step < kCubicSearchSteps; ++step)
+                {
+                    // Newton's method on the derivative of the squared distance
+                    Vec d1 = 3 * ab + 6 * t * br + 3 * t * t * as;
+                    Vec d2 = 6 * br + 6 * t * as;
+                    t -= dot(qe, d1) / (dot(d1, d1) + dot(qe, d2));
+                    if (t <= 0 || t >= 1)
+                        break;
+                    qe = qa + 3 * t * ab + 3 * t * t * br + t * t * t * as;
+                    double distance = qe.length();
+                    if (distance < std::fabs(minDistance))
+                    {
+                        minDistance = nonZeroSign(cross(d1, qe)) * distance;
+                        param = t;
+                    }
+                }
+            }
+        }
+
+        if (param >= 0 && param <= 1)
+            return SignedDistance(minDistance, 0);
+        if (param < 0.5)
+            return SignedDistance(minDistance, std::fabs(dot(direction(e, 0).normalize(), qa.normalize())));
+        return SignedDistance(minDistance, std::fabs(dot(direction(e, 1).normalize(), (last - origin).normalize())));
+    }
+
+    // beyond the ends of an edge, the distance to its extended tangent keeps corners sharp
+    template <typename E>
+    void toPseudoDistance(const E& e, SignedDistance& distance, const Vec& origin, double param)
+    {
+        if (param < 0)
+        {
+            Vec dir = direction(e, 0).normalize();
+            Vec aq = origin - Vec(e.p[0]);
+            if (dot(aq, dir) < 0)
+            {
+                double pseudoDistance = cross(aq, dir);
+                if (std::fabs(pseudoDistance) <= std::fabs(distance.distance))
+                {
+                    distance.distance = pseudoDistance;
+                    distance.dot = 0;
+                }
+            }
+        }
+        else if (param > 1)
+        {
+            Vec dir = direction(e, 1).normalize();
+            Vec bq = origin - Vec(e.p[e.degree]);
+            if (dot(bq, dir) > 0)
+            {
+                double pseudoDistance = cross(bq, dir);
+                if (std::fabs(pseudoDistance) <= std::fabs(distance.distance))
+                {
+                    distance.distance = pseudoDistance;
+                    distance.dot = 0;
+                }
+            }
+        }
+    }
+
+    bool isCorner(const Vec& a, const Vec& b)
+    {
+        return dot(a, b) <= 0 || std::fabs(cross(a, b)) > kCornerCrossThreshold;
+    }
+
+    void switchColor(int& color, unsigned long long& seed, int banned = BLACK)
+    {
+        int combined = color & banned;
+        if (combined == RED || combined == GREEN || combined == BLUE)
+        {
+            color = combined ^ WHITE;
+            return;
+        }
+        if (color == BLACK || color == WHITE)
+        {
+            static const int start[3] = { CYAN, MAGENTA, YELLOW };
+            color = start[seed % 3];
+            seed /= 3;
+            return;
+        }
+        int shifted = color << (1 + (seed & 1));
+        color = (shifted | shifted >> 3) & WHITE;
+        seed >>= 1;
+    }
+
+    int symmetricalTrichotomy(int position, int n)
+    {
+        return int(3 + 2.875 * position / (n - 1) - 1.4375 + 0.5) - 3;
+    }
+
+    bool detectClash(const float* a, const float* b, float threshold)
+    {
+        // sort the channel pairs from the biggest to the smallest difference
+        float a0 = a[0], a1 = a[1], a2 = a[2];
+        float b0 = b[0], b1 = b[1], b2 = b[2];
+        if (std::fabs(b0 - a0) < std::fabs(b1 - a1))
+        {
+            std::swap(a0, a1);
+            std::swap(b0, b1);
+        }
+        if (std::fabs(b1 - a1) < std::fabs(b2 - a2))
+        {
+            std::swap(a1, a2);
+            std::swap(b1, b2);
+            if (std::fabs(b0 - a0) < std::fabs(b1 - a1))
+            {
+                std::swap(a0, a1);
+                std::swap(b0, b1);
+            }
+        }
+        return std::fabs(b1 - a1) >= threshold
+            && !(b0 == b1 && b0 == b2)                      // already equalized
+            && std::fabs(a2 - 0.5f) >= std::fabs(b2 - 0.5f); // only flag the one farther from the edge
+    }
+
+    inline float median(float a, float b, float c)
+    {
+        return std::max(std::min(a, b), std::min(std::max(a, b), c));
+    }
+}
+
+void MSDFGenerator::moveTo(double x, double y)
+{
+    if (_contours.empty() || !_contours.back().empty())
+    {
+        _contours.emplace_back();
+    }
+    _lastX = x;
+    _lastY = y;
+    _colored = false;
+}
+
+void MSDFGenerator::lineTo(double x, double y)
+{
+    double points[4] = { _lastX, _lastY, x, y };
+    addEdge(1, points);
+}
+
+void MSDFGenerator::quadTo(double cx, double cy, double x, double y)
+{
+    double points[6] = { _lastX, _lastY, cx, cy, x, y };
+    addEdge(2, points);
+}
+
+void MSDFGenerator::cubicTo(double c1x, double c1y, double c2x, double c2y, double x, double y)
+{
+    double points[8] = { _lastX, _lastY, c1x, c1y, c2x, c2y, x, y };
+    addEdge(3, points);
+}
+
+void MSDFGenerator::addEdge(int degree, const double* points)
+{
+    _lastX = points[degree * 2];
+    _lastY = points[degree * 2 + 1];
+
+    // drop edges that collapse into a point, they have no direction
+    bool degenerate = true;
+    for (int i = 1; i <= degree; ++i)
+    {
+        if (points[i * 2] != points[0] || points[i * 2 + 1] != points[1])
+            degenerate = false;
+    }
+    if (degenerate)
+        return;
+
+    if (_contours.empty())
+    {
+        _contours.emplace_back();
+    }
+    Edge edge;
+    edge.degree = degree;
+    edge.color = WHITE;
+    for (int i = 0; i <= degree; ++i)
+    {
+        edge.p[i][0] = points[i * 2];
+        edge.p[i][1] = points[i * 2 + 1];
+    }
+    _contours.back().push_back(edge);
+    _colored = false;
+}
+
+bool MSDFGenerator::isEmpty() const
+{
+    for (auto&& contour : _contours)
+    {
+        if (!contour.empty())
+            return false;
+    }
+    return true;
+}
+
+void MSDFGenerator::clear()
+{
+    _contours.clear();
+    _lastX = _lastY = 0;
+    _colored = false;
+}
+
+void MSDFGenerator::colorEdges()
+{
+    unsigned long long seed = 0;
+    for (auto&& edges : _contours)
+    {
+        if (edges.empty())
+            continue;
+
+        std::vector<int> corners;
+        Vec prevDirection = direction(edges.back(), 1).normalize();
+        for (int i = 0; i < (int)edges.size(); ++i)
+        {
+            Vec dir = direction(edges[i], 0).normalize();
+            if (isCorner(prevDirection, dir))
+                corners.push_back(i);
+            prevDirection = direction(edges[i], 1).normalize();
+        }
+
+        int color = WHITE;
+        if (corners.empty())
+        {
+            // smooth contour, two channels are enough
+            switchColor(color, seed);
+            for (auto&& edge : edges)
+                edge.color = color;
+        }
+        else if (corners.size() == 1)
+        {
+            // teardrop, the single corner needs three colors around it
+            int colors[3] = { WHITE, WHITE, WHITE };
+            switchColor(colors[0], seed);
+            colors[2] = colors[0];
+            switchColor(colors[2], seed);
+
+            int corner = corners[0];
+            int m = (int)edges.size();
+            if (m >= 3)
+            {
+                for (int i = 0; i < m; ++i)
+                    edges[(corner + i) % m].color = colors[1 + symmetricalTrichotomy(i, m)];
+            }
+            else
+            {
+                // too few edges to color, split each in thirds starting at the corner
+                std::vector<Edge> parts;
+                for (int i = 0; i < m; ++i)
+                {
+                    const Edge& edge = edges[(corner + i) % m];
+                    for (int k = 0; k < 3; ++k)
+                        parts.push_back(subEdge(edge, k / 3.0, (k + 1) / 3.0));
+                }
+                int count = (int)parts.size();
+                for (int i = 0; i < count; ++i)
+                    parts[i].color = colors[i * 3 / count];
+                edges.swap(parts);
+            }
+        }
+        else
+        {
+            int cornerCount = (int)corners.size();
+            int spline = 0;
+            int start = corners[0];
+            int m = (int)edges.size();
+            switchColor(color, seed);
+            int initialColor = color;
+            for (int i = 0; i < m; ++i)
+            {
+                int index = (start + i) % m;
+                if (spline + 1 < cornerCount && corners[spline + 1] == index)
+                {
+                    ++spline;
+                    // the last spline must differ from the first one as well
+                    switchColor(color, seed, (spline == cornerCount - 1) ? initialColor : BLACK);
+                }
+                edges[index].color = color;
+            }
+        }
+    }
+}
+
+void MSDFGenerator::generate(unsigned char* out, int width, int height, double left, double top, double range)
+{
+    if (!_colored)
+    {
+        colorEdges();
+        _colored = true;
+    }
+
+    // the distances are positive left of the edge direction; flip them so that the
+    // inside of the outline is positive whichever way the font winds its contours
+    double area = 0;
+    for (auto&& contour : _contours)
+    {
+        for (auto&& edge : contour)
+        {
+            for (int i = 0; i < edge.degree; ++i)
+                area += edge.p[i][0] * edge.p[i + 1][1] - edge.p[i + 1][0] * edge.p[i][1];
+        }
+    }
+    const double sign = area < 0 ? 1.0 : -1.0;
+
+    std::vector<float> field(width * height * 3);
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            Vec origin(left + x + 0.5, top - y - 0.5);
+
+            SignedDistance minDistance[3];
+            const Edge* nearEdge[3] = { nullptr, nullptr, nullptr };
+            double nearParam[3] = { 0, 0, 0 };
+
+            for (auto&& contour : _contours)
+            {
+                for (auto&& edge : contour)
+                {
+                    double param;
+                    SignedDistance distance = signedDistance(edge, origin, param);
+                    for (int c = 0; c < 3; ++c)
+                    {
+                        if ((edge.color & (1 << c)) && distance < minDistance[c])
+                        {
+                            minDistance[c] = distance;
+                            nearEdge[c] = &edge;
+                            nearParam[c] = param;
+                        }
+                    }
+                }
+            }
+
+            float* pixel = &field[(y * width + x) * 3];
+            for (int c = 0; c < 3; ++c)
+            {
+                if (nearEdge[c])
+                {
+                    toPseudoDistance(*nearEdge[c], minDistance[c], origin, nearParam[c]);
+                    pixel[c] = (float)(sign * minDistance[c].distance / range + 0.5);
+                }
+                else
+                {
+                    pixel[c] = 0.0f;
+                }
+            }
+        }
+    }
+
+    // equalize pixels whose channels would interpolate into a false edge
+    const float threshold = (float)(kErrorCorrectionThreshold / range);
+    std::vector<int> clashes;
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            const float* pixel = &field[(y * width + x) * 3];
+            if ((x > 0 && detectClash(pixel, pixel - 3, threshold))
+                || (x < width - 1 && detectClash(pixel, pixel + 3, threshold))
+                || (y > 0 && detectClash(pixel, pixel - width * 3, threshold))
+                || (y < height - 1 && detectClash(pixel, pixel + width * 3, threshold)))
+            {
+                clashes.push_back(y * width + x);
+            }
+        }
+    }
+    for (auto index : clashes)
+    {
+        float* pixel = &field[index * 3];
+        pixel[0] = pixel[1] = pixel[2] = median(pixel[0], pixel[1], pixel[2]);
+    }
+
+    for (size_t i = 0; i < field.size(); ++i)
+    {
+        float value = std::max(0.0f, std::min(1.0f, field[i]));
+        out[i] = (unsigned char)(value * 255.0f + 0.5f);
+    }
+}
+
+NS_CC_END
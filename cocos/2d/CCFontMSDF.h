@@ -0,0 +1,88 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __2D_CCFONT_MSDF_H__
+#define __2D_CCFONT_MSDF_H__
+
+/// @cond DO_NOT_SHOW
+
+#include <vector>
+#include "platform/CCPlatformMacros.h"
+
+NS_CC_BEGIN
+
+/**
+ * Builds a multi-channel signed distance field from a glyph outline.
+ *
+ * The outline is given as contours of lines and quadratic or cubic bezier curves, the way
+ * FT_Outline_Decompose reports them. Edges are split into three colors at the corners of
+ * each contour and every color channel stores the distance to the edges of its color, so
+ * the median of the three channels keeps sharp corners that a single channel field rounds
+ * off. Neighbouring pixels whose channels disagree are equalized afterwards.
+ *
+ * The generator keeps no global state and may run on any thread.
+ */
+class CC_DLL MSDFGenerator
+{
+public:
+    void moveTo(double x, double y);
+    void lineTo(double x, double y);
+    void quadTo(double cx, double cy, double x, double y);
+    void cubicTo(double c1x, double c1y, double c2x, double c2y, double x, double y);
+
+    bool isEmpty() const;
+    void clear();
+
+    /** Renders the field as width * height RGB pixels, 3 bytes each.
+     *
+     * @param left Shape x coordinate of the left edge of the bitmap.
+     * @param top Shape y coordinate of the top edge of the bitmap. The shape y axis points
+     *        up, bitmap rows go down.
+     * @param range Distance in shape units between the values 0 and 255, centered on the
+     *        outline. Inside is above 127.
+     */
+    void generate(unsigned char* out, int width, int height, double left, double top, double range);
+
+protected:
+    struct Edge
+    {
+        int degree;
+        double p[4][2];
+        int color;
+    };
+
+    void addEdge(int degree, const double* points);
+    void colorEdges();
+
+    std::vector<std::vector<Edge>> _contours;
+    double _lastX = 0;
+    double _lastY = 0;
+    bool _colored = false;
+};
+
+NS_CC_END
+
+/// @endcond
+
+#endif // __2D_CCFONT_MSDF_H__
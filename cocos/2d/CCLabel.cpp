@@ -31,6 +31,7 @@
 #include "2d/CCFont.h"
 #include "2d/CCFontAtlasCache.h"
 #include "2d/CCFontAtlas.h"
+#include "2d/CCFontFreeType.h"
 #include "2d/CCSprite.h"
 #include "2d/CCSpriteBatchNode.h"
 #include "2d/CCDrawNode.h"
@@ -38,12 +39,15 @@
 #include "base/ccUTF8.h"
 #include "platform/CCFileUtils.h"
 #include "renderer/CCRenderer.h"
+#include "renderer/CCGLProgramCache.h"
 #include "renderer/ccGLStateCache.h"
+#include "platform/CCGLView.h"
 #include "base/CCDirector.h"
 #include "base/CCEventListenerCustom.h"
 #include "base/CCEventDispatcher.h"
 #include "base/CCEventCustom.h"
 #include "2d/CCFontFNT.h"
+#include "2d/CCTextShaper.h"
 
 NS_CC_BEGIN
 
@@ -57,6 +61,7 @@ public:
     {
         _textureAtlas = nullptr;
         _letterVisible = true;
+        _tint = Color4B::WHITE;
     }
 
     static LabelLetter* createWithTexture(Texture2D *texture, const Rect& rect, bool rotated = false)
@@ -136,13 +141,14 @@ public:
         {
             displayedOpacity = 0.0f;
         }
-        Color4B color4(_displayedColor.r, _displayedColor.g, _displayedColor.b, displayedOpacity);
+        Color4B color4(_displayedColor.r * _tint.r / 255, _displayedColor.g * _tint.g / 255,
+            _displayedColor.b * _tint.b / 255, displayedOpacity * _tint.a / 255);
         // special opacity for premultiplied textures
         if (_opacityModifyRGB)
         {
-            color4.r *= displayedOpacity / 255.0f;
-            color4.g *= displayedOpacity / 255.0f;
-            color4.b *= displayedOpacity / 255.0f;
+            color4.r *= color4.a / 255.0f;
+            color4.g *= color4.a / 255.0f;
+            color4.b *= color4.a / 255.0f;
         }
         _quad.bl.colors = color4;
         _quad.br.colors = color4;
@@ -158,6 +164,12 @@ public:
         updateColor();
     }
 
+    // the label's text color, baked into the quad when the label batches its glyphs
+    void setTint(const Color4B& tint)
+    {
+        _tint = tint;
+    }
+
     bool isVisible() const override
     {
         return _letterVisible;
@@ -170,8 +182,69 @@ public:
     
 private:
     bool _letterVisible;
+    Color4B _tint;
 };
 
+bool Label::s_glyphBatchingEnabled = true;
+
+namespace
+{
+    // Effect types of ccShader_Label_batch.frag
+    enum GlyphBatchEffect
+    {
+        GLYPH_BATCH_TEXT = 0,
+        GLYPH_BATCH_OUTLINE = 1,
+        GLYPH_BATCH_DISTANCE_FIELD = 2,
+        GLYPH_BATCH_GLOW = 3,
+    };
+
+    // Program states of the batch shader, shared by all labels with the same effect and effect color.
+    // Every label retains the state it draws with, a reference count of one means no label uses it.
+    std::unordered_map<uint64_t, GLProgramState*> s_glyphBatchStates;
+
+    GLProgramState* getGlyphBatchState(int effectType, const Color4B& effectColor)
+    {
+        uint64_t key = (static_cast<uint64_t>(effectType) << 32)
+            | (static_cast<uint64_t>(effectColor.r) << 24) | (static_cast<uint64_t>(effectColor.g) << 16)
+            | (static_cast<uint64_t>(effectColor.b) << 8) | effectColor.a;
+        auto it = s_glyphBatchStates.find(key);
+        if (it != s_glyphBatchStates.end())
+        {
+            return it->second;
+        }
+
+        // animated effect colors keep adding states, drop the ones nobody uses
+        if (s_glyphBatchStates.size() >= 64)
+        {
+            for (auto iter = s_glyphBatchStates.begin(); iter != s_glyphBatchStates.end();)
+            {
+                if (iter->second->getReferenceCount() == 1)
+                {
+                    iter->second->release();
+                    iter = s_glyphBatchStates.erase(iter);
+                }
+                else
+                {
+                    ++iter;
+                }
+            }
+        }
+
+        auto glProgram = GLProgramCache::getInstance()->getGLProgram(GLProgram::SHADER_NAME_LABEL_BATCH);
+        auto state = GLProgramState::create(glProgram);
+        if (state == nullptr)
+        {
+            return nullptr;
+        }
+        state->setUniformInt("u_effectType", effectType);
+        state->setUniformVec4("u_effectColor", Vec4(effectColor.r / 255.0f, effectColor.g / 255.0f,
+            effectColor.b / 255.0f, effectColor.a / 255.0f));
+        state->retain();
+        s_glyphBatchStates.emplace(key, state);
+        return state;
+    }
+}
+
 Label* Label::create()
 {
     auto ret = new (std::nothrow) Label;
@@ -387,6 +460,8 @@ Label::Label(TextHAlignment hAlignment /* = TextHAlignment::LEFT */,
 , _fontAtlas(nullptr)
 , _reusedLetter(nullptr)
 , _horizontalKernings(nullptr)
+, _glyphBatchGLProgramState(nullptr)
+, _textColorBaked(false)
 , _boldEnabled(false)
 , _underlineNode(nullptr)
 , _strikethroughEnabled(false)
@@ -453,6 +528,7 @@ Label::~Label()
 
     CC_SAFE_RELEASE_NULL(_textSprite);
     CC_SAFE_RELEASE_NULL(_shadowNode);
+    CC_SAFE_RELEASE_NULL(_glyphBatchGLProgramState);
 }
 
 void Label::reset()
@@ -477,6 +553,14 @@ void Label::reset()
     _lengthOfString = 0;
     _utf32Text.clear();
     _utf8Text.clear();
+    _shapedText.clear();
+    _shapedFlags.clear();
+    _textShaped = false;
+    _lineCheckpoints.clear();
+    _unchangedLength = 0;
+    _relayoutLine = 0;
+    _quadLinesOffsetX.clear();
+    _quadLetterOffsetY = 0.f;
 
     TTFConfig temp;
     _fontConfig = temp;
@@ -515,9 +599,12 @@ void Label::reset()
     _uniformEffectColor = -1;
     _uniformEffectType = -1;
     _uniformTextColor = -1;
+    _uniformPixelRange = -1;
+    _uniformEffectWidth = -1;
 
     _useDistanceField = false;
     _useA8Shader = false;
+    _useMSDF = false;
     _clipEnabled = false;
     _blendFuncDirty = false;
     _blendFunc = BlendFunc::ALPHA_PREMULTIPLIED;
@@ -554,6 +641,19 @@ static Texture2D* _getTexture(Label* label)
 
 void Label::updateShaderProgram()
 {
+    if (_useMSDF)
+    {
+        // one program draws every effect from the same atlas
+        setGLProgramState(GLProgramState::getOrCreateWithGLProgramName(GLProgram::SHADER_NAME_LABEL_MSDF));
+        auto program = getGLProgram()->getProgram();
+        _uniformEffectColor = glGetUniformLocation(program, "u_effectColor");
+        _uniformEffectType = glGetUniformLocation(program, "u_effectType");
+        _uniformTextColor = glGetUniformLocation(program, "u_textColor");
+        _uniformPixelRange = glGetUniformLocation(program, "u_pxRange");
+        _uniformEffectWidth = glGetUniformLocation(program, "u_effectWidth");
+        return;
+    }
+
     switch (_currLabelEffect)
     {
     case cocos2d::LabelEffect::NORMAL:
@@ -620,6 +720,8 @@ void Label::setFontAtlas(FontAtlas* atlas,bool distanceFieldEnabled /* = false *
     }
     _useDistanceField = distanceFieldEnabled;
     _useA8Shader = useA8Shader;
+    auto fontFreeType = _fontAtlas ? dynamic_cast<const FontFreeType*>(_fontAtlas->getFont()) : nullptr;
+    _useMSDF = fontFreeType && fontFreeType->isMSDFEnabled();
 
     if (_currentLabelType != LabelType::TTF)
     {
@@ -675,6 +777,15 @@ void Label::setString(const std::string& text)
         std::u32string utf32String;
         if (StringUtils::UTF8ToUTF32(_utf8Text, utf32String))
         {
+            // the layout of the unchanged prefix is reused by updateContent()
+            int unchangedLength = std::min(_unchangedLength, static_cast<int>(utf32String.length()));
+            int index = 0;
+            while (index < unchangedLength && utf32String[index] == _utf32Text[index])
+            {
+                ++index;
+            }
+            _unchangedLength = index;
+
             _utf32Text  = utf32String;
         }
 
@@ -814,13 +925,27 @@ bool Label::alignText()
 {
     if (_fontAtlas == nullptr || _utf32Text.empty())
     {
+        _lineCheckpoints.clear();
         setContentSize(Size::ZERO);
         return true;
     }
 
     bool ret = true;
     do {
-        _fontAtlas->prepareLetterDefinitions(_utf32Text);
+        if (_relayoutLine > 0)
+        {
+            // letters of the reused lines were prepared by the previous layout
+            _fontAtlas->prepareLetterDefinitions(getLayoutText().substr(_lineCheckpoints[_relayoutLine].letterIndex));
+            if (_fontAtlas->getGeneration() != _lastLayoutInputs.atlasGeneration)
+            {
+                _relayoutLine = 0;
+                _fontAtlas->prepareLetterDefinitions(getLayoutText());
+            }
+        }
+        else
+        {
+            _fontAtlas->prepareLetterDefinitions(getLayoutText());
+        }
         auto& textures = _fontAtlas->getTextures();
         auto size = textures.size();
         if (size > static_cast<size_t>(_batchNodes.size()))
@@ -840,6 +965,7 @@ bool Label::alignText()
         }
         if (_batchNodes.empty())
         {
+            _lineCheckpoints.clear();
             return true;
         }
         // optimize for one-texture-only scenario
@@ -852,7 +978,7 @@ bool Label::alignText()
         
         _lengthOfString = 0;
         _textDesiredHeight = 0.f;
-        _linesWidth.clear();
+        _linesWidth.resize(_relayoutLine);
         if (_maxLineWidth > 0.f && !_lineBreakWithoutSpaces)
         {
             multilineTextWrapByWord();
@@ -889,13 +1015,40 @@ bool Label::alignText()
 
 bool Label::computeHorizontalKernings(const std::u32string& stringToRender)
 {
+    int letterCount = 0;
+    if (_relayoutLine > 0)
+    {
+        // the kerning of a letter only depends on its predecessor, so only the
+        // letters from the resumed line on need to be asked for
+        int start = _lineCheckpoints[_relayoutLine].letterIndex;
+        auto tailKernings = _fontAtlas->getFont()->getHorizontalKerningForTextUTF32(stringToRender.substr(start - 1), letterCount);
+        if (tailKernings == nullptr && _horizontalKernings == nullptr)
+        {
+            return false;
+        }
+
+        if (tailKernings && _horizontalKernings)
+        {
+            auto kernings = new (std::nothrow) int[stringToRender.length()];
+            if (kernings)
+            {
+                memcpy(kernings, _horizontalKernings, start * sizeof(int));
+                memcpy(kernings + start, tailKernings + 1, (letterCount - 1) * sizeof(int));
+                delete [] tailKernings;
+                delete [] _horizontalKernings;
+                _horizontalKernings = kernings;
+                return true;
+            }
+        }
+        delete [] tailKernings;
+    }
+
     if (_horizontalKernings)
     {
         delete [] _horizontalKernings;
         _horizontalKernings = nullptr;
     }
 
-    int letterCount = 0;
     _horizontalKernings = _fontAtlas->getFont()->getHorizontalKerningForTextUTF32(stringToRender, letterCount);
 
     if(!_horizontalKernings)
@@ -904,6 +1057,36 @@ bool Label::computeHorizontalKernings(const std::u32string& stringToRender)
         return true;
 }
 
+void Label::shapeText()
+{
+    bool wasShaped = _textShaped;
+    std::u32string previousGlyphs;
+    std::vector<unsigned char> previousFlags;
+    _shapedText.swap(previousGlyphs);
+    _shapedFlags.swap(previousFlags);
+
+    // text without complex scripts is laid out as it is
+    _textShaped = TextShaper::needsShaping(_utf32Text);
+    if (!_textShaped)
+    {
+        return;
+    }
+    TextShaper::shape(_fontAtlas->getFont(), _utf32Text, _shapedText, _shapedFlags);
+
+    // a changed letter may change the shape or the direction of the letters before it
+    int unchangedLength = std::min(_unchangedLength, static_cast<int>(_utf32Text.length()));
+    for (int index = 0; index < unchangedLength; ++index)
+    {
+        auto previousGlyph = wasShaped ? previousGlyphs[index] : _utf32Text[index];
+        auto previousFlag = wasShaped ? previousFlags[index] : 0;
+        if (_shapedText[index] != previousGlyph || _shapedFlags[index] != previousFlag)
+        {
+            _unchangedLength = index;
+            break;
+        }
+    }
+}
+
 bool Label::isHorizontalClamped(float letterPositionX, int lineIndex)
 {
     auto wordWidth = this->_linesWidth[lineIndex];
@@ -918,13 +1101,36 @@ bool Label::isHorizontalClamped(float letterPositionX, int lineIndex)
 bool Label::updateQuads()
 {
     bool ret = true;
-    for (auto&& batchNode : _batchNodes)
+    int startLetter = 0;
+    if (_relayoutLine > 0)
     {
-        batchNode->getTextureAtlas()->removeAllQuads();
+        startLetter = _lineCheckpoints[_relayoutLine].letterIndex;
+        truncateQuadsForRelayout();
     }
-    
-    for (int ctr = 0; ctr < _lengthOfString; ++ctr)
+    else
+    {
+        for (auto&& batchNode : _batchNodes)
+        {
+            batchNode->getTextureAtlas()->removeAllQuads();
+        }
+    }
+
+    auto saveQuadCounts = [this](LineCheckpoint& checkpoint) {
+        checkpoint.quadCounts.resize(_batchNodes.size());
+        for (ssize_t index = 0; index < _batchNodes.size(); ++index)
+        {
+            checkpoint.quadCounts[index] = _batchNodes.at(index)->getTextureAtlas()->getTotalQuads();
+        }
+    };
+    size_t nextCheckpoint = _relayoutLine;
+
+    for (int ctr = startLetter; ctr < _lengthOfString; ++ctr)
     {
+        for (; nextCheckpoint < _lineCheckpoints.size() && _lineCheckpoints[nextCheckpoint].letterIndex <= ctr; ++nextCheckpoint)
+        {
+            saveQuadCounts(_lineCheckpoints[nextCheckpoint]);
+        }
+
         if (_lettersInfo[ctr].valid)
         {
             auto& letterDef = _fontAtlas->_letterDefinitions[_lettersInfo[ctr].utf32Char];
@@ -984,10 +1190,147 @@ bool Label::updateQuads()
         }     
     }
 
+    for (; nextCheckpoint < _lineCheckpoints.size(); ++nextCheckpoint)
+    {
+        saveQuadCounts(_lineCheckpoints[nextCheckpoint]);
+    }
+    _quadLinesOffsetX = _linesOffsetX;
+    _quadLetterOffsetY = _letterOffsetY;
 
     return ret;
 }
 
+void Label::truncateQuadsForRelayout()
+{
+    auto& checkpoint = _lineCheckpoints[_relayoutLine];
+    for (ssize_t index = 0; index < _batchNodes.size(); ++index)
+    {
+        auto textureAtlas = _batchNodes.at(index)->getTextureAtlas();
+        ssize_t keep = index < static_cast<ssize_t>(checkpoint.quadCounts.size()) ? checkpoint.quadCounts[index] : 0;
+        auto total = textureAtlas->getTotalQuads();
+        if (total > keep)
+        {
+            textureAtlas->removeQuadsAtIndex(keep, total - keep);
+        }
+    }
+
+    // the alignment offsets depend on the whole text, so the kept quads
+    // have to follow them when the content size changed
+    float offsetY = _letterOffsetY - _quadLetterOffsetY;
+    bool moved = offsetY != 0.f;
+    for (int line = 0; line < _relayoutLine && !moved; ++line)
+    {
+        moved = _linesOffsetX[line] != _quadLinesOffsetX[line];
+    }
+    if (!moved)
+    {
+        return;
+    }
+
+    for (int ctr = 0; ctr < checkpoint.letterIndex; ++ctr)
+    {
+        auto& letterInfo = _lettersInfo[ctr];
+        if (!letterInfo.valid || letterInfo.atlasIndex < 0)
+            continue;
+
+        auto& letterDef = _fontAtlas->_letterDefinitions[letterInfo.utf32Char];
+        auto& quad = _batchNodes.at(letterDef.textureID)->getTextureAtlas()->getQuads()[letterInfo.atlasIndex];
+        float offsetX = _linesOffsetX[letterInfo.lineIndex] - _quadLinesOffsetX[letterInfo.lineIndex];
+        quad.bl.vertices.x += offsetX;
+        quad.br.vertices.x += offsetX;
+        quad.tl.vertices.x += offsetX;
+        quad.tr.vertices.x += offsetX;
+        quad.bl.vertices.y += offsetY;
+        quad.br.vertices.y += offsetY;
+        quad.tl.vertices.y += offsetY;
+        quad.tr.vertices.y += offsetY;
+    }
+
+    for (auto&& batchNode : _batchNodes)
+    {
+        batchNode->getTextureAtlas()->setDirty(true);
+    }
+}
+
+bool Label::LayoutInputs::operator==(const LayoutInputs& other) const
+{
+    return fontAtlas == other.fontAtlas
+        && atlasGeneration == other.atlasGeneration
+        && labelType == other.labelType
+        && lineHeight == other.lineHeight
+        && lineSpacing == other.lineSpacing
+        && additionalKerning == other.additionalKerning
+        && maxLineWidth == other.maxLineWidth
+        && labelWidth == other.labelWidth
+        && labelHeight == other.labelHeight
+        && bmFontSize == other.bmFontSize
+        && fontSize == other.fontSize
+        && contentScaleFactor == other.contentScaleFactor
+        && hAlignment == other.hAlignment
+        && vAlignment == other.vAlignment
+        && overflow == other.overflow
+        && enableWrap == other.enableWrap
+        && lineBreakWithoutSpaces == other.lineBreakWithoutSpaces;
+}
+
+Label::LayoutInputs Label::getLayoutInputs() const
+{
+    LayoutInputs inputs;
+    inputs.fontAtlas = _fontAtlas;
+    inputs.atlasGeneration = _fontAtlas ? _fontAtlas->getGeneration() : 0;
+    inputs.labelType = _currentLabelType;
+    inputs.lineHeight = _lineHeight;
+    inputs.lineSpacing = _lineSpacing;
+    inputs.additionalKerning = _additionalKerning;
+    inputs.maxLineWidth = _maxLineWidth;
+    inputs.labelWidth = _labelWidth;
+    inputs.labelHeight = _labelHeight;
+    inputs.bmFontSize = _bmFontSize;
+    inputs.fontSize = _currentLabelType == LabelType::TTF ? _fontConfig.fontSize : 0.f;
+    inputs.contentScaleFactor = CC_CONTENT_SCALE_FACTOR();
+    inputs.hAlignment = _hAlignment;
+    inputs.vAlignment = _vAlignment;
+    inputs.overflow = _overflow;
+    inputs.enableWrap = _enableWrap;
+    inputs.lineBreakWithoutSpaces = _lineBreakWithoutSpaces;
+    return inputs;
+}
+
+int Label::findRelayoutLine() const
+{
+    // clipping and shrinking look at every letter, only plain layouts are resumed
+    if (_unchangedLength <= 0 || _lineCheckpoints.size() < 2
+        || _labelHeight > 0.f || _overflow == Overflow::CLAMP || _overflow == Overflow::SHRINK
+        || !(getLayoutInputs() == _lastLayoutInputs))
+    {
+        return 0;
+    }
+
+    // a line can be kept if nothing before it depended on a changed letter
+    int line = static_cast<int>(_lineCheckpoints.size()) - 1;
+    while (line > 0 && _lineCheckpoints[line].lastReadIndex >= _unchangedLength)
+    {
+        --line;
+    }
+    if (line == 0 || _lineCheckpoints[line].letterIndex < 1)
+    {
+        return 0;
+    }
+
+    // the quads may have been dropped meanwhile, e.g. by a purged atlas
+    auto& quadCounts = _lineCheckpoints[line].quadCounts;
+    if (static_cast<ssize_t>(quadCounts.size()) > _batchNodes.size())
+    {
+        return 0;
+    }
+    for (size_t index = 0; index < quadCounts.size(); ++index)
+    {
+        if (_batchNodes.at(index)->getTextureAtlas()->getTotalQuads() < quadCounts[index])
+            return 0;
+    }
+    return line;
+}
+
 bool Label::setTTFConfigInternal(const TTFConfig& ttfConfig)
 {
     FontAtlas *newAtlas = FontAtlasCache::getFontAtlasTTF(&ttfConfig);
@@ -1001,6 +1344,11 @@ bool Label::setTTFConfigInternal(const TTFConfig& ttfConfig)
     _currentLabelType = LabelType::TTF;
     setFontAtlas(newAtlas,ttfConfig.distanceFieldEnabled,true);
 
+    // every size shares the multi-channel distance field atlas, relayout with the new scale
+    if (_useMSDF && _fontConfig.fontSize != ttfConfig.fontSize)
+    {
+        _contentDirty = true;
+    }
     _fontConfig = ttfConfig;
 
     if (_fontConfig.outlineSize > 0)
@@ -1063,7 +1411,7 @@ void Label::enableGlow(const Color4B& glowColor)
 {
     if (_currentLabelType == LabelType::TTF)
     {
-        if (_fontConfig.distanceFieldEnabled == false)
+        if (_fontConfig.distanceFieldEnabled == false && !_useMSDF)
         {
             auto config = _fontConfig;
             config.outlineSize = 0;
@@ -1093,7 +1441,17 @@ void Label::enableOutline(const Color4B& outlineColor,int outlineSize /* = -1 */
             _effectColorF.b = outlineColor.b / 255.0f;
             _effectColorF.a = outlineColor.a / 255.0f;
 
-            if (outlineSize > 0 && _fontConfig.outlineSize != outlineSize)
+            if (_useMSDF)
+            {
+                // the shader draws the outline, the atlas stays the same
+                if (outlineSize > 0)
+                {
+                    _fontConfig.outlineSize = outlineSize;
+                }
+                _currLabelEffect = LabelEffect::OUTLINE;
+                updateShaderProgram();
+            }
+            else if (outlineSize > 0 && _fontConfig.outlineSize != outlineSize)
             {
                 _fontConfig.outlineSize = outlineSize;
                 setTTFConfig(_fontConfig);
@@ -1412,8 +1770,21 @@ void Label::updateContent()
             _utf32Text = utf32String;
         }
 
-        computeHorizontalKernings(_utf32Text);
+        shapeText();
+        _relayoutLine = findRelayoutLine();
+        computeHorizontalKernings(getLayoutText());
         updateFinished = alignText();
+        _relayoutLine = 0;
+
+        if (updateFinished)
+        {
+            _unchangedLength = static_cast<int>(_utf32Text.length());
+            _lastLayoutInputs = getLayoutInputs();
+        }
+        else
+        {
+            _unchangedLength = 0;
+        }
     }
     else
     {
@@ -1492,9 +1863,45 @@ float Label::getBMFontSize()const
     return _bmFontSize;
 }
 
+void Label::updateMSDFUniforms(GLProgram* glProgram, const Mat4& transform, float effectWidth)
+{
+    // screen pixels per point, taken from the x axis of the transform
+    float pixelsPerPoint = std::sqrt(transform.m[0] * transform.m[0] + transform.m[1] * transform.m[1]);
+    auto glview = Director::getInstance()->getOpenGLView();
+    if (glview)
+    {
+        pixelsPerPoint *= glview->getScaleX();
+    }
+
+    // a texel of the atlas covers 1 / CC_CONTENT_SCALE_FACTOR() points before the font size scale
+    float pixelsPerTexel = pixelsPerPoint * _bmfontScale / CC_CONTENT_SCALE_FACTOR();
+    float pixelRange = 2 * FontFreeType::MSDFSpread * pixelsPerTexel;
+    glProgram->setUniformLocationWith1f(_uniformPixelRange, std::max(pixelRange, 1.0f));
+    // the field saturates MSDFSpread texels away from the glyph, wider effects are clipped
+    glProgram->setUniformLocationWith1f(_uniformEffectWidth,
+        std::min(effectWidth * pixelsPerPoint, FontFreeType::MSDFSpread * pixelsPerTexel));
+}
+
 void Label::onDrawShadow(GLProgram* glProgram, const Color4F& shadowColor)
 {
-    if (_currentLabelType == LabelType::TTF)
+    if (_useMSDF)
+    {
+        glProgram->setUniformLocationWith1i(_uniformEffectType, 3); // 3: shadow
+        glProgram->setUniformLocationWith4f(_uniformEffectColor, shadowColor.r, shadowColor.g, shadowColor.b, shadowColor.a);
+        updateMSDFUniforms(glProgram, _shadowTransform,
+            _currLabelEffect == LabelEffect::OUTLINE ? _fontConfig.outlineSize : 0.f);
+
+        glProgram->setUniformsForBuiltins(_shadowTransform);
+        for (auto&& it : _letters)
+        {
+            it.second->updateTransform();
+        }
+        for (auto&& batchNode : _batchNodes)
+        {
+            batchNode->getTextureAtlas()->drawQuads();
+        }
+    }
+    else if (_currentLabelType == LabelType::TTF)
     {
         if (_currLabelEffect == LabelEffect::OUTLINE)
         {
@@ -1562,7 +1969,21 @@ void Label::onDraw(const Mat4& transform, bool /*transformUpdated*/)
         it.second->updateTransform();
     }
 
-    if (_currentLabelType == LabelType::TTF)
+    if (_useMSDF)
+    {
+        int effectType = 0; // 0: text
+        if (_currLabelEffect == LabelEffect::OUTLINE)
+            effectType = 1; // 1: outline
+        else if (_currLabelEffect == LabelEffect::GLOW)
+            effectType = 2; // 2: glow
+        glprogram->setUniformLocationWith1i(_uniformEffectType, effectType);
+        glprogram->setUniformLocationWith4f(_uniformEffectColor,
+            _effectColorF.r, _effectColorF.g, _effectColorF.b, _effectColorF.a);
+        glprogram->setUniformLocationWith4f(_uniformTextColor,
+            _textColorF.r, _textColorF.g, _textColorF.b, _textColorF.a);
+        updateMSDFUniforms(glprogram, transform, effectType == 1 ? _fontConfig.outlineSize : 0.f);
+    }
+    else if (_currentLabelType == LabelType::TTF)
     {
         switch (_currLabelEffect) {
         case LabelEffect::OUTLINE:
@@ -1597,6 +2018,139 @@ void Label::onDraw(const Mat4& transform, bool /*transformUpdated*/)
     }
 }
 
+bool Label::canBatchGlyphs() const
+{
+    if (!s_glyphBatchingEnabled || _currentLabelType != LabelType::TTF || _useMSDF)
+    {
+        return false;
+    }
+
+    // a program set by the user isn't replaced
+    const char* programName = nullptr;
+    switch (_currLabelEffect)
+    {
+    case LabelEffect::NORMAL:
+        programName = _useDistanceField ? GLProgram::SHADER_NAME_LABEL_DISTANCEFIELD_NORMAL : GLProgram::SHADER_NAME_LABEL_NORMAL;
+        break;
+    case LabelEffect::OUTLINE:
+        // the merged pass reproduces the two passes for this blend function only
+        if (_shadowEnabled || _blendFunc != BlendFunc::ALPHA_NON_PREMULTIPLIED)
+            return false;
+        programName = GLProgram::SHADER_NAME_LABEL_OUTLINE;
+        break;
+    case LabelEffect::GLOW:
+        if (_shadowEnabled || !_useDistanceField)
+            return false;
+        programName = GLProgram::SHADER_NAME_LABEL_DISTANCEFIELD_GLOW;
+        break;
+    default:
+        return false;
+    }
+    return getGLProgram() == GLProgramCache::getInstance()->getGLProgram(programName);
+}
+
+GLProgramState* Label::getGlyphBatchGLProgramState()
+{
+    int effectType = _useDistanceField ? GLYPH_BATCH_DISTANCE_FIELD : GLYPH_BATCH_TEXT;
+    Color4B effectColor(0, 0, 0, 0);
+    if (_currLabelEffect == LabelEffect::OUTLINE || _currLabelEffect == LabelEffect::GLOW)
+    {
+        effectType = _currLabelEffect == LabelEffect::OUTLINE ? GLYPH_BATCH_OUTLINE : GLYPH_BATCH_GLOW;
+        // the vertices carry the text color, the displayed color tints the effect color here
+        float alpha = _effectColorF.a * _displayedOpacity / 255.0f;
+        float rgbScale = _isOpacityModifyRGB ? _displayedOpacity / 255.0f : 1.0f;
+        effectColor.r = static_cast<GLubyte>(_effectColorF.r * _displayedColor.r * rgbScale);
+        effectColor.g = static_cast<GLubyte>(_effectColorF.g * _displayedColor.g * rgbScale);
+        effectColor.b = static_cast<GLubyte>(_effectColorF.b * _displayedColor.b * rgbScale);
+        effectColor.a = static_cast<GLubyte>(alpha * 255);
+    }
+
+    auto state = getGlyphBatchState(effectType, effectColor);
+    if (state != _glyphBatchGLProgramState)
+    {
+        CC_SAFE_RETAIN(state);
+        CC_SAFE_RELEASE(_glyphBatchGLProgramState);
+        _glyphBatchGLProgramState = state;
+    }
+    return state;
+}
+
+QuadCommand* Label::getGlyphCommand(size_t index)
+{
+    while (_glyphCommands.size() <= index)
+    {
+        _glyphCommands.emplace_back(new QuadCommand());
+    }
+    return _glyphCommands[index].get();
+}
+
+void Label::drawBatchedGlyphs(Renderer* renderer, const Mat4& transform, uint32_t flags)
+{
+    auto glProgramState = getGlyphBatchGLProgramState();
+    if (glProgramState == nullptr)
+    {
+        return;
+    }
+
+    for (auto&& it : _letters)
+    {
+        it.second->updateTransform();
+    }
+
+    // the vertices are transformed on the CPU, labels on the same page and with the same
+    // effect end up in one draw call; a shadow is a recolored copy of the text quads
+    Color4B shadowColor(_boldEnabled ? _textColorF : _shadowColor4F);
+    shadowColor.r = shadowColor.r * _displayedColor.r / 255;
+    shadowColor.g = shadowColor.g * _displayedColor.g / 255;
+    shadowColor.b = shadowColor.b * _displayedColor.b / 255;
+    shadowColor.a = shadowColor.a * _displayedOpacity / 255;
+    if (_isOpacityModifyRGB)
+    {
+        shadowColor.r *= shadowColor.a / 255.0f;
+        shadowColor.g *= shadowColor.a / 255.0f;
+        shadowColor.b *= shadowColor.a / 255.0f;
+    }
+    const Color4B hiddenColor(0, 0, 0, 0);
+
+    size_t commandIndex = 0;
+    _shadowQuads.resize(_batchNodes.size());
+    for (ssize_t index = 0; index < _batchNodes.size(); ++index)
+    {
+        auto textureAtlas = _batchNodes.at(index)->getTextureAtlas();
+        auto quadCount = textureAtlas->getTotalQuads();
+        if (quadCount == 0)
+        {
+            continue;
+        }
+        auto quads = textureAtlas->getQuads();
+
+        if (_shadowEnabled)
+        {
+            auto& shadowQuads = _shadowQuads[index];
+            shadowQuads.assign(quads, quads + quadCount);
+            for (auto&& quad : shadowQuads)
+            {
+                // hidden letters stay hidden
+                auto& color = quad.bl.colors.a == 0 && _textColor.a != 0 ? hiddenColor : shadowColor;
+                quad.bl.colors = color;
+                quad.br.colors = color;
+                quad.tl.colors = color;
+                quad.tr.colors = color;
+            }
+
+            auto shadowCommand = getGlyphCommand(commandIndex++);
+            shadowCommand->init(_globalZOrder, textureAtlas->getTexture(), glProgramState, _blendFunc,
+                shadowQuads.data(), quadCount, _shadowTransform, flags);
+            renderer->addCommand(shadowCommand);
+        }
+
+        auto command = getGlyphCommand(commandIndex++);
+        command->init(_globalZOrder, textureAtlas->getTexture(), glProgramState, _blendFunc,
+            quads, quadCount, transform, flags);
+        renderer->addCommand(command);
+    }
+}
+
 void Label::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
 {
     if (_batchNodes.empty() || _lengthOfString <= 0)
@@ -1605,6 +2159,14 @@ void Label::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
     }
     // Don't do calculate the culling if the transform was not updated
     bool transformUpdated = flags & FLAGS_TRANSFORM_DIRTY;
+
+    bool batchGlyphs = canBatchGlyphs();
+    if (batchGlyphs != _textColorBaked)
+    {
+        _textColorBaked = batchGlyphs;
+        updateColor();
+    }
+
 #if CC_USE_CULLING
     auto visitingCamera = Camera::getVisitingCamera();
     auto defaultCamera = Camera::getDefaultCamera();
@@ -1632,6 +2194,10 @@ void Label::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
                 _blendFunc, textureAtlas->getQuads(), textureAtlas->getTotalQuads(), transform, flags);
             renderer->addCommand(&_quadCommand);
         }
+        else if (batchGlyphs)
+        {
+            drawBatchedGlyphs(renderer, transform, flags);
+        }
         else
         {
             _customCommand.init(_globalZOrder, transform, flags);
@@ -1802,6 +2368,7 @@ Sprite* Label::getLetter(int letterIndex)
                     letter = LabelLetter::createWithTexture(_fontAtlas->getTexture(textureID), uvRect);
                     letter->setTextureAtlas(_batchNodes.at(textureID)->getTextureAtlas());
                     letter->setAtlasIndex(letterInfo.atlasIndex);
+                    static_cast<LabelLetter*>(letter)->setTint(_textColorBaked ? _textColor : Color4B::WHITE);
                     auto px = letterInfo.positionX + _bmfontScale * uvRect.size.width / 2 + _linesOffsetX[letterInfo.lineIndex];
                     auto py = letterInfo.positionY - _bmfontScale * uvRect.size.height / 2 + _letterOffsetY;
                     letter->setPosition(px,py);
@@ -1991,6 +2558,11 @@ void Label::setTextColor(const Color4B &color)
     _textColorF.g = _textColor.g / 255.0f;
     _textColorF.b = _textColor.b / 255.0f;
     _textColorF.a = _textColor.a / 255.0f;
+
+    if (_textColorBaked)
+    {
+        updateColor();
+    }
 }
 
 void Label::updateColor()
@@ -2002,12 +2574,26 @@ void Label::updateColor()
 
     Color4B color4( _displayedColor.r, _displayedColor.g, _displayedColor.b, _displayedOpacity );
 
+    // batched glyphs take the text color from the vertices instead of a uniform
+    auto tint = _textColorBaked ? _textColor : Color4B::WHITE;
+    if (_textColorBaked)
+    {
+        color4.r = color4.r * tint.r / 255;
+        color4.g = color4.g * tint.g / 255;
+        color4.b = color4.b * tint.b / 255;
+        color4.a = color4.a * tint.a / 255;
+    }
+    for (auto&& it : _letters)
+    {
+        static_cast<LabelLetter*>(it.second)->setTint(tint);
+    }
+
     // special opacity for premultiplied textures
     if (_isOpacityModifyRGB)
     {
-        color4.r *= _displayedOpacity/255.0f;
-        color4.g *= _displayedOpacity/255.0f;
-        color4.b *= _displayedOpacity/255.0f;
+        color4.r *= color4.a/255.0f;
+        color4.g *= color4.a/255.0f;
+        color4.b *= color4.a/255.0f;
     }
 
     cocos2d::TextureAtlas* textureAtlas;
@@ -2219,7 +2805,7 @@ Label::Overflow Label::getOverflow()const
 
 void Label::updateLetterSpriteScale(Sprite* sprite)
 {
-    if (_currentLabelType == LabelType::BMFONT && _bmFontSize > 0)
+    if ((_currentLabelType == LabelType::BMFONT && _bmFontSize > 0) || _useMSDF)
     {
         sprite->setScale(_bmfontScale);
     }
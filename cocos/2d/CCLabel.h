@@ -27,6 +27,7 @@
 #ifndef _COCOS2D_CCLABEL_H_
 #define _COCOS2D_CCLABEL_H_
 
+#include <memory>
 #include "2d/CCNode.h"
 #include "renderer/CCCustomCommand.h"
 #include "renderer/CCQuadCommand.h"
@@ -62,9 +63,17 @@ typedef struct _ttfConfig
     bool underline;
     bool strikethrough;
 
+    /** Renders glyphs as multi-channel signed distance fields generated once at
+     FontFreeType::MSDFFontSize, so labels of every size share one atlas per font file.
+     Outline and glow are drawn by the shader and don't need atlases of their own.
+     @since v3.18
+     */
+    bool msdfEnabled;
+
     _ttfConfig(const std::string& filePath = "",float size = CC_DEFAULT_FONT_LABEL_SIZE, const GlyphCollection& glyphCollection = GlyphCollection::DYNAMIC,
         const char *customGlyphCollection = nullptr, bool useDistanceField = false, int outline = 0,
-               bool useItalics = false, bool useBold = false, bool useUnderline = false, bool useStrikethrough = false)
+               bool useItalics = false, bool useBold = false, bool useUnderline = false, bool useStrikethrough = false,
+               bool useMSDF = false)
         : fontFilePath(filePath)
         , fontSize(size)
         , glyphs(glyphCollection)
@@ -75,6 +84,7 @@ typedef struct _ttfConfig
         , bold(useBold)
         , underline(useUnderline)
         , strikethrough(useStrikethrough)
+        , msdfEnabled(useMSDF)
     {
         if(outline > 0)
         {
@@ -242,6 +252,19 @@ public:
     //  end of creators group
     /// @}
 
+    /**
+     * Lets TTF labels that share a font atlas page draw in one batch.
+     *
+     * The text color is written into the vertex colors and labels with the same effect and
+     * effect color use one GLProgramState, so the renderer merges consecutive labels into a
+     * single draw call. Outlines are drawn together with the text in one pass. Labels with a
+     * custom shader, multi-channel distance fields, or a shadow combined with outline or glow
+     * are drawn separately as before. Enabled by default.
+     * @since v3.18
+     */
+    static void setGlyphBatchingEnabled(bool enabled) { s_glyphBatchingEnabled = enabled; }
+    static bool isGlyphBatchingEnabled() { return s_glyphBatchingEnabled; }
+
     /// @{
     /// @name Font methods
 
@@ -655,6 +678,11 @@ protected:
 
     void onDraw(const Mat4& transform, bool transformUpdated);
     void onDrawShadow(GLProgram* glProgram, const Color4F& shadowColor);
+    void updateMSDFUniforms(GLProgram* glProgram, const Mat4& transform, float effectWidth);
+    bool canBatchGlyphs() const;
+    void drawBatchedGlyphs(Renderer* renderer, const Mat4& transform, uint32_t flags);
+    QuadCommand* getGlyphCommand(size_t index);
+    GLProgramState* getGlyphBatchGLProgramState();
     void drawSelf(bool visibleByCamera, Renderer* renderer, uint32_t flags);
 
     bool multilineTextWrapByChar();
@@ -669,6 +697,9 @@ protected:
     virtual bool alignText();
     void computeAlignmentOffset();
     bool computeHorizontalKernings(const std::u32string& stringToRender);
+    void shapeText();
+    const std::u32string& getLayoutText() const { return _textShaped ? _shapedText : _utf32Text; }
+    void mirrorRightToLeftRuns(int firstLetter);
 
     void recordLetterInfo(const cocos2d::Vec2& point, char32_t utf32Char, int letterIndex, int lineIndex);
     void recordPlaceholderInfo(int letterIndex, char32_t utf16Char);
@@ -699,6 +730,10 @@ protected:
     bool _contentDirty;
     std::u32string _utf32Text;
     std::string _utf8Text;
+    // the glyph drawn for every character of _utf32Text, see TextShaper
+    std::u32string _shapedText;
+    std::vector<unsigned char> _shapedFlags;
+    bool _textShaped;
     int _numberOfLines;
 
     std::string _bmFontPath;
@@ -747,12 +782,20 @@ protected:
 
     QuadCommand _quadCommand;
     CustomCommand _customCommand;
+    // text and shadow commands of every atlas page when glyphs are batched
+    std::vector<std::unique_ptr<QuadCommand>> _glyphCommands;
+    std::vector<std::vector<V3F_C4B_T2F_Quad>> _shadowQuads;
+    GLProgramState* _glyphBatchGLProgramState;
+    bool _textColorBaked;
     Mat4  _shadowTransform;
     GLint _uniformEffectColor;
     GLint _uniformEffectType; // 0: None, 1: Outline, 2: Shadow; Only used when outline is enabled.
     GLint _uniformTextColor;
+    GLint _uniformPixelRange;
+    GLint _uniformEffectWidth;
     bool _useDistanceField;
     bool _useA8Shader;
+    bool _useMSDF;
 
     bool _shadowDirty;
     bool _shadowEnabled;
@@ -774,6 +817,8 @@ protected:
 
     std::unordered_map<int, Sprite*> _letters;
 
+    static bool s_glyphBatchingEnabled;
+
     EventListenerCustom* _purgeTextureListener;
     EventListenerCustom* _resetTextureListener;
 
@@ -791,6 +836,62 @@ protected:
     DrawNode* _underlineNode;
     bool _strikethroughEnabled;
 
+    // Incremental relayout: when only the tail of the string changes, layout
+    // resumes from the start of the first line that saw a changed character.
+    struct LineCheckpoint
+    {
+        int letterIndex;
+        // highest letter index the layout of the previous lines looked at
+        int lastReadIndex;
+        float nextTokenY;
+        float nextWhitespaceWidth;
+        float highestY;
+        float lowestY;
+        bool nextChangeSize;
+        // quads of the letters before letterIndex, per batch node
+        std::vector<ssize_t> quadCounts;
+    };
+
+    // everything besides the string that the letter positions depend on
+    struct LayoutInputs
+    {
+        FontAtlas* fontAtlas = nullptr;
+        unsigned int atlasGeneration = 0;
+        LabelType labelType = LabelType::STRING_TEXTURE;
+        float lineHeight = 0.f;
+        float lineSpacing = 0.f;
+        float additionalKerning = 0.f;
+        float maxLineWidth = 0.f;
+        float labelWidth = 0.f;
+        float labelHeight = 0.f;
+        float bmFontSize = 0.f;
+        float fontSize = 0.f;
+        float contentScaleFactor = 0.f;
+        TextHAlignment hAlignment = TextHAlignment::LEFT;
+        TextVAlignment vAlignment = TextVAlignment::TOP;
+        Overflow overflow = Overflow::NONE;
+        bool enableWrap = false;
+        bool lineBreakWithoutSpaces = false;
+
+        bool operator==(const LayoutInputs& other) const;
+    };
+
+    LayoutInputs getLayoutInputs() const;
+    int findRelayoutLine() const;
+    void recordLineCheckpoint(int letterIndex, int lastReadIndex, float nextTokenY, float nextWhitespaceWidth,
+                              float highestY, float lowestY, bool nextChangeSize);
+    void truncateQuadsForRelayout();
+
+    std::vector<LineCheckpoint> _lineCheckpoints;
+    LayoutInputs _lastLayoutInputs;
+    // leading characters that are the same as in the last successful layout
+    int _unchangedLength;
+    // line the current layout pass resumes from, 0 for a full layout
+    int _relayoutLine;
+    // offsets the existing quads were built with
+    std::vector<float> _quadLinesOffsetX;
+    float _quadLetterOffsetY;
+
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(Label);
 };
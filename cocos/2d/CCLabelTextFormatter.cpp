@@ -25,11 +25,15 @@
  ****************************************************************************/
 
 #include "2d/CCLabel.h"
+#include <algorithm>
+#include <cfloat>
 #include <vector>
 #include "base/ccUTF8.h"
 #include "base/CCDirector.h"
 #include "2d/CCFontAtlas.h"
 #include "2d/CCFontFNT.h"
+#include "2d/CCFontFreeType.h"
+#include "2d/CCTextShaper.h"
 
 NS_CC_BEGIN
 
@@ -88,6 +92,12 @@ int Label::getFirstWordLen(const std::u32string& utf32Text, int startIndex, int
     for (int index = startIndex; index < textLen; ++index)
     {
         char32_t character = utf32Text[index];
+        if (_textShaped && (_shapedFlags[index] & (TextShaper::MARK | TextShaper::HIDDEN)))
+        {
+            // drawn over the previous letter, it takes no room
+            len++;
+            continue;
+        }
 
         if (character == StringUtils::UnicodeCharacters::NewLine
             || (!StringUtils::isUnicodeNonBreaking(character)
@@ -142,6 +152,9 @@ void Label::updateBMFontScale()
         FontFNT *bmFont = (FontFNT*)font;
         float originalFontSize = bmFont->getOriginalFontSize();
         _bmfontScale = _bmFontSize * CC_CONTENT_SCALE_FACTOR() / originalFontSize;
+    }else if (_useMSDF) {
+        // glyphs are generated at one size and scaled to the requested one
+        _bmfontScale = _fontConfig.fontSize / FontFreeType::MSDFFontSize;
     }else{
         _bmfontScale = 1.0f;
     }
@@ -164,12 +177,40 @@ bool Label::multilineTextWrap(const std::function<int(const std::u32string&, int
     FontLetterDefinition letterDef;
     Vec2 letterPosition;
     bool nextChangeSize = true;
+    int index = 0;
+    int lastReadIndex = -1;
+    const auto& layoutText = getLayoutText();
+    const unsigned char* shapedFlags = _textShaped ? _shapedFlags.data() : nullptr;
+    // marks are centered on the last letter that advanced the pen
+    float baseLetterX = 0.f;
+    float baseLetterWidth = 0.f;
 
     this->updateBMFontScale();
 
-    for (int index = 0; index < textLen; )
+    if (_relayoutLine > 0)
+    {
+        // resume at the start of the first line that has to change
+        auto& checkpoint = _lineCheckpoints[_relayoutLine];
+        index = checkpoint.letterIndex;
+        lastReadIndex = checkpoint.lastReadIndex;
+        lineIndex = _relayoutLine;
+        nextTokenY = checkpoint.nextTokenY;
+        nextWhitespaceWidth = checkpoint.nextWhitespaceWidth;
+        highestY = checkpoint.highestY;
+        lowestY = checkpoint.lowestY;
+        nextChangeSize = checkpoint.nextChangeSize;
+        _lineCheckpoints.resize(_relayoutLine + 1);
+    }
+    else
     {
-        char32_t character = _utf32Text[index];
+        _lineCheckpoints.clear();
+        recordLineCheckpoint(0, -1, nextTokenY, nextWhitespaceWidth, highestY, lowestY, nextChangeSize);
+    }
+    int firstLetter = index;
+
+    while (index < textLen)
+    {
+        char32_t character = layoutText[index];
         if (character == StringUtils::UnicodeCharacters::NewLine)
         {
             _linesWidth.push_back(letterRight);
@@ -178,11 +219,15 @@ bool Label::multilineTextWrap(const std::function<int(const std::u32string&, int
             nextTokenX = 0.f;
             nextTokenY -= _lineHeight*_bmfontScale + lineSpacing;
             recordPlaceholderInfo(index, character);
+            lastReadIndex = std::max(lastReadIndex, index);
             index++;
+            recordLineCheckpoint(index, lastReadIndex, nextTokenY, nextWhitespaceWidth, highestY, lowestY, nextChangeSize);
             continue;
         }
 
-        auto tokenLen = nextTokenLen(_utf32Text, index, textLen);
+        auto tokenLen = nextTokenLen(layoutText, index, textLen);
+        // measuring the token looks at the letter after it, and so does its kerning
+        lastReadIndex = std::max(lastReadIndex, index + tokenLen);
         float tokenHighestY = highestY;
         float tokenLowestY = lowestY;
         float tokenRight = letterRight;
@@ -192,8 +237,9 @@ bool Label::multilineTextWrap(const std::function<int(const std::u32string&, int
         for (int tmp = 0; tmp < tokenLen;++tmp)
         {
             int letterIndex = index + tmp;
-            character = _utf32Text[letterIndex];
-            if (character == StringUtils::UnicodeCharacters::CarriageReturn)
+            character = layoutText[letterIndex];
+            if (character == StringUtils::UnicodeCharacters::CarriageReturn
+                || (shapedFlags && (shapedFlags[letterIndex] & TextShaper::HIDDEN)))
             {
                 recordPlaceholderInfo(letterIndex, character);
                 continue;
@@ -214,6 +260,18 @@ bool Label::multilineTextWrap(const std::function<int(const std::u32string&, int
                 continue;
             }
 
+            if (shapedFlags && (shapedFlags[letterIndex] & TextShaper::MARK))
+            {
+                letterPosition.x = baseLetterX + (baseLetterWidth - letterDef.width * _bmfontScale / contentScaleFactor) / 2;
+                letterPosition.y = (nextTokenY - letterDef.offsetY * _bmfontScale) / contentScaleFactor;
+                recordLetterInfo(letterPosition, character, letterIndex, lineIndex);
+                if (tokenHighestY < letterPosition.y)
+                    tokenHighestY = letterPosition.y;
+                if (tokenLowestY > letterPosition.y - letterDef.height * _bmfontScale)
+                    tokenLowestY = letterPosition.y - letterDef.height * _bmfontScale;
+                continue;
+            }
+
             auto letterX = (nextLetterX + letterDef.offsetX * _bmfontScale) / contentScaleFactor;
             if (_enableWrap && _maxLineWidth > 0.f && nextTokenX > 0.f && letterX + letterDef.width * _bmfontScale > _maxLineWidth
                 && !StringUtils::isUnicodeSpace(character) && nextChangeSize)
@@ -233,12 +291,14 @@ bool Label::multilineTextWrap(const std::function<int(const std::u32string&, int
             }
             letterPosition.y = (nextTokenY - letterDef.offsetY * _bmfontScale) / contentScaleFactor;
             recordLetterInfo(letterPosition, character, letterIndex, lineIndex);
+            baseLetterX = letterPosition.x;
+            baseLetterWidth = letterDef.width * _bmfontScale / contentScaleFactor;
 
             if (nextChangeSize)
             {
                 float newLetterWidth = 0.f;
                 if (_horizontalKernings && letterIndex < textLen - 1)
-                    newLetterWidth = _horizontalKernings[letterIndex + 1];
+                    newLetterWidth = _horizontalKernings[letterIndex + 1] * (_useMSDF ? _bmfontScale : 1.f);
                 newLetterWidth += letterDef.xAdvance * _bmfontScale + _additionalKerning;
 
                 nextLetterX += newLetterWidth;
@@ -263,6 +323,7 @@ bool Label::multilineTextWrap(const std::function<int(const std::u32string&, int
 
         if (newLine)
         {
+            recordLineCheckpoint(index, lastReadIndex, nextTokenY, nextWhitespaceWidth, highestY, lowestY, nextChangeSize);
             continue;
         }
 
@@ -276,6 +337,11 @@ bool Label::multilineTextWrap(const std::function<int(const std::u32string&, int
         index += tokenLen;
     }
 
+    if (_textShaped)
+    {
+        mirrorRightToLeftRuns(firstLetter);
+    }
+
     if (_linesWidth.empty())
     {
         _linesWidth.push_back(letterRight);
@@ -312,6 +378,81 @@ bool Label::multilineTextWrap(const std::function<int(const std::u32string&, int
     return true;
 }
 
+void Label::mirrorRightToLeftRuns(int firstLetter)
+{
+    auto contentScaleFactor = CC_CONTENT_SCALE_FACTOR();
+    int letterCount = std::min(getStringLength(), static_cast<int>(_lettersInfo.size()));
+
+    // reverses the order of the letters in [begin, end) within the room their advances take
+    std::vector<int> run;
+    auto reverse = [&](size_t begin, size_t end) {
+        float left = FLT_MAX;
+        float right = -FLT_MAX;
+        for (auto tmp = begin; tmp < end; ++tmp)
+        {
+            auto& info = _lettersInfo[run[tmp]];
+            if (_shapedFlags[run[tmp]] & TextShaper::MARK)
+                continue;
+            auto& letterDef = _fontAtlas->_letterDefinitions[info.utf32Char];
+            float pen = info.positionX - letterDef.offsetX * _bmfontScale / contentScaleFactor;
+            left = std::min(left, pen);
+            right = std::max(right, pen + letterDef.xAdvance * _bmfontScale / contentScaleFactor);
+        }
+        if (left > right)
+            return;
+
+        float shift = 0.f;
+        for (auto tmp = begin; tmp < end; ++tmp)
+        {
+            auto& info = _lettersInfo[run[tmp]];
+            if (!(_shapedFlags[run[tmp]] & TextShaper::MARK))
+            {
+                // marks move with their letter
+                auto& letterDef = _fontAtlas->_letterDefinitions[info.utf32Char];
+                float pen = info.positionX - letterDef.offsetX * _bmfontScale / contentScaleFactor;
+                float advance = letterDef.xAdvance * _bmfontScale / contentScaleFactor;
+                shift = left + right - (pen + advance) - pen;
+            }
+            info.positionX += shift;
+        }
+    };
+    auto flush = [&]() {
+        reverse(0, run.size());
+        // digits keep reading from left to right
+        size_t begin = 0;
+        while (begin < run.size())
+        {
+            if (!(_shapedFlags[run[begin]] & TextShaper::NUMBER))
+            {
+                ++begin;
+                continue;
+            }
+            auto end = begin;
+            while (end < run.size() && (_shapedFlags[run[end]] & (TextShaper::NUMBER | TextShaper::MARK)))
+                ++end;
+            reverse(begin, end);
+            begin = end;
+        }
+        run.clear();
+    };
+
+    for (int index = firstLetter; index < letterCount; ++index)
+    {
+        if (!(_shapedFlags[index] & TextShaper::RIGHT_TO_LEFT))
+        {
+            flush();
+            continue;
+        }
+        auto& info = _lettersInfo[index];
+        if (!info.valid)
+            continue;
+        if (!run.empty() && _lettersInfo[run.back()].lineIndex != info.lineIndex)
+            flush();
+        run.push_back(index);
+    }
+    flush();
+}
+
 bool Label::multilineTextWrapByWord()
 {
     return multilineTextWrap(CC_CALLBACK_3(Label::getFirstWordLen, this));
@@ -425,6 +566,20 @@ void Label::recordLetterInfo(const cocos2d::Vec2& point, char32_t utf32Char, int
     _lettersInfo[letterIndex].atlasIndex = -1;
 }
 
+void Label::recordLineCheckpoint(int letterIndex, int lastReadIndex, float nextTokenY, float nextWhitespaceWidth,
+                                 float highestY, float lowestY, bool nextChangeSize)
+{
+    LineCheckpoint checkpoint;
+    checkpoint.letterIndex = letterIndex;
+    checkpoint.lastReadIndex = lastReadIndex;
+    checkpoint.nextTokenY = nextTokenY;
+    checkpoint.nextWhitespaceWidth = nextWhitespaceWidth;
+    checkpoint.highestY = highestY;
+    checkpoint.lowestY = lowestY;
+    checkpoint.nextChangeSize = nextChangeSize;
+    _lineCheckpoints.push_back(checkpoint);
+}
+
 void Label::recordPlaceholderInfo(int letterIndex, char32_t utf32Char)
 {
     if (static_cast<std::size_t>(letterIndex) >= _lettersInfo.size())
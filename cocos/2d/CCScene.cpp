@@ -35,6 +35,7 @@ THE SOFTWARE.
 #include "renderer/CCRenderer.h"
 #include "renderer/CCFrameBuffer.h"
 #include "platform/CCDataManager.h"
+#include "3d/CCSceneBVH.h"
 
 #if CC_USE_PHYSICS
 #include "physics/CCPhysicsWorld.h"
@@ -68,6 +69,7 @@ Scene::Scene()
     setAnchorPoint(Vec2(0.5f, 0.5f));
     
     _cameraOrderDirty = true;
+    _sceneBVH = nullptr;
     
     //create default camera
     _defaultCamera = Camera::create();
@@ -103,6 +105,7 @@ Scene::~Scene()
 #endif
     Director::getInstance()->getEventDispatcher()->removeEventListener(_event);
     CC_SAFE_RELEASE(_event);
+    CC_SAFE_DELETE(_sceneBVH);
     
 #if CC_USE_PHYSICS
     delete _physicsWorld;
@@ -189,6 +192,13 @@ static bool camera_cmp(const Camera* a, const Camera* b)
     return a->getRenderOrder() < b->getRenderOrder();
 }
 
+SceneBVH* Scene::getSceneBVH()
+{
+    if (!_sceneBVH)
+        _sceneBVH = new (std::nothrow) SceneBVH();
+    return _sceneBVH;
+}
+
 const std::vector<Camera*>& Scene::getCameras()
 {
     if (_cameraOrderDirty)
@@ -237,6 +247,10 @@ void Scene::render(Renderer* renderer, const Mat4* eyeTransforms, const Mat4* ey
             director->loadProjectionMatrix(Camera::_visitingCamera->getViewProjectionMatrix(), i);
         }
 
+        // the 3D nodes are culled against this camera when the first of them is drawn
+        if (_sceneBVH)
+            _sceneBVH->beginCamera(camera);
+
         camera->apply();
         //clear background with max depth
         camera->clearBackground();
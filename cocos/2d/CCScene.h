@@ -36,6 +36,7 @@ NS_CC_BEGIN
 
 class Camera;
 class BaseLight;
+class SceneBVH;
 class Renderer;
 class EventListenerCustom;
 class EventCustom;
@@ -106,6 +107,15 @@ public:
      */
     const std::vector<BaseLight*>& getLights() const { return _lights; }
 
+    /** Get the bounding volume hierarchy of the 3D nodes of the scene, created the first time it is asked for.
+     * Sprite3D adds itself to it to be culled, and it can pick them with a ray.
+     * @return The bounding volume hierarchy of the scene.
+     * @since v3.18
+     * @js NA
+     * @lua NA
+     */
+    SceneBVH* getSceneBVH();
+
     /** Render the scene.
      * @param renderer The renderer use to render the scene.
      * @param eyeTransform The AdditionalTransform of camera.
@@ -160,6 +170,7 @@ protected:
     EventListenerCustom*       _event;
 
     std::vector<BaseLight *> _lights;
+    SceneBVH*                _sceneBVH;
     
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(Scene);
@@ -0,0 +1,160 @@
+/****************************************************************************
+ Copyright (c) 2013-2017 Chukong Technologies
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+ 
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "2d/CCSkylinePacker.h"
+#include <climits>
+
+NS_CC_BEGIN
+
+SkylinePacker::SkylinePacker(int width, int height)
+{
+    reset(width, height);
+}
+
+void SkylinePacker::reset(int width, int height)
+{
+    _width = width;
+    _height = height;
+    _usedArea = 0;
+    _skyline.clear();
+    if (width > 0)
+    {
+        _skyline.push_back({ 0, 0, width });
+    }
+}
+
+float SkylinePacker::getOccupancy() const
+{
+    if (_width <= 0 || _height <= 0)
+        return 0.0f;
+    return static_cast<float>(_usedArea) / (static_cast<float>(_width) * _height);
+}
+
+int SkylinePacker::fit(size_t index, int width, int height) const
+{
+    int x = _skyline[index].x;
+    if (x + width > _width)
+        return -1;
+
+    int y = _skyline[index].y;
+    int widthLeft = width;
+    while (widthLeft > 0 && index < _skyline.size())
+    {
+        if (_skyline[index].y > y)
+            y = _skyline[index].y;
+        if (y + height > _height)
+            return -1;
+        widthLeft -= _skyline[index].width;
+        ++index;
+    }
+    return y;
+}
+
+bool SkylinePacker::findPosition(int width, int height, size_t* bestIndex, int* bestX, int* bestY) const
+{
+    if (width <= 0 || height <= 0)
+        return false;
+
+    int bestBottom = INT_MAX;
+    int bestWidth = INT_MAX;
+    bool found = false;
+    for (size_t i = 0; i < _skyline.size(); ++i)
+    {
+        int y = fit(i, width, height);
+        if (y < 0)
+            continue;
+
+        // bottom-left: lowest resulting edge first, narrowest segment to break ties
+        int bottom = y + height;
+        if (bottom < bestBottom || (bottom == bestBottom && _skyline[i].width < bestWidth))
+        {
+            bestBottom = bottom;
+            bestWidth = _skyline[i].width;
+            *bestIndex = i;
+            *bestX = _skyline[i].x;
+            *bestY = y;
+            found = true;
+        }
+    }
+    return found;
+}
+
+bool SkylinePacker::canFit(int width, int height) const
+{
+    size_t index;
+    int x, y;
+    return findPosition(width, height, &index, &x, &y);
+}
+
+bool SkylinePacker::insert(int width, int height, int* x, int* y)
+{
+    size_t index;
+    int bestX, bestY;
+    if (!findPosition(width, height, &index, &bestX, &bestY))
+        return false;
+
+    addSegment(index, bestX, bestY, width, height);
+    _usedArea += width * height;
+    *x = bestX;
+    *y = bestY;
+    return true;
+}
+
+void SkylinePacker::addSegment(size_t index, int x, int y, int width, int height)
+{
+    _skyline.insert(_skyline.begin() + index, { x, y + height, width });
+
+    // trim the segments now covered by the new one
+    for (size_t i = index + 1; i < _skyline.size(); )
+    {
+        const Segment& previous = _skyline[i - 1];
+        int previousRight = previous.x + previous.width;
+        if (_skyline[i].x >= previousRight)
+            break;
+
+        int shrink = previousRight - _skyline[i].x;
+        _skyline[i].x += shrink;
+        _skyline[i].width -= shrink;
+        if (_skyline[i].width > 0)
+            break;
+        _skyline.erase(_skyline.begin() + i);
+    }
+
+    // merge neighbours at the same height
+    for (size_t i = 0; i + 1 < _skyline.size(); )
+    {
+        if (_skyline[i].y == _skyline[i + 1].y)
+        {
+            _skyline[i].width += _skyline[i + 1].width;
+            _skyline.erase(_skyline.begin() + i + 1);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+}
+
+NS_CC_END
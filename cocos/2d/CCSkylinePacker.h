@@ -0,0 +1,101 @@
+/****************************************************************************
+ Copyright (c) 2013-2017 Chukong Technologies
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+ 
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __2D_CCSKYLINE_PACKER_H__
+#define __2D_CCSKYLINE_PACKER_H__
+
+#include <vector>
+#include "platform/CCPlatformMacros.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup _2d
+ * @{
+ */
+
+/** @class SkylinePacker
+ * @brief Packs rectangles into a fixed size bin using the skyline bottom-left heuristic.
+ *
+ * The packer only tracks the upper outline of the placed rectangles, so inserting is
+ * O(segments) and the memory cost is tiny. Space below the skyline can't be reused;
+ * call reset() to start over.
+ * @since v3.18
+ */
+class CC_DLL SkylinePacker
+{
+public:
+    SkylinePacker(int width = 0, int height = 0);
+
+    /** Clears every placed rectangle and resizes the bin. */
+    void reset(int width, int height);
+
+    /** Finds a place for a width x height rectangle.
+     *
+     * @param width Width of the rectangle.
+     * @param height Height of the rectangle.
+     * @param x Receives the left edge of the placed rectangle.
+     * @param y Receives the top edge of the placed rectangle.
+     * @return False if the rectangle doesn't fit anywhere.
+     */
+    bool insert(int width, int height, int* x, int* y);
+
+    /** Whether a width x height rectangle would fit, without placing it. */
+    bool canFit(int width, int height) const;
+
+    int getWidth() const { return _width; }
+    int getHeight() const { return _height; }
+
+    /** Sum of the areas of the placed rectangles. */
+    int getUsedArea() const { return _usedArea; }
+
+    /** Used area divided by the bin area. */
+    float getOccupancy() const;
+
+protected:
+    struct Segment
+    {
+        int x;
+        int y;
+        int width;
+    };
+
+    // returns the y a rectangle starting at segment index would sit at, or -1 if it doesn't fit
+    int fit(size_t index, int width, int height) const;
+    bool findPosition(int width, int height, size_t* bestIndex, int* bestX, int* bestY) const;
+    void addSegment(size_t index, int x, int y, int width, int height);
+
+    std::vector<Segment> _skyline;
+    int _width;
+    int _height;
+    int _usedArea;
+};
+
+// end of _2d group
+/// @}
+
+NS_CC_END
+
+#endif //__2D_CCSKYLINE_PACKER_H__
@@ -34,6 +34,7 @@ THE SOFTWARE.
 #include "2d/CCAnimationCache.h"
 #include "2d/CCSpriteFrame.h"
 #include "2d/CCSpriteFrameCache.h"
+#include "2d/CCDynamicAtlasCache.h"
 #include "renderer/CCTextureCache.h"
 #include "renderer/CCTexture2D.h"
 #include "renderer/CCRenderer.h"
@@ -176,6 +177,16 @@ bool Sprite::initWithFile(const std::string& filename)
     _fileName = filename;
     _fileType = 0;
 
+    auto atlasCache = DynamicAtlasCache::getInstance();
+    if (atlasCache->isEnabled())
+    {
+        SpriteFrame* frame = atlasCache->getSpriteFrame(filename);
+        if (frame)
+        {
+            return initWithSpriteFrame(frame);
+        }
+    }
+
     Texture2D *texture = _director->getTextureCache()->addImage(filename);
     if (texture)
     {
@@ -1355,6 +1366,10 @@ void Sprite::setVisible(bool bVisible)
 
 void Sprite::setContentSize(const Size& size)
 {
+    // the vertices only depend on the size, the rect and the center rect, which rebuild them on their own
+    if (size.equals(_contentSize))
+        return;
+
     if (_renderMode == RenderMode::QUAD_BATCHNODE || _renderMode == RenderMode::POLYGON)
         CCLOGWARN("Sprite::setContentSize() doesn't stretch the sprite when using QUAD_BATCHNODE or POLYGON render modes");
 
@@ -0,0 +1,582 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "2d/CCTextShaper.h"
+
+#include <algorithm>
+#include <list>
+#include <unordered_map>
+#include "2d/CCFontFreeType.h"
+
+NS_CC_BEGIN
+
+namespace
+{
+    enum Script
+    {
+        SCRIPT_NONE,
+        SCRIPT_HEBREW,
+        SCRIPT_ARABIC,
+        SCRIPT_DEVANAGARI,
+        SCRIPT_THAI,
+    };
+
+    Script getScript(char32_t c)
+    {
+        if (c < 0x0590)
+            return SCRIPT_NONE;
+        if (c <= 0x05FF)
+            return SCRIPT_HEBREW;
+        if (c <= 0x06FF || (c >= 0x0750 && c <= 0x077F))
+            return SCRIPT_ARABIC;
+        if (c >= 0x0900 && c <= 0x097F)
+            return SCRIPT_DEVANAGARI;
+        if (c >= 0x0E00 && c <= 0x0E7F)
+            return SCRIPT_THAI;
+        return SCRIPT_NONE;
+    }
+
+    bool isMark(char32_t c)
+    {
+        switch (getScript(c))
+        {
+        case SCRIPT_HEBREW:
+            return (c >= 0x0591 && c <= 0x05BD) || c == 0x05BF || c == 0x05C1 || c == 0x05C2
+                || c == 0x05C4 || c == 0x05C5 || c == 0x05C7;
+        case SCRIPT_ARABIC:
+            return (c >= 0x0610 && c <= 0x061A) || (c >= 0x064B && c <= 0x065F) || c == 0x0670
+                || (c >= 0x06D6 && c <= 0x06DC) || (c >= 0x06DF && c <= 0x06E4) || c == 0x06E7 || c == 0x06E8
+                || (c >= 0x06EA && c <= 0x06ED);
+        case SCRIPT_DEVANAGARI:
+            return (c >= 0x0900 && c <= 0x0902) || c == 0x093A || c == 0x093C || (c >= 0x0941 && c <= 0x0948)
+                || c == 0x094D || (c >= 0x0951 && c <= 0x0957) || c == 0x0962 || c == 0x0963;
+        case SCRIPT_THAI:
+            return c == 0x0E31 || (c >= 0x0E34 && c <= 0x0E3A) || (c >= 0x0E47 && c <= 0x0E4E);
+        default:
+            return false;
+        }
+    }
+
+    bool isNumber(char32_t c)
+    {
+        return (c >= '0' && c <= '9') || (c >= 0x0660 && c <= 0x0669) || (c >= 0x06F0 && c <= 0x06F9);
+    }
+
+    bool isRightToLeft(char32_t c)
+    {
+        if (c < 0x0590)
+            return false;
+        if (c <= 0x05FF)
+            return c == 0x05BE || c == 0x05C0 || c == 0x05C3 || c == 0x05C6 || (c >= 0x05D0 && c <= 0x05F4);
+        if (c <= 0x06FF || (c >= 0x0750 && c <= 0x077F))
+            return !isMark(c) && !isNumber(c);
+        return (c >= 0xFB1D && c <= 0xFDFF) || (c >= 0xFE70 && c <= 0xFEFC);
+    }
+
+    // Characters that take the direction of their surroundings
+    bool isNeutral(char32_t c)
+    {
+        if (c < 0x80)
+            return !((c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z'));
+        return (c >= 0x00A0 && c <= 0x00BF) || (c >= 0x2000 && c <= 0x206F) || c == 0x3000;
+    }
+
+    // Arabic letters and their presentation forms, 0 where a form doesn't exist
+    struct ArabicForms
+    {
+        char32_t letter;
+        char32_t isolated;
+        char32_t final;
+        char32_t initial;
+        char32_t medial;
+    };
+
+    const ArabicForms kArabicForms[] = {
+        { 0x0621, 0xFE80, 0, 0, 0 },
+        { 0x0622, 0xFE81, 0xFE82, 0, 0 },
+        { 0x0623, 0xFE83, 0xFE84, 0, 0 },
+        { 0x0624, 0xFE85, 0xFE86, 0, 0 },
+        { 0x0625, 0xFE87, 0xFE88, 0, 0 },
+        { 0x0626, 0xFE89, 0xFE8A, 0xFE8B, 0xFE8C },
+        { 0x0627, 0xFE8D, 0xFE8E, 0, 0 },
+        { 0x0628, 0xFE8F, 0xFE90, 0xFE91, 0xFE92 },
+        { 0x0629, 0xFE93, 0xFE94, 0, 0 },
+        { 0x062A, 0xFE95, 0xFE96, 0xFE97, 0xFE98 },
+        { 0x062B, 0xFE99, 0xFE9A, 0xFE9B, 0xFE9C },
+        { 0x062C, 0xFE9D, 0xFE9E, 0xFE9F, 0xFEA0 },
+        { 0x062D, 0xFEA1, 0xFEA2, 0xFEA3, 0xFEA4 },
+        { 0x062E, 0xFEA5, 0xFEA6, 0xFEA7, 0xFEA8 },
+        { 0x062F, 0xFEA9, 0xFEAA, 0, 0 },
+        { 0x0630, 0xFEAB, 0xFEAC, 0, 0 },
+        { 0x0631, 0xFEAD, 0xFEAE, 0, 0 },
+        { 0x0632, 0xFEAF, 0xFEB0, 0, 0 },
+        { 0x0633, 0xFEB1, 0xFEB2, 0xFEB3, 0xFEB4 },
+        { 0x0634, 0xFEB5, 0xFEB6, 0xFEB7, 0xFEB8 },
+        { 0x0635, 0xFEB9, 0xFEBA, 0xFEBB, 0xFEBC },
+        { 0x0636, 0xFEBD, 0xFEBE, 0xFEBF, 0xFEC0 },
+        { 0x0637, 0xFEC1, 0xFEC2, 0xFEC3, 0xFEC4 },
+        { 0x0638, 0xFEC5, 0xFEC6, 0xFEC7, 0xFEC8 },
+        { 0x0639, 0xFEC9, 0xFECA, 0xFECB, 0xFECC },
+        { 0x063A, 0xFECD, 0xFECE, 0xFECF, 0xFED0 },
+        { 0x0641, 0xFED1, 0xFED2, 0xFED3, 0xFED4 },
+        { 0x0642, 0xFED5, 0xFED6, 0xFED7, 0xFED8 },
+        { 0x0643, 0xFED9, 0xFEDA, 0xFEDB, 0xFEDC },
+        { 0x0644, 0xFEDD, 0xFEDE, 0xFEDF, 0xFEE0 },
+        { 0x0645, 0xFEE1, 0xFEE2, 0xFEE3, 0xFEE4 },
+        { 0x0646, 0xFEE5, 0xFEE6, 0xFEE7, 0xFEE8 },
+        { 0x0647, 0xFEE9, 0xFEEA, 0xFEEB, 0xFEEC },
+        { 0x0648, 0xFEED, 0xFEEE, 0, 0 },
+        { 0x0649, 0xFEEF, 0xFEF0, 0, 0 },
+        { 0x064A, 0xFEF1, 0xFEF2, 0xFEF3, 0xFEF4 },
+        { 0x067E, 0xFB56, 0xFB57, 0xFB58, 0xFB59 },
+        { 0x0686, 0xFB7A, 0xFB7B, 0xFB7C, 0xFB7D },
+        { 0x0698, 0xFB8A, 0xFB8B, 0, 0 },
+        { 0x06A9, 0xFB8E, 0xFB8F, 0xFB90, 0xFB91 },
+        { 0x06AF, 0xFB92, 0xFB93, 0xFB94, 0xFB95 },
+        { 0x06CC, 0xFBFC, 0xFBFD, 0xFBFE, 0xFBFF },
+    };
+
+    const char32_t kArabicLam = 0x0644;
+    const char32_t kArabicTatweel = 0x0640;
+
+    const ArabicForms* findArabicForms(char32_t c)
+    {
+        auto end = kArabicForms + sizeof(kArabicForms) / sizeof(kArabicForms[0]);
+        auto it = std::lower_bound(kArabicForms, end, c, [](const ArabicForms& forms, char32_t letter) {
+            return forms.letter < letter;
+        });
+        return (it != end && it->letter == c) ? it : nullptr;
+    }
+
+    // isolated and final form of lam followed by an alef, indexed by the alef
+    bool getLamAlefLigature(char32_t alef, char32_t& isolated, char32_t& final)
+    {
+        switch (alef)
+        {
+        case 0x0622: isolated = 0xFEF5; final = 0xFEF6; return true;
+        case 0x0623: isolated = 0xFEF7; final = 0xFEF8; return true;
+        case 0x0625: isolated = 0xFEF9; final = 0xFEFA; return true;
+        case 0x0627: isolated = 0xFEFB; final = 0xFEFC; return true;
+        default: return false;
+        }
+    }
+
+    enum Joining
+    {
+        JOINING_NONE,   // doesn't join, breaks the joining of its neighbours
+        JOINING_RIGHT,  // joins the previous letter only
+        JOINING_DUAL,   // joins both sides
+        JOINING_CAUSING // tatweel, joins both sides without changing its own shape
+    };
+
+    Joining getJoining(char32_t c)
+    {
+        if (c == kArabicTatweel)
+            return JOINING_CAUSING;
+        auto forms = findArabicForms(c);
+        if (forms == nullptr || forms->final == 0)
+            return JOINING_NONE;
+        return forms->initial ? JOINING_DUAL : JOINING_RIGHT;
+    }
+
+    bool hasGlyph(const FontFreeType* font, char32_t c)
+    {
+        return c != 0 && font && font->hasGlyph(c);
+    }
+
+    void shapeArabic(const Font* font, const std::u32string& run, std::u32string& glyphs, std::vector<unsigned char>& flags)
+    {
+        // fonts without the presentation forms show the letters unjoined
+        auto fontFreeType = dynamic_cast<const FontFreeType*>(font);
+        int length = static_cast<int>(run.length());
+
+        std::vector<Joining> joinings(length);
+        for (int index = 0; index < length; ++index)
+        {
+            joinings[index] = getJoining(run[index]);
+        }
+
+        int previous = -1;
+        for (int index = 0; index < length; ++index)
+        {
+            if (flags[index] & TextShaper::MARK)
+            {
+                continue;
+            }
+
+            // marks are transparent to joining
+            int next = index + 1;
+            while (next < length && (flags[next] & TextShaper::MARK))
+            {
+                ++next;
+            }
+
+            auto joining = joinings[index];
+            bool joinsPrevious = joining != JOINING_NONE && previous >= 0
+                && (joinings[previous] == JOINING_DUAL || joinings[previous] == JOINING_CAUSING);
+            bool joinsNext = (joining == JOINING_DUAL || joining == JOINING_CAUSING) && next < length
+                && joinings[next] != JOINING_NONE;
+
+            char32_t isolated, final;
+            if (run[index] == kArabicLam && next < length && getLamAlefLigature(run[next], isolated, final))
+            {
+                auto ligature = joinsPrevious ? final : isolated;
+                if (hasGlyph(fontFreeType, ligature))
+                {
+                    glyphs[index] = ligature;
+                    flags[next] |= TextShaper::HIDDEN;
+                    // the ligature ends like an alef, which doesn't join the next letter
+                    joinings[next] = JOINING_RIGHT;
+                    previous = next;
+                    index = next;
+                    continue;
+                }
+            }
+
+            auto forms = findArabicForms(run[index]);
+            if (forms)
+            {
+                char32_t form = forms->isolated;
+                if (joinsPrevious && joinsNext)
+                    form = forms->medial;
+                else if (joinsPrevious)
+                    form = forms->final;
+                else if (joinsNext)
+                    form = forms->initial;
+
+                if (hasGlyph(fontFreeType, form))
+                {
+                    glyphs[index] = form;
+                }
+            }
+            previous = index;
+        }
+    }
+
+    bool isDevanagariConsonant(char32_t c)
+    {
+        return (c >= 0x0915 && c <= 0x0939) || (c >= 0x0958 && c <= 0x095F);
+    }
+
+    void shapeDevanagari(const std::u32string& run, std::u32string& glyphs, std::vector<unsigned char>& flags)
+    {
+        const char32_t kVowelSignI = 0x093F;
+        const char32_t kVirama = 0x094D;
+        const char32_t kNukta = 0x093C;
+
+        for (int index = 1; index < static_cast<int>(run.length()); ++index)
+        {
+            if (run[index] != kVowelSignI)
+            {
+                continue;
+            }
+
+            // the vowel sign i is written before the cluster C(N)(virama C(N))*
+            int start = index - 1;
+            if (start >= 0 && run[start] == kNukta)
+                --start;
+            if (start < 0 || !isDevanagariConsonant(run[start]))
+                continue;
+            while (start >= 2 && run[start - 1] == kVirama)
+            {
+                int consonant = start - 2;
+                if (consonant >= 1 && run[consonant] == kNukta)
+                    --consonant;
+                if (!isDevanagariConsonant(run[consonant]))
+                    break;
+                start = consonant;
+            }
+
+            for (int move = index; move > start; --move)
+            {
+                glyphs[move] = glyphs[move - 1];
+                flags[move] = flags[move - 1];
+            }
+            glyphs[start] = kVowelSignI;
+            flags[start] = 0;
+        }
+    }
+
+    // Shapes one run of a single script, marks are already flagged
+    void shapeRun(const Font* font, Script script, const std::u32string& run, std::u32string& glyphs, std::vector<unsigned char>& flags)
+    {
+        switch (script)
+        {
+        case SCRIPT_ARABIC:
+            shapeArabic(font, run, glyphs, flags);
+            break;
+        case SCRIPT_DEVANAGARI:
+            shapeDevanagari(run, glyphs, flags);
+            break;
+        default:
+            break;
+        }
+    }
+
+    struct RunKey
+    {
+        const Font* font;
+        std::u32string text;
+
+        bool operator==(const RunKey& other) const
+        {
+            return font == other.font && text == other.text;
+        }
+    };
+
+    struct RunKeyHash
+    {
+        size_t operator()(const RunKey& key) const
+        {
+            return std::hash<std::u32string>()(key.text) ^ (std::hash<const void*>()(key.font) << 1);
+        }
+    };
+
+    struct ShapedRun
+    {
+        RunKey key;
+        std::u32string glyphs;
+        std::vector<unsigned char> flags;
+    };
+
+    // most recently used first
+    std::list<ShapedRun> s_shapedRuns;
+    std::unordered_map<RunKey, std::list<ShapedRun>::iterator, RunKeyHash> s_shapedRunIndex;
+    size_t s_cacheCapacity = 1024;
+    size_t s_cacheHits = 0;
+    size_t s_cacheMisses = 0;
+
+    void shapeRunCached(const Font* font, Script script, const std::u32string& text, size_t start, size_t length,
+                        std::u32string& glyphs, std::vector<unsigned char>& flags)
+    {
+        RunKey key = { font, text.substr(start, length) };
+        if (s_cacheCapacity > 0)
+        {
+            auto found = s_shapedRunIndex.find(key);
+            if (found != s_shapedRunIndex.end())
+            {
+                ++s_cacheHits;
+                s_shapedRuns.splice(s_shapedRuns.begin(), s_shapedRuns, found->second);
+                std::copy(found->second->glyphs.begin(), found->second->glyphs.end(), glyphs.begin() + start);
+                std::copy(found->second->flags.begin(), found->second->flags.end(), flags.begin() + start);
+                return;
+            }
+        }
+        ++s_cacheMisses;
+
+        std::u32string runGlyphs = key.text;
+        std::vector<unsigned char> runFlags(flags.begin() + start, flags.begin() + start + length);
+        shapeRun(font, script, key.text, runGlyphs, runFlags);
+        std::copy(runGlyphs.begin(), runGlyphs.end(), glyphs.begin() + start);
+        std::copy(runFlags.begin(), runFlags.end(), flags.begin() + start);
+
+        if (s_cacheCapacity > 0)
+        {
+            if (s_shapedRuns.size() >= s_cacheCapacity)
+            {
+                s_shapedRunIndex.erase(s_shapedRuns.back().key);
+                s_shapedRuns.pop_back();
+            }
+            ShapedRun shaped = { key, std::move(runGlyphs), std::move(runFlags) };
+            s_shapedRuns.push_front(std::move(shaped));
+            s_shapedRunIndex.emplace(std::move(key), s_shapedRuns.begin());
+        }
+    }
+
+    // Flags the letters to be laid out from right to left. The paragraph direction stays left
+    // to right: runs of right-to-left letters, with the spaces and digits between them, are
+    // mirrored within their line, and digits keep their own order inside such a run.
+    void resolveDirections(const std::u32string& text, std::vector<unsigned char>& flags)
+    {
+        int length = static_cast<int>(text.length());
+        // whether the closest strong letter before the current one is right-to-left
+        bool previousRightToLeft = false;
+        int index = 0;
+        while (index < length)
+        {
+            auto c = text[index];
+            if (c == '\n')
+            {
+                previousRightToLeft = false;
+                ++index;
+                continue;
+            }
+
+            if (flags[index] & TextShaper::MARK)
+            {
+                // marks follow the letter they belong to
+                if (index > 0 && (flags[index - 1] & TextShaper::RIGHT_TO_LEFT))
+                    flags[index] |= TextShaper::RIGHT_TO_LEFT;
+                ++index;
+                continue;
+            }
+
+            if (isRightToLeft(c))
+            {
+                flags[index] |= TextShaper::RIGHT_TO_LEFT;
+                previousRightToLeft = true;
+                ++index;
+                continue;
+            }
+
+            if (!isNeutral(c) && !isNumber(c))
+            {
+                previousRightToLeft = false;
+                ++index;
+                continue;
+            }
+
+            // neutrals and digits up to the next strong letter join a right-to-left run if
+            // they are surrounded by one
+            int end = index;
+            while (end < length && text[end] != '\n' && !(flags[end] & TextShaper::MARK)
+                   && (isNeutral(text[end]) || isNumber(text[end])))
+            {
+                ++end;
+            }
+            bool nextRightToLeft = end < length && isRightToLeft(text[end]);
+            bool hasNumber = false;
+            for (int tmp = index; tmp < end; ++tmp)
+            {
+                hasNumber = hasNumber || isNumber(text[tmp]);
+            }
+            bool nextEndsRun = end >= length || text[end] == '\n';
+            if (previousRightToLeft && (nextRightToLeft || (hasNumber && nextEndsRun)))
+            {
+                for (int tmp = index; tmp < end; ++tmp)
+                {
+                    flags[tmp] |= TextShaper::RIGHT_TO_LEFT;
+                    if (isNumber(text[tmp]))
+                        flags[tmp] |= TextShaper::NUMBER;
+                }
+                // trailing neutrals after the last digit of the line stay left-to-right
+                if (!nextRightToLeft)
+                {
+                    for (int tmp = end - 1; tmp >= index && !isNumber(text[tmp]); --tmp)
+                        flags[tmp] &= ~TextShaper::RIGHT_TO_LEFT;
+                }
+            }
+            index = end;
+        }
+    }
+}
+
+bool TextShaper::needsShaping(const std::u32string& text)
+{
+    for (auto c : text)
+    {
+        if ((c >= 0x0590 && c <= 0x0E7F) || (c >= 0xFB1D && c <= 0xFEFC))
+            return true;
+    }
+    return false;
+}
+
+void TextShaper::shape(const Font* font, const std::u32string& text, std::u32string& glyphs, std::vector<unsigned char>& flags)
+{
+    glyphs = text;
+    flags.assign(text.length(), 0);
+
+    size_t length = text.length();
+    size_t index = 0;
+    while (index < length)
+    {
+        auto script = getScript(text[index]);
+        if (script == SCRIPT_NONE)
+        {
+            ++index;
+            continue;
+        }
+
+        // a run is a word of one script, joining never crosses a space
+        size_t end = index;
+        while (end < length && getScript(text[end]) == script)
+        {
+            if (isMark(text[end]))
+                flags[end] = MARK;
+            ++end;
+        }
+        // a mark can't start a run, it stays where the font puts it
+        if (flags[index] & MARK)
+            flags[index] = 0;
+
+        if (script == SCRIPT_ARABIC || script == SCRIPT_DEVANAGARI)
+        {
+            shapeRunCached(font, script, text, index, end - index, glyphs, flags);
+        }
+        index = end;
+    }
+
+    resolveDirections(text, flags);
+}
+
+void TextShaper::setCacheCapacity(size_t capacity)
+{
+    s_cacheCapacity = capacity;
+    while (s_shapedRuns.size() > s_cacheCapacity)
+    {
+        s_shapedRunIndex.erase(s_shapedRuns.back().key);
+        s_shapedRuns.pop_back();
+    }
+}
+
+size_t TextShaper::getCacheCapacity()
+{
+    return s_cacheCapacity;
+}
+
+void TextShaper::removeFont(const Font* font)
+{
+    for (auto it = s_shapedRuns.begin(); it != s_shapedRuns.end();)
+    {
+        if (it->key.font == font)
+        {
+            s_shapedRunIndex.erase(it->key);
+            it = s_shapedRuns.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void TextShaper::clearCache()
+{
+    s_shapedRunIndex.clear();
+    s_shapedRuns.clear();
+    s_cacheHits = 0;
+    s_cacheMisses = 0;
+}
+
+size_t TextShaper::getCacheHits()
+{
+    return s_cacheHits;
+}
+
+size_t TextShaper::getCacheMisses()
+{
+    return s_cacheMisses;
+}
+
+NS_CC_END
@@ -0,0 +1,106 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __2D_CCTEXT_SHAPER_H__
+#define __2D_CCTEXT_SHAPER_H__
+
+#include <string>
+#include <vector>
+#include "platform/CCPlatformMacros.h"
+
+NS_CC_BEGIN
+
+class Font;
+
+/**
+ * @addtogroup _2d
+ * @{
+ */
+
+/** @class TextShaper
+ * @brief Turns the characters of a Label into the glyphs to draw for complex scripts.
+ *
+ * Label lays out one glyph per character. The shaper keeps that one to one mapping and
+ * changes what is drawn for each character:
+ * - Arabic letters take their isolated, initial, medial or final presentation form, and
+ *   lam followed by alef becomes one ligature.
+ * - The Devanagari vowel sign i moves in front of the consonant cluster it follows.
+ * - Combining marks of Arabic, Hebrew, Devanagari and Thai don't advance the pen and are
+ *   centered on the glyph they belong to.
+ * - Right-to-left runs are flagged so the layout can mirror them within their line.
+ *
+ * Font tables such as GSUB and GPOS aren't read, so conjuncts and stacked marks stay
+ * approximate. Text without any of these scripts is left alone and costs one scan.
+ *
+ * The shaped form of every script run is kept in an LRU cache keyed by font and run, so
+ * labels that show the same words again skip shaping. Use it from the main thread only.
+ * @since v3.18
+ */
+class CC_DLL TextShaper
+{
+public:
+    /** Per character results of shape(). */
+    enum Flag
+    {
+        /** Combining mark, drawn over the previous glyph without advancing. */
+        MARK = 0x01,
+        /** Part of a ligature drawn by a previous character, nothing is drawn. */
+        HIDDEN = 0x02,
+        /** Laid out from right to left. */
+        RIGHT_TO_LEFT = 0x04,
+        /** Digits inside a right-to-left run, which keep their left-to-right order. */
+        NUMBER = 0x08,
+    };
+
+    /** Whether the text has characters of a script that needs shaping. */
+    static bool needsShaping(const std::u32string& text);
+
+    /** Shapes a text.
+     *
+     * @param font The font the glyphs are drawn with. Presentation forms it lacks aren't used.
+     * @param text Characters in logical order.
+     * @param glyphs Receives one glyph per character.
+     * @param flags Receives the Flag bits of every character.
+     */
+    static void shape(const Font* font, const std::u32string& text, std::u32string& glyphs, std::vector<unsigned char>& flags);
+
+    /** Sets how many shaped runs are cached, 0 disables the cache. The default is 1024. */
+    static void setCacheCapacity(size_t capacity);
+    static size_t getCacheCapacity();
+
+    /** Forgets the runs shaped for a font, called when the font is released. */
+    static void removeFont(const Font* font);
+    static void clearCache();
+
+    /** Number of runs found in the cache and number of runs shaped since the last clearCache(). */
+    static size_t getCacheHits();
+    static size_t getCacheMisses();
+};
+
+// end of _2d group
+/// @}
+
+NS_CC_END
+
+#endif // __2D_CCTEXT_SHAPER_H__
@@ -9,8 +9,10 @@ LOCAL_MODULE_FILENAME := libc3d
 LOCAL_SRC_FILES := \
 CCRay.cpp \
 CCAABB.cpp \
+CCAABBTree.cpp \
 CCOBB.cpp \
 CCAnimate3D.cpp \
+CCAnimate3DScheduler.cpp \
 CCAnimation3D.cpp \
 CCAttachNode.cpp \
 CCBillBoard.cpp \
@@ -22,9 +24,13 @@ CCMeshVertexIndexData.cpp \
 CCMotionStreak3D.cpp \
 CCSprite3DMaterial.cpp \
 CCObjLoader.cpp \
+CCOcclusionBuffer.cpp \
+CCSceneBVH.cpp \
 CCSkeleton3D.cpp \
 CCSprite3D.cpp \
+CCSprite3DAsyncLoader.cpp \
 CCTerrain.cpp \
+CCTerrainPager.cpp \
 CCSkybox.cpp
 
 LOCAL_EXPORT_C_INCLUDES := $(LOCAL_PATH)/..
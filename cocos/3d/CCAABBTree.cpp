@@ -0,0 +1,665 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "3d/CCAABBTree.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#define AABB_TREE_USE_SSE
+#elif defined(__ARM_NEON__) || defined(__aarch64__)
+#include <arm_neon.h>
+#define AABB_TREE_USE_NEON
+#endif
+
+NS_CC_BEGIN
+
+namespace
+{
+    AABB combine(const AABB& a, const AABB& b)
+    {
+        return AABB(Vec3(std::min(a._min.x, b._min.x), std::min(a._min.y, b._min.y), std::min(a._min.z, b._min.z)),
+                    Vec3(std::max(a._max.x, b._max.x), std::max(a._max.y, b._max.y), std::max(a._max.z, b._max.z)));
+    }
+
+    float surfaceArea(const AABB& aabb)
+    {
+        Vec3 size = aabb._max - aabb._min;
+        return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
+    bool contains(const AABB& outer, const AABB& inner)
+    {
+        return outer._min.x <= inner._min.x && outer._min.y <= inner._min.y && outer._min.z <= inner._min.z
+            && inner._max.x <= outer._max.x && inner._max.y <= outer._max.y && inner._max.z <= outer._max.z;
+    }
+
+    bool overlaps(const AABB& a, const AABB& b)
+    {
+        return a._min.x <= b._max.x && b._min.x <= a._max.x
+            && a._min.y <= b._max.y && b._min.y <= a._max.y
+            && a._min.z <= b._max.z && b._min.z <= a._max.z;
+    }
+
+    // The frustum planes laid out for testing four of them at once. The planes after the
+    // used ones have a zero normal and a positive distance, every box is inside of them.
+    struct PackedPlanes
+    {
+        float nx[8], ny[8], nz[8], d[8];
+        float ax[8], ay[8], az[8];
+        int count;
+    };
+
+    void packPlanes(const Frustum& frustum, PackedPlanes& planes)
+    {
+        planes.count = frustum.getPlaneCount();
+        for (int i = 0; i < 8; ++i)
+        {
+            Vec3 normal = i < planes.count ? frustum.getPlane(i).getNormal() : Vec3::ZERO;
+            planes.nx[i] = normal.x;
+            planes.ny[i] = normal.y;
+            planes.nz[i] = normal.z;
+            planes.d[i] = i < planes.count ? frustum.getPlane(i).getDist() : 1.0f;
+            planes.ax[i] = std::abs(normal.x);
+            planes.ay[i] = std::abs(normal.y);
+            planes.az[i] = std::abs(normal.z);
+        }
+    }
+
+    // Sets a bit in outside for every plane the box is in front of, and in inside for every
+    // plane the box is fully behind. Only the planes in mask are meaningful.
+    inline void testPlanes(const PackedPlanes& planes, const AABB& aabb, unsigned int mask, unsigned int& outside, unsigned int& inside)
+    {
+        float cx = (aabb._min.x + aabb._max.x) * 0.5f;
+        float cy = (aabb._min.y + aabb._max.y) * 0.5f;
+        float cz = (aabb._min.z + aabb._max.z) * 0.5f;
+        float ex = (aabb._max.x - aabb._min.x) * 0.5f;
+        float ey = (aabb._max.y - aabb._min.y) * 0.5f;
+        float ez = (aabb._max.z - aabb._min.z) * 0.5f;
+
+        outside = 0;
+        inside = 0;
+#if defined(AABB_TREE_USE_SSE)
+        __m128 vcx = _mm_set1_ps(cx), vcy = _mm_set1_ps(cy), vcz = _mm_set1_ps(cz);
+        __m128 vex = _mm_set1_ps(ex), vey = _mm_set1_ps(ey), vez = _mm_set1_ps(ez);
+        for (int i = 0; i < planes.count && !(outside & mask); i += 4)
+        {
+            // the near and far planes are often all the planes left to test, or none of them
+            if (!((mask >> i) & 0xF))
+                continue;
+
+            __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(planes.nx + i), vcx), _mm_mul_ps(_mm_loadu_ps(planes.ny + i), vcy)),
+                                     _mm_sub_ps(_mm_mul_ps(_mm_loadu_ps(planes.nz + i), vcz), _mm_loadu_ps(planes.d + i)));
+            __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(planes.ax + i), vex), _mm_mul_ps(_mm_loadu_ps(planes.ay + i), vey)),
+                                       _mm_mul_ps(_mm_loadu_ps(planes.az + i), vez));
+            outside |= (unsigned int)_mm_movemask_ps(_mm_cmpgt_ps(dist, radius)) << i;
+            inside |= (unsigned int)_mm_movemask_ps(_mm_cmplt_ps(dist, _mm_sub_ps(_mm_setzero_ps(), radius))) << i;
+        }
+#elif defined(AABB_TREE_USE_NEON)
+        float32x4_t vcx = vdupq_n_f32(cx), vcy = vdupq_n_f32(cy), vcz = vdupq_n_f32(cz);
+        float32x4_t vex = vdupq_n_f32(ex), vey = vdupq_n_f32(ey), vez = vdupq_n_f32(ez);
+        const uint32x4_t bits = {1, 2, 4, 8};
+        for (int i = 0; i < planes.count && !(outside & mask); i += 4)
+        {
+            if (!((mask >> i) & 0xF))
+                continue;
+
+            float32x4_t dist = vmlaq_f32(vmlaq_f32(vmulq_f32(vld1q_f32(planes.nx + i), vcx), vld1q_f32(planes.ny + i), vcy), vld1q_f32(planes.nz + i), vcz);
+            dist = vsubq_f32(dist, vld1q_f32(planes.d + i));
+            float32x4_t radius = vmlaq_f32(vmlaq_f32(vmulq_f32(vld1q_f32(planes.ax + i), vex), vld1q_f32(planes.ay + i), vey), vld1q_f32(planes.az + i), vez);
+            uint32x4_t out = vandq_u32(vcgtq_f32(dist, radius), bits);
+            uint32x4_t in = vandq_u32(vcltq_f32(dist, vnegq_f32(radius)), bits);
+            uint32x2_t outPair = vpadd_u32(vget_low_u32(out), vget_high_u32(out));
+            uint32x2_t inPair = vpadd_u32(vget_low_u32(in), vget_high_u32(in));
+            outside |= (vget_lane_u32(outPair, 0) | vget_lane_u32(outPair, 1)) << i;
+            inside |= (vget_lane_u32(inPair, 0) | vget_lane_u32(inPair, 1)) << i;
+        }
+#else
+        for (int i = 0; i < planes.count; ++i)
+        {
+            if (!(mask & (1u << i)))
+                continue;
+
+            float dist = planes.nx[i] * cx + planes.ny[i] * cy + planes.nz[i] * cz - planes.d[i];
+            float radius = planes.ax[i] * ex + planes.ay[i] * ey + planes.az[i] * ez;
+            if (dist > radius)
+            {
+                outside |= 1u << i;
+                return;
+            }
+            if (dist < -radius)
+                inside |= 1u << i;
+        }
+#endif
+    }
+
+    // slab test against the ray, with the inverse of its direction computed once
+    bool intersectsRay(const AABB& aabb, const Vec3& origin, const Vec3& inverseDirection)
+    {
+        float t1 = (aabb._min.x - origin.x) * inverseDirection.x;
+        float t2 = (aabb._max.x - origin.x) * inverseDirection.x;
+        float tmin = std::min(t1, t2);
+        float tmax = std::max(t1, t2);
+
+        t1 = (aabb._min.y - origin.y) * inverseDirection.y;
+        t2 = (aabb._max.y - origin.y) * inverseDirection.y;
+        tmin = std::max(tmin, std::min(t1, t2));
+        tmax = std::min(tmax, std::max(t1, t2));
+
+        t1 = (aabb._min.z - origin.z) * inverseDirection.z;
+        t2 = (aabb._max.z - origin.z) * inverseDirection.z;
+        tmin = std::max(tmin, std::min(t1, t2));
+        tmax = std::min(tmax, std::max(t1, t2));
+
+        return tmax >= std::max(tmin, 0.0f);
+    }
+}
+
+AABBTree::AABBTree()
+: _root(NULL_NODE)
+, _freeList(NULL_NODE)
+, _leafCount(0)
+, _marginRatio(0.1f)
+{
+}
+
+AABBTree::~AABBTree()
+{
+}
+
+int AABBTree::allocateNode()
+{
+    if (_freeList == NULL_NODE)
+    {
+        // grow the pool and chain the new nodes into the free list
+        int oldSize = (int)_nodes.size();
+        int newSize = std::max(16, oldSize * 2);
+        _nodes.resize(newSize);
+        for (int i = oldSize; i < newSize; ++i)
+        {
+            _nodes[i].next = i + 1 < newSize ? i + 1 : NULL_NODE;
+            _nodes[i].height = -1;
+        }
+        _freeList = oldSize;
+    }
+
+    int nodeId = _freeList;
+    TreeNode& node = _nodes[nodeId];
+    _freeList = node.next;
+    node.parent = NULL_NODE;
+    node.child1 = NULL_NODE;
+    node.child2 = NULL_NODE;
+    node.height = 0;
+    node.userData = nullptr;
+    return nodeId;
+}
+
+void AABBTree::freeNode(int nodeId)
+{
+    _nodes[nodeId].next = _freeList;
+    _nodes[nodeId].height = -1;
+    _freeList = nodeId;
+}
+
+int AABBTree::createProxy(const AABB& aabb, void* userData)
+{
+    int proxyId = allocateNode();
+
+    Vec3 margin = (aabb._max - aabb._min) * _marginRatio;
+    _nodes[proxyId].aabb.set(aabb._min - margin, aabb._max + margin);
+    _nodes[proxyId].userData = userData;
+
+    insertLeaf(proxyId);
+    ++_leafCount;
+    return proxyId;
+}
+
+void AABBTree::destroyProxy(int proxyId)
+{
+    CCASSERT(proxyId >= 0 && proxyId < (int)_nodes.size() && _nodes[proxyId].isLeaf(), "invalid proxy id");
+
+    removeLeaf(proxyId);
+    freeNode(proxyId);
+    --_leafCount;
+}
+
+bool AABBTree::moveProxy(int proxyId, const AABB& aabb)
+{
+    CCASSERT(proxyId >= 0 && proxyId < (int)_nodes.size() && _nodes[proxyId].isLeaf(), "invalid proxy id");
+
+    if (contains(_nodes[proxyId].aabb, aabb))
+        return false;
+
+    removeLeaf(proxyId);
+
+    Vec3 margin = (aabb._max - aabb._min) * _marginRatio;
+    _nodes[proxyId].aabb.set(aabb._min - margin, aabb._max + margin);
+
+    insertLeaf(proxyId);
+    return true;
+}
+
+void AABBTree::insertLeaf(int leaf)
+{
+    if (_root == NULL_NODE)
+    {
+        _root = leaf;
+        _nodes[leaf].parent = NULL_NODE;
+        return;
+    }
+
+    // walk down to the sibling whose union with the leaf adds the least surface area
+    AABB leafAABB = _nodes[leaf].aabb;
+    int index = _root;
+    while (!_nodes[index].isLeaf())
+    {
+        const TreeNode& node = _nodes[index];
+        float area = surfaceArea(node.aabb);
+        float combinedArea = surfaceArea(combine(node.aabb, leafAABB));
+
+        // cost of making a new parent for this node and the leaf
+        float cost = 2.0f * combinedArea;
+        // cost pushed down to the children by growing this node
+        float inheritanceCost = 2.0f * (combinedArea - area);
+
+        float childCost[2];
+        int children[2] = { node.child1, node.child2 };
+        for (int i = 0; i < 2; ++i)
+        {
+            const TreeNode& child = _nodes[children[i]];
+            float childArea = surfaceArea(combine(child.aabb, leafAABB));
+            if (!child.isLeaf())
+                childArea -= surfaceArea(child.aabb);
+            childCost[i] = childArea + inheritanceCost;
+        }
+
+        if (cost < childCost[0] && cost < childCost[1])
+            break;
+
+        index = childCost[0] < childCost[1] ? children[0] : children[1];
+    }
+
+    int sibling = index;
+    int oldParent = _nodes[sibling].parent;
+    int newParent = allocateNode();
+    _nodes[newParent].parent = oldParent;
+    _nodes[newParent].aabb = combine(leafAABB, _nodes[sibling].aabb);
+    _nodes[newParent].height = _nodes[sibling].height + 1;
+    _nodes[newParent].child1 = sibling;
+    _nodes[newParent].child2 = leaf;
+    _nodes[sibling].parent = newParent;
+    _nodes[leaf].parent = newParent;
+
+    if (oldParent != NULL_NODE)
+    {
+        if (_nodes[oldParent].child1 == sibling)
+            _nodes[oldParent].child1 = newParent;
+        else
+            _nodes[oldParent].child2 = newParent;
+    }
+    else
+    {
+        _root = newParent;
+    }
+
+    // refit and rebalance the ancestors
+    index = _nodes[leaf].parent;
+    while (index != NULL_NODE)
+    {
+        index = balance(index);
+
+        TreeNode& node = _nodes[index];
+        node.height = 1 + std::max(_nodes[node.child1].height, _nodes[node.child2].height);
+        node.aabb = combine(_nodes[node.child1].aabb, _nodes[node.child2].aabb);
+
+        index = node.parent;
+    }
+}
+
+void AABBTree::removeLeaf(int leaf)
+{
+    if (leaf == _root)
+    {
+        _root = NULL_NODE;
+        return;
+    }
+
+    int parent = _nodes[leaf].parent;
+    int grandParent = _nodes[parent].parent;
+    int sibling = _nodes[parent].child1 == leaf ? _nodes[parent].child2 : _nodes[parent].child1;
+
+    if (grandParent == NULL_NODE)
+    {
+        _root = sibling;
+        _nodes[sibling].parent = NULL_NODE;
+        freeNode(parent);
+        return;
+    }
+
+    // the sibling takes the place of the parent
+    if (_nodes[grandParent].child1 == parent)
+        _nodes[grandParent].child1 = sibling;
+    else
+        _nodes[grandParent].child2 = sibling;
+    _nodes[sibling].parent = grandParent;
+    freeNode(parent);
+
+    int index = grandParent;
+    while (index != NULL_NODE)
+    {
+        index = balance(index);
+
+        TreeNode& node = _nodes[index];
+        node.aabb = combine(_nodes[node.child1].aabb, _nodes[node.child2].aabb);
+        node.height = 1 + std::max(_nodes[node.child1].height, _nodes[node.child2].height);
+
+        index = node.parent;
+    }
+}
+
+int AABBTree::balance(int iA)
+{
+    TreeNode& a = _nodes[iA];
+    if (a.isLeaf() || a.height < 2)
+        return iA;
+
+    int iB = a.child1;
+    int iC = a.child2;
+    TreeNode& b = _nodes[iB];
+    TreeNode& c = _nodes[iC];
+
+    int heightDifference = c.height - b.height;
+
+    if (heightDifference > 1)
+    {
+        // rotate c up: c takes the place of a, and a keeps the lower child of c
+        int iF = c.child1;
+        int iG = c.child2;
+        TreeNode& f = _nodes[iF];
+        TreeNode& g = _nodes[iG];
+
+        c.child1 = iA;
+        c.parent = a.parent;
+        a.parent = iC;
+
+        if (c.parent != NULL_NODE)
+        {
+            if (_nodes[c.parent].child1 == iA)
+                _nodes[c.parent].child1 = iC;
+            else
+                _nodes[c.parent].child2 = iC;
+        }
+        else
+        {
+            _root = iC;
+        }
+
+        if (f.height > g.height)
+        {
+            c.child2 = iF;
+            a.child2 = iG;
+            g.parent = iA;
+            a.aabb = combine(b.aabb, g.aabb);
+            c.aabb = combine(a.aabb, f.aabb);
+            a.height = 1 + std::max(b.height, g.height);
+            c.height = 1 + std::max(a.height, f.height);
+        }
+        else
+        {
+            c.child2 = iG;
+            a.child2 = iF;
+            f.parent = iA;
+            a.aabb = combine(b.aabb, f.aabb);
+            c.aabb = combine(a.aabb, g.aabb);
+            a.height = 1 + std::max(b.height, f.height);
+            c.height = 1 + std::max(a.height, g.height);
+        }
+        return iC;
+    }
+
+    if (heightDifference < -1)
+    {
+        // rotate b up
+        int iD = b.child1;
+        int iE = b.child2;
+        TreeNode& d = _nodes[iD];
+        TreeNode& e = _nodes[iE];
+
+        b.child1 = iA;
+        b.parent = a.parent;
+        a.parent = iB;
+
+        if (b.parent != NULL_NODE)
+        {
+            if (_nodes[b.parent].child1 == iA)
+                _nodes[b.parent].child1 = iB;
+            else
+                _nodes[b.parent].child2 = iB;
+        }
+        else
+        {
+            _root = iB;
+        }
+
+        if (d.height > e.height)
+        {
+            b.child2 = iD;
+            a.child1 = iE;
+            e.parent = iA;
+            a.aabb = combine(c.aabb, e.aabb);
+            b.aabb = combine(a.aabb, d.aabb);
+            a.height = 1 + std::max(c.height, e.height);
+            b.height = 1 + std::max(a.height, d.height);
+        }
+        else
+        {
+            b.child2 = iE;
+            a.child1 = iD;
+            d.parent = iA;
+            a.aabb = combine(c.aabb, d.aabb);
+            b.aabb = combine(a.aabb, e.aabb);
+            a.height = 1 + std::max(c.height, d.height);
+            b.height = 1 + std::max(a.height, e.height);
+        }
+        return iB;
+    }
+
+    return iA;
+}
+
+void AABBTree::collectLeaves(int nodeId, std::vector<int>& result) const
+{
+    // the caller's traversal stack is still in use, keep a separate one
+    int stack[64];
+    int count = 0;
+    stack[count++] = nodeId;
+    while (count > 0)
+    {
+        int index = stack[--count];
+        const TreeNode& node = _nodes[index];
+        if (node.isLeaf())
+        {
+            result.push_back(index);
+        }
+        else if (count + 2 <= 64)
+        {
+            stack[count++] = node.child1;
+            stack[count++] = node.child2;
+        }
+        else
+        {
+            collectLeaves(node.child1, result);
+            collectLeaves(node.child2, result);
+        }
+    }
+}
+
+void AABBTree::queryFrustum(const Frustum& frustum, std::vector<int>& result) const
+{
+    if (_root == NULL_NODE)
+        return;
+
+    if (!frustum.isInitialized())
+    {
+        collectLeaves(_root, result);
+        return;
+    }
+
+    PackedPlanes planes;
+    packPlanes(frustum, planes);
+
+    // every entry is a node followed by the planes it still has to be tested against
+    _stack.clear();
+    _stack.push_back(_root);
+    _stack.push_back((1 << planes.count) - 1);
+    while (!_stack.empty())
+    {
+        unsigned int mask = _stack.back();
+        _stack.pop_back();
+        int nodeId = _stack.back();
+        _stack.pop_back();
+
+        const TreeNode& node = _nodes[nodeId];
+        unsigned int outside, inside;
+        testPlanes(planes, node.aabb, mask, outside, inside);
+        if (outside & mask)
+            continue;
+
+        mask &= ~inside;
+        if (mask == 0 || node.isLeaf())
+        {
+            collectLeaves(nodeId, result);
+        }
+        else
+        {
+            _stack.push_back(node.child1);
+            _stack.push_back(mask);
+            _stack.push_back(node.child2);
+            _stack.push_back(mask);
+        }
+    }
+}
+
+void AABBTree::queryRay(const Ray& ray, std::vector<int>& result) const
+{
+    if (_root == NULL_NODE)
+        return;
+
+    // a zero component gives an infinite inverse, which the slab test handles
+    Vec3 inverseDirection(1.0f / ray._direction.x, 1.0f / ray._direction.y, 1.0f / ray._direction.z);
+
+    _stack.clear();
+    _stack.push_back(_root);
+    while (!_stack.empty())
+    {
+        int nodeId = _stack.back();
+        _stack.pop_back();
+
+        const TreeNode& node = _nodes[nodeId];
+        if (!intersectsRay(node.aabb, ray._origin, inverseDirection))
+            continue;
+
+        if (node.isLeaf())
+        {
+            result.push_back(nodeId);
+        }
+        else
+        {
+            _stack.push_back(node.child1);
+            _stack.push_back(node.child2);
+        }
+    }
+}
+
+void AABBTree::queryAABB(const AABB& aabb, std::vector<int>& result) const
+{
+    if (_root == NULL_NODE)
+        return;
+
+    _stack.clear();
+    _stack.push_back(_root);
+    while (!_stack.empty())
+    {
+        int nodeId = _stack.back();
+        _stack.pop_back();
+
+        const TreeNode& node = _nodes[nodeId];
+        if (!overlaps(node.aabb, aabb))
+            continue;
+
+        if (node.isLeaf())
+        {
+            result.push_back(nodeId);
+        }
+        else
+        {
+            _stack.push_back(node.child1);
+            _stack.push_back(node.child2);
+        }
+    }
+}
+
+int AABBTree::getHeight() const
+{
+    return _root == NULL_NODE ? 0 : _nodes[_root].height;
+}
+
+bool AABBTree::validate() const
+{
+    if (_root == NULL_NODE)
+        return _leafCount == 0;
+
+    if (_nodes[_root].parent != NULL_NODE)
+        return false;
+
+    int freeCount = 0;
+    for (int index = _freeList; index != NULL_NODE; index = _nodes[index].next)
+        ++freeCount;
+
+    // a tree of n leaves has n - 1 inner nodes
+    return validateNode(_root) && freeCount + 2 * _leafCount - 1 == (int)_nodes.size();
+}
+
+bool AABBTree::validateNode(int nodeId) const
+{
+    const TreeNode& node = _nodes[nodeId];
+    if (node.isLeaf())
+        return node.child2 == NULL_NODE && node.height == 0;
+
+    const TreeNode& child1 = _nodes[node.child1];
+    const TreeNode& child2 = _nodes[node.child2];
+    if (child1.parent != nodeId || child2.parent != nodeId)
+        return false;
+    if (node.height != 1 + std::max(child1.height, child2.height))
+        return false;
+    if (!contains(node.aabb, child1.aabb) || !contains(node.aabb, child2.aabb))
+        return false;
+
+    return validateNode(node.child1) && validateNode(node.child2);
+}
+
+NS_CC_END
@@ -0,0 +1,144 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __CC_AABB_TREE_H__
+#define __CC_AABB_TREE_H__
+
+#include <vector>
+#include "3d/CCAABB.h"
+#include "3d/CCFrustum.h"
+#include "3d/CCRay.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup _3d
+ * @{
+ */
+
+/** @class AABBTree
+ * @brief A dynamic bounding volume hierarchy of axis aligned boxes.
+ *
+ * Every proxy is a leaf holding a box and a user pointer. Leaves store their box grown by a
+ * margin, so an object moving a little doesn't touch the tree; when it leaves its grown box
+ * the leaf is removed and inserted again where it makes the combined surface area smallest,
+ * and the tree is rebalanced with rotations on the way up.
+ *
+ * Queries walk the tree and skip whole subtrees. The frustum query tests a node against all the
+ * planes at once with SSE or NEON when available, and hands the planes a node is fully inside of
+ * down to its children so they aren't tested again: a subtree inside every plane is accepted
+ * without any test.
+ * @since v3.18
+ * @js NA
+ * @lua NA
+ */
+class CC_DLL AABBTree
+{
+public:
+    static const int NULL_NODE = -1;
+
+    AABBTree();
+    ~AABBTree();
+
+    /** Adds a leaf and returns its proxy id. The box must not be empty. */
+    int createProxy(const AABB& aabb, void* userData);
+
+    /** Removes a leaf, its proxy id may be given to a later leaf. */
+    void destroyProxy(int proxyId);
+
+    /** Updates the box of a leaf.
+     *
+     * @return true if the leaf was inserted again, false if its grown box still contains the new box.
+     */
+    bool moveProxy(int proxyId, const AABB& aabb);
+
+    void* getUserData(int proxyId) const { return _nodes[proxyId].userData; }
+
+    /** The box a leaf is stored with, which contains the box it was given. */
+    const AABB& getFatAABB(int proxyId) const { return _nodes[proxyId].aabb; }
+
+    /** Sets how much leaves are grown on each side, as a fraction of their size. The default is 0.1. */
+    void setMarginRatio(float ratio) { _marginRatio = ratio; }
+    float getMarginRatio() const { return _marginRatio; }
+
+    /** Appends the proxy id of every leaf whose grown box isn't out of the frustum. */
+    void queryFrustum(const Frustum& frustum, std::vector<int>& result) const;
+
+    /** Appends the proxy id of every leaf whose grown box is hit by the ray. */
+    void queryRay(const Ray& ray, std::vector<int>& result) const;
+
+    /** Appends the proxy id of every leaf whose grown box overlaps the box. */
+    void queryAABB(const AABB& aabb, std::vector<int>& result) const;
+
+    int getProxyCount() const { return _leafCount; }
+
+    /** Height of the tree, 0 when it is a single leaf. */
+    int getHeight() const;
+
+    /** Checks the links, heights and boxes of every node, for tests. */
+    bool validate() const;
+
+protected:
+    struct TreeNode
+    {
+        AABB aabb;
+        void* userData;
+        union
+        {
+            int parent;
+            int next;
+        };
+        int child1;
+        int child2;
+        // leaf = 0, free node = -1
+        int height;
+
+        bool isLeaf() const { return child1 == NULL_NODE; }
+    };
+
+    int allocateNode();
+    void freeNode(int nodeId);
+
+    void insertLeaf(int leaf);
+    void removeLeaf(int leaf);
+    int balance(int nodeId);
+    void collectLeaves(int nodeId, std::vector<int>& result) const;
+    bool validateNode(int nodeId) const;
+
+    std::vector<TreeNode> _nodes;
+    int _root;
+    int _freeList;
+    int _leafCount;
+    float _marginRatio;
+    // traversal stack reused by the queries
+    mutable std::vector<int> _stack;
+};
+
+// end of 3d group
+/// @}
+
+NS_CC_END
+
+#endif // __CC_AABB_TREE_H__
@@ -24,8 +24,11 @@
  ****************************************************************************/
 
 #include "3d/CCAnimate3D.h"
+#include "3d/CCAnimate3DScheduler.h"
 #include "3d/CCSprite3D.h"
 #include "3d/CCSkeleton3D.h"
+#include "2d/CCCamera.h"
+#include "2d/CCScene.h"
 #include "platform/CCFileUtils.h"
 #include "base/CCConfiguration.h"
 #include "base/CCEventCustom.h"
@@ -38,6 +41,33 @@ std::unordered_map<Node*, Animate3D*> Animate3D::s_fadeInAnimates;
 std::unordered_map<Node*, Animate3D*> Animate3D::s_fadeOutAnimates;
 std::unordered_map<Node*, Animate3D*> Animate3D::s_runningAnimates;
 float      Animate3D::_transTime = 0.1f;
+std::vector<Animate3D::LODLevel> Animate3D::s_lodLevels;
+
+namespace
+{
+    // the level of detail for the distance of target to the default camera, nullptr for full detail
+    const Animate3D::LODLevel* findLODLevel(Node* target, const std::vector<Animate3D::LODLevel>& levels)
+    {
+        auto scene = Director::getInstance()->getRunningScene();
+        auto camera = scene ? scene->getDefaultCamera() : nullptr;
+        if (camera == nullptr)
+            return nullptr;
+        
+        Vec3 targetPosition, cameraPosition;
+        target->getNodeToWorldTransform().getTranslation(&targetPosition);
+        camera->getNodeToWorldTransform().getTranslation(&cameraPosition);
+        float distance = targetPosition.distance(cameraPosition);
+        
+        const Animate3D::LODLevel* found = nullptr;
+        for (const auto& level : levels)
+        {
+            if (distance < level.distance)
+                break;
+            found = &level;
+        }
+        return found;
+    }
+}
 
 //create Animate3D using Animation.
 Animate3D* Animate3D::create(Animation3D* animation)
@@ -227,6 +257,20 @@ void Animate3D::startWithTarget(Node *target)
         {
             CCLOG("warning: no animation found for the skeleton");
         }
+        
+        _animatedBones.clear();
+        _animatedCurves.clear();
+        _animatedBoneDepths.clear();
+        for (const auto& it : _boneCurves)
+        {
+            int depth = 0;
+            for (auto parent = it.first->getParentBone(); parent; parent = parent->getParentBone())
+                ++depth;
+            _animatedBones.push_back(it.first);
+            _animatedCurves.push_back(it.second);
+            _animatedBoneDepths.push_back(depth);
+        }
+        _keyIndices.assign(_animatedBones.size() * 3, 0);
     }
     
     auto runningAction = s_runningAnimates.find(target);
@@ -335,7 +379,6 @@ void Animate3D::update(float t)
             if (_weight > 0.0f)
             {
                 float transDst[3], rotDst[4], scaleDst[3];
-                float* trans = nullptr, *rot = nullptr, *scale = nullptr;
                 if (_playReverse){
                     t = 1 - t;
                     lastTime = 1.0f - lastTime;
@@ -344,25 +387,30 @@ void Animate3D::update(float t)
                 t = _start + t * _last;
                 lastTime = _start + lastTime * _last;
                 
-                for (const auto& it : _boneCurves) {
-                    auto bone = it.first;
-                    auto curve = it.second;
-                    if (curve->translateCurve)
-                    {
-                        curve->translateCurve->evaluate(t, transDst, _translateEvaluate);
-                        trans = &transDst[0];
-                    }
-                    if (curve->rotCurve)
+                if (!_animatedBones.empty())
+                {
+                    int maxBoneDepth = -1;
+                    bool animateBones = true;
+                    if (!s_lodLevels.empty())
                     {
-                        curve->rotCurve->evaluate(t, rotDst, _roteEvaluate);
-                        rot = &rotDst[0];
+                        auto level = findLODLevel(_target, s_lodLevels);
+                        if (level)
+                        {
+                            maxBoneDepth = level->maxBoneDepth;
+                            // the animations of a target skip the same frames, different targets skip different ones
+                            auto frame = Director::getInstance()->getTotalFrames() + (reinterpret_cast<uintptr_t>(_target) >> 4);
+                            animateBones = (level->updateInterval <= 1 || frame % level->updateInterval == 0);
+                        }
                     }
-                    if (curve->scaleCurve)
+                    
+                    if (animateBones)
                     {
-                        curve->scaleCurve->evaluate(t, scaleDst, _scaleEvaluate);
-                        scale = &scaleDst[0];
+                        auto scheduler = Animate3DScheduler::getInstance();
+                        if (scheduler->isEnabled())
+                            scheduler->schedulePose(this, _target, static_cast<Sprite3D*>(_target)->getSkeleton(), t, _weight, maxBoneDepth);
+                        else
+                            evaluateBoneCurves(t, _weight, maxBoneDepth);
                     }
-                    bone->setAnimationValue(trans, rot, scale, this, _weight);
                 }
                 
                 for (const auto& it : _nodeCurves)
@@ -418,6 +466,44 @@ void Animate3D::update(float t)
     }
 }
 
+void Animate3D::evaluateBoneCurves(float t, float weight, int maxBoneDepth)
+{
+    float transDst[3], rotDst[4], scaleDst[3];
+    int* keyIndex = _keyIndices.data();
+    for (size_t i = 0, count = _animatedBones.size(); i < count; ++i, keyIndex += 3)
+    {
+        if (maxBoneDepth >= 0 && _animatedBoneDepths[i] > maxBoneDepth)
+            continue;
+        
+        auto curve = _animatedCurves[i];
+        float* trans = nullptr, *rot = nullptr, *scale = nullptr;
+        if (curve->translateCurve)
+        {
+            curve->translateCurve->evaluate(t, transDst, _translateEvaluate, &keyIndex[0]);
+            trans = &transDst[0];
+        }
+        if (curve->rotCurve)
+        {
+            curve->rotCurve->evaluate(t, rotDst, _roteEvaluate, &keyIndex[1]);
+            rot = &rotDst[0];
+        }
+        if (curve->scaleCurve)
+        {
+            curve->scaleCurve->evaluate(t, scaleDst, _scaleEvaluate, &keyIndex[2]);
+            scale = &scaleDst[0];
+        }
+        _animatedBones[i]->setAnimationValue(trans, rot, scale, this, weight);
+    }
+}
+
+void Animate3D::setLODLevels(const std::vector<LODLevel>& levels)
+{
+    s_lodLevels = levels;
+    std::sort(s_lodLevels.begin(), s_lodLevels.end(), [](const LODLevel& a, const LODLevel& b) {
+        return a.distance < b.distance;
+    });
+}
+
 float Animate3D::getSpeed() const
 {
     return _playReverse ? -_absSpeed : _absSpeed;
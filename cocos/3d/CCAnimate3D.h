@@ -28,6 +28,7 @@
 
 #include <map>
 #include <unordered_map>
+#include <vector>
 
 #include "3d/CCAnimation3D.h"
 #include "base/ccMacros.h"
@@ -110,6 +111,27 @@ public:
     /** set animate transition time between 3d animations */
     static void setTransitionTime(float transTime) { if (transTime >= 0.f) _transTime = transTime; }
     
+    /**
+     * Level of detail of the bone animations, picked by the distance between the animated Sprite3D
+     * and the default camera of the running scene.
+     * @since v3.18
+     */
+    struct LODLevel
+    {
+        float distance;     // the level applies from this distance on
+        int updateInterval; // the bones are animated every updateInterval frames
+        int maxBoneDepth;   // bones deeper than this under their root keep their last pose, -1 animates them all
+    };
+    
+    /** set the levels of detail of the bone animations, none by default so every bone is animated every frame
+     * @since v3.18
+     */
+    static void setLODLevels(const std::vector<LODLevel>& levels);
+    /** get the levels of detail of the bone animations, sorted by distance
+     * @since v3.18
+     */
+    static const std::vector<LODLevel>& getLODLevels() { return s_lodLevels; }
+    
     /**get & set play reverse, these are deprecated, use set negative speed instead*/
     CC_DEPRECATED_ATTRIBUTE bool getPlayBack() const { return _playReverse; }
     CC_DEPRECATED_ATTRIBUTE void setPlayBack(bool reverse) { _playReverse = reverse; }
@@ -140,6 +162,9 @@ CC_CONSTRUCTOR_ACCESS:
     
     void removeFromMap();
     
+    /** set the pose of the animated bones at t, bones deeper than maxBoneDepth are skipped unless it is -1 */
+    void evaluateBoneCurves(float t, float weight, int maxBoneDepth);
+    
     /** init method */
     bool init(Animation3D* animation);
     bool init(Animation3D* animation, float fromTime, float duration);
@@ -174,6 +199,12 @@ protected:
     Animate3DQuality _quality;
     
     std::unordered_map<Bone3D*, Animation3D::Curve*> _boneCurves; //weak ref
+    // _boneCurves as flat arrays for evaluateBoneCurves(), with the depth of each bone and the key frame
+    // each of its translate, rotation and scale curves was last evaluated at
+    std::vector<Bone3D*> _animatedBones;
+    std::vector<Animation3D::Curve*> _animatedCurves;
+    std::vector<int> _animatedBoneDepths;
+    std::vector<int> _keyIndices;
     std::unordered_map<Node*, Animation3D::Curve*> _nodeCurves;
     
     std::unordered_map<int, ValueMap> _keyFrameUserInfos;
@@ -184,6 +215,10 @@ protected:
     static std::unordered_map<Node*, Animate3D*> s_fadeInAnimates;
     static std::unordered_map<Node*, Animate3D*> s_fadeOutAnimates;
     static std::unordered_map<Node*, Animate3D*> s_runningAnimates;
+    
+    static std::vector<LODLevel> s_lodLevels;
+    
+    friend class Animate3DScheduler;
 };
 
 // end of 3d group
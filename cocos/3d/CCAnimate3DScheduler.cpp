@@ -0,0 +1,249 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "3d/CCAnimate3DScheduler.h"
+#include <algorithm>
+#include "3d/CCAnimate3D.h"
+#include "3d/CCSkeleton3D.h"
+#include "base/CCDirector.h"
+#include "base/CCEventDispatcher.h"
+#include "base/CCEventListenerCustom.h"
+
+NS_CC_BEGIN
+
+namespace
+{
+    Animate3DScheduler* s_sharedAnimate3DScheduler = nullptr;
+
+    // the main thread takes jobs too, more workers than this mostly wait on each other
+    const int MAX_DEFAULT_THREADS = 3;
+}
+
+Animate3DScheduler* Animate3DScheduler::getInstance()
+{
+    if (nullptr == s_sharedAnimate3DScheduler)
+    {
+        s_sharedAnimate3DScheduler = new (std::nothrow) Animate3DScheduler();
+    }
+    return s_sharedAnimate3DScheduler;
+}
+
+void Animate3DScheduler::destroyInstance()
+{
+    CC_SAFE_DELETE(s_sharedAnimate3DScheduler);
+}
+
+Animate3DScheduler::Animate3DScheduler()
+: _enabled(true)
+, _jobCount(0)
+, _afterUpdateListener(nullptr)
+, _resetListener(nullptr)
+, _generation(0)
+, _busyWorkers(0)
+, _quit(false)
+, _nextJob(0)
+, _lastSkeletonCount(0)
+, _lastPoseCount(0)
+{
+    _afterUpdateListener = Director::getInstance()->getEventDispatcher()->addCustomEventListener(Director::EVENT_AFTER_UPDATE, [this](EventCustom* /*event*/) {
+        flush();
+    });
+    _afterUpdateListener->retain();
+    // the director removes every listener when it is reset, a new scheduler is made on the next use
+    _resetListener = Director::getInstance()->getEventDispatcher()->addCustomEventListener(Director::EVENT_RESET, [](EventCustom* /*event*/) {
+        Animate3DScheduler::destroyInstance();
+    });
+    _resetListener->retain();
+
+    int cores = static_cast<int>(std::thread::hardware_concurrency());
+    startWorkers(std::min(std::max(cores - 1, 0), MAX_DEFAULT_THREADS));
+}
+
+Animate3DScheduler::~Animate3DScheduler()
+{
+    flush();
+    stopWorkers();
+    auto dispatcher = Director::getInstance()->getEventDispatcher();
+    dispatcher->removeEventListener(_afterUpdateListener);
+    dispatcher->removeEventListener(_resetListener);
+    CC_SAFE_RELEASE(_afterUpdateListener);
+    CC_SAFE_RELEASE(_resetListener);
+}
+
+void Animate3DScheduler::setEnabled(bool enabled)
+{
+    if (_enabled != enabled)
+    {
+        flush();
+        _enabled = enabled;
+    }
+}
+
+void Animate3DScheduler::setThreadCount(int count)
+{
+    count = std::max(count, 0);
+    if (count != getThreadCount())
+    {
+        stopWorkers();
+        startWorkers(count);
+    }
+}
+
+void Animate3DScheduler::schedulePose(Animate3D* animate, Node* target, Skeleton3D* skeleton, float t, float weight, int maxBoneDepth)
+{
+    size_t index;
+    auto it = _jobIndices.find(target);
+    if (it != _jobIndices.end())
+    {
+        index = it->second;
+    }
+    else
+    {
+        index = _jobCount++;
+        if (index == _jobs.size())
+            _jobs.emplace_back();
+        _jobIndices[target] = index;
+
+        auto& job = _jobs[index];
+        job.target = target;
+        job.skeleton = skeleton;
+        target->retain();
+    }
+
+    // kept alive until flush(), an action stopped in between was updated for this frame already
+    animate->retain();
+    _jobs[index].poses.push_back({animate, t, weight, maxBoneDepth});
+}
+
+void Animate3DScheduler::flush()
+{
+    _lastSkeletonCount = static_cast<int>(_jobCount);
+    _lastPoseCount = 0;
+    if (_jobCount == 0)
+        return;
+
+    runJobs();
+
+    for (size_t i = 0; i < _jobCount; ++i)
+    {
+        auto& job = _jobs[i];
+        _lastPoseCount += static_cast<int>(job.poses.size());
+        for (auto& pose : job.poses)
+        {
+            pose.animate->release();
+        }
+        job.poses.clear();
+        job.target->release();
+        job.target = nullptr;
+        job.skeleton = nullptr;
+    }
+    _jobCount = 0;
+    _jobIndices.clear();
+}
+
+void Animate3DScheduler::runJobs()
+{
+    if (_workers.empty() || _jobCount < 2)
+    {
+        for (size_t i = 0; i < _jobCount; ++i)
+        {
+            runJob(_jobs[i]);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _nextJob = 0;
+        _busyWorkers = static_cast<int>(_workers.size());
+        ++_generation;
+    }
+    _workAvailable.notify_all();
+
+    for (size_t i = _nextJob++; i < _jobCount; i = _nextJob++)
+    {
+        runJob(_jobs[i]);
+    }
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _workDone.wait(lock, [this]() { return _busyWorkers == 0; });
+}
+
+void Animate3DScheduler::runJob(Job& job)
+{
+    for (const auto& pose : job.poses)
+    {
+        pose.animate->evaluateBoneCurves(pose.t, pose.weight, pose.maxBoneDepth);
+    }
+    job.skeleton->updateBoneMatrix();
+}
+
+void Animate3DScheduler::startWorkers(int count)
+{
+    _quit = false;
+    for (int i = 0; i < count; ++i)
+    {
+        _workers.emplace_back(&Animate3DScheduler::workerLoop, this, _generation);
+    }
+}
+
+void Animate3DScheduler::stopWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _quit = true;
+    }
+    _workAvailable.notify_all();
+    for (auto& worker : _workers)
+    {
+        worker.join();
+    }
+    _workers.clear();
+}
+
+void Animate3DScheduler::workerLoop(unsigned int generation)
+{
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _workAvailable.wait(lock, [&]() { return _quit || _generation != generation; });
+            if (_quit)
+                return;
+            generation = _generation;
+        }
+
+        for (size_t i = _nextJob++; i < _jobCount; i = _nextJob++)
+        {
+            runJob(_jobs[i]);
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (--_busyWorkers == 0)
+            _workDone.notify_one();
+    }
+}
+
+NS_CC_END
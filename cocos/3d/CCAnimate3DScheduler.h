@@ -0,0 +1,143 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __CCANIMATE3DSCHEDULER_H__
+#define __CCANIMATE3DSCHEDULER_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "platform/CCPlatformMacros.h"
+
+NS_CC_BEGIN
+
+class Animate3D;
+class EventListenerCustom;
+class Node;
+class Skeleton3D;
+
+/**
+ * @addtogroup _3d
+ * @{
+ */
+
+/**
+ * @brief Evaluates the bone poses of every Animate3D of a frame at once, on worker threads.
+ *
+ * Animate3D::update() keeps the weights, the node animations and the key frame events on the
+ * main thread and queues the bone curves here. Right after the scheduler update of the frame
+ * the queue is split into one job per skeleton: the job evaluates the curves of every Animate3D
+ * playing on the skeleton, blended as before, then refreshes its bone matrices. Jobs run on a
+ * few worker threads and on the main thread, which waits for them before the scene is visited.
+ *
+ * Sprite3D skips its own bone matrix refresh when a job already did it in the frame.
+ * @since v3.18
+ */
+class CC_DLL Animate3DScheduler
+{
+public:
+    /** Returns the shared scheduler. */
+    static Animate3DScheduler* getInstance();
+    static void destroyInstance();
+
+    /**
+     * Turns the deferred evaluation on or off. When off, Animate3D evaluates its bones in update()
+     * as before. On by default.
+     */
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return _enabled; }
+
+    /**
+     * Sets the number of worker threads, 0 evaluates every job on the main thread.
+     * The default is the number of cores minus one, at most 3.
+     */
+    void setThreadCount(int count);
+    int getThreadCount() const { return static_cast<int>(_workers.size()); }
+
+    /** Queues the bone curves of an Animate3D to be evaluated at t with its current weight. */
+    void schedulePose(Animate3D* animate, Node* target, Skeleton3D* skeleton, float t, float weight, int maxBoneDepth);
+
+    /** Evaluates the queued poses. Called after the scheduler update of every frame. */
+    void flush();
+
+    /** Number of skeletons and of Animate3D evaluated by the last flush(). */
+    int getLastSkeletonCount() const { return _lastSkeletonCount; }
+    int getLastPoseCount() const { return _lastPoseCount; }
+
+protected:
+    Animate3DScheduler();
+    ~Animate3DScheduler();
+
+    struct Pose
+    {
+        Animate3D* animate;
+        float t;
+        float weight;
+        int maxBoneDepth;
+    };
+
+    // the Animate3D playing on one skeleton, they write the same bones so they run in one job
+    struct Job
+    {
+        Node* target;
+        Skeleton3D* skeleton;
+        std::vector<Pose> poses;
+    };
+
+    void runJobs();
+    void runJob(Job& job);
+    void startWorkers(int count);
+    void stopWorkers();
+    void workerLoop(unsigned int generation);
+
+    bool _enabled;
+    std::vector<Job> _jobs;
+    size_t _jobCount;
+    std::unordered_map<Node*, size_t> _jobIndices;
+    EventListenerCustom* _afterUpdateListener;
+    EventListenerCustom* _resetListener;
+
+    std::vector<std::thread> _workers;
+    std::mutex _mutex;
+    std::condition_variable _workAvailable;
+    std::condition_variable _workDone;
+    unsigned int _generation;
+    int _busyWorkers;
+    bool _quit;
+    std::atomic<size_t> _nextJob;
+
+    int _lastSkeletonCount;
+    int _lastPoseCount;
+};
+
+// end of 3d group
+/// @}
+
+NS_CC_END
+
+#endif // __CCANIMATE3DSCHEDULER_H__
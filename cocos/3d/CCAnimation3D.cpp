@@ -184,6 +184,44 @@ bool Animation3D::init(const Animation3DData &data)
         if(curve->scaleCurve) curve->scaleCurve->retain();
     }
     
+    // curves of compressed c3b animations keep their 16 bit keys
+    auto getCurve = [this](const std::string& name) {
+        Curve*& curve = _boneCurves[name];
+        if (curve == nullptr)
+            curve = new (std::nothrow) Curve();
+        return curve;
+    };
+    
+    for (const auto& iter : data._quantizedTranslations)
+    {
+        const auto& keys = iter.second;
+        Curve* curve = getCurve(iter.first);
+        if (keys._offset.size() != 3 || keys._values.empty()) continue;
+        CC_SAFE_RELEASE(curve->translateCurve);
+        curve->translateCurve = Curve::AnimationCurveVec3::createQuantized(keys._startTime, keys._interval, &keys._values[0], &keys._offset[0], &keys._scale[0], (int)keys._values.size() / 3);
+        curve->translateCurve->retain();
+    }
+    
+    for (const auto& iter : data._quantizedRotations)
+    {
+        const auto& keys = iter.second;
+        Curve* curve = getCurve(iter.first);
+        if (keys._offset.size() != 4 || keys._values.empty()) continue;
+        CC_SAFE_RELEASE(curve->rotCurve);
+        curve->rotCurve = Curve::AnimationCurveQuat::createQuantized(keys._startTime, keys._interval, &keys._values[0], &keys._offset[0], &keys._scale[0], (int)keys._values.size() / 4);
+        curve->rotCurve->retain();
+    }
+    
+    for (const auto& iter : data._quantizedScales)
+    {
+        const auto& keys = iter.second;
+        Curve* curve = getCurve(iter.first);
+        if (keys._offset.size() != 3 || keys._values.empty()) continue;
+        CC_SAFE_RELEASE(curve->scaleCurve);
+        curve->scaleCurve = Curve::AnimationCurveVec3::createQuantized(keys._startTime, keys._interval, &keys._values[0], &keys._offset[0], &keys._scale[0], (int)keys._values.size() / 3);
+        curve->scaleCurve->retain();
+    }
+    
     return true;
 }
 
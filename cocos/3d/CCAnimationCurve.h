@@ -25,6 +25,7 @@
 #ifndef __CCANIMATIONCURVE_H__
 #define __CCANIMATIONCURVE_H__
 
+#include <algorithm>
 #include <cmath>
 #include <functional>
 
@@ -67,6 +68,14 @@ public:
     /**create animation curve*/
     static AnimationCurve* create(float* keytime, float* value, int count);
     
+    /**
+     * create animation curve from keys sampled every interval from startTime and quantized to 16 bits,
+     * as written by the c3b animation compressor. Component i of a key is offset[i] + value * scale[i].
+     * The keys around a time are found in constant time.
+     * @since v3.18
+     */
+    static AnimationCurve* createQuantized(float startTime, float interval, const unsigned short* value, const float* offset, const float* scale, int count);
+    
     /**
      * evaluate value of time
      * @param time Time to be estimated
@@ -75,6 +84,17 @@ public:
      */
     void evaluate(float time, float* dst, EvaluateType type) const;
     
+    /**
+     * evaluate value of time, looking for the key frame from a cached index first
+     * @param time Time to be estimated
+     * @param dst Estimated value of that time
+     * @param type EvaluateType
+     * @param keyIndex Key frame found by the previous call, it receives the key frame of this one. Playing
+     * forward or backward moves it by a few keys at most, so the binary search is mostly skipped.
+     * @since v3.18
+     */
+    void evaluate(float time, float* dst, EvaluateType type, int* keyIndex) const;
+    
     /**set evaluate function, allow the user use own function*/
     void setEvaluateFun(std::function<void(float time, float* dst)> fun);
     
@@ -94,6 +114,21 @@ CC_CONSTRUCTOR_ACCESS:
      */
     int determineIndex(float time) const;
     
+    /**
+     * Determine index by time, trying the keys around hint before searching.
+     */
+    int determineIndex(float time, int hint) const;
+    
+    /**
+     * Interpolate between two keys.
+     */
+    void interpolate(float* fromValue, float* toValue, float t, float time, float* dst, EvaluateType type) const;
+    
+    /**
+     * Evaluate a curve created by createQuantized().
+     */
+    void evaluateQuantized(float time, float* dst, EvaluateType type, int* keyIndex) const;
+    
 protected:
     
     float* _value;   //
@@ -101,6 +136,12 @@ protected:
     int _count;
     int _componentSizeByte; //component size in byte, position and scale 3 * sizeof(float), rotation 4 * sizeof(float)
     
+    unsigned short* _quantizedValue; //keys of a quantized curve, _value and _keytime are null for it
+    float _quantizedOffset[componentSize];
+    float _quantizedScale[componentSize];
+    float _startTime; //time of the first key of a quantized curve
+    float _interval;  //time between two keys of a quantized curve
+    
     std::function<void(float time, float* dst)> _evaluateFun; //user defined function
 };
 
@@ -4,6 +4,18 @@ NS_CC_BEGIN
 template <int componentSize>
 void AnimationCurve<componentSize>::evaluate(float time, float* dst, EvaluateType type) const
 {
+    evaluate(time, dst, type, nullptr);
+}
+
+template <int componentSize>
+void AnimationCurve<componentSize>::evaluate(float time, float* dst, EvaluateType type, int* keyIndex) const
+{
+    if (_quantizedValue)
+    {
+        evaluateQuantized(time, dst, type, keyIndex);
+        return;
+    }
+    
     if (_count == 1 || time <= _keytime[0])
     {
         memcpy(dst, _value, _componentSizeByte);
@@ -15,14 +27,21 @@ void AnimationCurve<componentSize>::evaluate(float time, float* dst, EvaluateTyp
         return;
     }
     
-    unsigned int index = determineIndex(time);
+    unsigned int index = keyIndex ? determineIndex(time, *keyIndex) : determineIndex(time);
+    if (keyIndex)
+        *keyIndex = index;
     
     float scale = (_keytime[index + 1] - _keytime[index]);
     float t = (time - _keytime[index]) / scale;
     
     float* fromValue = &_value[index * componentSize];
     float* toValue = fromValue + componentSize;
-    
+    interpolate(fromValue, toValue, t, time, dst, type);
+}
+
+template <int componentSize>
+void AnimationCurve<componentSize>::interpolate(float* fromValue, float* toValue, float t, float time, float* dst, EvaluateType type) const
+{
     switch (type) {
         case EvaluateType::INT_LINEAR:
         {
@@ -64,6 +83,46 @@ void AnimationCurve<componentSize>::evaluate(float time, float* dst, EvaluateTyp
     }
 }
 
+template <int componentSize>
+void AnimationCurve<componentSize>::evaluateQuantized(float time, float* dst, EvaluateType type, int* keyIndex) const
+{
+    // keys are evenly spaced, the one before time comes straight from it
+    int index = 0;
+    float t = 0.0f;
+    if (_count > 1 && _interval > 0.0f && time > _startTime)
+    {
+        float position = (time - _startTime) / _interval;
+        index = std::min(static_cast<int>(position), _count - 2);
+        t = std::min(position - index, 1.0f);
+    }
+    if (keyIndex)
+        *keyIndex = index;
+    
+    float fromValue[componentSize];
+    float toValue[componentSize];
+    const unsigned short* from = &_quantizedValue[index * componentSize];
+    const unsigned short* to = _count > 1 ? from + componentSize : from;
+    for (auto i = 0; i < componentSize; i++) {
+        fromValue[i] = _quantizedOffset[i] + from[i] * _quantizedScale[i];
+        toValue[i] = _quantizedOffset[i] + to[i] * _quantizedScale[i];
+    }
+    
+    if (type == EvaluateType::INT_QUAT_SLERP)
+    {
+        // quantizing moved the keys off the unit sphere
+        for (float* key : { fromValue, toValue })
+        {
+            float length = 0.0f;
+            for (auto i = 0; i < componentSize; i++)
+                length += key[i] * key[i];
+            length = length > 0.0f ? 1.0f / std::sqrt(length) : 0.0f;
+            for (auto i = 0; i < componentSize; i++)
+                key[i] *= length;
+        }
+    }
+    interpolate(fromValue, toValue, t, time, dst, type);
+}
+
 template <int componentSize>
 void AnimationCurve<componentSize>::setEvaluateFun(std::function<void(float time, float* dst)> fun)
 {
@@ -91,15 +150,37 @@ AnimationCurve<componentSize>* AnimationCurve<componentSize>::create(float* keyt
     return curve;
 }
 
+template <int componentSize>
+AnimationCurve<componentSize>* AnimationCurve<componentSize>::createQuantized(float startTime, float interval, const unsigned short* value, const float* offset, const float* scale, int count)
+{
+    AnimationCurve* curve = new (std::nothrow) AnimationCurve();
+    curve->_quantizedValue = new unsigned short[count * componentSize];
+    memcpy(curve->_quantizedValue, value, count * componentSize * sizeof(unsigned short));
+    memcpy(curve->_quantizedOffset, offset, sizeof(curve->_quantizedOffset));
+    memcpy(curve->_quantizedScale, scale, sizeof(curve->_quantizedScale));
+    
+    curve->_count = count;
+    curve->_componentSizeByte = componentSize * sizeof(float);
+    curve->_startTime = startTime;
+    curve->_interval = count > 1 ? interval : 0.0f;
+    
+    curve->autorelease();
+    return curve;
+}
+
 template <int componentSize>
 float AnimationCurve<componentSize>::getStartTime() const
 {
+    if (_quantizedValue)
+        return _startTime;
     return _keytime[0];
 }
 
 template <int componentSize>
 float AnimationCurve<componentSize>::getEndTime() const
 {
+    if (_quantizedValue)
+        return _startTime + _interval * (_count - 1);
     return _keytime[_count - 1];
 }
 
@@ -110,6 +191,9 @@ AnimationCurve<componentSize>::AnimationCurve()
 , _keytime(nullptr)
 , _count(0)
 , _componentSizeByte(0)
+, _quantizedValue(nullptr)
+, _startTime(0.0f)
+, _interval(0.0f)
 , _evaluateFun(nullptr)
 {
     
@@ -119,6 +203,7 @@ AnimationCurve<componentSize>::~AnimationCurve()
 {
     CC_SAFE_DELETE_ARRAY(_keytime);
     CC_SAFE_DELETE_ARRAY(_value);
+    CC_SAFE_DELETE_ARRAY(_quantizedValue);
 }
 
 template <int componentSize>
@@ -144,4 +229,26 @@ int AnimationCurve<componentSize>::determineIndex(float time) const
     return -1;
 }
 
+template <int componentSize>
+int AnimationCurve<componentSize>::determineIndex(float time, int hint) const
+{
+    // the cached key, then the next ones for playing forward and the previous one for playing backward
+    if (hint >= 0 && hint < _count - 1)
+    {
+        if (time >= _keytime[hint])
+        {
+            for (int index = hint, last = std::min(hint + 3, _count - 1); index < last; ++index)
+            {
+                if (time <= _keytime[index + 1])
+                    return index;
+            }
+        }
+        else if (hint > 0 && time >= _keytime[hint - 1])
+        {
+            return hint - 1;
+        }
+    }
+    return determineIndex(time);
+}
+
 NS_CC_END
\ No newline at end of file
@@ -32,11 +32,22 @@ THE SOFTWARE.
 #include "3d/CCBundleReader.h"
 #include "base/CCData.h"
 
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32) && (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CC_BUNDLE3D_USE_MMAP 1
+#else
+#define CC_BUNDLE3D_USE_MMAP 0
+#endif
+
 #define BUNDLE_TYPE_SCENE               1
 #define BUNDLE_TYPE_NODE                2
 #define BUNDLE_TYPE_ANIMATIONS          3
 #define BUNDLE_TYPE_ANIMATION           4
 #define BUNDLE_TYPE_ANIMATION_CHANNEL   5
+#define BUNDLE_TYPE_COMPRESSED_ANIMATIONS 6
 #define BUNDLE_TYPE_MODEL               10
 #define BUNDLE_TYPE_MATERIAL            16
 #define BUNDLE_TYPE_EFFECT              18
@@ -45,6 +56,7 @@ THE SOFTWARE.
 #define BUNDLE_TYPE_MESH                34
 #define BUNDLE_TYPE_MESHPART            35
 #define BUNDLE_TYPE_MESHSKIN            36
+#define BUNDLE_TYPE_MAPPED_MESH         37
 
 static const char* VERSION = "version";
 static const char* ID = "id";
@@ -91,6 +103,44 @@ static const char* AABBS = "aabb";
 
 NS_CC_BEGIN
 
+namespace
+{
+    // meshes of a mapped mesh record are uploaded from the file, so it is mapped rather than read where possible
+    std::shared_ptr<const unsigned char> mapBundleFile(const std::string& path, ssize_t* size)
+    {
+#if CC_BUNDLE3D_USE_MMAP
+        // files packed in an archive, such as the assets of an apk, can't be opened this way
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd >= 0)
+        {
+            struct stat st;
+            void* mapped = MAP_FAILED;
+            if (fstat(fd, &st) == 0 && st.st_size > 0)
+                mapped = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+            close(fd);
+            if (mapped != MAP_FAILED)
+            {
+                *size = static_cast<ssize_t>(st.st_size);
+                size_t length = static_cast<size_t>(st.st_size);
+                return std::shared_ptr<const unsigned char>(static_cast<const unsigned char*>(mapped), [length](const unsigned char* bytes) {
+                    munmap(const_cast<unsigned char*>(bytes), length);
+                });
+            }
+        }
+#endif
+        auto data = new (std::nothrow) Data(FileUtils::getInstance()->getDataFromFile(path));
+        if (data == nullptr || data->isNull())
+        {
+            delete data;
+            return nullptr;
+        }
+        *size = data->getSize();
+        return std::shared_ptr<const unsigned char>(data->getBytes(), [data](const unsigned char*) {
+            delete data;
+        });
+    }
+}
+
 void getChildMap(std::map<int, std::vector<int> >& map, SkinData* skinData, const rapidjson::Value& val)
 {
     if (!skinData)
@@ -162,13 +212,15 @@ void Bundle3D::clear()
 {
     if (_isBinary)
     {
-        _binaryBuffer.clear();
+        _binaryBuffer.reset();
+        _binarySize = 0;
         CC_SAFE_DELETE_ARRAY(_references);
     }
     else
     {
         _jsonBuffer.clear();
     }
+    _meshOffsets.clear();
 }
 
 bool Bundle3D::load(const std::string& path)
@@ -365,6 +417,12 @@ bool Bundle3D::loadMeshDatas(MeshDatas& meshdatas)
     meshdatas.resetData();
     if (_isBinary)
     {
+        // meshes laid out for the GPU by tools/c3b-model-converter
+        if (seekToFirstType(BUNDLE_TYPE_MAPPED_MESH))
+        {
+            return loadMappedMeshDatasBinary(meshdatas);
+        }
+        
         if (_version == "0.1" || _version == "0.2")
         {
             return loadMeshDatasBinary_0_1(meshdatas);
@@ -397,104 +455,275 @@ bool  Bundle3D::loadMeshDatasBinary(MeshDatas& meshdatas)
         CCLOG("warning: Failed to read meshdata: attribCount '%s'.", _path.c_str());
         return false;
     }
-    MeshData*   meshData = nullptr;
     for(unsigned int i = 0; i < meshSize ; ++i)
     {
-         unsigned int attribSize=0;
-        // read mesh data
-        if (_binaryReader.read(&attribSize, 4, 1) != 1 || attribSize < 1)
+        MeshData* meshData = new (std::nothrow) MeshData();
+        meshdatas.meshDatas.push_back(meshData);
+        if (!parseMeshDataBinary(_binaryReader, meshData))
         {
-            CCLOG("warning: Failed to read meshdata: attribCount '%s'.", _path.c_str());
-            goto FAILED;
+            meshdatas.resetData();
+            return false;
         }
-        meshData = new (std::nothrow) MeshData();
-        meshData->attribCount = attribSize;
-        meshData->attribs.resize(meshData->attribCount);
-        for (ssize_t j = 0; j < meshData->attribCount; ++j)
+    }
+    return true;
+}
+
+bool Bundle3D::parseMeshDataBinary(BundleReader& reader, MeshData* meshData)
+{
+    unsigned int attribSize=0;
+    // read mesh data
+    if (reader.read(&attribSize, 4, 1) != 1 || attribSize < 1)
+    {
+        CCLOG("warning: Failed to read meshdata: attribCount '%s'.", _path.c_str());
+        return false;
+    }
+    meshData->attribCount = attribSize;
+    meshData->attribs.resize(meshData->attribCount);
+    for (ssize_t j = 0; j < meshData->attribCount; ++j)
+    {
+        std::string attribute="";
+        unsigned int vSize;
+        if (reader.read(&vSize, 4, 1) != 1)
         {
-            std::string attribute="";
-            unsigned int vSize;
-            if (_binaryReader.read(&vSize, 4, 1) != 1)
+            CCLOG("warning: Failed to read meshdata: usage or size '%s'.", _path.c_str());
+            return false;
+        }
+        std::string type = reader.readString();
+        attribute=reader.readString();
+        meshData->attribs[j].size = vSize;
+        meshData->attribs[j].attribSizeBytes = meshData->attribs[j].size * 4;
+        meshData->attribs[j].type =  parseGLType(type);
+        meshData->attribs[j].vertexAttrib = parseGLProgramAttribute(attribute);
+    }
+    unsigned int vertexSizeInFloat = 0;
+    // Read vertex data
+    if (reader.read(&vertexSizeInFloat, 4, 1) != 1 || vertexSizeInFloat == 0)
+    {
+        CCLOG("warning: Failed to read meshdata: vertexSizeInFloat '%s'.", _path.c_str());
+        return false;
+    }
+    meshData->vertex.resize(vertexSizeInFloat);
+    if (reader.read(&meshData->vertex[0], 4, vertexSizeInFloat) != vertexSizeInFloat)
+    {
+        CCLOG("warning: Failed to read meshdata: vertex element '%s'.", _path.c_str());
+        return false;
+    }
+    // Read index data
+    unsigned int meshPartCount = 1;
+    reader.read(&meshPartCount, 4, 1);
+    for (unsigned int k = 0; k < meshPartCount; ++k)
+    {
+        std::vector<unsigned short>      indexArray;
+        std:: string meshPartid = reader.readString();
+        meshData->subMeshIds.push_back(meshPartid);
+        unsigned int nIndexCount;
+        if (reader.read(&nIndexCount, 4, 1) != 1)
+        {
+            CCLOG("warning: Failed to read meshdata: nIndexCount '%s'.", _path.c_str());
+            return false;
+        }
+        indexArray.resize(nIndexCount);
+        if (reader.read(&indexArray[0], 2, nIndexCount) != nIndexCount)
+        {
+            CCLOG("warning: Failed to read meshdata: indices '%s'.", _path.c_str());
+            return false;
+        }
+        meshData->subMeshIndices.push_back(indexArray);
+        meshData->numIndex = (int)meshData->subMeshIndices.size();
+        //meshData->subMeshAABB.push_back(calculateAABB(meshData->vertex, meshData->getPerVertexSize(), indexArray));
+        if (_version != "0.3" && _version != "0.4" && _version != "0.5")
+        {
+            //read mesh aabb
+            float aabb[6];
+            if (reader.read(aabb, 4, 6) != 6)
             {
-                CCLOG("warning: Failed to read meshdata: usage or size '%s'.", _path.c_str());
-                goto FAILED;
+                CCLOG("warning: Failed to read meshdata: aabb '%s'.", _path.c_str());
+                return false;
             }
-            std::string type = _binaryReader.readString();
-            attribute=_binaryReader.readString();
-            meshData->attribs[j].size = vSize;
-            meshData->attribs[j].attribSizeBytes = meshData->attribs[j].size * 4;
-            meshData->attribs[j].type =  parseGLType(type);
-            meshData->attribs[j].vertexAttrib = parseGLProgramAttribute(attribute);
+            meshData->subMeshAABB.push_back(AABB(Vec3(aabb[0], aabb[1], aabb[2]), Vec3(aabb[3], aabb[4], aabb[5])));
         }
-        unsigned int vertexSizeInFloat = 0;
-        // Read vertex data
-        if (_binaryReader.read(&vertexSizeInFloat, 4, 1) != 1 || vertexSizeInFloat == 0)
+        else
         {
-            CCLOG("warning: Failed to read meshdata: vertexSizeInFloat '%s'.", _path.c_str());
-            goto FAILED;
+            meshData->subMeshAABB.push_back(calculateAABB(meshData->vertex, meshData->getPerVertexSize(), indexArray));
         }
+    }
+    return true;
+}
 
-        meshData->vertex.resize(vertexSizeInFloat);
-        if (_binaryReader.read(&meshData->vertex[0], 4, vertexSizeInFloat) != vertexSizeInFloat)
+bool Bundle3D::loadMappedMeshDatasBinary(MeshDatas& meshdatas)
+{
+    size_t recordOffset = (size_t)_binaryReader.tell();
+    unsigned int meshSize = 0;
+    if (_binaryReader.read(&meshSize, 4, 1) != 1)
+    {
+        CCLOG("warning: Failed to read mapped meshdata: meshSize '%s'.", _path.c_str());
+        return false;
+    }
+    
+    for (unsigned int i = 0; i < meshSize; ++i)
+    {
+        MeshData* meshData = new (std::nothrow) MeshData();
+        meshdatas.meshDatas.push_back(meshData);
+        if (!parseMappedMeshDataBinary(_binaryReader, recordOffset, meshData))
         {
-            CCLOG("warning: Failed to read meshdata: vertex element '%s'.", _path.c_str());
-            goto FAILED;
+            meshdatas.resetData();
+            return false;
         }
+    }
+    return true;
+}
 
-        // Read index data
-        unsigned int meshPartCount = 1;
-        _binaryReader.read(&meshPartCount, 4, 1);
+bool Bundle3D::parseMappedMeshDataBinary(BundleReader& reader, size_t recordOffset, MeshData* meshData)
+{
+    // vertices and indices stay in the file, at offsets from the start of the record
+    auto isInFile = [this, recordOffset](unsigned int offset, size_t size) {
+        return recordOffset + offset <= (size_t)_binarySize && size <= (size_t)_binarySize - recordOffset - offset;
+    };
+    // the converter aligns them to 16 bytes, a moved record may only keep 4, less can't be read as floats
+    auto isAligned = [recordOffset](unsigned int offset) {
+        return (recordOffset + offset) % 4 == 0;
+    };
+    meshData->mapping = _binaryBuffer;
+    
+    unsigned int attribSize = 0;
+    if (reader.read(&attribSize, 4, 1) != 1 || attribSize < 1)
+    {
+        CCLOG("warning: Failed to read mapped meshdata: attribCount '%s'.", _path.c_str());
+        return false;
+    }
+    meshData->attribCount = attribSize;
+    meshData->attribs.resize(attribSize);
+    for (auto& attrib : meshData->attribs)
+    {
+        unsigned int vSize = 0;
+        if (reader.read(&vSize, 4, 1) != 1)
+        {
+            CCLOG("warning: Failed to read mapped meshdata: usage or size '%s'.", _path.c_str());
+            return false;
+        }
+        attrib.size = vSize;
+        attrib.attribSizeBytes = vSize * 4;
+        attrib.type = parseGLType(reader.readString());
+        attrib.vertexAttrib = parseGLProgramAttribute(reader.readString());
+    }
+    
+    unsigned int vertexSizeInFloat = 0, vertexOffset = 0;
+    if (reader.read(&vertexSizeInFloat, 4, 1) != 1 || reader.read(&vertexOffset, 4, 1) != 1 ||
+        vertexSizeInFloat == 0 || !isAligned(vertexOffset) || !isInFile(vertexOffset, vertexSizeInFloat * sizeof(float)))
+    {
+        CCLOG("warning: Failed to read mapped meshdata: vertices '%s'.", _path.c_str());
+        return false;
+    }
+    meshData->vertexSizeInFloat = vertexSizeInFloat;
+    meshData->mappedVertex = reinterpret_cast<const float*>(_binaryBuffer.get() + recordOffset + vertexOffset);
+    
+    unsigned int meshPartCount = 0;
+    if (reader.read(&meshPartCount, 4, 1) != 1)
+    {
+        CCLOG("warning: Failed to read mapped meshdata: meshPartCount '%s'.", _path.c_str());
+        return false;
+    }
+    for (unsigned int k = 0; k < meshPartCount; ++k)
+    {
+        meshData->subMeshIds.push_back(reader.readString());
+        unsigned int indexCount = 0, indexOffset = 0;
+        float aabb[6];
+        if (reader.read(&indexCount, 4, 1) != 1 || reader.read(&indexOffset, 4, 1) != 1 ||
+            !isAligned(indexOffset) || !isInFile(indexOffset, indexCount * sizeof(unsigned short)) || reader.read(aabb, 4, 6) != 6)
+        {
+            CCLOG("warning: Failed to read mapped meshdata: indices '%s'.", _path.c_str());
+            return false;
+        }
+        meshData->mappedIndices.push_back(reinterpret_cast<const unsigned short*>(_binaryBuffer.get() + recordOffset + indexOffset));
+        meshData->mappedIndexCounts.push_back(indexCount);
+        meshData->subMeshAABB.push_back(AABB(Vec3(aabb[0], aabb[1], aabb[2]), Vec3(aabb[3], aabb[4], aabb[5])));
+    }
+    meshData->numIndex = (int)meshPartCount;
+    return true;
+}
 
-        for (unsigned int k = 0; k < meshPartCount; ++k)
+int Bundle3D::prepareMeshDatas()
+{
+    _meshOffsets.clear();
+    if (!_isBinary)
+    {
+        if (_version == "1.2" || _version == "0.2" || !_jsonReader.HasMember(MESHES))
+            return -1;
+        return (int)_jsonReader[MESHES].Size();
+    }
+    if (_version == "0.1" || _version == "0.2")
+        return -1;
+    
+    // walk the records without reading the vertices and indices, each mesh is parsed on its own later
+    _mappedMeshes = (seekToFirstType(BUNDLE_TYPE_MAPPED_MESH) != nullptr);
+    if (!_mappedMeshes && !seekToFirstType(BUNDLE_TYPE_MESH))
+        return -1;
+    _meshRecordOffset = (size_t)_binaryReader.tell();
+    bool hasAABB = _mappedMeshes || (_version != "0.3" && _version != "0.4" && _version != "0.5");
+    
+    unsigned int meshSize = 0;
+    if (_binaryReader.read(&meshSize, 4, 1) != 1)
+        return -1;
+    for (unsigned int i = 0; i < meshSize; ++i)
+    {
+        _meshOffsets.push_back((size_t)_binaryReader.tell());
+        unsigned int attribSize = 0;
+        if (_binaryReader.read(&attribSize, 4, 1) != 1)
+            goto FAILED;
+        for (unsigned int j = 0; j < attribSize; ++j)
         {
-            std::vector<unsigned short>      indexArray;
-            std:: string meshPartid = _binaryReader.readString();
-            meshData->subMeshIds.push_back(meshPartid);
-            unsigned int nIndexCount;
-            if (_binaryReader.read(&nIndexCount, 4, 1) != 1)
-            {
-                CCLOG("warning: Failed to read meshdata: nIndexCount '%s'.", _path.c_str());
+            unsigned int vSize = 0;
+            if (_binaryReader.read(&vSize, 4, 1) != 1)
                 goto FAILED;
-            }
-            indexArray.resize(nIndexCount);
-            if (_binaryReader.read(&indexArray[0], 2, nIndexCount) != nIndexCount)
-            {
-                CCLOG("warning: Failed to read meshdata: indices '%s'.", _path.c_str());
+            _binaryReader.readString();
+            _binaryReader.readString();
+        }
+        unsigned int vertexSizeInFloat = 0;
+        if (_binaryReader.read(&vertexSizeInFloat, 4, 1) != 1 ||
+            !_binaryReader.seek(_mappedMeshes ? 4 : (long)vertexSizeInFloat * 4, SEEK_CUR))
+            goto FAILED;
+        unsigned int meshPartCount = 0;
+        if (_binaryReader.read(&meshPartCount, 4, 1) != 1)
+            goto FAILED;
+        for (unsigned int k = 0; k < meshPartCount; ++k)
+        {
+            _binaryReader.readString();
+            unsigned int indexCount = 0;
+            if (_binaryReader.read(&indexCount, 4, 1) != 1 ||
+                !_binaryReader.seek((_mappedMeshes ? 4 : (long)indexCount * 2) + (hasAABB ? 24 : 0), SEEK_CUR))
                 goto FAILED;
-            }
-            meshData->subMeshIndices.push_back(indexArray);
-            meshData->numIndex = (int)meshData->subMeshIndices.size();
-            //meshData->subMeshAABB.push_back(calculateAABB(meshData->vertex, meshData->getPerVertexSize(), indexArray));
-            if (_version != "0.3" && _version != "0.4" && _version != "0.5")
-            {
-                //read mesh aabb
-                float aabb[6];
-                if (_binaryReader.read(aabb, 4, 6) != 6)
-                {
-                    CCLOG("warning: Failed to read meshdata: aabb '%s'.", _path.c_str());
-                    goto FAILED;
-                }
-                meshData->subMeshAABB.push_back(AABB(Vec3(aabb[0], aabb[1], aabb[2]), Vec3(aabb[3], aabb[4], aabb[5])));
-            }
-            else
-            {
-                meshData->subMeshAABB.push_back(calculateAABB(meshData->vertex, meshData->getPerVertexSize(), indexArray));
-            }
         }
-        meshdatas.meshDatas.push_back(meshData);
     }
-    return true;
+    return (int)meshSize;
     
 FAILED:
+    CCLOG("warning: Failed to split meshdata '%s'.", _path.c_str());
+    _meshOffsets.clear();
+    return -1;
+}
+
+bool Bundle3D::loadMeshData(int index, MeshData* meshdata)
+{
+    meshdata->resetData();
+    if (!_isBinary)
     {
-        CC_SAFE_DELETE(meshData);
-        for (auto& meshdata : meshdatas.meshDatas) {
-            delete meshdata;
-        }
-        meshdatas.meshDatas.clear();
-        return false;
+        const rapidjson::Value& mesh_data_array = _jsonReader[MESHES];
+        if (index < 0 || index >= (int)mesh_data_array.Size())
+            return false;
+        return parseMeshDataJson(mesh_data_array[(rapidjson::SizeType)index], meshdata);
     }
+    if (index < 0 || index >= (int)_meshOffsets.size())
+        return false;
+    
+    // a reader of its own, so meshes can be parsed on several threads at once
+    BundleReader reader;
+    reader.init((char*)_binaryBuffer.get(), _binarySize);
+    reader.seek((long)_meshOffsets[index], SEEK_SET);
+    if (_mappedMeshes)
+        return parseMappedMeshDataBinary(reader, _meshRecordOffset, meshdata);
+    return parseMeshDataBinary(reader, meshdata);
 }
+
 bool Bundle3D::loadMeshDatasBinary_0_1(MeshDatas& meshdatas)
 {
     if (!seekToFirstType(BUNDLE_TYPE_MESH))
@@ -738,74 +967,79 @@ bool  Bundle3D::loadMeshDatasJson(MeshDatas& meshdatas)
     for (rapidjson::SizeType index = 0, mesh_data_array_size = mesh_data_array.Size(); index < mesh_data_array_size; ++index)
     {
         MeshData*   meshData = new (std::nothrow) MeshData();
-        const rapidjson::Value& mesh_data = mesh_data_array[index];
-        // mesh_vertex_attribute
-        const rapidjson::Value& mesh_vertex_attribute = mesh_data[ATTRIBUTES];
-        MeshVertexAttrib tempAttrib;
-        meshData->attribCount=mesh_vertex_attribute.Size();
-        meshData->attribs.resize(meshData->attribCount);
-        for (rapidjson::SizeType i = 0, mesh_vertex_attribute_size = mesh_vertex_attribute.Size(); i < mesh_vertex_attribute_size; ++i)
-        {
-            const rapidjson::Value& mesh_vertex_attribute_val = mesh_vertex_attribute[i];
-
-            int size = mesh_vertex_attribute_val[ATTRIBUTESIZE].GetInt();
-            std::string type = mesh_vertex_attribute_val[TYPE].GetString();
-            std::string attribute = mesh_vertex_attribute_val[ATTRIBUTE].GetString();
-
-            tempAttrib.size = size;
-            tempAttrib.attribSizeBytes = sizeof(float) * size;
-            tempAttrib.type = parseGLType(type);
-            tempAttrib.vertexAttrib = parseGLProgramAttribute(attribute);
-            meshData->attribs[i]=tempAttrib;
-        }
-        // mesh vertices
-        ////////////////////////////////////////////////////////////////////////////////////////////////
-        const rapidjson::Value& mesh_data_vertex_array = mesh_data[VERTICES];
-        auto mesh_data_vertex_array_size = mesh_data_vertex_array.Size();
-        meshData->vertexSizeInFloat = mesh_data_vertex_array_size;
-        for (rapidjson::SizeType i = 0; i < mesh_data_vertex_array_size; ++i)
-        {
-            meshData->vertex.push_back(mesh_data_vertex_array[i].GetDouble());
-        }
-        // mesh part
-        ////////////////////////////////////////////////////////////////////////////////////////////////
-        const rapidjson::Value& mesh_part_array = mesh_data[PARTS];
-        for (rapidjson::SizeType i = 0, mesh_part_array_size = mesh_part_array.Size(); i < mesh_part_array_size; ++i)
-        {
-            std::vector<unsigned short>      indexArray;
-            const rapidjson::Value& mesh_part = mesh_part_array[i];
-            meshData->subMeshIds.push_back(mesh_part[ID].GetString());
-            // index_number
-            const rapidjson::Value& indices_val_array = mesh_part[INDICES];
-            for (rapidjson::SizeType j = 0, indices_val_array_size = indices_val_array.Size(); j < indices_val_array_size; ++j)
-                indexArray.push_back((unsigned short)indices_val_array[j].GetUint());
-
-            meshData->subMeshIndices.push_back(indexArray);
-            meshData->numIndex = (int)meshData->subMeshIndices.size();
-
-            if(mesh_data.HasMember(AABBS))
+        parseMeshDataJson(mesh_data_array[index], meshData);
+        meshdatas.meshDatas.push_back(meshData);
+    }
+    return true;
+}
+
+bool Bundle3D::parseMeshDataJson(const rapidjson::Value& mesh_data, MeshData* meshData)
+{
+    // mesh_vertex_attribute
+    const rapidjson::Value& mesh_vertex_attribute = mesh_data[ATTRIBUTES];
+    MeshVertexAttrib tempAttrib;
+    meshData->attribCount=mesh_vertex_attribute.Size();
+    meshData->attribs.resize(meshData->attribCount);
+    for (rapidjson::SizeType i = 0, mesh_vertex_attribute_size = mesh_vertex_attribute.Size(); i < mesh_vertex_attribute_size; ++i)
+    {
+        const rapidjson::Value& mesh_vertex_attribute_val = mesh_vertex_attribute[i];
+
+        int size = mesh_vertex_attribute_val[ATTRIBUTESIZE].GetInt();
+        std::string type = mesh_vertex_attribute_val[TYPE].GetString();
+        std::string attribute = mesh_vertex_attribute_val[ATTRIBUTE].GetString();
+
+        tempAttrib.size = size;
+        tempAttrib.attribSizeBytes = sizeof(float) * size;
+        tempAttrib.type = parseGLType(type);
+        tempAttrib.vertexAttrib = parseGLProgramAttribute(attribute);
+        meshData->attribs[i]=tempAttrib;
+    }
+    // mesh vertices
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    const rapidjson::Value& mesh_data_vertex_array = mesh_data[VERTICES];
+    auto mesh_data_vertex_array_size = mesh_data_vertex_array.Size();
+    meshData->vertexSizeInFloat = mesh_data_vertex_array_size;
+    for (rapidjson::SizeType i = 0; i < mesh_data_vertex_array_size; ++i)
+    {
+        meshData->vertex.push_back(mesh_data_vertex_array[i].GetDouble());
+    }
+    // mesh part
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    const rapidjson::Value& mesh_part_array = mesh_data[PARTS];
+    for (rapidjson::SizeType i = 0, mesh_part_array_size = mesh_part_array.Size(); i < mesh_part_array_size; ++i)
+    {
+        std::vector<unsigned short>      indexArray;
+        const rapidjson::Value& mesh_part = mesh_part_array[i];
+        meshData->subMeshIds.push_back(mesh_part[ID].GetString());
+        // index_number
+        const rapidjson::Value& indices_val_array = mesh_part[INDICES];
+        for (rapidjson::SizeType j = 0, indices_val_array_size = indices_val_array.Size(); j < indices_val_array_size; ++j)
+            indexArray.push_back((unsigned short)indices_val_array[j].GetUint());
+
+        meshData->subMeshIndices.push_back(indexArray);
+        meshData->numIndex = (int)meshData->subMeshIndices.size();
+
+        if(mesh_data.HasMember(AABBS))
+        {
+            const rapidjson::Value& mesh_part_aabb = mesh_part[AABBS];
+            if (mesh_part.HasMember(AABBS) && mesh_part_aabb.Size() == 6)
             {
-                const rapidjson::Value& mesh_part_aabb = mesh_part[AABBS];
-                if (mesh_part.HasMember(AABBS) && mesh_part_aabb.Size() == 6)
-                {
-                    Vec3 min(mesh_part_aabb[(rapidjson::SizeType)0].GetDouble(),
-                             mesh_part_aabb[(rapidjson::SizeType)1].GetDouble(), mesh_part_aabb[(rapidjson::SizeType)2].GetDouble());
-                    Vec3 max(mesh_part_aabb[(rapidjson::SizeType)3].GetDouble(),
-                             mesh_part_aabb[(rapidjson::SizeType)4].GetDouble(), mesh_part_aabb[(rapidjson::SizeType)5].GetDouble());
-                    meshData->subMeshAABB.push_back(AABB(min, max));
-                }
-                else
-                {
-                    meshData->subMeshAABB.push_back(calculateAABB(meshData->vertex, meshData->getPerVertexSize(), indexArray));
-                }
+                Vec3 min(mesh_part_aabb[(rapidjson::SizeType)0].GetDouble(),
+                         mesh_part_aabb[(rapidjson::SizeType)1].GetDouble(), mesh_part_aabb[(rapidjson::SizeType)2].GetDouble());
+                Vec3 max(mesh_part_aabb[(rapidjson::SizeType)3].GetDouble(),
+                         mesh_part_aabb[(rapidjson::SizeType)4].GetDouble(), mesh_part_aabb[(rapidjson::SizeType)5].GetDouble());
+                meshData->subMeshAABB.push_back(AABB(min, max));
             }
             else
             {
                 meshData->subMeshAABB.push_back(calculateAABB(meshData->vertex, meshData->getPerVertexSize(), indexArray));
             }
-           
         }
-        meshdatas.meshDatas.push_back(meshData);
+        else
+        {
+            meshData->subMeshAABB.push_back(calculateAABB(meshData->vertex, meshData->getPerVertexSize(), indexArray));
+        }
+       
     }
     return true;
 }
@@ -1080,17 +1314,16 @@ bool Bundle3D::loadBinary(const std::string& path)
     clear();
     
     // get file data
-    _binaryBuffer.clear();
-    _binaryBuffer = FileUtils::getInstance()->getDataFromFile(path);
-    if (_binaryBuffer.isNull())
+    _binaryBuffer = mapBundleFile(path, &_binarySize);
+    if (!_binaryBuffer)
     {
         clear();
         CCLOG("warning: Failed to read file: %s", path.c_str());
         return false;
     }
     
-    // Initialise bundle reader
-    _binaryReader.init( (char*)_binaryBuffer.getBytes(),  _binaryBuffer.getSize() );
+    // Initialise bundle reader, it only reads from the buffer
+    _binaryReader.init( (char*)_binaryBuffer.get(),  _binarySize );
     
     // Read identifier info
     char identifier[] = { 'C', '3', 'B', '\0'};
@@ -1534,7 +1767,12 @@ bool Bundle3D::loadAnimationDataJson(const std::string& id, Animation3DData* ani
 
 bool Bundle3D::loadAnimationDataBinary(const std::string& id, Animation3DData* animationdata)
 {
- 
+    // animations rewritten by tools/c3b-animation-compressor, one per reference whatever the version
+    std::string compressedId = id;
+    if (id != "") compressedId = id + "animation";
+    if (seekToFirstType(BUNDLE_TYPE_COMPRESSED_ANIMATIONS, compressedId))
+        return loadCompressedAnimationDataBinary(animationdata);
+
     if( _version == "0.1"|| _version == "0.2" || _version == "0.3"|| _version == "0.4")
     {
         if (!seekToFirstType(BUNDLE_TYPE_ANIMATIONS))
@@ -1676,6 +1914,59 @@ bool Bundle3D::loadAnimationDataBinary(const std::string& id, Animation3DData* a
     return true;
 }
 
+bool Bundle3D::loadCompressedAnimationDataBinary(Animation3DData* animationdata)
+{
+    animationdata->resetData();
+    _binaryReader.readString(); // animation id
+
+    unsigned int boneNum = 0;
+    if (!_binaryReader.read(&animationdata->_totalTime) || !_binaryReader.read(&boneNum))
+    {
+        CCLOG("warning: Failed to read compressed AnimationData: header '%s'.", _path.c_str());
+        return false;
+    }
+
+    auto readCurve = [this](Animation3DData::QuantizedCurve& curve, ssize_t componentCount) {
+        unsigned int keyNum = 0;
+        if (!_binaryReader.read(&curve._startTime) || !_binaryReader.read(&curve._interval) || !_binaryReader.read(&keyNum) || keyNum == 0)
+            return false;
+        // offsets and scales as floats, then the values as 16 bits, all of them must be in the file
+        uint64_t byteCount = (uint64_t)componentCount * sizeof(float) * 2 + (uint64_t)keyNum * componentCount * sizeof(uint16_t);
+        if (byteCount > (uint64_t)(_binaryReader.length() - _binaryReader.tell()))
+            return false;
+        curve._offset.resize(componentCount);
+        curve._scale.resize(componentCount);
+        curve._values.resize(keyNum * componentCount);
+        ssize_t valueNum = curve._values.size();
+        return _binaryReader.read(&curve._offset[0], 4, componentCount) == componentCount
+            && _binaryReader.read(&curve._scale[0], 4, componentCount) == componentCount
+            && _binaryReader.read(&curve._values[0], 2, valueNum) == valueNum;
+    };
+
+    for (unsigned int i = 0; i < boneNum; ++i)
+    {
+        std::string boneName = _binaryReader.readString();
+
+        // same bits as the transform flag of a key frame
+        unsigned char transformFlag = 0;
+        if (!_binaryReader.read(&transformFlag))
+        {
+            CCLOG("warning: Failed to read compressed AnimationData: transformFlag '%s'.", _path.c_str());
+            animationdata->resetData();
+            return false;
+        }
+
+        if (((transformFlag & 0x01) && !readCurve(animationdata->_quantizedRotations[boneName], 4)) ||
+            (((transformFlag >> 1) & 0x01) && !readCurve(animationdata->_quantizedScales[boneName], 3)) ||
+            (((transformFlag >> 2) & 0x01) && !readCurve(animationdata->_quantizedTranslations[boneName], 3)))
+        {
+            CCLOG("warning: Failed to read compressed AnimationData: curve of '%s' in '%s'.", boneName.c_str(), _path.c_str());
+            animationdata->resetData();
+            return false;
+        }
+    }
+    return true;
+}
 
 bool Bundle3D::loadNodesJson(NodeDatas& nodedatas)
 {
@@ -2210,9 +2501,12 @@ std::vector<Vec3> Bundle3D::getTrianglesList(const std::string& path)
     Bundle3D::destroyBundle(bundle);
     for (auto iter : meshs.meshDatas){
         int preVertexSize = iter->getPerVertexSize() / sizeof(float);
-        for (const auto& indexArray : iter->subMeshIndices){
-            for (auto i : indexArray){
-                trianglesList.push_back(Vec3(iter->vertex[i * preVertexSize], iter->vertex[i * preVertexSize + 1], iter->vertex[i * preVertexSize + 2]));
+        auto vertices = iter->getVertices();
+        for (ssize_t part = 0, partCount = iter->getSubMeshCount(); part < partCount; ++part){
+            auto indices = iter->getSubMeshIndices(part);
+            for (ssize_t j = 0, count = iter->getSubMeshIndexCount(part); j < count; ++j){
+                auto i = indices[j];
+                trianglesList.push_back(Vec3(vertices[i * preVertexSize], vertices[i * preVertexSize + 1], vertices[i * preVertexSize + 2]));
             }
         }
     }
@@ -2224,9 +2518,12 @@ Bundle3D::Bundle3D()
 : _modelPath(""),
 _path(""),
 _version(""),
+_binarySize(0),
 _referenceCount(0),
 _references(nullptr),
-_isBinary(false)
+_isBinary(false),
+_meshRecordOffset(0),
+_mappedMeshes(false)
 {
 
 }
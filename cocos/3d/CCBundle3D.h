@@ -26,6 +26,7 @@
 #ifndef __CCBUNDLE3D_H__
 #define __CCBUNDLE3D_H__
 
+#include <memory>
 #include "base/CCData.h"
 #include "3d/CCBundle3DData.h"
 #include "3d/CCBundleReader.h"
@@ -86,6 +87,23 @@ public:
     //since 3.3, to support reskin
     virtual bool loadMaterials(MaterialDatas& materialdatas);
     
+    /**
+     * Finds where every mesh of the loaded file starts, so they can be parsed one at a time with loadMeshData().
+     * Meshes of c3b and c3t files older than version 0.3 can only be loaded with loadMeshDatas().
+     * @return the number of meshes, -1 if they have to be loaded with loadMeshDatas()
+     * @since v3.18
+     */
+    int prepareMeshDatas();
+    
+    /**
+     * Parses one mesh found by prepareMeshDatas(). Different meshes can be parsed at once on several threads,
+     * while at most one other thread reads the rest of the bundle, with loadMaterials() for instance.
+     * @param index Index of the mesh, less than the count returned by prepareMeshDatas()
+     * @param meshdata Receives the mesh
+     * @since v3.18
+     */
+    bool loadMeshData(int index, MeshData* meshdata);
+    
     /**
      * load triangle list
      * @param path the file path to load
@@ -108,6 +126,10 @@ protected:
     bool loadMeshDatasBinary(MeshDatas& meshdatas);
     bool loadMeshDatasBinary_0_1(MeshDatas& meshdatas);
     bool loadMeshDatasBinary_0_2(MeshDatas& meshdatas);
+    bool loadMappedMeshDatasBinary(MeshDatas& meshdatas);
+    bool parseMeshDataJson(const rapidjson::Value& mesh_data, MeshData* meshData);
+    bool parseMeshDataBinary(BundleReader& reader, MeshData* meshData);
+    bool parseMappedMeshDataBinary(BundleReader& reader, size_t recordOffset, MeshData* meshData);
     bool loadMaterialsJson(MaterialDatas& materialdatas);
     bool loadMaterialDataJson_0_1(MaterialDatas& materialdatas);
     bool loadMaterialDataJson_0_2(MaterialDatas& materialdatas);
@@ -124,6 +146,7 @@ protected:
     bool loadMaterialDataJson_0_2(MaterialData* materialdata);
     bool loadAnimationDataJson(const std::string& id,Animation3DData* animationdata);
     bool loadAnimationDataBinary(const std::string& id,Animation3DData* animationdata);
+    bool loadCompressedAnimationDataBinary(Animation3DData* animationdata);
 
     /**
      * load nodes of json
@@ -181,12 +204,18 @@ protected:
     std::string _jsonBuffer;
     rapidjson::Document _jsonReader;
 
-    // for binary reading
-    Data _binaryBuffer;
+    // for binary reading, the file is mapped when the platform allows it and shared with the meshes of mapped mesh records
+    std::shared_ptr<const unsigned char> _binaryBuffer;
+    ssize_t _binarySize;
     BundleReader _binaryReader;
     unsigned int _referenceCount;
     Reference* _references;
     bool  _isBinary;
+    
+    // where the meshes start, found by prepareMeshDatas()
+    std::vector<size_t> _meshOffsets;
+    size_t _meshRecordOffset;
+    bool _mappedMeshes;
 };
 
 // end of 3d group
@@ -33,6 +33,7 @@
 
 #include <vector>
 #include <map>
+#include <memory>
  
 NS_CC_BEGIN
 
@@ -154,6 +155,13 @@ struct MeshData
     std::vector<MeshVertexAttrib> attribs;
     int attribCount;
 
+    // a mesh of a mapped mesh record points into the bundle file, which mapping keeps alive,
+    // instead of filling vertex and subMeshIndices (since 3.18)
+    std::shared_ptr<const unsigned char> mapping;
+    const float* mappedVertex;
+    std::vector<const unsigned short*> mappedIndices;
+    std::vector<unsigned int> mappedIndexCounts;
+
 public:
     /**
      * Get per vertex size
@@ -169,6 +177,40 @@ public:
         return vertexsize;
     }
 
+    /**
+     * Get the vertices, from vertex or from the mapped bundle file
+     * @since v3.18
+     */
+    const float* getVertices() const
+    {
+        if (mappedVertex)
+            return mappedVertex;
+        return vertex.empty() ? nullptr : &vertex[0];
+    }
+    ssize_t getVertexCountInFloat() const
+    {
+        return mappedVertex ? vertexSizeInFloat : (ssize_t)vertex.size();
+    }
+
+    /**
+     * Get the indices of a sub mesh, from subMeshIndices or from the mapped bundle file
+     * @since v3.18
+     */
+    ssize_t getSubMeshCount() const
+    {
+        return mappedVertex ? (ssize_t)mappedIndices.size() : (ssize_t)subMeshIndices.size();
+    }
+    const unsigned short* getSubMeshIndices(ssize_t index) const
+    {
+        if (mappedVertex)
+            return mappedIndices[index];
+        return subMeshIndices[index].empty() ? nullptr : &subMeshIndices[index][0];
+    }
+    ssize_t getSubMeshIndexCount(ssize_t index) const
+    {
+        return mappedVertex ? (ssize_t)mappedIndexCounts[index] : (ssize_t)subMeshIndices[index].size();
+    }
+
     /**
      * Reset the data
      */
@@ -181,11 +223,16 @@ public:
         vertexSizeInFloat = 0;
         numIndex = 0;
         attribCount = 0;
+        mapping.reset();
+        mappedVertex = nullptr;
+        mappedIndices.clear();
+        mappedIndexCounts.clear();
     }
     MeshData()
     : vertexSizeInFloat(0)
     , numIndex(0)
     , attribCount(0)
+    , mappedVertex(nullptr)
     {
     }
     ~MeshData()
@@ -403,12 +450,32 @@ public:
         float _time;
         Quaternion _key;
     };
+    
+    /**keys of a compressed c3b animation, evenly spaced and quantized to 16 bits*/
+    struct QuantizedCurve
+    {
+        QuantizedCurve()
+        : _startTime(0)
+        , _interval(0)
+        {
+        }
+        
+        float _startTime;
+        float _interval;
+        std::vector<float> _offset; //one per component, component i of a key is _offset[i] + value * _scale[i]
+        std::vector<float> _scale;
+        std::vector<unsigned short> _values;
+    };
 
 public:
     std::map<std::string, std::vector<Vec3Key>> _translationKeys;
     std::map<std::string, std::vector<QuatKey>> _rotationKeys;
     std::map<std::string, std::vector<Vec3Key>> _scaleKeys;
     
+    std::map<std::string, QuantizedCurve> _quantizedTranslations;
+    std::map<std::string, QuantizedCurve> _quantizedRotations;
+    std::map<std::string, QuantizedCurve> _quantizedScales;
+    
     float _totalTime;
 
 public:
@@ -421,6 +488,9 @@ public:
     : _translationKeys(other._translationKeys)
     , _rotationKeys(other._rotationKeys)
     , _scaleKeys(other._scaleKeys)
+    , _quantizedTranslations(other._quantizedTranslations)
+    , _quantizedRotations(other._quantizedRotations)
+    , _quantizedScales(other._quantizedScales)
     , _totalTime(other._totalTime)
     {
     }
@@ -431,6 +501,9 @@ public:
         _translationKeys.clear();
         _rotationKeys.clear();
         _scaleKeys.clear();
+        _quantizedTranslations.clear();
+        _quantizedRotations.clear();
+        _quantizedScales.clear();
     }
 };
 
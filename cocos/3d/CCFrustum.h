@@ -71,6 +71,22 @@ public:
      */
     void setClipZ(bool clipZ) { _clipZ = clipZ; }
     bool isClipZ() { return _clipZ; }
+
+    /**
+     * get a clip plane: left, right, bottom, top, near or far.
+     * @since v3.18
+     */
+    const Plane& getPlane(int index) const { return _plane[index]; }
+    /**
+     * get the number of clip planes used, 4 without z clip and 6 with it.
+     * @since v3.18
+     */
+    int getPlaneCount() const { return _clipZ ? 6 : 4; }
+    /**
+     * whether the planes have been created, a frustum that isn't initialized culls nothing.
+     * @since v3.18
+     */
+    bool isInitialized() const { return _initialized; }
     
 protected:
     /**
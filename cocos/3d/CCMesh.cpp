@@ -414,7 +414,7 @@ void Mesh::draw(Renderer* renderer, float globalZOrder, const Mat4& transform, u
         programState->setUniformVec4("u_color", color);
 
         if (_skin)
-            programState->setUniformVec4v("u_matrixPalette", (GLsizei)_skin->getMatrixPaletteSize(), _skin->getMatrixPalette());
+            setSkinUniforms(programState);
 
         if (scene && scene->getLights().size() > 0)
             setLightUniforms(pass, scene, color, lightMask);
@@ -423,6 +423,30 @@ void Mesh::draw(Renderer* renderer, float globalZOrder, const Mat4& transform, u
     renderer->addCommand(&_meshCommand);
 }
 
+void Mesh::setSkinUniforms(GLProgramState* programState)
+{
+    // the palette layout follows the uniforms the program declares, custom skinning shaders keep u_matrixPalette
+    auto glProgram = programState->getGLProgram();
+    if (glProgram->getUniform("u_matrixPalette"))
+    {
+        programState->setUniformVec4v("u_matrixPalette", (GLsizei)_skin->getMatrixPaletteSize(), _skin->getMatrixPalette());
+    }
+    else if (glProgram->getUniform("u_dualQuaternionPalette"))
+    {
+        programState->setUniformVec4v("u_dualQuaternionPalette", (GLsizei)_skin->getDualQuaternionPaletteSize(), _skin->getDualQuaternionPalette());
+    }
+    else
+    {
+        bool dualQuaternion = (glProgram->getUniform("u_dualQuaternionPaletteTexture") != nullptr);
+        if (dualQuaternion || glProgram->getUniform("u_matrixPaletteTexture"))
+        {
+            auto texture = _skin->getPaletteTexture(dualQuaternion);
+            programState->setUniformTexture(dualQuaternion ? "u_dualQuaternionPaletteTexture" : "u_matrixPaletteTexture", texture);
+            programState->setUniformVec2("u_paletteTextureSize", Vec2((float)texture->getPixelsWide(), (float)texture->getPixelsHigh()));
+        }
+    }
+}
+
 void Mesh::setSkin(MeshSkin* skin)
 {
     if (_skin != skin)
@@ -236,6 +236,7 @@ CC_CONSTRUCTOR_ACCESS:
 protected:
     void resetLightUniformValues();
     void setLightUniforms(Pass* pass, Scene* scene, const Vec4& color, unsigned int lightmask);
+    void setSkinUniforms(GLProgramState* programState);
     void bindMeshCommand();
 
     std::map<NTextureData::Usage, Texture2D*> _textures; //textures that submesh is using
@@ -26,22 +26,103 @@
 #include "3d/CCMeshSkin.h"
 #include "3d/CCBundle3D.h"
 #include "3d/CCSkeleton3D.h"
+#include "base/CCDirector.h"
+#include "base/CCEventDispatcher.h"
+#include "base/CCEventType.h"
+#include "renderer/CCTexture2D.h"
+#include "renderer/ccGLStateCache.h"
 
 NS_CC_BEGIN
 
 static int PALETTE_ROWS = 3;
+static int DUAL_QUATERNION_PALETTE_ROWS = 2;
+
+namespace
+{
+    // RGBA float texture with one palette row per texel, sampled with GL_NEAREST by the skinning shaders
+    class BonePaletteTexture : public Texture2D
+    {
+    public:
+        void update(const Vec4* rows, int rowsPerBone, int boneCount)
+        {
+            bool allocate = (_name == 0 || _pixelsWide != rowsPerBone || _pixelsHigh != boneCount);
+            if (_name == 0)
+            {
+                glGenTextures(1, &_name);
+                GL::bindTexture2D(_name);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            }
+            else
+            {
+                GL::bindTexture2D(_name);
+            }
+
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            if (allocate)
+            {
+#ifdef GL_RGBA32F_ARB
+                // desktop GL clamps GL_RGBA to [0, 1] whatever the type of the data
+                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F_ARB, rowsPerBone, boneCount, 0, GL_RGBA, GL_FLOAT, rows);
+#else
+                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, rowsPerBone, boneCount, 0, GL_RGBA, GL_FLOAT, rows);
+#endif
+                _pixelsWide = rowsPerBone;
+                _pixelsHigh = boneCount;
+                _contentSize.setSize((float)rowsPerBone, (float)boneCount);
+                _maxS = 1.0f;
+                _maxT = 1.0f;
+            }
+            else
+            {
+                glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, rowsPerBone, boneCount, GL_RGBA, GL_FLOAT, rows);
+            }
+            CHECK_GL_ERROR_DEBUG();
+        }
+
+        // the GL context was lost along with the texture, don't delete its name
+        void forgetGLTexture()
+        {
+            _name = 0;
+        }
+    };
+}
 
 MeshSkin::MeshSkin()
 : _rootBone(nullptr)
 , _skeleton(nullptr)
 , _matrixPalette(nullptr)
+, _dualQuaternionPalette(nullptr)
+, _matrixPaletteVersion(0)
+, _dualQuaternionPaletteVersion(0)
+, _matrixPaletteTextureVersion(0)
+, _dualQuaternionPaletteTextureVersion(0)
+, _matrixPaletteTexture(nullptr)
+, _dualQuaternionPaletteTexture(nullptr)
 {
-    
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    _rendererRecreatedListener = Director::getInstance()->getEventDispatcher()->addCustomEventListener(EVENT_RENDERER_RECREATED, [this](EventCustom*)
+    {
+        if (_matrixPaletteTexture)
+            static_cast<BonePaletteTexture*>(_matrixPaletteTexture)->forgetGLTexture();
+        if (_dualQuaternionPaletteTexture)
+            static_cast<BonePaletteTexture*>(_dualQuaternionPaletteTexture)->forgetGLTexture();
+        _matrixPaletteTextureVersion = 0;
+        _dualQuaternionPaletteTextureVersion = 0;
+    });
+#endif
 }
 
 MeshSkin::~MeshSkin()
 {
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    Director::getInstance()->getEventDispatcher()->removeEventListener(_rendererRecreatedListener);
+#endif
     removeAllBones();
+    CC_SAFE_RELEASE(_matrixPaletteTexture);
+    CC_SAFE_RELEASE(_dualQuaternionPaletteTexture);
     CC_SAFE_RELEASE(_skeleton);
 }
 
@@ -104,16 +185,20 @@ Vec4* MeshSkin::getMatrixPalette()
     if (_matrixPalette == nullptr)
     {
         _matrixPalette = new (std::nothrow) Vec4[_skinBones.size() * PALETTE_ROWS];
+        _matrixPaletteVersion = 0;
     }
+    if (_matrixPaletteVersion != 0 && _matrixPaletteVersion == _skeleton->getBoneMatrixVersion())
+        return _matrixPalette;
+    
     int i = 0, paletteIndex = 0;
-    static Mat4 t;
+    Mat4 t;
     for (auto it : _skinBones )
     {
         Mat4::multiply(it->getWorldMat(), _invBindPoses[i++], &t);
-        _matrixPalette[paletteIndex++].set(t.m[0], t.m[4], t.m[8], t.m[12]);
-        _matrixPalette[paletteIndex++].set(t.m[1], t.m[5], t.m[9], t.m[13]);
-        _matrixPalette[paletteIndex++].set(t.m[2], t.m[6], t.m[10], t.m[14]);
+        computeMatrixPaletteRows(t, &_matrixPalette[paletteIndex]);
+        paletteIndex += PALETTE_ROWS;
     }
+    _matrixPaletteVersion = _skeleton->getBoneMatrixVersion();
     
     return _matrixPalette;
 }
@@ -123,16 +208,76 @@ ssize_t MeshSkin::getMatrixPaletteSize() const
     return _skinBones.size() * PALETTE_ROWS;
 }
 
+Vec4* MeshSkin::getDualQuaternionPalette()
+{
+    if (_dualQuaternionPalette == nullptr)
+    {
+        _dualQuaternionPalette = new (std::nothrow) Vec4[_skinBones.size() * DUAL_QUATERNION_PALETTE_ROWS];
+        _dualQuaternionPaletteVersion = 0;
+    }
+    if (_dualQuaternionPaletteVersion != 0 && _dualQuaternionPaletteVersion == _skeleton->getBoneMatrixVersion())
+        return _dualQuaternionPalette;
+    
+    int i = 0, paletteIndex = 0;
+    Mat4 t;
+    for (auto it : _skinBones )
+    {
+        Mat4::multiply(it->getWorldMat(), _invBindPoses[i++], &t);
+        computeDualQuaternionPaletteRows(t, &_dualQuaternionPalette[paletteIndex]);
+        paletteIndex += DUAL_QUATERNION_PALETTE_ROWS;
+    }
+    _dualQuaternionPaletteVersion = _skeleton->getBoneMatrixVersion();
+    
+    return _dualQuaternionPalette;
+}
+
+ssize_t MeshSkin::getDualQuaternionPaletteSize() const
+{
+    return _skinBones.size() * DUAL_QUATERNION_PALETTE_ROWS;
+}
+
+Texture2D* MeshSkin::getPaletteTexture(bool dualQuaternion)
+{
+    auto& texture = dualQuaternion ? _dualQuaternionPaletteTexture : _matrixPaletteTexture;
+    auto& version = dualQuaternion ? _dualQuaternionPaletteTextureVersion : _matrixPaletteTextureVersion;
+    
+    const Vec4* rows = dualQuaternion ? getDualQuaternionPalette() : getMatrixPalette();
+    if (texture == nullptr)
+    {
+        texture = new (std::nothrow) BonePaletteTexture();
+        version = 0;
+    }
+    if (version == 0 || version != _skeleton->getBoneMatrixVersion())
+    {
+        int rowsPerBone = dualQuaternion ? DUAL_QUATERNION_PALETTE_ROWS : PALETTE_ROWS;
+        if (_skinBones.empty())
+        {
+            // a skin without bones still needs a valid texture
+            Vec4 emptyBone[3];
+            static_cast<BonePaletteTexture*>(texture)->update(emptyBone, rowsPerBone, 1);
+        }
+        else
+        {
+            static_cast<BonePaletteTexture*>(texture)->update(rows, rowsPerBone, static_cast<int>(_skinBones.size()));
+        }
+        version = _skeleton->getBoneMatrixVersion();
+    }
+    return texture;
+}
+
 void MeshSkin::removeAllBones()
 {
     _skinBones.clear();
     CC_SAFE_DELETE_ARRAY(_matrixPalette);
+    CC_SAFE_DELETE_ARRAY(_dualQuaternionPalette);
     CC_SAFE_RELEASE(_rootBone);
 }
 
 void MeshSkin::addSkinBone(Bone3D* bone)
 {
     _skinBones.pushBack(bone);
+    CC_SAFE_DELETE_ARRAY(_matrixPalette);
+    CC_SAFE_DELETE_ARRAY(_dualQuaternionPalette);
 }
 
 Bone3D* MeshSkin::getRootBone() const
@@ -159,4 +304,124 @@ const Mat4& MeshSkin::getInvBindPose(const Bone3D* bone)
     return Mat4::IDENTITY;
 }
 
+bool MeshSkin::isSameSkin(Skeleton3D* skeleton, const std::vector<std::string>& boneNames, const std::vector<Mat4>& invBindPose) const
+{
+    if (_skeleton != skeleton || _invBindPoses.size() != invBindPose.size())
+        return false;
+    
+    // create() skips the names the skeleton doesn't have
+    ssize_t boneIndex = 0;
+    for (const auto& it : boneNames)
+    {
+        auto bone = skeleton->getBoneByName(it);
+        if (bone)
+        {
+            if (boneIndex >= _skinBones.size() || _skinBones.at(boneIndex) != bone)
+                return false;
+            ++boneIndex;
+        }
+    }
+    if (boneIndex != _skinBones.size())
+        return false;
+    
+    for (size_t i = 0, size = invBindPose.size(); i < size; ++i)
+    {
+        if (memcmp(_invBindPoses[i].m, invBindPose[i].m, sizeof(invBindPose[i].m)) != 0)
+            return false;
+    }
+    return true;
+}
+
+void MeshSkin::computeMatrixPaletteRows(const Mat4& t, Vec4* rows)
+{
+    rows[0].set(t.m[0], t.m[4], t.m[8], t.m[12]);
+    rows[1].set(t.m[1], t.m[5], t.m[9], t.m[13]);
+    rows[2].set(t.m[2], t.m[6], t.m[10], t.m[14]);
+}
+
+void MeshSkin::computeDualQuaternionPaletteRows(const Mat4& skinMatrix, Vec4* rows)
+{
+    Quaternion real;
+    Vec3 translation;
+    skinMatrix.decompose(nullptr, &real, &translation);
+    real.normalize();
+    
+    // dual = translation * real / 2, the translation being a pure quaternion
+    rows[0].set(real.x, real.y, real.z, real.w);
+    rows[1].set(0.5f * (translation.x * real.w + translation.y * real.z - translation.z * real.y),
+                0.5f * (translation.y * real.w + translation.z * real.x - translation.x * real.z),
+                0.5f * (translation.z * real.w + translation.x * real.y - translation.y * real.x),
+                -0.5f * (translation.x * real.x + translation.y * real.y + translation.z * real.z));
+}
+
+void MeshSkin::skinVertex(const Vec4* palette, bool dualQuaternion, const Vec4& blendIndex, const Vec4& blendWeight,
+                          const Vec3& position, const Vec3& normal, Vec3* outPosition, Vec3* outNormal)
+{
+    const float indices[4] = { blendIndex.x, blendIndex.y, blendIndex.z, blendIndex.w };
+    const float weights[4] = { blendWeight.x, blendWeight.y, blendWeight.z, blendWeight.w };
+    
+    if (dualQuaternion)
+    {
+        // same steps as getPositionAndNormal() in cc3D_SkinPositionNormalTex_vert
+        const Vec4& firstReal = palette[static_cast<int>(indices[0]) * DUAL_QUATERNION_PALETTE_ROWS];
+        Vec4 real = firstReal * weights[0];
+        Vec4 dual = palette[static_cast<int>(indices[0]) * DUAL_QUATERNION_PALETTE_ROWS + 1] * weights[0];
+        for (int i = 1; i < 4; ++i)
+        {
+            float weight = weights[i];
+            if (weight > 0.0f)
+            {
+                int index = static_cast<int>(indices[i]) * DUAL_QUATERNION_PALETTE_ROWS;
+                if (palette[index].dot(firstReal) < 0.0f)
+                    weight = -weight;
+                real += palette[index] * weight;
+                dual += palette[index + 1] * weight;
+            }
+        }
+        
+        float len = real.length();
+        real.scale(1.0f / len);
+        dual.scale(1.0f / len);
+        
+        Vec3 axis(real.x, real.y, real.z);
+        Vec3 dualAxis(dual.x, dual.y, dual.z);
+        Vec3 cross, rotated;
+        
+        Vec3 translation = dualAxis * real.w - axis * dual.w;
+        Vec3::cross(axis, dualAxis, &cross);
+        translation = (translation + cross) * 2.0f;
+        
+        Vec3::cross(axis, position, &cross);
+        Vec3::cross(axis, cross + position * real.w, &rotated);
+        *outPosition = position + rotated * 2.0f + translation;
+        
+        if (outNormal)
+        {
+            Vec3::cross(axis, normal, &cross);
+            Vec3::cross(axis, cross + normal * real.w, &rotated);
+            *outNormal = normal + rotated * 2.0f;
+        }
+        return;
+    }
+    
+    // same steps as getPositionAndNormal() in cc3D_SkinPositionNormalTex_vert, the blend stops at the first empty weight
+    Vec4 rows[3];
+    for (int i = 0; i < 4; ++i)
+    {
+        if (i > 0 && !(weights[i] > 0.0f))
+            break;
+        int index = static_cast<int>(indices[i]) * PALETTE_ROWS;
+        for (int r = 0; r < 3; ++r)
+            rows[r] += palette[index + r] * weights[i];
+    }
+    
+    Vec4 p(position.x, position.y, position.z, 1.0f);
+    outPosition->set(p.dot(rows[0]), p.dot(rows[1]), p.dot(rows[2]));
+    if (outNormal)
+    {
+        Vec4 n(normal.x, normal.y, normal.z, 0.0f);
+        outNormal->set(n.dot(rows[0]), n.dot(rows[1]), n.dot(rows[2]));
+    }
+}
+
 NS_CC_END
@@ -41,10 +41,17 @@ NS_CC_BEGIN
 
 class Bone3D;
 class Skeleton3D;
+class Texture2D;
+class EventListenerCustom;
 
 /**
  * @brief MeshSkin, A class maintain a collection of bones that affect Mesh vertex.
  * And it is responsible for computing matrix palettes that used by skin mesh rendering.
+ *
+ * The palettes are computed once per update of the skeleton, however many meshes share the skin.
+ * The default skinning shaders read them from a float texture when the GPU supports it, which has
+ * no joint limit, and from a uniform array of 60 bones otherwise. They blend the bones as matrices,
+ * or as dual quaternions when Configuration::isDualQuaternionSkinningEnabled() is true.
  * @js NA
  * @lua NA
  */
@@ -68,15 +75,60 @@ public:
     /**get bone index*/
     int getBoneIndex(Bone3D* bone) const;
     
-    /**compute matrix palette used by gpu skin*/
+    /**compute matrix palette used by gpu skin, only when the skeleton was updated since the last call*/
     Vec4* getMatrixPalette();
     
     /**getSkinBoneCount() * 3*/
     ssize_t getMatrixPaletteSize() const;
     
+    /**compute dual quaternion palette used by gpu skin, the real and the dual part of every bone
+     * @since v3.18
+     */
+    Vec4* getDualQuaternionPalette();
+    
+    /**getSkinBoneCount() * 2
+     * @since v3.18
+     */
+    ssize_t getDualQuaternionPaletteSize() const;
+    
+    /**float texture holding the matrix palette, or the dual quaternion palette, with one bone per line of texels.
+     * It is uploaded when the skeleton was updated since the last call. Needs Configuration::supportsFloatTexture().
+     * @since v3.18
+     */
+    Texture2D* getPaletteTexture(bool dualQuaternion);
+    
     /**get root bone of the skin*/
     Bone3D* getRootBone() const;
     
+    /**whether the skin binds the same bones of the skeleton with the same inverse bind poses, meshes can share it then
+     * @since v3.18
+     */
+    bool isSameSkin(Skeleton3D* skeleton, const std::vector<std::string>& boneNames, const std::vector<Mat4>& invBindPose) const;
+    
+    /**write the 3 palette rows of a bone, skinMatrix is the world matrix of the bone times its inverse bind pose
+     * @since v3.18
+     */
+    static void computeMatrixPaletteRows(const Mat4& skinMatrix, Vec4* rows);
+    
+    /**write the 2 dual quaternion palette rows of a bone, the scale of skinMatrix is dropped
+     * @since v3.18
+     */
+    static void computeDualQuaternionPaletteRows(const Mat4& skinMatrix, Vec4* rows);
+    
+    /**skin a vertex on the CPU like the default skinning shaders do, for tools and tests running without GL
+     *
+     * @param palette The rows of getMatrixPalette(), or of getDualQuaternionPalette() if dualQuaternion is true.
+     * @param blendIndex The bone indices of the vertex, a_blendIndex in the shaders.
+     * @param blendWeight The bone weights of the vertex, a_blendWeight in the shaders.
+     * @param position The position of the vertex in bind pose.
+     * @param normal The normal of the vertex in bind pose, it isn't normalized after skinning.
+     * @param outPosition Receives the skinned position.
+     * @param outNormal Receives the skinned normal, may be nullptr.
+     * @since v3.18
+     */
+    static void skinVertex(const Vec4* palette, bool dualQuaternion, const Vec4& blendIndex, const Vec4& blendWeight,
+                           const Vec3& position, const Vec3& normal, Vec3* outPosition, Vec3* outNormal);
+    
 CC_CONSTRUCTOR_ACCESS:
     
     MeshSkin();
@@ -105,6 +157,22 @@ protected:
     // Each 4x3 row-wise matrix is represented as 3 Vec4's.
     // The number of Vec4's is (_skinBones.size() * 3).
     Vec4* _matrixPalette;
+    
+    // Real and dual part of each bone, (_skinBones.size() * 2) Vec4's.
+    Vec4* _dualQuaternionPalette;
+    
+    // Bone matrix version of the skeleton the palettes and textures hold, 0 if never computed
+    unsigned int _matrixPaletteVersion;
+    unsigned int _dualQuaternionPaletteVersion;
+    unsigned int _matrixPaletteTextureVersion;
+    unsigned int _dualQuaternionPaletteTextureVersion;
+    
+    Texture2D* _matrixPaletteTexture;
+    Texture2D* _dualQuaternionPaletteTexture;
+    
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    EventListenerCustom* _rendererRecreatedListener;
+#endif
 };
 
 // end of 3d group
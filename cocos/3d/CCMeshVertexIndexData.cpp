@@ -84,7 +84,10 @@ MeshVertexData* MeshVertexData::create(const MeshData& meshdata)
 {
     auto vertexdata = new (std::nothrow) MeshVertexData();
     int pervertexsize = meshdata.getPerVertexSize();
-    vertexdata->_vertexBuffer = VertexBuffer::create(pervertexsize, (int)(meshdata.vertex.size() / (pervertexsize / 4)));
+    // vertices and indices of a mapped bundle are uploaded straight from the file
+    auto vertices = meshdata.getVertices();
+    auto vertexCountInFloat = meshdata.getVertexCountInFloat();
+    vertexdata->_vertexBuffer = VertexBuffer::create(pervertexsize, (int)(vertexCountInFloat / (pervertexsize / 4)));
     vertexdata->_vertexData = VertexData::create();
     CC_SAFE_RETAIN(vertexdata->_vertexData);
     CC_SAFE_RETAIN(vertexdata->_vertexBuffer);
@@ -99,20 +102,22 @@ MeshVertexData* MeshVertexData::create(const MeshData& meshdata)
     
     if(vertexdata->_vertexBuffer)
     {
-        vertexdata->_vertexBuffer->updateVertices((void*)&meshdata.vertex[0], (int)meshdata.vertex.size() * 4 / vertexdata->_vertexBuffer->getSizePerVertex(), 0);
+        vertexdata->_vertexBuffer->updateVertices(vertices, (int)vertexCountInFloat * 4 / vertexdata->_vertexBuffer->getSizePerVertex(), 0);
     }
     
-    bool needCalcAABB = (meshdata.subMeshAABB.size() != meshdata.subMeshIndices.size());
-    for (size_t i = 0, size = meshdata.subMeshIndices.size(); i < size; ++i) {
-
-        auto& index = meshdata.subMeshIndices[i];
-        auto indexBuffer = IndexBuffer::create(IndexBuffer::IndexType::INDEX_TYPE_SHORT_16, (int)(index.size()));
-        indexBuffer->updateIndices(&index[0], (int)index.size(), 0);
-        std::string id = (i < meshdata.subMeshIds.size() ? meshdata.subMeshIds[i] : "");
+    auto subMeshCount = meshdata.getSubMeshCount();
+    bool needCalcAABB = ((ssize_t)meshdata.subMeshAABB.size() != subMeshCount);
+    for (ssize_t i = 0; i < subMeshCount; ++i) {
+
+        auto indexCount = meshdata.getSubMeshIndexCount(i);
+        auto indexBuffer = IndexBuffer::create(IndexBuffer::IndexType::INDEX_TYPE_SHORT_16, (int)indexCount);
+        indexBuffer->updateIndices(meshdata.getSubMeshIndices(i), (int)indexCount, 0);
+        std::string id = (i < (ssize_t)meshdata.subMeshIds.size() ? meshdata.subMeshIds[i] : "");
         MeshIndexData* indexdata = nullptr;
         if (needCalcAABB)
         {
-            auto aabb = Bundle3D::calculateAABB(meshdata.vertex, meshdata.getPerVertexSize(), index);
+            // mapped meshes always come with their bounding boxes
+            auto aabb = Bundle3D::calculateAABB(meshdata.vertex, meshdata.getPerVertexSize(), meshdata.subMeshIndices[i]);
             indexdata = MeshIndexData::create(id, vertexdata, indexBuffer, aabb);
         }
         else
@@ -390,6 +390,7 @@ void MotionStreak3D::onDraw(const Mat4 &transform, uint32_t /*flags*/)
     GL::enableVertexAttribs(GL::VERTEX_ATTRIB_FLAG_POS_COLOR_TEX );
     GL::blendFunc( _blendFunc.src, _blendFunc.dst );
 
+    _texture->markAsUsed();
     GL::bindTexture2D( _texture->getName() );
     
     glDisable(GL_CULL_FACE);
@@ -0,0 +1,339 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "3d/CCOcclusionBuffer.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#define OCCLUSION_BUFFER_USE_SSE
+#elif defined(__ARM_NEON__) || defined(__aarch64__)
+#include <arm_neon.h>
+#define OCCLUSION_BUFFER_USE_NEON
+#endif
+
+NS_CC_BEGIN
+
+namespace
+{
+    inline Vec4 transformPoint(const Mat4& m, const Vec3& p)
+    {
+        return Vec4(m.m[0] * p.x + m.m[4] * p.y + m.m[8] * p.z + m.m[12],
+                    m.m[1] * p.x + m.m[5] * p.y + m.m[9] * p.z + m.m[13],
+                    m.m[2] * p.x + m.m[6] * p.y + m.m[10] * p.z + m.m[14],
+                    m.m[3] * p.x + m.m[7] * p.y + m.m[11] * p.z + m.m[15]);
+    }
+
+    // distance to the near plane in clip space, z = -w
+    inline float nearDistance(const Vec4& v)
+    {
+        return v.z + v.w;
+    }
+
+    // clips a triangle against the near plane, returns the number of vertices of the polygon left
+    int clipNear(const Vec4* in, Vec4* out)
+    {
+        int count = 0;
+        for (int i = 0; i < 3; ++i)
+        {
+            const Vec4& a = in[i];
+            const Vec4& b = in[(i + 1) % 3];
+            float da = nearDistance(a);
+            float db = nearDistance(b);
+            if (da >= 0)
+                out[count++] = a;
+            if ((da >= 0) != (db >= 0))
+            {
+                float t = da / (da - db);
+                out[count++] = a + (b - a) * t;
+            }
+        }
+        return count;
+    }
+}
+
+OcclusionBuffer::OcclusionBuffer(int width, int height)
+: _width(0)
+, _height(0)
+, _tilesX(0)
+, _tilesY(0)
+, _tilesDirty(false)
+, _triangleCount(0)
+, _testCount(0)
+, _occludedCount(0)
+{
+    setResolution(width, height);
+}
+
+OcclusionBuffer::~OcclusionBuffer()
+{
+}
+
+void OcclusionBuffer::setResolution(int width, int height)
+{
+    _tilesX = std::max(1, (width + TILE_SIZE - 1) / TILE_SIZE);
+    _tilesY = std::max(1, (height + TILE_SIZE - 1) / TILE_SIZE);
+    _width = _tilesX * TILE_SIZE;
+    _height = _tilesY * TILE_SIZE;
+    _depth.assign(_width * _height, 1.0f);
+    _tileMaxDepth.assign(_tilesX * _tilesY, 1.0f);
+    _tilesDirty = false;
+}
+
+void OcclusionBuffer::clear(const Mat4& viewProjection)
+{
+    _viewProjection = viewProjection;
+    std::fill(_depth.begin(), _depth.end(), 1.0f);
+    std::fill(_tileMaxDepth.begin(), _tileMaxDepth.end(), 1.0f);
+    _tilesDirty = false;
+    _triangleCount = 0;
+    _testCount = 0;
+    _occludedCount = 0;
+}
+
+void OcclusionBuffer::rasterize(const Vec3* positions, int vertexCount, const unsigned short* indices, int indexCount, const Mat4& worldTransform)
+{
+    Mat4 transform = _viewProjection * worldTransform;
+
+    // the occluders are low-poly, their vertices are projected once
+    std::vector<Vec4> clip(vertexCount);
+    for (int i = 0; i < vertexCount; ++i)
+        clip[i] = transformPoint(transform, positions[i]);
+
+    const float halfWidth = _width * 0.5f;
+    const float halfHeight = _height * 0.5f;
+    for (int i = 0; i + 2 < indexCount; i += 3)
+    {
+        if (indices[i] >= vertexCount || indices[i + 1] >= vertexCount || indices[i + 2] >= vertexCount)
+            continue;
+
+        Vec4 triangle[3] = { clip[indices[i]], clip[indices[i + 1]], clip[indices[i + 2]] };
+        Vec4 polygon[4];
+        int count;
+        if (nearDistance(triangle[0]) >= 0 && nearDistance(triangle[1]) >= 0 && nearDistance(triangle[2]) >= 0)
+        {
+            polygon[0] = triangle[0];
+            polygon[1] = triangle[1];
+            polygon[2] = triangle[2];
+            count = 3;
+        }
+        else
+        {
+            count = clipNear(triangle, polygon);
+        }
+
+        // to pixels, with the depth from 0 at the near plane to 1 at the far plane
+        Vec3 screen[4];
+        for (int j = 0; j < count; ++j)
+        {
+            float inverseW = 1.0f / std::max(polygon[j].w, 1e-6f);
+            screen[j].set((polygon[j].x * inverseW + 1.0f) * halfWidth,
+                          (polygon[j].y * inverseW + 1.0f) * halfHeight,
+                          (polygon[j].z * inverseW + 1.0f) * 0.5f);
+        }
+        for (int j = 2; j < count; ++j)
+            rasterizeTriangle(screen[0], screen[j - 1], screen[j]);
+    }
+}
+
+void OcclusionBuffer::rasterizeTriangle(const Vec3& v0, const Vec3& in1, const Vec3& in2)
+{
+    float area = (in1.x - v0.x) * (in2.y - v0.y) - (in1.y - v0.y) * (in2.x - v0.x);
+    if (std::abs(area) < 1e-6f)
+        return;
+
+    // counter clockwise, so the inside is where the three edge functions are positive
+    const Vec3& v1 = area > 0 ? in1 : in2;
+    const Vec3& v2 = area > 0 ? in2 : in1;
+    area = std::abs(area);
+
+    int minX = std::max(0, (int)std::floor(std::min(v0.x, std::min(v1.x, v2.x))));
+    int maxX = std::min(_width - 1, (int)std::floor(std::max(v0.x, std::max(v1.x, v2.x))));
+    int minY = std::max(0, (int)std::floor(std::min(v0.y, std::min(v1.y, v2.y))));
+    int maxY = std::min(_height - 1, (int)std::floor(std::max(v0.y, std::max(v1.y, v2.y))));
+    if (minX > maxX || minY > maxY)
+        return;
+
+    ++_triangleCount;
+    _tilesDirty = true;
+
+    // edge function of the edge facing each vertex: a * x + b * y + c
+    const float a0 = v1.y - v2.y, b0 = v2.x - v1.x, c0 = v1.x * v2.y - v1.y * v2.x;
+    const float a1 = v2.y - v0.y, b1 = v0.x - v2.x, c1 = v2.x * v0.y - v2.y * v0.x;
+    const float a2 = v0.y - v1.y, b2 = v1.x - v0.x, c2 = v0.x * v1.y - v0.y * v1.x;
+
+    // depth is linear in screen space
+    const float inverseArea = 1.0f / area;
+    const float za = (a0 * v0.z + a1 * v1.z + a2 * v2.z) * inverseArea;
+    const float zb = (b0 * v0.z + b1 * v1.z + b2 * v2.z) * inverseArea;
+    const float zc = (c0 * v0.z + c1 * v1.z + c2 * v2.z) * inverseArea;
+
+    // rows start on a multiple of 4 pixels, the width of the buffer is one too
+    const int startX = minX & ~3;
+    for (int y = minY; y <= maxY; ++y)
+    {
+        const float py = y + 0.5f;
+        float* row = &_depth[y * _width];
+#if defined(OCCLUSION_BUFFER_USE_SSE)
+        const __m128 zero = _mm_setzero_ps();
+        __m128 px = _mm_add_ps(_mm_set1_ps(startX + 0.5f), _mm_set_ps(3, 2, 1, 0));
+        const __m128 step = _mm_set1_ps(4.0f);
+        const __m128 va0 = _mm_set1_ps(a0), va1 = _mm_set1_ps(a1), va2 = _mm_set1_ps(a2), vza = _mm_set1_ps(za);
+        const __m128 row0 = _mm_set1_ps(b0 * py + c0), row1 = _mm_set1_ps(b1 * py + c1), row2 = _mm_set1_ps(b2 * py + c2), rowZ = _mm_set1_ps(zb * py + zc);
+        for (int x = startX; x <= maxX; x += 4, px = _mm_add_ps(px, step))
+        {
+            __m128 e0 = _mm_add_ps(_mm_mul_ps(va0, px), row0);
+            __m128 e1 = _mm_add_ps(_mm_mul_ps(va1, px), row1);
+            __m128 e2 = _mm_add_ps(_mm_mul_ps(va2, px), row2);
+            __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)), _mm_cmpge_ps(e2, zero));
+            if (!_mm_movemask_ps(inside))
+                continue;
+
+            __m128 z = _mm_add_ps(_mm_mul_ps(vza, px), rowZ);
+            __m128 depth = _mm_loadu_ps(row + x);
+            __m128 nearest = _mm_min_ps(depth, z);
+            _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, depth)));
+        }
+#elif defined(OCCLUSION_BUFFER_USE_NEON)
+        const float32x4_t zero = vdupq_n_f32(0.0f);
+        const float offsets[4] = { 0.5f, 1.5f, 2.5f, 3.5f };
+        float32x4_t px = vaddq_f32(vdupq_n_f32((float)startX), vld1q_f32(offsets));
+        const float32x4_t step = vdupq_n_f32(4.0f);
+        const float32x4_t row0 = vdupq_n_f32(b0 * py + c0), row1 = vdupq_n_f32(b1 * py + c1), row2 = vdupq_n_f32(b2 * py + c2), rowZ = vdupq_n_f32(zb * py + zc);
+        for (int x = startX; x <= maxX; x += 4, px = vaddq_f32(px, step))
+        {
+            float32x4_t e0 = vmlaq_n_f32(row0, px, a0);
+            float32x4_t e1 = vmlaq_n_f32(row1, px, a1);
+            float32x4_t e2 = vmlaq_n_f32(row2, px, a2);
+            uint32x4_t inside = vandq_u32(vandq_u32(vcgeq_f32(e0, zero), vcgeq_f32(e1, zero)), vcgeq_f32(e2, zero));
+            uint32x2_t any = vorr_u32(vget_low_u32(inside), vget_high_u32(inside));
+            if (!(vget_lane_u32(any, 0) | vget_lane_u32(any, 1)))
+                continue;
+
+            float32x4_t z = vmlaq_n_f32(rowZ, px, za);
+            float32x4_t depth = vld1q_f32(row + x);
+            vst1q_f32(row + x, vbslq_f32(inside, vminq_f32(depth, z), depth));
+        }
+#else
+        for (int x = startX; x <= maxX; ++x)
+        {
+            const float px = x + 0.5f;
+            if (a0 * px + b0 * py + c0 >= 0 && a1 * px + b1 * py + c1 >= 0 && a2 * px + b2 * py + c2 >= 0)
+            {
+                float z = za * px + zb * py + zc;
+                if (z < row[x])
+                    row[x] = z;
+            }
+        }
+#endif
+    }
+}
+
+void OcclusionBuffer::updateTiles() const
+{
+    for (int ty = 0; ty < _tilesY; ++ty)
+    {
+        for (int tx = 0; tx < _tilesX; ++tx)
+        {
+            float maxDepth = 0.0f;
+            for (int y = ty * TILE_SIZE; y < (ty + 1) * TILE_SIZE; ++y)
+            {
+                const float* row = &_depth[y * _width + tx * TILE_SIZE];
+                for (int x = 0; x < TILE_SIZE; ++x)
+                    maxDepth = std::max(maxDepth, row[x]);
+            }
+            _tileMaxDepth[ty * _tilesX + tx] = maxDepth;
+        }
+    }
+    _tilesDirty = false;
+}
+
+bool OcclusionBuffer::isVisible(const AABB& aabb) const
+{
+    ++_testCount;
+    if (_tilesDirty)
+        updateTiles();
+
+    Vec3 corners[8];
+    aabb.getCorners(corners);
+
+    float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX, minZ = FLT_MAX;
+    for (int i = 0; i < 8; ++i)
+    {
+        Vec4 clip = transformPoint(_viewProjection, corners[i]);
+        // a box reaching the camera can't be hidden
+        if (nearDistance(clip) < 0 || clip.w <= 1e-6f)
+            return true;
+
+        float inverseW = 1.0f / clip.w;
+        float x = (clip.x * inverseW + 1.0f) * 0.5f * _width;
+        float y = (clip.y * inverseW + 1.0f) * 0.5f * _height;
+        minX = std::min(minX, x);
+        maxX = std::max(maxX, x);
+        minY = std::min(minY, y);
+        maxY = std::max(maxY, y);
+        minZ = std::min(minZ, (clip.z * inverseW + 1.0f) * 0.5f);
+    }
+
+    // off screen boxes are left to frustum culling
+    if (maxX < 0 || maxY < 0 || minX >= _width || minY >= _height)
+        return true;
+
+    // every pixel the box touches
+    const int x0 = std::max(0, (int)std::floor(minX));
+    const int x1 = std::min(_width - 1, (int)std::floor(maxX));
+    const int y0 = std::max(0, (int)std::floor(minY));
+    const int y1 = std::min(_height - 1, (int)std::floor(maxY));
+
+    for (int ty = y0 / TILE_SIZE; ty <= y1 / TILE_SIZE; ++ty)
+    {
+        for (int tx = x0 / TILE_SIZE; tx <= x1 / TILE_SIZE; ++tx)
+        {
+            // the whole tile is in front of the box
+            if (_tileMaxDepth[ty * _tilesX + tx] < minZ)
+                continue;
+
+            const int startX = std::max(x0, tx * TILE_SIZE), endX = std::min(x1, (tx + 1) * TILE_SIZE - 1);
+            const int startY = std::max(y0, ty * TILE_SIZE), endY = std::min(y1, (ty + 1) * TILE_SIZE - 1);
+            for (int y = startY; y <= endY; ++y)
+            {
+                const float* row = &_depth[y * _width];
+                for (int x = startX; x <= endX; ++x)
+                {
+                    if (row[x] >= minZ)
+                        return true;
+                }
+            }
+        }
+    }
+
+    ++_occludedCount;
+    return false;
+}
+
+NS_CC_END
@@ -0,0 +1,120 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __CC_OCCLUSION_BUFFER_H__
+#define __CC_OCCLUSION_BUFFER_H__
+
+#include <vector>
+#include "math/CCMath.h"
+#include "3d/CCAABB.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup _3d
+ * @{
+ */
+
+/** @class OcclusionBuffer
+ * @brief A small depth buffer drawn on the CPU from occluders, to skip what is hidden behind them.
+ *
+ * Occluders are low-poly meshes, such as the boxes of buildings. Their triangles are clipped
+ * against the near plane and rasterized at low resolution, four pixels at a time with SSE or
+ * NEON when available, keeping the nearest depth. The buffer is split into tiles of 8 x 8
+ * pixels whose farthest depth is kept, so a box is tested against whole tiles first and
+ * against single pixels only where a tile doesn't decide.
+ *
+ * Pixels are covered when their center is inside a triangle, so an object seen through a gap
+ * thinner than a pixel of the buffer may be culled. Boxes crossing the near plane are
+ * always visible.
+ *
+ * It doesn't need a GL context. SceneBVH uses one to cull the 3D nodes of a scene.
+ * @since v3.18
+ * @js NA
+ * @lua NA
+ */
+class CC_DLL OcclusionBuffer
+{
+public:
+    /** Size of the tiles of the hierarchy, the resolution is rounded up to a multiple of it. */
+    static const int TILE_SIZE = 8;
+
+    OcclusionBuffer(int width = 256, int height = 128);
+    ~OcclusionBuffer();
+
+    /** Sets the resolution, which clears the buffer. */
+    void setResolution(int width, int height);
+    int getWidth() const { return _width; }
+    int getHeight() const { return _height; }
+
+    /** Clears the buffer to the far plane and sets the view projection matrix occluders and boxes are projected with. */
+    void clear(const Mat4& viewProjection);
+
+    /** Rasterizes an occluder.
+     *
+     * @param positions Vertices in the space of the occluder.
+     * @param vertexCount Number of vertices.
+     * @param indices Three indices per triangle, either winding.
+     * @param indexCount Number of indices.
+     * @param worldTransform Transform from the space of the occluder to world space.
+     */
+    void rasterize(const Vec3* positions, int vertexCount, const unsigned short* indices, int indexCount, const Mat4& worldTransform);
+
+    /** Whether any part of a world space box may be in front of the occluders. */
+    bool isVisible(const AABB& aabb) const;
+
+    /** Depth of a pixel, from 0 at the near plane to 1 at the far plane. */
+    float getDepth(int x, int y) const { return _depth[y * _width + x]; }
+
+    /** Triangles rasterized, boxes tested and boxes found hidden since the last clear(). */
+    int getTriangleCount() const { return _triangleCount; }
+    int getTestCount() const { return _testCount; }
+    int getOccludedCount() const { return _occludedCount; }
+
+protected:
+    void rasterizeTriangle(const Vec3& v0, const Vec3& v1, const Vec3& v2);
+    void updateTiles() const;
+
+    int _width;
+    int _height;
+    int _tilesX;
+    int _tilesY;
+    Mat4 _viewProjection;
+    std::vector<float> _depth;
+    // farthest depth of every tile, updated when a box is tested after rasterizing
+    mutable std::vector<float> _tileMaxDepth;
+    mutable bool _tilesDirty;
+
+    int _triangleCount;
+    mutable int _testCount;
+    mutable int _occludedCount;
+};
+
+// end of 3d group
+/// @}
+
+NS_CC_END
+
+#endif // __CC_OCCLUSION_BUFFER_H__
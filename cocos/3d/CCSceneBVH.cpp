@@ -0,0 +1,242 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "3d/CCSceneBVH.h"
+
+#include <algorithm>
+#include "2d/CCNode.h"
+#include "2d/CCCamera.h"
+#include "base/CCDirector.h"
+
+NS_CC_BEGIN
+
+namespace
+{
+    // a node hidden this frame isn't drawn, although it was visited last frame
+    bool isVisibleInHierarchy(const Node* node)
+    {
+        for (; node; node = node->getParent())
+        {
+            if (!node->isVisible())
+                return false;
+        }
+        return true;
+    }
+}
+
+SceneBVH::SceneBVH()
+: _occluderCount(0)
+, _occlusionCamera(nullptr)
+, _camera(nullptr)
+, _clock(0)
+, _queryStamp(0)
+, _queryPending(false)
+, _cullingEnabled(true)
+, _occlusionCullingEnabled(true)
+, _visibleCount(0)
+, _occludedCount(0)
+, _drawnOccluderCount(0)
+{
+}
+
+SceneBVH::~SceneBVH()
+{
+}
+
+int SceneBVH::addNode(Node* node, const AABB& aabb)
+{
+    int proxyId = _tree.createProxy(aabb, node);
+    if (proxyId >= (int)_aabbs.size())
+    {
+        _aabbs.resize(proxyId + 1);
+        _visibleStamps.resize(proxyId + 1, 0);
+        _insertStamps.resize(proxyId + 1, 0);
+        _occluders.resize(proxyId + 1, Occluder{ nullptr, nullptr, 0 });
+    }
+    _aabbs[proxyId] = aabb;
+    _visibleStamps[proxyId] = 0;
+    _insertStamps[proxyId] = ++_clock;
+    return proxyId;
+}
+
+void SceneBVH::updateNode(int proxyId, const AABB& aabb)
+{
+    _aabbs[proxyId] = aabb;
+    // staying inside its grown box keeps the answer of the last query right
+    if (_tree.moveProxy(proxyId, aabb))
+        _insertStamps[proxyId] = ++_clock;
+}
+
+void SceneBVH::removeNode(int proxyId)
+{
+    setOccluder(proxyId, nullptr, nullptr);
+    _tree.destroyProxy(proxyId);
+}
+
+void SceneBVH::setOccluder(int proxyId, const std::vector<Vec3>* positions, const std::vector<unsigned short>* indices)
+{
+    Occluder& occluder = _occluders[proxyId];
+    if (!occluder.positions && positions)
+        ++_occluderCount;
+    else if (occluder.positions && !positions)
+        --_occluderCount;
+
+    occluder.positions = positions;
+    occluder.indices = indices;
+    occluder.visitFrame = Director::getInstance()->getTotalFrames();
+}
+
+void SceneBVH::visitOccluder(int proxyId)
+{
+    _occluders[proxyId].visitFrame = Director::getInstance()->getTotalFrames();
+}
+
+void SceneBVH::beginCamera(const Camera* camera)
+{
+    _camera = camera;
+    _queryPending = true;
+}
+
+void SceneBVH::query(const Camera* camera)
+{
+    _queryPending = false;
+    _queryStamp = ++_clock;
+    _queryResult.clear();
+    _tree.queryFrustum(camera->getFrustum(), _queryResult);
+
+    // the occluders in the frustum seen by the camera are drawn first, those not visited
+    // since the last frame or hidden now are skipped
+    _occlusionCamera = nullptr;
+    _drawnOccluderCount = 0;
+    if (_occlusionCullingEnabled && _occluderCount > 0)
+    {
+        auto frame = Director::getInstance()->getTotalFrames();
+        auto cameraFlag = (unsigned short)camera->getCameraFlag();
+        for (auto proxyId : _queryResult)
+        {
+            const Occluder& occluder = _occluders[proxyId];
+            auto node = static_cast<Node*>(_tree.getUserData(proxyId));
+            if (!occluder.positions || occluder.visitFrame + 1 < frame || !(node->getCameraMask() & cameraFlag)
+                || !isVisibleInHierarchy(node))
+                continue;
+
+            if (!_occlusionCamera)
+            {
+                _occlusionBuffer.clear(camera->getViewProjectionMatrix());
+                _occlusionCamera = camera;
+            }
+            _occlusionBuffer.rasterize(occluder.positions->data(), (int)occluder.positions->size(),
+                                       occluder.indices->data(), (int)occluder.indices->size(), node->getNodeToWorldTransform());
+            ++_drawnOccluderCount;
+        }
+    }
+
+    // grown boxes are tested, they still hold a node that moves a little after the query
+    _occludedCount = 0;
+    for (auto proxyId : _queryResult)
+    {
+        if (_occlusionCamera && !_occluders[proxyId].positions && !_occlusionBuffer.isVisible(_tree.getFatAABB(proxyId)))
+        {
+            ++_occludedCount;
+            continue;
+        }
+        _visibleStamps[proxyId] = _queryStamp;
+    }
+    _visibleCount = (int)_queryResult.size() - _occludedCount;
+}
+
+const OcclusionBuffer* SceneBVH::getOcclusionBuffer(const Camera* camera)
+{
+    if (!_cullingEnabled || camera != _camera)
+        return nullptr;
+
+    if (_queryPending)
+        query(camera);
+    return _occlusionCamera == camera ? &_occlusionBuffer : nullptr;
+}
+
+SceneBVH::Visibility SceneBVH::getVisibility(int proxyId, const Camera* camera)
+{
+    // a camera visiting the scene from elsewhere, such as a render texture, has no query
+    if (!_cullingEnabled || camera != _camera)
+        return Visibility::UNKNOWN;
+
+    if (_queryPending)
+        query(camera);
+
+    if (_insertStamps[proxyId] > _queryStamp)
+        return Visibility::UNKNOWN;
+    return _visibleStamps[proxyId] == _queryStamp ? Visibility::VISIBLE : Visibility::CULLED;
+}
+
+Node* SceneBVH::intersectRay(const Ray& ray, float* distance, unsigned short cameraMask)
+{
+    _queryResult.clear();
+    _tree.queryRay(ray, _queryResult);
+
+    Node* nearest = nullptr;
+    float nearestDistance = 0.0f;
+    for (auto proxyId : _queryResult)
+    {
+        auto node = static_cast<Node*>(_tree.getUserData(proxyId));
+        if (!(node->getCameraMask() & cameraMask))
+            continue;
+
+        // Ray::intersects leaves the distance alone when the ray starts inside the box
+        float hitDistance = 0.0f;
+        if (ray.intersects(_aabbs[proxyId], &hitDistance) && (!nearest || hitDistance < nearestDistance))
+        {
+            nearest = node;
+            nearestDistance = hitDistance;
+        }
+    }
+
+    if (nearest && distance)
+        *distance = nearestDistance;
+    return nearest;
+}
+
+void SceneBVH::intersectRay(const Ray& ray, std::vector<Node*>& result, unsigned short cameraMask)
+{
+    _queryResult.clear();
+    _tree.queryRay(ray, _queryResult);
+
+    std::vector<std::pair<float, Node*>> hits;
+    for (auto proxyId : _queryResult)
+    {
+        auto node = static_cast<Node*>(_tree.getUserData(proxyId));
+        float hitDistance = 0.0f;
+        if ((node->getCameraMask() & cameraMask) && ray.intersects(_aabbs[proxyId], &hitDistance))
+            hits.push_back(std::make_pair(hitDistance, node));
+    }
+
+    std::stable_sort(hits.begin(), hits.end(), [](const std::pair<float, Node*>& a, const std::pair<float, Node*>& b) {
+        return a.first < b.first;
+    });
+    for (const auto& hit : hits)
+        result.push_back(hit.second);
+}
+
+NS_CC_END
@@ -0,0 +1,171 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __CC_SCENE_BVH_H__
+#define __CC_SCENE_BVH_H__
+
+#include <cstdint>
+#include <vector>
+#include "3d/CCAABBTree.h"
+#include "3d/CCOcclusionBuffer.h"
+
+NS_CC_BEGIN
+
+class Node;
+class Camera;
+
+/**
+ * @addtogroup _3d
+ * @{
+ */
+
+/** @class SceneBVH
+ * @brief The bounding volume hierarchy of the 3D nodes of a Scene, used to cull them and to pick them with a ray.
+ *
+ * Sprite3D adds itself when it enters a scene and updates its box when its transform changes.
+ * The frustum of a camera is queried once, when the first node asks whether it's visible, and
+ * culls whole subtrees; the nodes then only check a stamp instead of testing their own box. A
+ * node that is inserted again after the query answers UNKNOWN and tests its box as before.
+ *
+ * Nodes can also be occluders, with a low-poly mesh. The occluders found in the frustum are
+ * drawn into an OcclusionBuffer, and the other nodes found are culled when their box is hidden
+ * behind them. Terrain tests its chunks against the same buffer.
+ *
+ * Get it with Scene::getSceneBVH(). Use it from the main thread only.
+ * @since v3.18
+ * @js NA
+ * @lua NA
+ */
+class CC_DLL SceneBVH
+{
+public:
+    enum class Visibility
+    {
+        VISIBLE,
+        CULLED,
+        /** Not known from the last query, test the box of the node. */
+        UNKNOWN,
+    };
+
+    SceneBVH();
+    ~SceneBVH();
+
+    /** Adds a node with its world space box and returns its proxy id. */
+    int addNode(Node* node, const AABB& aabb);
+    /** Updates the world space box of a node. */
+    void updateNode(int proxyId, const AABB& aabb);
+    void removeNode(int proxyId);
+
+    /** Called by Scene before a camera visits it, the next getVisibility() queries its frustum. */
+    void beginCamera(const Camera* camera);
+
+    /** Whether a node is in the frustum of the camera visiting the scene. */
+    Visibility getVisibility(int proxyId, const Camera* camera);
+
+    /** Makes a node an occluder, or not when positions is null.
+     *
+     * @param proxyId The proxy of the node.
+     * @param positions Vertices of the occluder in the space of the node, kept by the caller.
+     * @param indices Three indices per triangle, kept by the caller.
+     */
+    void setOccluder(int proxyId, const std::vector<Vec3>* positions, const std::vector<unsigned short>* indices);
+
+    /** Called when an occluder is visited, occluders that are not visited, being hidden, don't hide anything. */
+    void visitOccluder(int proxyId);
+
+    /** Occlusion culling can be disabled, nodes in the frustum are then all visible. Enabled by default. */
+    void setOcclusionCullingEnabled(bool enabled) { _occlusionCullingEnabled = enabled; }
+    bool isOcclusionCullingEnabled() const { return _occlusionCullingEnabled; }
+
+    /** The buffer the occluders are drawn into, to change its resolution for instance. */
+    OcclusionBuffer* getOcclusionBuffer() { return &_occlusionBuffer; }
+
+    /** The buffer holding the occluders seen by a camera, or nullptr if that camera isn't visiting the scene or sees no occluder. */
+    const OcclusionBuffer* getOcclusionBuffer(const Camera* camera);
+
+    /** Culling through the hierarchy can be disabled, getVisibility() then answers UNKNOWN. */
+    void setCullingEnabled(bool enabled) { _cullingEnabled = enabled; }
+    bool isCullingEnabled() const { return _cullingEnabled; }
+
+    /** Finds the nearest node whose box is hit by the ray.
+     *
+     * @param ray The ray in world space.
+     * @param distance Receives the distance to the box of the node found, if not null.
+     * @param cameraMask Only nodes whose camera mask shares a bit with it are picked.
+     * @return The node found, or nullptr.
+     */
+    Node* intersectRay(const Ray& ray, float* distance = nullptr, unsigned short cameraMask = 0xFFFF);
+
+    /** Appends every node whose box is hit by the ray, nearest first. */
+    void intersectRay(const Ray& ray, std::vector<Node*>& result, unsigned short cameraMask = 0xFFFF);
+
+    const AABBTree& getTree() const { return _tree; }
+
+    /** Number of nodes found in the frustum and not hidden by the last query. */
+    int getVisibleCount() const { return _visibleCount; }
+    /** Number of nodes found in the frustum but hidden by occluders by the last query. */
+    int getOccludedCount() const { return _occludedCount; }
+    /** Number of occluders drawn by the last query. */
+    int getOccluderCount() const { return _drawnOccluderCount; }
+
+protected:
+    struct Occluder
+    {
+        const std::vector<Vec3>* positions;
+        const std::vector<unsigned short>* indices;
+        unsigned int visitFrame;
+    };
+
+    void query(const Camera* camera);
+
+    AABBTree _tree;
+    // per proxy: the box given, the query that found it visible, the last time it was inserted
+    std::vector<AABB> _aabbs;
+    std::vector<uint64_t> _visibleStamps;
+    std::vector<uint64_t> _insertStamps;
+    std::vector<int> _queryResult;
+    // per proxy, positions is null for nodes that aren't occluders
+    std::vector<Occluder> _occluders;
+    int _occluderCount;
+    OcclusionBuffer _occlusionBuffer;
+    const Camera* _occlusionCamera;
+
+    const Camera* _camera;
+    uint64_t _clock;
+    uint64_t _queryStamp;
+    bool _queryPending;
+    bool _cullingEnabled;
+    bool _occlusionCullingEnabled;
+    int _visibleCount;
+    int _occludedCount;
+    int _drawnOccluderCount;
+};
+
+// end of 3d group
+/// @}
+
+NS_CC_END
+
+#endif // __CC_SCENE_BVH_H__
@@ -24,6 +24,7 @@
  ****************************************************************************/
 
 #include "3d/CCSkeleton3D.h"
+#include "base/CCDirector.h"
 
 
 NS_CC_BEGIN
@@ -247,6 +248,8 @@ void Bone3D::updateLocalMat()
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 Skeleton3D::Skeleton3D()
+: _boneMatrixVersion(1)
+, _boneMatrixFrame(static_cast<unsigned int>(-1))
 {
     
 }
@@ -319,6 +322,10 @@ void Skeleton3D::updateBoneMatrix()
         it->setWorldMatDirty(true);
         it->updateWorldMat();
     }
+    if (++_boneMatrixVersion == 0)
+        _boneMatrixVersion = 1;
+    // may run on an Animate3DScheduler worker while the main thread waits for it
+    _boneMatrixFrame = Director::getInstance()->getTotalFrames();
 }
 
 void Skeleton3D::removeAllBones()
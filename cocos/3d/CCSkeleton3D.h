@@ -212,6 +212,16 @@ public:
     /**refresh bone world matrix*/
     void updateBoneMatrix();
     
+    /**changes every time updateBoneMatrix() is called and is never 0, the palettes of the skins only need recomputing when it changes
+     * @since v3.18
+     */
+    unsigned int getBoneMatrixVersion() const { return _boneMatrixVersion; }
+    
+    /**frame updateBoneMatrix() was last called in, see Director::getTotalFrames()
+     * @since v3.18
+     */
+    unsigned int getBoneMatrixFrame() const { return _boneMatrixFrame; }
+    
 CC_CONSTRUCTOR_ACCESS:
     
     Skeleton3D();
@@ -232,6 +242,9 @@ protected:
     Vector<Bone3D*> _bones; // bones
 
     Vector<Bone3D*> _rootBones;
+    
+    unsigned int _boneMatrixVersion;
+    unsigned int _boneMatrixFrame;
 };
 
 // end of 3d group
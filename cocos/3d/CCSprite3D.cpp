@@ -30,12 +30,15 @@
 #include "3d/CCSprite3DMaterial.h"
 #include "3d/CCAttachNode.h"
 #include "3d/CCMesh.h"
+#include "3d/CCSceneBVH.h"
 
 #include "base/CCDirector.h"
 #include "base/CCAsyncTaskPool.h"
+#include "3d/CCSprite3DAsyncLoader.h"
 #include "base/ccUTF8.h"
 #include "2d/CCLight.h"
 #include "2d/CCCamera.h"
+#include "2d/CCScene.h"
 #include "base/ccMacros.h"
 #include "platform/CCPlatformMacros.h"
 #include "platform/CCFileUtils.h"
@@ -96,28 +99,20 @@ void Sprite3D::createAsync(const std::string& modelPath, const std::function<voi
 
 void Sprite3D::createAsync(const std::string& modelPath, const std::string& texturePath, const std::function<void(Sprite3D*, void*)>& callback, void* callbackparam)
 {
-    Sprite3D *sprite = new (std::nothrow) Sprite3D();
-    if (sprite->loadFromCache(modelPath))
+    if (Sprite3DCache::getInstance()->getSpriteData(modelPath))
     {
-        sprite->autorelease();
+        auto sprite = Sprite3D::create(modelPath);
         if (!texturePath.empty())
             sprite->setTexture(texturePath);
         callback(sprite, callbackparam);
         return;
     }
     
-    sprite->_asyncLoadParam.afterLoadCallback = callback;
-    sprite->_asyncLoadParam.texPath = texturePath;
-    sprite->_asyncLoadParam.modelPath = modelPath;
-    sprite->_asyncLoadParam.callbackParam = callbackparam;
-    sprite->_asyncLoadParam.materialdatas = new (std::nothrow) MaterialDatas();
-    sprite->_asyncLoadParam.meshdatas = new (std::nothrow) MeshDatas();
-    sprite->_asyncLoadParam.nodeDatas = new (std::nothrow) NodeDatas();
-    AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_IO, CC_CALLBACK_1(Sprite3D::afterAsyncLoad, sprite), (void*)(&sprite->_asyncLoadParam), [sprite]()
+    Sprite3DAsyncLoader::load(modelPath, texturePath, [callback, callbackparam](Sprite3D* sprite)
     {
-        sprite->_asyncLoadParam.result = sprite->loadFromFile(sprite->_asyncLoadParam.modelPath, sprite->_asyncLoadParam.nodeDatas, sprite->_asyncLoadParam.meshdatas, sprite->_asyncLoadParam.materialdatas);
+        // an empty sprite when the file couldn't be loaded, as before
+        callback(sprite ? sprite : Sprite3D::create(), callbackparam);
     });
-    
 }
 
 void Sprite3D::afterAsyncLoad(void* param)
@@ -264,6 +259,8 @@ Sprite3D::Sprite3D()
 , _shaderUsingLight(false)
 , _forceDepthWrite(false)
 , _usingAutogeneratedGLProgram(true)
+, _sceneBVH(nullptr)
+, _sceneBVHProxy(-1)
 {
 }
 
@@ -336,6 +333,13 @@ bool Sprite3D::initFrom(const NodeDatas& nodeDatas, const MeshDatas& meshdatas,
             _meshVertexDatas.pushBack(meshvertex);
         }
     }
+    return initFrom(nodeDatas, _meshVertexDatas, materialdatas);
+}
+
+bool Sprite3D::initFrom(const NodeDatas& nodeDatas, const Vector<MeshVertexData*>& meshVertexDatas, const MaterialDatas& materialdatas)
+{
+    if (&meshVertexDatas != &_meshVertexDatas)
+        _meshVertexDatas = meshVertexDatas;
     _skeleton = Skeleton3D::create(nodeDatas.skeleton);
     CC_SAFE_RETAIN(_skeleton);
     
@@ -359,6 +363,18 @@ bool Sprite3D::initFrom(const NodeDatas& nodeDatas, const MeshDatas& meshdatas,
     return true;
 }
 
+MeshSkin* Sprite3D::getMeshSkin(const std::vector<std::string>& boneNames, const std::vector<Mat4>& invBindPose) const
+{
+    // meshes bound to the same bones share one skin, so its palette is computed once per frame
+    for (const auto& mesh : _meshes)
+    {
+        auto skin = mesh->getSkin();
+        if (skin && skin->isSameSkin(_skeleton, boneNames, invBindPose))
+            return skin;
+    }
+    return MeshSkin::create(_skeleton, boneNames, invBindPose);
+}
+
 Sprite3D* Sprite3D::createSprite3DNode(NodeData* nodedata,ModelData* modeldata,const MaterialDatas& materialdatas)
 {
     auto sprite = new (std::nothrow) Sprite3D();
@@ -532,8 +548,7 @@ void Sprite3D::createNode(NodeData* nodedata, Node* root, const MaterialDatas& m
                     _meshes.pushBack(mesh);
                     if (_skeleton && it->bones.size())
                     {
-                        auto skin = MeshSkin::create(_skeleton, it->bones, it->invBindPose);
-                        mesh->setSkin(skin);
+                        mesh->setSkin(getMeshSkin(it->bones, it->invBindPose));
                     }
                     mesh->_visibleChanged = std::bind(&Sprite3D::onAABBDirty, this);
 
@@ -719,6 +734,12 @@ void Sprite3D::visit(cocos2d::Renderer *renderer, const cocos2d::Mat4 &parentTra
     uint32_t flags = processParentFlags(parentTransform, parentFlags);
     flags |= FLAGS_RENDER_AS_3D;
     
+    // sprites without meshes have no box to cull
+    if (_sceneBVH && !_meshes.empty() && (_sceneBVHProxy < 0 || (flags & FLAGS_DIRTY_MASK) || _aabbDirty))
+        updateSceneBVH();
+    if (_sceneBVHProxy >= 0 && !_occluderIndices.empty())
+        _sceneBVH->visitOccluder(_sceneBVHProxy);
+    
     //
     Director* director = Director::getInstance();
     director->pushMatrix(MATRIX_STACK_TYPE::MATRIX_STACK_MODELVIEW);
@@ -759,12 +780,20 @@ void Sprite3D::visit(cocos2d::Renderer *renderer, const cocos2d::Mat4 &parentTra
 void Sprite3D::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
 {
 #if CC_USE_CULLING
-    // camera clipping
-    if(_children.size() == 0 && Camera::getVisitingCamera() && !Camera::getVisitingCamera()->isVisibleInFrustum(&getAABB()))
-        return;
+    // camera clipping, through the scene's hierarchy when it knows the answer
+    auto camera = Camera::getVisitingCamera();
+    if(_children.size() == 0 && camera)
+    {
+        auto visibility = _sceneBVHProxy >= 0 ? _sceneBVH->getVisibility(_sceneBVHProxy, camera) : SceneBVH::Visibility::UNKNOWN;
+        if (visibility == SceneBVH::Visibility::CULLED)
+            return;
+        if (visibility == SceneBVH::Visibility::UNKNOWN && !camera->isVisibleInFrustum(&getAABB()))
+            return;
+    }
 #endif
     
-    if (_skeleton)
+    // the skeleton is already up to date when Animate3DScheduler posed it this frame
+    if (_skeleton && _skeleton->getBoneMatrixFrame() != Director::getInstance()->getTotalFrames())
         _skeleton->updateBoneMatrix();
     
     Color4F color(getDisplayedColor());
@@ -837,6 +866,65 @@ AABB Sprite3D::getAABBRecursively()
     return getAABBRecursivelyImp(this);
 }
 
+void Sprite3D::setOccluder(const std::vector<Vec3>& positions, const std::vector<unsigned short>& indices)
+{
+    _occluderPositions = positions;
+    _occluderIndices = indices;
+    if (_sceneBVHProxy >= 0)
+        _sceneBVH->setOccluder(_sceneBVHProxy, _occluderIndices.empty() ? nullptr : &_occluderPositions, &_occluderIndices);
+}
+
+void Sprite3D::removeOccluder()
+{
+    _occluderPositions.clear();
+    _occluderIndices.clear();
+    if (_sceneBVHProxy >= 0)
+        _sceneBVH->setOccluder(_sceneBVHProxy, nullptr, nullptr);
+}
+
+void Sprite3D::onEnter()
+{
+    Node::onEnter();
+
+    auto scene = getScene();
+    _sceneBVH = scene ? scene->getSceneBVH() : nullptr;
+}
+
+void Sprite3D::onExit()
+{
+    if (_sceneBVHProxy >= 0)
+    {
+        _sceneBVH->removeNode(_sceneBVHProxy);
+        _sceneBVHProxy = -1;
+    }
+    _sceneBVH = nullptr;
+
+    Node::onExit();
+}
+
+void Sprite3D::updateSceneBVH()
+{
+    const AABB& aabb = getAABB();
+    if (aabb.isEmpty())
+    {
+        if (_sceneBVHProxy >= 0)
+        {
+            _sceneBVH->removeNode(_sceneBVHProxy);
+            _sceneBVHProxy = -1;
+        }
+    }
+    else if (_sceneBVHProxy < 0)
+    {
+        _sceneBVHProxy = _sceneBVH->addNode(this, aabb);
+        if (!_occluderIndices.empty())
+            _sceneBVH->setOccluder(_sceneBVHProxy, &_occluderPositions, &_occluderIndices);
+    }
+    else
+    {
+        _sceneBVH->updateNode(_sceneBVHProxy, aabb);
+    }
+}
+
 const AABB& Sprite3D::getAABB() const
 {
     Mat4 nodeToWorldTransform(getNodeToWorldTransform());
@@ -51,6 +51,7 @@ class Mesh;
 class Texture2D;
 class MeshSkin;
 class AttachNode;
+class SceneBVH;
 struct NodeData;
 /** @brief Sprite3D: A sprite can be loaded from 3D model files, .obj, .c3t, .c3b, then can be drawn as sprite */
 class CC_DLL Sprite3D : public Node, public BlendProtocol
@@ -71,7 +72,8 @@ public:
     
     /** create 3d sprite asynchronously
      * If the 3d model was previously loaded, it will create a new 3d sprite and the callback will be called at once.
-     * Otherwise it will load the model file in a new thread, and when the 3d sprite is loaded, the callback will be called with the created Sprite3D and a user-defined parameter.
+     * Otherwise it will load the model file with a Sprite3DAsyncLoader, and when the 3d sprite is loaded, the callback will be called with the created Sprite3D and a user-defined parameter.
+     * Use Sprite3DAsyncLoader directly to follow the progress of the load or cancel it.
      * The callback will be called from the main thread, so it is safe to create any cocos2d object from the callback.
      * @param modelPath model to be loaded
      * @param callback callback after loading
@@ -178,6 +180,21 @@ public:
     /**draw*/
     virtual void draw(Renderer *renderer, const Mat4 &transform, uint32_t flags) override;
 
+    /**
+     * Makes the sprite an occluder, hiding the sprites and terrain chunks behind it from the cameras.
+     * @param positions vertices of a low-poly version of the sprite, in its own space, which must not be bigger than the sprite
+     * @param indices three indices per triangle
+     * @since v3.18
+     */
+    void setOccluder(const std::vector<Vec3>& positions, const std::vector<unsigned short>& indices);
+    /** stops the sprite from being an occluder */
+    void removeOccluder();
+    bool isOccluder() const { return !_occluderIndices.empty(); }
+
+    /** adds the sprite to the bounding volume hierarchy of its scene, which culls it and picks it with rays, see Scene::getSceneBVH() */
+    virtual void onEnter() override;
+    virtual void onExit() override;
+
     /** Adds a new material to the sprite.
      The Material will be applied to all the meshes that belong to the sprite.
      Internally it will call `setMaterial(material,-1)`
@@ -217,6 +234,9 @@ CC_CONSTRUCTOR_ACCESS:
     
     bool initFrom(const NodeDatas& nodedatas, const MeshDatas& meshdatas, const MaterialDatas& materialdatas);
     
+    /** init with meshes already uploaded, by Sprite3DAsyncLoader for instance */
+    bool initFrom(const NodeDatas& nodedatas, const Vector<MeshVertexData*>& meshVertexDatas, const MaterialDatas& materialdatas);
+    
     /**load sprite3d from cache, return true if succeed, false otherwise*/
     bool loadFromCache(const std::string& path);
     
@@ -239,14 +259,21 @@ CC_CONSTRUCTOR_ACCESS:
     /**get MeshIndexData by Id*/
     MeshIndexData* getMeshIndexData(const std::string& indexId) const;
     
+    /**skin of a mesh already created with the same bones, or a new one*/
+    MeshSkin* getMeshSkin(const std::vector<std::string>& boneNames, const std::vector<Mat4>& invBindPose) const;
+    
     void addMesh(Mesh* mesh);
     
     void onAABBDirty() { _aabbDirty = true; }
     
+    // kept for the bindings, createAsync() loads with Sprite3DAsyncLoader since 3.18
     void afterAsyncLoad(void* param);
 
     static AABB getAABBRecursivelyImp(Node *node);
     
+    /** adds or moves the world space box of the sprite in the scene's bounding volume hierarchy */
+    void updateSceneBVH();
+    
 protected:
 
     Skeleton3D*                  _skeleton; //skeleton
@@ -266,6 +293,10 @@ protected:
     bool                         _shaderUsingLight; // is current shader using light ?
     bool                         _forceDepthWrite; // Always write to depth buffer
     bool                         _usingAutogeneratedGLProgram;
+    SceneBVH*                    _sceneBVH; // weak ref, owned by the scene the sprite is in
+    int                          _sceneBVHProxy; // -1 until the sprite has a box in _sceneBVH
+    std::vector<Vec3>            _occluderPositions;
+    std::vector<unsigned short>  _occluderIndices;
     
     struct AsyncLoadParam
     {
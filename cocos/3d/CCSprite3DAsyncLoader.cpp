@@ -0,0 +1,418 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "3d/CCSprite3DAsyncLoader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <unordered_set>
+#include "3d/CCBundle3D.h"
+#include "3d/CCMesh.h"
+#include "3d/CCMeshVertexIndexData.h"
+#include "3d/CCSprite3D.h"
+#include "base/CCAsyncTaskPool.h"
+#include "base/CCDirector.h"
+#include "base/CCScheduler.h"
+#include "base/ccUTF8.h"
+#include "platform/CCFileUtils.h"
+#include "renderer/CCTextureCache.h"
+
+NS_CC_BEGIN
+
+namespace
+{
+    // share of the progress of every stage, uploading takes the rest
+    const float READ_PROGRESS = 0.1f;
+    const float PARSE_PROGRESS = 0.4f;
+    const float TEXTURE_PROGRESS = 0.2f;
+
+    const char* UPLOAD_KEY = "Sprite3DAsyncLoader::upload";
+
+    float s_uploadBudget = 2.0f;
+    // time spent uploading by every loader in the current frame
+    unsigned int s_budgetFrame = 0;
+    float s_budgetSpent = 0.0f;
+}
+
+Sprite3DAsyncLoader* Sprite3DAsyncLoader::load(const std::string& modelPath, const LoadCallback& callback)
+{
+    return load(modelPath, "", callback);
+}
+
+Sprite3DAsyncLoader* Sprite3DAsyncLoader::load(const std::string& modelPath, const std::string& texturePath, const LoadCallback& callback)
+{
+    auto loader = new (std::nothrow) Sprite3DAsyncLoader();
+    if (loader)
+    {
+        loader->_modelPath = modelPath;
+        loader->_texturePath = texturePath;
+        loader->_callback = callback;
+        loader->autorelease();
+        loader->start();
+    }
+    return loader;
+}
+
+void Sprite3DAsyncLoader::setUploadBudget(float milliseconds)
+{
+    s_uploadBudget = milliseconds;
+}
+
+float Sprite3DAsyncLoader::getUploadBudget()
+{
+    return s_uploadBudget;
+}
+
+Sprite3DAsyncLoader::Sprite3DAsyncLoader()
+: _state(State::READING)
+, _progress(0.0f)
+, _cancelled(false)
+, _retainedSelf(false)
+, _pendingTasks(0)
+, _bundle(nullptr)
+, _isObj(false)
+, _readResult(false)
+, _meshCount(-1)
+, _meshDatas(nullptr)
+, _materialDatas(nullptr)
+, _nodeDatas(nullptr)
+, _parseTasks(0)
+, _parsedTasks(0)
+, _loadedTextures(0)
+, _uploadedMeshes(0)
+{
+}
+
+Sprite3DAsyncLoader::~Sprite3DAsyncLoader()
+{
+    if (_bundle)
+        Bundle3D::destroyBundle(_bundle);
+    CC_SAFE_DELETE(_meshDatas);
+    CC_SAFE_DELETE(_materialDatas);
+    CC_SAFE_DELETE(_nodeDatas);
+}
+
+void Sprite3DAsyncLoader::start()
+{
+    retain();
+    _retainedSelf = true;
+
+    // a model already loaded is built at once, on the next frame so the callback doesn't run before load() returns
+    if (Sprite3DCache::getInstance()->getSpriteData(_modelPath))
+    {
+        _state = State::UPLOADING;
+        ++_pendingTasks;
+        Director::getInstance()->getScheduler()->performFunctionInCocosThread([this]() {
+            --_pendingTasks;
+            if (_cancelled)
+                releaseIfIdle();
+            else
+                finish();
+        });
+        return;
+    }
+
+    _fullPath = FileUtils::getInstance()->fullPathForFilename(_modelPath);
+    _isObj = (FileUtils::getInstance()->getFileExtension(_modelPath) == ".obj");
+    _meshDatas = new (std::nothrow) MeshDatas();
+    _materialDatas = new (std::nothrow) MaterialDatas();
+    _nodeDatas = new (std::nothrow) NodeDatas();
+
+    ++_pendingTasks;
+    AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_IO, [this](void*) {
+        onFileRead();
+    }, nullptr, [this]() {
+        if (_cancelled)
+            return;
+        if (_isObj)
+        {
+            // obj files are parsed at once
+            _readResult = Bundle3D::loadObj(*_meshDatas, *_materialDatas, *_nodeDatas, _fullPath);
+            return;
+        }
+        _bundle = Bundle3D::createBundle();
+        _readResult = _bundle->load(_fullPath);
+        if (_readResult)
+            _meshCount = _bundle->prepareMeshDatas();
+    });
+}
+
+void Sprite3DAsyncLoader::onFileRead()
+{
+    --_pendingTasks;
+    if (_cancelled)
+    {
+        releaseIfIdle();
+        return;
+    }
+    if (!_readResult)
+    {
+        fail();
+        return;
+    }
+
+    _state = State::PARSING;
+    updateProgress(READ_PROGRESS);
+    if (_isObj)
+    {
+        loadTextures();
+        return;
+    }
+
+    auto pool = AsyncTaskPool::getInstance();
+    auto bundle = _bundle;
+    auto callback = [this](void*) { onParsed(); };
+    if (_meshCount < 0)
+    {
+        // older files are parsed at once
+        _parseResults.assign(1, 0);
+        _parseTasks = 1;
+        ++_pendingTasks;
+        pool->enqueue(AsyncTaskPool::TaskType::TASK_COMPUTE, callback, nullptr, [this, bundle]() {
+            if (!_cancelled)
+                _parseResults[0] = bundle->loadMeshDatas(*_meshDatas) && bundle->loadMaterials(*_materialDatas) && bundle->loadNodes(*_nodeDatas);
+        });
+        return;
+    }
+
+    // one task for the materials and the nodes, one per mesh
+    for (int i = 0; i < _meshCount; ++i)
+        _meshDatas->meshDatas.push_back(new (std::nothrow) MeshData());
+    _parseResults.assign(_meshCount + 1, 0);
+    _parseTasks = _meshCount + 1;
+    _pendingTasks += _parseTasks;
+    pool->enqueue(AsyncTaskPool::TaskType::TASK_COMPUTE, callback, nullptr, [this, bundle]() {
+        if (!_cancelled)
+            _parseResults[_meshCount] = bundle->loadMaterials(*_materialDatas) && bundle->loadNodes(*_nodeDatas);
+    });
+    for (int i = 0; i < _meshCount; ++i)
+    {
+        auto meshData = _meshDatas->meshDatas[i];
+        pool->enqueue(AsyncTaskPool::TaskType::TASK_COMPUTE, callback, nullptr, [this, bundle, i, meshData]() {
+            if (!_cancelled)
+                _parseResults[i] = bundle->loadMeshData(i, meshData);
+        });
+    }
+}
+
+void Sprite3DAsyncLoader::onParsed()
+{
+    --_pendingTasks;
+    ++_parsedTasks;
+    if (_cancelled)
+    {
+        releaseIfIdle();
+        return;
+    }
+
+    updateProgress(READ_PROGRESS + PARSE_PROGRESS * _parsedTasks / _parseTasks);
+    if (_parsedTasks < _parseTasks)
+        return;
+
+    // the meshes keep what they need of the file, mapped meshes share it
+    Bundle3D::destroyBundle(_bundle);
+    _bundle = nullptr;
+    for (auto result : _parseResults)
+    {
+        if (!result)
+        {
+            fail();
+            return;
+        }
+    }
+    loadTextures();
+}
+
+void Sprite3DAsyncLoader::loadTextures()
+{
+    _state = State::LOADING_TEXTURES;
+
+    std::vector<std::string> fileNames;
+    std::unordered_set<std::string> known;
+    for (const auto& material : _materialDatas->materials)
+    {
+        for (const auto& texture : material.textures)
+        {
+            if (!texture.filename.empty() && known.insert(texture.filename).second)
+                fileNames.push_back(texture.filename);
+        }
+    }
+    if (!_texturePath.empty() && known.insert(_texturePath).second)
+        fileNames.push_back(_texturePath);
+
+    if (fileNames.empty())
+    {
+        updateProgress(READ_PROGRESS + PARSE_PROGRESS + TEXTURE_PROGRESS);
+        startUpload();
+        return;
+    }
+
+    // textures already cached call back at once, so every key is known before the first request
+    for (const auto& fileName : fileNames)
+        _textureKeys.push_back(StringUtils::format("Sprite3DAsyncLoader:%p:", this) + fileName);
+    auto textureCache = Director::getInstance()->getTextureCache();
+    auto keys = _textureKeys;
+    for (size_t i = 0; i < fileNames.size() && !_cancelled; ++i)
+    {
+        textureCache->addImageAsync(fileNames[i], [this](Texture2D*) {
+            onTextureLoaded();
+        }, keys[i]);
+    }
+}
+
+void Sprite3DAsyncLoader::onTextureLoaded()
+{
+    // a missing texture is reported again when the sprite uses it
+    ++_loadedTextures;
+    updateProgress(READ_PROGRESS + PARSE_PROGRESS + TEXTURE_PROGRESS * _loadedTextures / _textureKeys.size());
+    if (_loadedTextures == (int)_textureKeys.size())
+    {
+        _textureKeys.clear();
+        startUpload();
+    }
+}
+
+void Sprite3DAsyncLoader::startUpload()
+{
+    _state = State::UPLOADING;
+    Director::getInstance()->getScheduler()->schedule([this](float) {
+        upload();
+    }, this, 0, false, UPLOAD_KEY);
+}
+
+void Sprite3DAsyncLoader::upload()
+{
+    auto frame = Director::getInstance()->getTotalFrames();
+    if (frame != s_budgetFrame)
+    {
+        s_budgetFrame = frame;
+        s_budgetSpent = 0.0f;
+    }
+
+    auto& meshes = _meshDatas->meshDatas;
+    // the first mesh of a frame goes whatever the budget, so loads always move on
+    while (_uploadedMeshes < meshes.size() && (s_budgetSpent == 0.0f || s_budgetSpent < s_uploadBudget))
+    {
+        auto start = std::chrono::steady_clock::now();
+        auto& meshData = meshes[_uploadedMeshes++];
+        if (meshData)
+        {
+            _meshVertexDatas.pushBack(MeshVertexData::create(*meshData));
+            CC_SAFE_DELETE(meshData);
+        }
+        std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        s_budgetSpent += std::max(elapsed.count(), 0.001f);
+        updateProgress(READ_PROGRESS + PARSE_PROGRESS + TEXTURE_PROGRESS
+                       + (1.0f - READ_PROGRESS - PARSE_PROGRESS - TEXTURE_PROGRESS) * _uploadedMeshes / meshes.size());
+    }
+
+    if (_uploadedMeshes == meshes.size())
+        finish();
+}
+
+void Sprite3DAsyncLoader::finish()
+{
+    Director::getInstance()->getScheduler()->unschedule(UPLOAD_KEY, this);
+
+    auto sprite = new (std::nothrow) Sprite3D();
+    // another load of the same model may have ended first
+    bool result = false;
+    if (Sprite3DCache::getInstance()->getSpriteData(_modelPath))
+    {
+        result = sprite->loadFromCache(_modelPath);
+    }
+    else if (sprite->initFrom(*_nodeDatas, _meshVertexDatas, *_materialDatas))
+    {
+        auto data = new (std::nothrow) Sprite3DCache::Sprite3DData();
+        data->materialdatas = _materialDatas;
+        data->nodedatas = _nodeDatas;
+        data->meshVertexDatas = _meshVertexDatas;
+        for (const auto mesh : sprite->getMeshes())
+            data->glProgramStates.pushBack(mesh->getGLProgramState());
+        Sprite3DCache::getInstance()->addSprite3DData(_modelPath, data);
+        _materialDatas = nullptr;
+        _nodeDatas = nullptr;
+        result = true;
+    }
+    _meshVertexDatas.clear();
+    sprite->autorelease();
+
+    if (!result)
+    {
+        fail();
+        return;
+    }
+    if (!_texturePath.empty())
+        sprite->setTexture(_texturePath);
+
+    _state = State::DONE;
+    updateProgress(1.0f);
+    if (_callback)
+        _callback(sprite);
+    releaseIfIdle();
+}
+
+void Sprite3DAsyncLoader::fail()
+{
+    CCLOG("file load failed: %s ", _modelPath.c_str());
+    _state = State::FAILED;
+    if (_callback)
+        _callback(nullptr);
+    releaseIfIdle();
+}
+
+void Sprite3DAsyncLoader::cancel()
+{
+    if (_state == State::DONE || _state == State::FAILED || _state == State::CANCELLED)
+        return;
+
+    _cancelled = true;
+    _state = State::CANCELLED;
+    Director::getInstance()->getScheduler()->unschedule(UPLOAD_KEY, this);
+    auto textureCache = Director::getInstance()->getTextureCache();
+    for (const auto& key : _textureKeys)
+        textureCache->unbindImageAsync(key);
+    _textureKeys.clear();
+    releaseIfIdle();
+}
+
+void Sprite3DAsyncLoader::updateProgress(float progress)
+{
+    _progress = progress;
+    if (_progressCallback)
+        _progressCallback(progress);
+}
+
+void Sprite3DAsyncLoader::releaseIfIdle()
+{
+    bool ended = (_state == State::DONE || _state == State::FAILED || _state == State::CANCELLED);
+    if (ended && _retainedSelf && _pendingTasks == 0)
+    {
+        _retainedSelf = false;
+        release();
+    }
+}
+
+NS_CC_END
@@ -0,0 +1,162 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __CCSPRITE3DASYNCLOADER_H__
+#define __CCSPRITE3DASYNCLOADER_H__
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+#include "base/CCRef.h"
+#include "base/CCVector.h"
+#include "3d/CCBundle3DData.h"
+
+NS_CC_BEGIN
+
+class Bundle3D;
+class MeshVertexData;
+class Sprite3D;
+
+/**
+ * @addtogroup _3d
+ * @{
+ */
+
+/**
+ * @brief Loads a Sprite3D in stages, so the main thread never does more than its share of a frame.
+ *
+ * - The file is read, and a c3t file parsed, by an IO task.
+ * - Every mesh is parsed by a compute task of its own, materials and nodes by one more, so they
+ *   run in parallel on the compute threads of AsyncTaskPool.
+ * - The textures of the materials are loaded with TextureCache::addImageAsync().
+ * - The meshes are uploaded on the main thread, as many per frame as the upload budget allows,
+ *   then the sprite is built and the model added to Sprite3DCache.
+ *
+ * A load can be cancelled at any stage, and reports its progress on the main thread.
+ * Sprite3D::createAsync() loads this way.
+ * @since v3.18
+ */
+class CC_DLL Sprite3DAsyncLoader : public Ref
+{
+public:
+    enum class State
+    {
+        READING,
+        PARSING,
+        LOADING_TEXTURES,
+        UPLOADING,
+        DONE,
+        FAILED,
+        CANCELLED,
+    };
+
+    /** Called on the main thread with the loaded sprite, or nullptr if the model couldn't be loaded. Not called once cancelled. */
+    typedef std::function<void(Sprite3D*)> LoadCallback;
+    /** Called on the main thread with the progress of the load, from 0 to 1. */
+    typedef std::function<void(float)> ProgressCallback;
+
+    /**
+     * Starts loading a model. The loader keeps itself alive until the load ends or is cancelled,
+     * retain it to use it later.
+     * @param modelPath The .c3b, .c3t or .obj file to load
+     * @param texturePath Texture that overrides the ones of the model, may be empty
+     * @param callback Called with the sprite once loaded
+     */
+    static Sprite3DAsyncLoader* load(const std::string& modelPath, const std::string& texturePath, const LoadCallback& callback);
+    static Sprite3DAsyncLoader* load(const std::string& modelPath, const LoadCallback& callback);
+
+    /**
+     * Sets how many milliseconds per frame the loads in progress spend uploading meshes, together.
+     * At least one mesh is uploaded per frame. The default is 2.
+     */
+    static void setUploadBudget(float milliseconds);
+    static float getUploadBudget();
+
+    void setProgressCallback(const ProgressCallback& callback) { _progressCallback = callback; }
+
+    /** Stops the load, its callback isn't called. Tasks already running finish and their results are dropped. */
+    void cancel();
+
+    State getState() const { return _state; }
+    float getProgress() const { return _progress; }
+    const std::string& getModelPath() const { return _modelPath; }
+
+CC_CONSTRUCTOR_ACCESS:
+    Sprite3DAsyncLoader();
+    virtual ~Sprite3DAsyncLoader();
+
+protected:
+    void start();
+    void onFileRead();
+    void onParsed();
+    void loadTextures();
+    void onTextureLoaded();
+    void startUpload();
+    void upload();
+    void finish();
+    void fail();
+    void updateProgress(float progress);
+    // drops the reference the loader holds on itself once no task points to it anymore
+    void releaseIfIdle();
+
+    std::string _modelPath;
+    std::string _texturePath;
+    std::string _fullPath;
+    LoadCallback _callback;
+    ProgressCallback _progressCallback;
+
+    State _state;
+    float _progress;
+    std::atomic<bool> _cancelled;
+    bool _retainedSelf;
+    // tasks of AsyncTaskPool whose callback hasn't run yet
+    int _pendingTasks;
+
+    Bundle3D* _bundle;
+    bool _isObj;
+    bool _readResult;
+    int _meshCount;
+    MeshDatas* _meshDatas;
+    MaterialDatas* _materialDatas;
+    NodeDatas* _nodeDatas;
+    // written by one task each, read on the main thread once the tasks are done
+    std::vector<char> _parseResults;
+    int _parseTasks;
+    int _parsedTasks;
+
+    std::vector<std::string> _textureKeys;
+    int _loadedTextures;
+
+    Vector<MeshVertexData*> _meshVertexDatas;
+    size_t _uploadedMeshes;
+};
+
+// end of 3d group
+/// @}
+
+NS_CC_END
+
+#endif // __CCSPRITE3DASYNCLOADER_H__
@@ -28,7 +28,7 @@ THE SOFTWARE.
 USING_NS_CC;
 #include <stdlib.h>
 #include <float.h>
-#include <set>
+#include <algorithm>
 #include "renderer/CCGLProgram.h"
 #include "renderer/CCGLProgramCache.h"
 #include "renderer/CCGLProgramState.h"
@@ -38,11 +38,62 @@ USING_NS_CC;
 #include "renderer/CCRenderState.h"
 #include "base/CCDirector.h"
 #include "base/CCEventType.h"
+#include "base/CCAsyncTaskPool.h"
 #include "2d/CCCamera.h"
+#include "2d/CCScene.h"
+#include "3d/CCSceneBVH.h"
 #include "platform/CCImage.h"
+#include "renderer/CCTextureCache.h"
 
 NS_CC_BEGIN
 
+// clip the range [enter, exit] of a ray to the slab between min and max on one axis
+static inline bool clipRayToSlab(float origin, float direction, float min, float max, float& enter, float& exit)
+{
+    if (direction == 0.0f)
+        return origin >= min && origin <= max;
+    float inverse = 1.0f / direction;
+    float t1 = (min - origin) * inverse;
+    float t2 = (max - origin) * inverse;
+    if (t1 > t2)
+        std::swap(t1, t2);
+    enter = std::max(enter, t1);
+    exit = std::min(exit, t2);
+    return enter <= exit;
+}
+
+// same test as Terrain::Triangle::getIntersectPoint, returning the distance and ignoring the hits behind the origin
+static inline bool intersectRayTriangle(const Vec3& origin, const Vec3& direction, const Vec3& p1, const Vec3& p2, const Vec3& p3, float& distance)
+{
+    Vec3 E1 = p2 - p1;
+    Vec3 E2 = p3 - p1;
+    Vec3 P;
+    Vec3::cross(direction, E2, &P);
+    float det = E1.dot(P);
+    Vec3 T;
+    if (det > 0)
+    {
+        T = origin - p1;
+    }
+    else
+    {
+        T = p1 - origin;
+        det = -det;
+    }
+    if (det < 0.0001f)
+        return false;
+    float u = T.dot(P);
+    if (u < 0.0f || u > det)
+        return false;
+    Vec3 Q;
+    Vec3::cross(T, E1, &Q);
+    float v = direction.dot(Q);
+    if (v < 0.0f || u + v > det)
+        return false;
+    distance = E2.dot(Q) / det;
+    return distance >= 0.0f;
+}
+
 // check a number is power of two.
 static bool isPOT(int number)
 {
@@ -82,6 +133,41 @@ bool Terrain::initWithTerrainData(TerrainData &parameter, CrackFixedType fixedTy
     return initResult;
 }
 
+void Terrain::createAsync(const TerrainData &parameter, CrackFixedType fixedType, const std::function<void(Terrain*, void*)>& callback, void* callbackparam)
+{
+    auto terrain = new (std::nothrow) Terrain();
+    terrain->setSkirtHeightRatio(parameter._skirtHeightRatio);
+    terrain->_terrainData = parameter;
+    terrain->_crackFixedType = fixedType;
+    terrain->_isCameraViewChanged = true;
+    terrain->_chunkSize = parameter._chunkSize;
+    terrain->_shareDetailMaps = true;
+
+    auto loaded = std::make_shared<bool>(false);
+    AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_COMPUTE, [terrain, loaded, callback](void* param)
+    {
+        if (!*loaded)
+        {
+            delete terrain;
+            callback(nullptr, param);
+            return;
+        }
+        terrain->finishHeightMap();
+        terrain->initTextures();
+        terrain->initProperties();
+        terrain->autorelease();
+        callback(terrain, param);
+    }, callbackparam, [terrain, loaded]()
+    {
+        *loaded = terrain->loadHeightMap(terrain->_terrainData._heightMapSrc);
+        if (*loaded && !terrain->_terrainData._alphaMapSrc.empty())
+        {
+            terrain->_alphaMapImage = new (std::nothrow) Image();
+            terrain->_alphaMapImage->initWithImageFile(terrain->_terrainData._alphaMapSrc);
+        }
+    });
+}
+
 void cocos2d::Terrain::setLightMap(const std::string& fileName)
 {
     CC_SAFE_RELEASE(_lightMap);
@@ -123,6 +209,16 @@ bool Terrain::initProperties()
 
 void Terrain::draw(cocos2d::Renderer *renderer, const cocos2d::Mat4 &transform, uint32_t flags)
 {
+    // the root of the quad tree culls the whole terrain before anything is queued
+    auto camera = Camera::getVisitingCamera();
+    if (_isEnableFrustumCull && camera)
+    {
+        AABB aabb = _quadRoot->_localAABB;
+        aabb.transform(transform);
+        if (!camera->isVisibleInFrustum(&aabb))
+            return;
+    }
+
     _customCommand.func = CC_CALLBACK_0(Terrain::onDraw, this, transform, flags);
     renderer->addCommand(&_customCommand);
 }
@@ -156,6 +252,7 @@ void Terrain::onDraw(const Mat4 &transform, uint32_t /*flags*/)
     glUniform3f(_lightDirLocation,_lightDir.x,_lightDir.y,_lightDir.z);
     if(!_alphaMap)
     {
+        _detailMapTextures[0]->markAsUsed();
         GL::bindTexture2D(_detailMapTextures[0]->getName());
         //getGLProgramState()->setUniformTexture("")
         glUniform1i(_detailMapLocation[0],0);
@@ -164,6 +261,7 @@ void Terrain::onDraw(const Mat4 &transform, uint32_t /*flags*/)
     {
         for(int i =0;i<_maxDetailMapValue;++i)
         {
+            _detailMapTextures[i]->markAsUsed();
             GL::bindTexture2DN(i,_detailMapTextures[i]->getName());
             glUniform1i(_detailMapLocation[i],i);
 
@@ -172,12 +270,14 @@ void Terrain::onDraw(const Mat4 &transform, uint32_t /*flags*/)
 
         glUniform1i(_alphaIsHasAlphaMapLocation,1);
 
+        _alphaMap->markAsUsed();
         GL::bindTexture2DN(4, _alphaMap->getName());
         glUniform1i(_alphaMapLocation,4);
     }
     if (_lightMap)
     {
         glUniform1i(_lightMapCheckLocation, 1);
+        _lightMap->markAsUsed();
         GL::bindTexture2DN(5, _lightMap->getName());
         glUniform1i(_lightMapLocation, 5);
     }else
@@ -200,7 +300,11 @@ void Terrain::onDraw(const Mat4 &transform, uint32_t /*flags*/)
         setChunksLOD(Vec3(m.m[12], m.m[13], m.m[14]));
     }
 
-    if(_isCameraViewChanged )
+    // the chunks hidden by the occluders of the scene change every frame
+    auto scene = getScene();
+    auto occlusionBuffer = (scene && _isEnableFrustumCull) ? scene->getSceneBVH()->getOcclusionBuffer(camera) : nullptr;
+
+    if(_isCameraViewChanged || occlusionBuffer || _isOcclusionCulled)
     {
         _quadRoot->resetNeedDraw(true);//reset it
         //camera frustum culling
@@ -209,6 +313,11 @@ void Terrain::onDraw(const Mat4 &transform, uint32_t /*flags*/)
             _quadRoot->cullByCamera(camera, _terrainModelMatrix);
         }
     }
+    if (occlusionBuffer)
+    {
+        _quadRoot->cullByOcclusion(occlusionBuffer);
+    }
+    _isOcclusionCulled = occlusionBuffer != nullptr;
     _quadRoot->draw();
     if(_isCameraViewChanged)
     {
@@ -225,6 +334,14 @@ void Terrain::onDraw(const Mat4 &transform, uint32_t /*flags*/)
 }
 
 bool Terrain::initHeightMap(const std::string& heightMap)
+{
+    if (!loadHeightMap(heightMap))
+        return false;
+    finishHeightMap();
+    return true;
+}
+
+bool Terrain::loadHeightMap(const std::string& heightMap)
 {
     _heightMapImage = new (std::nothrow) Image();
     _heightMapImage->initWithImageFile(heightMap);
@@ -239,6 +356,7 @@ bool Terrain::initHeightMap(const std::string& heightMap)
         int chunk_amount_x = _imageWidth/_chunkSize.width;
         loadVertices();
         calculateNormal();
+        buildHeightPyramid();
         memset(_chunkesArray, 0, sizeof(_chunkesArray));
 
         for(int m =0;m<chunk_amount_y;m++)
@@ -273,10 +391,28 @@ bool Terrain::initHeightMap(const std::string& heightMap)
     }
 }
 
+void Terrain::finishHeightMap()
+{
+    int chunk_amount_y = _imageHeight/_chunkSize.height;
+    int chunk_amount_x = _imageWidth/_chunkSize.width;
+    for(int m =0;m<chunk_amount_y;m++)
+    {
+        for(int n =0; n<chunk_amount_x;n++)
+        {
+            _chunkesArray[m][n]->finish();
+        }
+    }
+}
+
 Terrain::Terrain()
-: _alphaMap(nullptr)
+: _data(nullptr)
+, _alphaMap(nullptr)
 , _lightMap(nullptr)
 , _lightDir(-1.f, -1.f, 0.f)
+, _quadRoot(nullptr)
+, _heightMapImage(nullptr)
+, _alphaMapImage(nullptr)
+, _shareDetailMaps(false)
 , _stateBlock(nullptr)
 #if CC_ENABLE_CACHE_TEXTURE_DATA
 , _backToForegroundListener(nullptr)
@@ -284,6 +420,8 @@ Terrain::Terrain()
 {
     _stateBlock = RenderState::StateBlock::create();
     CC_SAFE_RETAIN(_stateBlock);
+    memset(_detailMapTextures, 0, sizeof(_detailMapTextures));
+    memset(_chunkesArray, 0, sizeof(_chunkesArray));
 
     _customCommand.setTransparent(false);
     _customCommand.set3D(true);
@@ -461,6 +599,173 @@ void Terrain::calculateNormal()
     _indices.clear();
 }
 
+void Terrain::buildHeightPyramid()
+{
+    _heightPyramid.clear();
+    if (_imageWidth < 2 || _imageHeight < 2)
+        return;
+
+    // one range per cell, the square between four vertices
+    HeightPyramidLevel level;
+    level._width = _imageWidth - 1;
+    level._height = _imageHeight - 1;
+    level._ranges.resize(level._width * level._height);
+    for (int i = 0; i < level._height; ++i)
+    {
+        for (int j = 0; j < level._width; ++j)
+        {
+            int index = i * _imageWidth + j;
+            float a = _vertices[index]._position.y;
+            float b = _vertices[index + 1]._position.y;
+            float c = _vertices[index + _imageWidth]._position.y;
+            float d = _vertices[index + _imageWidth + 1]._position.y;
+            auto& range = level._ranges[i * level._width + j];
+            range._min = std::min(std::min(a, b), std::min(c, d));
+            range._max = std::max(std::max(a, b), std::max(c, d));
+        }
+    }
+    _heightPyramid.push_back(std::move(level));
+
+    // halve until a single range covers the whole terrain
+    while (_heightPyramid.back()._width > 1 || _heightPyramid.back()._height > 1)
+    {
+        const auto& below = _heightPyramid.back();
+        HeightPyramidLevel above;
+        above._width = (below._width + 1) / 2;
+        above._height = (below._height + 1) / 2;
+        above._ranges.resize(above._width * above._height);
+        for (int i = 0; i < above._height; ++i)
+        {
+            for (int j = 0; j < above._width; ++j)
+            {
+                HeightRange range = below._ranges[(i * 2) * below._width + j * 2];
+                for (int k = 1; k < 4; ++k)
+                {
+                    int x = j * 2 + (k & 1);
+                    int y = i * 2 + (k >> 1);
+                    if (x >= below._width || y >= below._height)
+                        continue;
+                    const auto& child = below._ranges[y * below._width + x];
+                    range._min = std::min(range._min, child._min);
+                    range._max = std::max(range._max, child._max);
+                }
+                above._ranges[i * above._width + j] = range;
+            }
+        }
+        _heightPyramid.push_back(std::move(above));
+    }
+}
+
+bool Terrain::intersectHeightPyramid(const Ray& worldRay, const Mat4& worldToNode, const Mat4& nodeToWorld, Vec3& intersectionPoint) const
+{
+    if (_heightPyramid.empty())
+        return false;
+
+    // convert the ray from world space to local space
+    Vec3 origin = worldRay._origin;
+    Vec3 direction = worldRay._direction;
+    worldToNode.transformPoint(&origin);
+    worldToNode.transformVector(&direction);
+    if (direction.isZero())
+        return false;
+    direction.normalize();
+
+    // the cells are laid out like the vertices of loadVertices()
+    const float scale = _terrainData._mapScale;
+    const float left = -(_imageWidth / 2) * scale;
+    const float back = -(_imageHeight / 2) * scale;
+    const int cellsX = _heightPyramid[0]._width;
+    const int cellsY = _heightPyramid[0]._height;
+
+    struct Entry
+    {
+        int level;
+        int x;
+        int y;
+        float distance;
+    };
+    float nearest = FLT_MAX;
+    // the distance where the ray enters the box of a node, if it hits it before the nearest hit
+    auto enter = [&](int level, int x, int y, float& distance) -> bool
+    {
+        const auto& pyramidLevel = _heightPyramid[level];
+        const auto& range = pyramidLevel._ranges[y * pyramidLevel._width + x];
+        int x0 = x << level;
+        int y0 = y << level;
+        int x1 = std::min((x + 1) << level, cellsX);
+        int y1 = std::min((y + 1) << level, cellsY);
+        float exit = nearest;
+        distance = 0.0f;
+        return clipRayToSlab(origin.y, direction.y, range._min, range._max, distance, exit)
+            && clipRayToSlab(origin.x, direction.x, left + x0 * scale, left + x1 * scale, distance, exit)
+            && clipRayToSlab(origin.z, direction.z, back + y0 * scale, back + y1 * scale, distance, exit);
+    };
+
+    // depth first, the nearest child first, skipping the nodes behind the nearest hit
+    Entry stack[128];
+    int stackSize = 0;
+    int top = (int)_heightPyramid.size() - 1;
+    float distance;
+    if (!enter(top, 0, 0, distance))
+        return false;
+    stack[stackSize++] = { top, 0, 0, distance };
+    bool hit = false;
+    while (stackSize > 0)
+    {
+        Entry node = stack[--stackSize];
+        if (node.distance > nearest)
+            continue;
+
+        if (node.level == 0)
+        {
+            // the two triangles of the cell, split like the chunks do
+            int index = node.y * _imageWidth + node.x;
+            const Vec3& p0 = _vertices[index]._position;
+            const Vec3& p1 = _vertices[index + 1]._position;
+            const Vec3& p2 = _vertices[index + _imageWidth]._position;
+            const Vec3& p3 = _vertices[index + _imageWidth + 1]._position;
+            if (intersectRayTriangle(origin, direction, p0, p2, p1, distance) && distance < nearest)
+            {
+                nearest = distance;
+                hit = true;
+            }
+            if (intersectRayTriangle(origin, direction, p1, p2, p3, distance) && distance < nearest)
+            {
+                nearest = distance;
+                hit = true;
+            }
+            continue;
+        }
+
+        Entry children[4];
+        int childCount = 0;
+        int level = node.level - 1;
+        const auto& below = _heightPyramid[level];
+        for (int k = 0; k < 4; ++k)
+        {
+            int x = node.x * 2 + (k & 1);
+            int y = node.y * 2 + (k >> 1);
+            if (x < below._width && y < below._height && enter(level, x, y, distance))
+            {
+                children[childCount++] = { level, x, y, distance };
+            }
+        }
+        // pushed farthest first, so the nearest is visited next
+        std::sort(children, children + childCount, [](const Entry& a, const Entry& b) { return a.distance > b.distance; });
+        for (int k = 0; k < childCount; ++k)
+        {
+            stack[stackSize++] = children[k];
+        }
+    }
+
+    if (hit)
+    {
+        intersectionPoint = origin + direction * nearest;
+        nodeToWorld.transformPoint(&intersectionPoint);
+    }
+    return hit;
+}
+
 void Terrain::setDrawWire(bool bool_value)
 {
     _isDrawWire = bool_value;
@@ -484,6 +789,7 @@ Terrain::~Terrain()
     CC_SAFE_RELEASE(_alphaMap);
     CC_SAFE_RELEASE(_lightMap);
     CC_SAFE_RELEASE(_heightMapImage);
+    CC_SAFE_RELEASE(_alphaMapImage);
     delete _quadRoot;
     for(int i=0;i<4;++i)
     {
@@ -545,64 +851,28 @@ cocos2d::Vec3 Terrain::getIntersectionPoint(const Ray & ray) const
     }
 }
 
-bool Terrain::getIntersectionPoint(const Ray & ray_, Vec3 & intersectionPoint) const
-{
-    // convert ray from world space to local space
-    Ray ray(ray_);
-    getWorldToNodeTransform().transformPoint(&(ray._origin));
-
-    std::set<Chunk *> closeList;
-    Vec2 start = Vec2(ray_._origin.x,ray_._origin.z);
-    Vec2 dir = Vec2(ray._direction.x,ray._direction.z);
-    start = convertToTerrainSpace(start);
-    start.x /=(_terrainData._chunkSize.width+1);
-    start.y /=(_terrainData._chunkSize.height+1);
-    Vec2 delta = dir.getNormalized();
-    auto width = float(_imageWidth) / (_terrainData._chunkSize.width + 1);
-    auto height = float(_imageHeight) / (_terrainData._chunkSize.height + 1);
-    bool hasIntersect = false;
-    float intersectionDist = FLT_MAX;
-    Vec3 tmpIntersectionPoint;
-    for(;;)
-    {
-        int x1 = floorf(start.x);
-        int x2 = ceilf(start.x);
-        int y1 = floorf(start.y);
-        int y2 = ceilf(start.y);
-        for (int x = x1; x <= x2; x++) {
-            for (int y = y1; y <= y2; y++) {
-                auto chunk = getChunkByIndex(x, y);
-                if (chunk)
-                {
-                    if (closeList.find(chunk) == closeList.end())
-                    {
-                        if (chunk->getIntersectPointWithRay(ray, tmpIntersectionPoint))
-                        {
-                            float dist = (ray._origin - tmpIntersectionPoint).length();
-                            if (intersectionDist > dist)
-                            {
-                                hasIntersect = true;
-                                intersectionDist = dist;
-                                intersectionPoint = tmpIntersectionPoint;
-                            }
-                        }
-                        closeList.insert(chunk);
-                    }
-                }
-            }
-        }
-        if ((delta.x > 0 && start.x > width) || (delta.x <0 && start.x <0))
-        {
-            break;
-        }
-        if ((delta.y > 0 && start.y > height) || (delta.y < 0 && start.y < 0))
+bool Terrain::getIntersectionPoint(const Ray & ray, Vec3 & intersectionPoint) const
+{
+    return intersectHeightPyramid(ray, getWorldToNodeTransform(), getNodeToWorldTransform(), intersectionPoint);
+}
+
+int Terrain::getIntersectionPoints(const std::vector<Ray> & rays, std::vector<Vec3> & intersectionPoints, std::vector<bool> & hits) const
+{
+    // the transforms are shared by all the rays
+    const Mat4 worldToNode = getWorldToNodeTransform();
+    const Mat4 nodeToWorld = getNodeToWorldTransform();
+    intersectionPoints.resize(rays.size());
+    hits.assign(rays.size(), false);
+    int hitCount = 0;
+    for (size_t i = 0, size = rays.size(); i < size; ++i)
+    {
+        if (intersectHeightPyramid(rays[i], worldToNode, nodeToWorld, intersectionPoints[i]))
         {
-            break;
+            hits[i] = true;
+            ++hitCount;
         }
-        start.x += delta.x;
-        start.y += delta.y;
     }
-    return hasIntersect;
+    return hitCount;
 }
 
 void Terrain::setMaxDetailMapAmount(int max_value)
@@ -687,6 +957,54 @@ std::vector<float> Terrain::getHeightData() const
     return data;
 }
 
+size_t Terrain::getMemoryUsage() const
+{
+    size_t bytes = sizeof(Terrain) + _vertices.capacity() * sizeof(TerrainVertexData);
+    for (const auto& level : _heightPyramid)
+    {
+        bytes += level._ranges.capacity() * sizeof(HeightRange);
+    }
+    if (_heightMapImage)
+    {
+        bytes += _heightMapImage->getDataLen();
+    }
+    int chunk_amount_y = _imageHeight/_chunkSize.height;
+    int chunk_amount_x = _imageWidth/_chunkSize.width;
+    for(int m =0;m<chunk_amount_y;m++)
+    {
+        for(int n =0; n<chunk_amount_x;n++)
+        {
+            auto chunk = _chunkesArray[m][n];
+            // the vertex buffer holds a copy of the original vertices
+            bytes += sizeof(Chunk) + (chunk->_originalVertices.capacity() + chunk->_originalVertices.size() + chunk->_currentVertices.capacity()) * sizeof(TerrainVertexData);
+            bytes += chunk->_trianglesList.capacity() * sizeof(Triangle);
+            for(int i =0;i<4;++i)
+            {
+                bytes += chunk->_lod[i]._indices.capacity() * sizeof(GLushort);
+            }
+        }
+    }
+    Texture2D * textures[] = { _alphaMap, _lightMap };
+    for (auto texture : textures)
+    {
+        if (texture)
+        {
+            bytes += texture->getPixelsWide() * texture->getPixelsHigh() * texture->getBitsPerPixelForFormat() / 8;
+        }
+    }
+    if (!_shareDetailMaps)
+    {
+        for(int i =0;i<4;++i)
+        {
+            if (_detailMapTextures[i])
+            {
+                bytes += _detailMapTextures[i]->getPixelsWide() * _detailMapTextures[i]->getPixelsHigh() * _detailMapTextures[i]->getBitsPerPixelForFormat() / 8;
+            }
+        }
+    }
+    return bytes;
+}
+
 Terrain::Chunk * cocos2d::Terrain::getChunkByIndex(int x, int y) const
 {
     if (x<0 || y<0 || x>= MAX_CHUNKES || y >= MAX_CHUNKES) return nullptr;
@@ -862,21 +1180,21 @@ bool Terrain::initTextures()
     texParam.wrapT = GL_REPEAT;
     if(_terrainData._alphaMapSrc.empty())
     {
-        auto textImage = new (std::nothrow)Image();
-        textImage->initWithImageFile(_terrainData._detailMaps[0]._detailMapSrc);
-        auto texture = new (std::nothrow)Texture2D();
-        texture->initWithImage(textImage);
-        texture->generateMipmap();
+        auto texture = createDetailMapTexture(_terrainData._detailMaps[0]._detailMapSrc);
         _detailMapTextures[0] = texture;
         texParam.minFilter = GL_LINEAR_MIPMAP_LINEAR;
         texParam.magFilter = GL_LINEAR;
         texture->setTexParameters(texParam);
-        delete textImage;
     }else
     {
-        //alpha map
-        auto image = new (std::nothrow)Image();
-        image->initWithImageFile(_terrainData._alphaMapSrc);
+        //alpha map, already decoded when created asynchronously
+        auto image = _alphaMapImage;
+        _alphaMapImage = nullptr;
+        if (!image)
+        {
+            image = new (std::nothrow)Image();
+            image->initWithImageFile(_terrainData._alphaMapSrc);
+        }
         _alphaMap = new (std::nothrow)Texture2D();
         _alphaMap->initWithImage(image);
         texParam.wrapS = GL_CLAMP_TO_EDGE;
@@ -888,12 +1206,7 @@ bool Terrain::initTextures()
 
         for(int i =0;i<_terrainData._detailMapAmount;++i)
         {
-            auto textImage = new (std::nothrow)Image();
-            textImage->initWithImageFile(_terrainData._detailMaps[i]._detailMapSrc);
-            auto texture = new (std::nothrow)Texture2D();
-            texture->initWithImage(textImage);
-            delete textImage;
-            texture->generateMipmap();
+            auto texture = createDetailMapTexture(_terrainData._detailMaps[i]._detailMapSrc);
             _detailMapTextures[i] = texture;
 
             texParam.wrapS = GL_REPEAT;
@@ -907,6 +1220,29 @@ bool Terrain::initTextures()
     return true;
 }
 
+Texture2D * Terrain::createDetailMapTexture(const std::string& fileName)
+{
+    Texture2D * texture = nullptr;
+    if (_shareDetailMaps)
+    {
+        texture = Director::getInstance()->getTextureCache()->addImage(fileName);
+        CC_SAFE_RETAIN(texture);
+    }
+    if (!texture)
+    {
+        auto textImage = new (std::nothrow)Image();
+        textImage->initWithImageFile(fileName);
+        texture = new (std::nothrow)Texture2D();
+        texture->initWithImage(textImage);
+        delete textImage;
+    }
+    if (!texture->hasMipmaps())
+    {
+        texture->generateMipmap();
+    }
+    return texture;
+}
+
 void Terrain::reload()
 {
     int chunk_amount_y = _imageHeight/_chunkSize.height;
@@ -937,8 +1273,6 @@ void Terrain::Chunk::finish()
 
     glBindBuffer(GL_ARRAY_BUFFER,0);
 
-    calculateSlope();
-
     for(int i =0;i<4;++i)
     {
         int step = 1<<_currentLod;
@@ -1072,11 +1406,12 @@ void Terrain::Chunk::generate(int imgWidth, int imageHei, int m, int n, const un
     }
 
     calculateAABB();
-    finish();
+    calculateSlope();
 }
 
 Terrain::Chunk::Chunk()
 {
+    _vbo = 0;
     _currentLod = 0;
     _left = nullptr;
     _right = nullptr;
@@ -1568,6 +1903,22 @@ void Terrain::QuadTree::cullByCamera(const Camera * camera, const Mat4 & worldTr
     }
 }
 
+void Terrain::QuadTree::cullByOcclusion(const OcclusionBuffer * buffer)
+{
+    if(!_needDraw)
+        return;
+    if(!buffer->isVisible(_worldSpaceAABB))
+    {
+        this->resetNeedDraw(false);
+    }else if(!_isTerminal)
+    {
+        _tl->cullByOcclusion(buffer);
+        _tr->cullByOcclusion(buffer);
+        _bl->cullByOcclusion(buffer);
+        _br->cullByOcclusion(buffer);
+    }
+}
+
 void Terrain::QuadTree::preCalculateAABB(const Mat4 & worldTransform)
 {
 
@@ -1597,6 +1948,7 @@ Terrain::TerrainData::TerrainData(const std::string& heightMapsrc , const std::s
     this->_chunkSize = chunksize;
     this->_mapHeight = height;
     this->_mapScale = scale;
+    _detailMapAmount = 1;
     _skirtHeightRatio = 1;
 }
 
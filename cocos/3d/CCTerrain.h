@@ -25,6 +25,7 @@ THE SOFTWARE.
 #ifndef CC_TERRAIN_H
 #define CC_TERRAIN_H
 
+#include <functional>
 #include <vector>
 
 #include "2d/CCNode.h"
@@ -39,6 +40,9 @@ THE SOFTWARE.
 
 NS_CC_BEGIN
 
+class Image;
+class OcclusionBuffer;
+
 /**
  * @addtogroup _3d
  * @{
@@ -179,6 +183,25 @@ private:
         int _selfLod;
         ChunkIndices _chunkIndices;
     };
+
+    /*
+    *the lowest and highest vertices of a square of cells
+    **/
+    struct HeightRange
+    {
+        float _min;
+        float _max;
+    };
+
+    /*
+    *a level of the height pyramid, each range covers four ranges of the level below
+    **/
+    struct HeightPyramidLevel
+    {
+        int _width;
+        int _height;
+        std::vector<HeightRange> _ranges;
+    };
     /*
     *terrain vertices internal data format
     **/
@@ -287,6 +310,8 @@ private:
         void resetNeedDraw(bool value);
         /**recursively potential visible culling*/
         void cullByCamera(const Camera * camera, const Mat4 & worldTransform);
+        /**recursively cull the nodes hidden behind the occluders of the scene*/
+        void cullByOcclusion(const OcclusionBuffer * buffer);
         /**precalculate the AABB(In world space) of each quad*/
         void preCalculateAABB(const Mat4 & worldTransform);
         QuadTree * _tl;
@@ -329,6 +354,18 @@ public:
     bool initTextures();
     /**create entry*/
     static Terrain * create(TerrainData &parameter, CrackFixedType fixedType = CrackFixedType::INCREASE_LOWER);
+    /**
+     * create a terrain without blocking the main thread.
+     * The height map and alpha map are decoded and the chunks built on a compute thread of AsyncTaskPool,
+     * only the buffers and textures are created on the main thread.
+     * The detail maps of the terrains created this way are shared through the TextureCache.
+     * @param parameter the terrain data, copied
+     * @param fixedType the crack fix type
+     * @param callback called on the main thread with the terrain, or nullptr if the height map can't be used
+     * @param callbackparam passed to the callback
+     * @since v3.18
+     */
+    static void createAsync(const TerrainData &parameter, CrackFixedType fixedType, const std::function<void(Terrain*, void*)>& callback, void* callbackparam);
     /**get specified position's height mapping to the terrain,use bi-linear interpolation method
      * @param x the X position
      * @param z the Z position
@@ -387,6 +424,16 @@ public:
     */
     bool getIntersectionPoint(const Ray & ray, Vec3 & intersectionPoint) const;
 
+   /**
+    * Ray-Terrain intersection of many rays at once, to place many units for instance.
+    * @param rays the rays to hit the terrain
+    * @param intersectionPoints resized to the number of rays, the hit point of each ray that hits
+    * @param hits resized to the number of rays, whether each ray hits
+    * @return the number of rays that hit
+    * @since v3.18
+    */
+    int getIntersectionPoints(const std::vector<Ray> & rays, std::vector<Vec3> & intersectionPoints, std::vector<bool> & hits) const;
+
     /**
      * set the MaxDetailAmount.
      */
@@ -439,6 +486,12 @@ public:
      */
     std::vector<float> getHeightData() const;
 
+    /**
+     * get the estimated bytes used by the terrain, height map, vertices, buffers and own textures included.
+     * @since v3.18
+     */
+    size_t getMemoryUsage() const;
+
 CC_CONSTRUCTOR_ACCESS:
     Terrain();
     virtual ~Terrain();
@@ -446,6 +499,22 @@ CC_CONSTRUCTOR_ACCESS:
 protected:
     void onDraw(const Mat4 &transform, uint32_t flags);
 
+    /**
+     * load the height map and build the chunks and quad tree, without any OpenGL call,
+     * so it can run on another thread.
+     **/
+    bool loadHeightMap(const std::string& heightMap);
+
+    /**
+     * create the vertex buffers of the chunks built by loadHeightMap.
+     **/
+    void finishHeightMap();
+
+    /**
+     * create a detail map texture, retained.
+     **/
+    Texture2D * createDetailMapTexture(const std::string& fileName);
+
     /**
      * recursively set each chunk's LOD
      * @param cameraPos the camera position in world space
@@ -462,6 +531,20 @@ protected:
      **/
     void calculateNormal();
 
+    /**
+     * build the min/max height pyramid of the cells, which lets the ray queries skip the empty space.
+     **/
+    void buildHeightPyramid();
+
+    /**
+     * intersect a ray with the triangles of the cells, descending the height pyramid nearest first.
+     * @param ray the ray in world space
+     * @param worldToNode the world to node transform, the query is done in the terrain space
+     * @param nodeToWorld the node to world transform, to bring the hit point back
+     * @param intersectionPoint the nearest hit point in world space, if hit
+     **/
+    bool intersectHeightPyramid(const Ray& ray, const Mat4& worldToNode, const Mat4& nodeToWorld, Vec3& intersectionPoint) const;
+
     //override
     virtual void onEnter() override;
 
@@ -499,12 +582,16 @@ protected:
     Chunk * _chunkesArray[MAX_CHUNKES][MAX_CHUNKES];
     std::vector<TerrainVertexData> _vertices;
     std::vector<unsigned int> _indices;
+    std::vector<HeightPyramidLevel> _heightPyramid;
     int _imageWidth;
     int _imageHeight;
     Size _chunkSize;
     bool _isEnableFrustumCull;
+    bool _isOcclusionCulled = false; // chunks hidden by occluders last frame, culling is redone every frame then
     int _maxDetailMapValue;
     cocos2d::Image * _heightMapImage;
+    cocos2d::Image * _alphaMapImage; // decoded by createAsync, turned into _alphaMap on the main thread
+    bool _shareDetailMaps; // detail map textures come from the TextureCache
     Mat4 _oldCameraModelMatrix;
     Mat4 _terrainModelMatrix;
     GLuint _normalLocation;
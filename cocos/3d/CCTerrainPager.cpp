@@ -0,0 +1,255 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "3d/CCTerrainPager.h"
+
+#include <algorithm>
+#include <cmath>
+#include "2d/CCCamera.h"
+#include "base/CCDirector.h"
+#include "base/ccUTF8.h"
+
+NS_CC_BEGIN
+
+TerrainPager::PagerData::PagerData()
+: _tileSize(0)
+, _tilesX(0)
+, _tilesY(0)
+, _crackFixedType(Terrain::CrackFixedType::SKIRT)
+, _loadDistance(0.0f)
+, _memoryBudget(64 * 1024 * 1024)
+, _maxLoadingTiles(2)
+{
+}
+
+TerrainPager::PagerData::PagerData(const std::string& heightMapPattern, int tileSize, int tilesX, int tilesY, const Terrain::TerrainData& tileData)
+: _heightMapPattern(heightMapPattern)
+, _tileSize(tileSize)
+, _tilesX(tilesX)
+, _tilesY(tilesY)
+, _tileData(tileData)
+, _crackFixedType(Terrain::CrackFixedType::SKIRT)
+, _memoryBudget(64 * 1024 * 1024)
+, _maxLoadingTiles(2)
+{
+    // the ring of tiles around the one under the camera
+    _loadDistance = (tileSize - 1) * tileData._mapScale * 1.5f;
+}
+
+TerrainPager* TerrainPager::create(const PagerData& data)
+{
+    auto pager = new (std::nothrow) TerrainPager();
+    if (pager && pager->initWithData(data))
+    {
+        pager->autorelease();
+        return pager;
+    }
+    CC_SAFE_DELETE(pager);
+    return nullptr;
+}
+
+TerrainPager::TerrainPager()
+: _loadedCount(0)
+, _loadingCount(0)
+, _memoryUsage(0)
+, _updateFrame(0)
+{
+}
+
+TerrainPager::~TerrainPager()
+{
+}
+
+bool TerrainPager::initWithData(const PagerData& data)
+{
+    if (data._tilesX <= 0 || data._tilesY <= 0 || data._tileSize < 2 || data._heightMapPattern.empty())
+    {
+        CCLOG("warning: TerrainPager needs a height map pattern and at least one tile");
+        return false;
+    }
+    if (!Node::init())
+        return false;
+
+    _data = data;
+    Tile tile = { nullptr, 0, false, false };
+    _tiles.assign(data._tilesX * data._tilesY, tile);
+    _updateFrame = (unsigned int)-1;
+    return true;
+}
+
+float TerrainPager::getTileExtent() const
+{
+    // neighbours share their border pixels
+    return (_data._tileSize - 1) * _data._tileData._mapScale;
+}
+
+Vec3 TerrainPager::getTileCenter(int x, int y) const
+{
+    float extent = getTileExtent();
+    return Vec3((x + 0.5f - _data._tilesX * 0.5f) * extent, 0.0f, (y + 0.5f - _data._tilesY * 0.5f) * extent);
+}
+
+Terrain* TerrainPager::getTile(int x, int y) const
+{
+    if (x < 0 || y < 0 || x >= _data._tilesX || y >= _data._tilesY)
+        return nullptr;
+    return _tiles[y * _data._tilesX + x].terrain;
+}
+
+float TerrainPager::getHeight(float x, float z, Vec3* normal) const
+{
+    Vec3 position(x, 0.0f, z);
+    getWorldToNodeTransform().transformPoint(&position);
+
+    float extent = getTileExtent();
+    auto tile = getTile((int)std::floor(position.x / extent + _data._tilesX * 0.5f), (int)std::floor(position.z / extent + _data._tilesY * 0.5f));
+    if (!tile)
+    {
+        if (normal)
+        {
+            normal->setZero();
+        }
+        return 0;
+    }
+    return tile->getHeight(x, z, normal);
+}
+
+float TerrainPager::getTileDistance(int index, const Vec3& position) const
+{
+    auto center = getTileCenter(index % _data._tilesX, index / _data._tilesX);
+    float half = getTileExtent() * 0.5f;
+    float dx = std::max(std::abs(position.x - center.x) - half, 0.0f);
+    float dz = std::max(std::abs(position.z - center.z) - half, 0.0f);
+    return std::sqrt(dx * dx + dz * dz);
+}
+
+void TerrainPager::updateTiles(const Vec3& position)
+{
+    // load the missing tiles in reach, nearest first
+    std::vector<std::pair<float, int>> tiles;
+    for (int i = 0, count = (int)_tiles.size(); i < count; ++i)
+    {
+        const auto& tile = _tiles[i];
+        if (tile.terrain || tile.loading || tile.failed)
+            continue;
+        float distance = getTileDistance(i, position);
+        if (distance <= _data._loadDistance)
+            tiles.push_back(std::make_pair(distance, i));
+    }
+    std::sort(tiles.begin(), tiles.end());
+    for (const auto& tile : tiles)
+    {
+        if (_loadingCount >= _data._maxLoadingTiles)
+            break;
+        loadTile(tile.second);
+    }
+
+    if (_memoryUsage <= _data._memoryBudget)
+        return;
+
+    // over budget, remove the farthest tiles out of reach
+    tiles.clear();
+    for (int i = 0, count = (int)_tiles.size(); i < count; ++i)
+    {
+        if (!_tiles[i].terrain)
+            continue;
+        float distance = getTileDistance(i, position);
+        if (distance > _data._loadDistance)
+            tiles.push_back(std::make_pair(distance, i));
+    }
+    std::sort(tiles.begin(), tiles.end());
+    for (auto it = tiles.rbegin(); it != tiles.rend() && _memoryUsage > _data._memoryBudget; ++it)
+    {
+        unloadTile(it->second);
+    }
+}
+
+void TerrainPager::loadTile(int index)
+{
+    int x = index % _data._tilesX;
+    int y = index / _data._tilesX;
+    auto data = _data._tileData;
+    data._heightMapSrc = StringUtils::format(_data._heightMapPattern.c_str(), x, y);
+    data._alphaMapSrc = _data._alphaMapPattern.empty() ? "" : StringUtils::format(_data._alphaMapPattern.c_str(), x, y);
+
+    _tiles[index].loading = true;
+    ++_loadingCount;
+    // kept alive until the tile arrives
+    retain();
+    Terrain::createAsync(data, _data._crackFixedType, [this, index](Terrain* terrain, void*)
+    {
+        onTileLoaded(index, terrain);
+        release();
+    }, nullptr);
+}
+
+void TerrainPager::onTileLoaded(int index, Terrain* terrain)
+{
+    auto& tile = _tiles[index];
+    tile.loading = false;
+    --_loadingCount;
+    if (!terrain)
+    {
+        CCLOG("warning: TerrainPager can't load the tile %d, %d", index % _data._tilesX, index / _data._tilesX);
+        tile.failed = true;
+        return;
+    }
+
+    terrain->setPosition3D(getTileCenter(index % _data._tilesX, index / _data._tilesX));
+    terrain->setCameraMask(getCameraMask());
+    addChild(terrain);
+    tile.terrain = terrain;
+    tile.memory = terrain->getMemoryUsage();
+    _memoryUsage += tile.memory;
+    ++_loadedCount;
+}
+
+void TerrainPager::unloadTile(int index)
+{
+    auto& tile = _tiles[index];
+    removeChild(tile.terrain);
+    tile.terrain = nullptr;
+    _memoryUsage -= tile.memory;
+    tile.memory = 0;
+    --_loadedCount;
+}
+
+void TerrainPager::visit(Renderer* renderer, const Mat4& parentTransform, uint32_t parentFlags)
+{
+    auto camera = Camera::getVisitingCamera();
+    unsigned int frame = _director->getTotalFrames();
+    if (camera && _updateFrame != frame && _visible && isVisitableByVisitingCamera())
+    {
+        _updateFrame = frame;
+        auto cameraTransform = camera->getNodeToWorldTransform();
+        Vec3 position(cameraTransform.m[12], cameraTransform.m[13], cameraTransform.m[14]);
+        getWorldToNodeTransform().transformPoint(&position);
+        updateTiles(position);
+    }
+
+    Node::visit(renderer, parentTransform, parentFlags);
+}
+
+NS_CC_END
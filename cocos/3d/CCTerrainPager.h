@@ -0,0 +1,170 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __CCTERRAINPAGER_H__
+#define __CCTERRAINPAGER_H__
+
+#include <string>
+#include <vector>
+#include "2d/CCNode.h"
+#include "3d/CCTerrain.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup _3d
+ * @{
+ */
+
+/**
+ * @brief A terrain too large to be loaded at once, split in a grid of tiles loaded around the camera.
+ *
+ * Every tile is a Terrain of its own, with its own height map and alpha map files, and
+ * is created with Terrain::createAsync(), so the images are decoded and the chunks built
+ * on the compute threads of AsyncTaskPool. Each tile keeps its quad tree to cull and set
+ * the LOD of its chunks, and is skipped altogether when out of the frustum.
+ *
+ * The tiles closer to the camera than the load distance are loaded, nearest first.
+ * When the loaded tiles use more memory than the budget, the farthest ones out of the load
+ * distance are removed.
+ *
+ * The tile images are POT + 1 pixels wide, like Terrain height maps, and repeat the last row
+ * and column of their neighbours, so the tiles join without gaps. Use CrackFixedType::SKIRT,
+ * the LOD of a chunk only knows about the chunks of its own tile.
+ * @since v3.18
+ */
+class CC_DLL TerrainPager : public Node
+{
+public:
+    /**
+     * PagerData
+     * The tiles and the budgets of a TerrainPager.
+     */
+    struct CC_DLL PagerData
+    {
+        PagerData();
+        /**
+         * @param heightMapPattern printf pattern of the height map files, given the column then the row of the tile, like "terrain/height_%d_%d.png"
+         * @param tileSize the width and height of the tile images, in pixels
+         * @param tilesX the number of tile columns
+         * @param tilesY the number of tile rows
+         * @param tileData the detail maps, chunk size, height and scale shared by the tiles
+         */
+        PagerData(const std::string& heightMapPattern, int tileSize, int tilesX, int tilesY, const Terrain::TerrainData& tileData);
+
+        /** printf pattern of the height map files, given the column then the row of the tile */
+        std::string _heightMapPattern;
+        /** printf pattern of the alpha map files, empty when the tiles only have one detail map */
+        std::string _alphaMapPattern;
+        /** the width and height of the tile images, in pixels */
+        int _tileSize;
+        int _tilesX;
+        int _tilesY;
+        /** the terrain data of every tile, its height map and alpha map are ignored */
+        Terrain::TerrainData _tileData;
+        Terrain::CrackFixedType _crackFixedType;
+        /** the tiles closer than this to the camera, in the space of the pager, are loaded */
+        float _loadDistance;
+        /** the bytes the loaded tiles may use before the far ones are removed */
+        size_t _memoryBudget;
+        /** the tiles loaded at the same time at most */
+        int _maxLoadingTiles;
+    };
+
+    static TerrainPager* create(const PagerData& data);
+
+    /**
+     * get the height of the terrain at a position, like Terrain::getHeight.
+     * @return the height, 0 when the position is out of the terrain or its tile isn't loaded
+     */
+    float getHeight(float x, float z, Vec3* normal = nullptr) const;
+
+    /** get a tile, nullptr if it isn't loaded */
+    Terrain* getTile(int x, int y) const;
+
+    /** get the center of a tile, in the space of the pager */
+    Vec3 getTileCenter(int x, int y) const;
+
+    /** get the width and depth of a tile, in the space of the pager */
+    float getTileExtent() const;
+
+    int getLoadedTileCount() const { return _loadedCount; }
+    int getLoadingTileCount() const { return _loadingCount; }
+
+    /** get the estimated bytes used by the loaded tiles */
+    size_t getMemoryUsage() const { return _memoryUsage; }
+
+    void setLoadDistance(float distance) { _data._loadDistance = distance; }
+    float getLoadDistance() const { return _data._loadDistance; }
+
+    void setMemoryBudget(size_t bytes) { _data._memoryBudget = bytes; }
+    size_t getMemoryBudget() const { return _data._memoryBudget; }
+
+    /**
+     * load the tiles around a position and remove the far ones over budget.
+     * Called when the pager is visited, with the position of the first camera visiting it in a frame.
+     * @param position the position in the space of the pager
+     */
+    void updateTiles(const Vec3& position);
+
+    // Overrides
+    virtual void visit(Renderer* renderer, const Mat4& parentTransform, uint32_t parentFlags) override;
+
+CC_CONSTRUCTOR_ACCESS:
+    TerrainPager();
+    virtual ~TerrainPager();
+
+    bool initWithData(const PagerData& data);
+
+protected:
+    struct Tile
+    {
+        Terrain* terrain;
+        size_t memory;
+        bool loading;
+        // the height map couldn't be loaded, don't try again
+        bool failed;
+    };
+
+    void loadTile(int index);
+    void onTileLoaded(int index, Terrain* terrain);
+    void unloadTile(int index);
+    // distance from a position to the area of a tile, on the XZ plane
+    float getTileDistance(int index, const Vec3& position) const;
+
+    PagerData _data;
+    std::vector<Tile> _tiles;
+    int _loadedCount;
+    int _loadingCount;
+    size_t _memoryUsage;
+    unsigned int _updateFrame;
+};
+
+// end of 3d group
+/// @}
+
+NS_CC_END
+
+#endif // __CCTERRAINPAGER_H__
@@ -48,6 +48,8 @@ cocos2d.cpp \
 2d/CCFontCharMap.cpp \
 2d/CCFontFNT.cpp \
 2d/CCFontFreeType.cpp \
+2d/CCFontGlyphCache.cpp \
+2d/CCFontMSDF.cpp \
 2d/CCGLBufferedNode.cpp \
 2d/CCGrabber.cpp \
 2d/CCGrid.cpp \
@@ -56,6 +58,7 @@ cocos2d.cpp \
 2d/CCLabelBMFont.cpp \
 2d/CCLabelTTF.cpp \
 2d/CCLabelTextFormatter.cpp \
+2d/CCTextShaper.cpp \
 2d/CCLayer.cpp \
 2d/CCLight.cpp \
 2d/CCMenu.cpp \
@@ -76,6 +79,8 @@ cocos2d.cpp \
 2d/CCSpriteBatchNode.cpp \
 2d/CCSpriteFrame.cpp \
 2d/CCSpriteFrameCache.cpp \
+2d/CCDynamicAtlasCache.cpp \
+2d/CCSkylinePacker.cpp \
 2d/CCTMXLayer.cpp \
 2d/CCTMXObjectGroup.cpp \
 2d/CCTMXTiledMap.cpp \
@@ -161,6 +166,7 @@ base/ccUtils.cpp \
 base/etc1.cpp \
 base/pvr.cpp \
 base/s3tc.cpp \
+base/ktx2.cpp \
 renderer/CCBatchCommand.cpp \
 renderer/CCCustomCommand.cpp \
 renderer/CCGLProgram.cpp \
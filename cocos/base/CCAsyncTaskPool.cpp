@@ -25,6 +25,7 @@ THE SOFTWARE.
 ****************************************************************************/
 
 #include "base/CCAsyncTaskPool.h"
+#include <algorithm>
 
 NS_CC_BEGIN
 
@@ -47,6 +48,11 @@ void AsyncTaskPool::destroyInstance()
 
 AsyncTaskPool::AsyncTaskPool()
 {
+    // the main thread keeps a core, more threads than this mostly wait on each other
+    int cores = static_cast<int>(std::thread::hardware_concurrency());
+    int computeThreads = std::min(std::max(cores - 1, 1), 4);
+    for (int i = 1; i < computeThreads; ++i)
+        _threadTasks[(int)TaskType::TASK_COMPUTE].addThread();
 }
 
 AsyncTaskPool::~AsyncTaskPool()
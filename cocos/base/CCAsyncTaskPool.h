@@ -61,6 +61,8 @@ public:
         TASK_IO,
         TASK_NETWORK,
         TASK_OTHER,
+        /** CPU bound tasks, run on several threads at once and finished in any order. @since v3.18 */
+        TASK_COMPUTE,
         TASK_MAX_TYPE,
     };
 
@@ -87,7 +89,8 @@ public:
     /**
      * Enqueue a asynchronous task.
      *
-     * @param type task type is io task, network task or others, each type of task has a thread to deal with it.
+     * @param type task type is io task, network task or others, each type of task has a thread to deal with it,
+     *             compute tasks have one thread per core left by the main thread.
      * @param callback callback when the task is finished. The callback is called in the main thread instead of task thread.
      * @param callbackParam parameter used by the callback.
      * @param task: task can be lambda function to be performed off thread.
@@ -121,7 +124,11 @@ protected:
         ThreadTasks()
         : _stop(false)
         {
-            _thread = std::thread(
+            addThread();
+        }
+        void addThread()
+        {
+            _threads.emplace_back(
                                   [this]
                                   {
                                       for(;;)
@@ -158,7 +165,8 @@ protected:
                     _taskCallBacks.pop();
             }
             _condition.notify_all();
-            _thread.join();
+            for (auto& thread : _threads)
+                thread.join();
         }
         void clear()
         {
@@ -192,8 +200,8 @@ protected:
         }
     private:
         
-        // need to keep track of thread so we can join them
-        std::thread _thread;
+        // need to keep track of threads so we can join them
+        std::vector<std::thread> _threads;
         // the task queue
         std::queue< std::function<void()> > _tasks;
         std::queue<AsyncTaskCallBack> _taskCallBacks;
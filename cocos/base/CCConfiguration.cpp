@@ -53,13 +53,17 @@ Configuration::Configuration()
 , _supportsOESMapBuffer(false)
 , _supportsOESDepth24(false)
 , _supportsOESPackedDepthStencil(false)
+, _supportsFloatTexture(false)
 , _maxSamplesAllowed(0)
 , _maxTextureUnits(0)
+, _maxVertexTextureUnits(0)
 , _glExtensions(nullptr)
 , _maxDirLightInShader(1)
 , _maxPointLightInShader(1)
 , _maxSpotLightInShader(1)
 , _animate3DQuality(Animate3DQuality::QUALITY_LOW)
+, _bonePaletteTexture(true)
+, _dualQuaternionSkinning(false)
 {
     _loadedEvent = new (std::nothrow) EventCustom(CONFIG_FILE_LOADED);
 }
@@ -125,6 +129,9 @@ void Configuration::gatherGPUInfo()
     glGetIntegerv(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &_maxTextureUnits);
 	_valueDict["gl.max_texture_units"] = Value((int)_maxTextureUnits);
 
+    glGetIntegerv(GL_MAX_VERTEX_TEXTURE_IMAGE_UNITS, &_maxVertexTextureUnits);
+    _valueDict["gl.max_vertex_texture_units"] = Value((int)_maxVertexTextureUnits);
+
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_IOS)
     glGetIntegerv(GL_MAX_SAMPLES_APPLE, &_maxSamplesAllowed);
 	_valueDict["gl.max_samples_allowed"] = Value((int)_maxSamplesAllowed);
@@ -168,6 +175,12 @@ void Configuration::gatherGPUInfo()
     _supportsOESPackedDepthStencil = checkForGLExtension("GL_OES_packed_depth_stencil");
     _valueDict["gl.supports_OES_packed_depth_stencil"] = Value(_supportsOESPackedDepthStencil);
 
+#ifdef CC_PLATFORM_PC
+    _supportsFloatTexture = checkForGLExtension("GL_ARB_texture_float");
+#else
+    _supportsFloatTexture = checkForGLExtension("GL_OES_texture_float");
+#endif
+    _valueDict["gl.supports_float_texture"] = Value(_supportsFloatTexture);
 
     CHECK_GL_ERROR_DEBUG();
 }
@@ -327,6 +340,26 @@ Animate3DQuality Configuration::getAnimate3DQuality() const
     return _animate3DQuality;
 }
 
+bool Configuration::supportsFloatTexture() const
+{
+    return _supportsFloatTexture;
+}
+
+int Configuration::getMaxVertexTextureUnits() const
+{
+    return _maxVertexTextureUnits;
+}
+
+bool Configuration::isBonePaletteTextureEnabled() const
+{
+    return _bonePaletteTexture && _supportsFloatTexture && _maxVertexTextureUnits > 0;
+}
+
+bool Configuration::isDualQuaternionSkinningEnabled() const
+{
+    return _dualQuaternionSkinning;
+}
+
 //
 // generic getters for properties
 //
@@ -422,6 +455,19 @@ void Configuration::loadConfigFile(const std::string& filename)
         _animate3DQuality = (Animate3DQuality)_valueDict[name].asInt();
     else
         _valueDict[name] = Value((int)_animate3DQuality);
+
+    //skinning
+    name = "cocos2d.x.3d.bone_palette_texture";
+    if (_valueDict.find(name) != _valueDict.end())
+        _bonePaletteTexture = _valueDict[name].asBool();
+    else
+        _valueDict[name] = Value(_bonePaletteTexture);
+
+    name = "cocos2d.x.3d.dual_quaternion_skinning";
+    if (_valueDict.find(name) != _valueDict.end())
+        _dualQuaternionSkinning = _valueDict[name].asBool();
+    else
+        _valueDict[name] = Value(_dualQuaternionSkinning);
     
     Director::getInstance()->getEventDispatcher()->dispatchEvent(_loadedEvent);
 }
@@ -171,6 +171,21 @@ public:
      */
     bool supportsMapBuffer() const;
 
+    /** Whether or not textures with 32 bit float components are supported.
+     *
+     * It checks for the extension `GL_OES_texture_float` on mobile and `GL_ARB_texture_float` on desktop.
+     *
+     * @return Whether or not float textures are supported.
+     * @since v3.18
+     */
+    bool supportsFloatTexture() const;
+
+    /** Max texture units a vertex shader can sample, 0 when the driver can't fetch textures in vertex shaders.
+     *
+     * @return The value of GL_MAX_VERTEX_TEXTURE_IMAGE_UNITS.
+     * @since v3.18
+     */
+    int getMaxVertexTextureUnits() const;
     
     /** Max support directional light in shader, for Sprite3D.
      *
@@ -195,6 +210,27 @@ public:
 
     /** get 3d animate quality*/
     Animate3DQuality getAnimate3DQuality() const;
+
+    /** Whether skinned Sprite3D read their bone palette from a float texture, for Sprite3D.
+     *
+     * Set "cocos2d.x.3d.bone_palette_texture" to false in the config file to keep the uniform array,
+     * which is limited to 60 bones per mesh. It is also used when the GPU can't sample float textures
+     * in vertex shaders.
+     *
+     * @return Whether the bone palette is stored in a float texture.
+     * @since v3.18
+     */
+    bool isBonePaletteTextureEnabled() const;
+
+    /** Whether skinned Sprite3D blend their bones as dual quaternions instead of matrices, for Sprite3D.
+     *
+     * Set "cocos2d.x.3d.dual_quaternion_skinning" to true in the config file to enable it. Dual quaternions
+     * don't collapse twisted joints, but ignore the scale of the bones.
+     *
+     * @return Whether dual quaternion skinning is used.
+     * @since v3.18
+     */
+    bool isDualQuaternionSkinningEnabled() const;
     
     /** Returns whether or not an OpenGL is supported. 
      *
@@ -270,14 +306,18 @@ protected:
     bool            _supportsOESMapBuffer;
     bool            _supportsOESDepth24;
     bool            _supportsOESPackedDepthStencil;
+    bool            _supportsFloatTexture;
     
     GLint           _maxSamplesAllowed;
     GLint           _maxTextureUnits;
+    GLint           _maxVertexTextureUnits;
     char *          _glExtensions;
     int             _maxDirLightInShader; //max support directional light in shader
     int             _maxPointLightInShader; // max support point light in shader
     int             _maxSpotLightInShader; // max support spot light in shader
     Animate3DQuality  _animate3DQuality; // animate 3d quality
+    bool            _bonePaletteTexture; // store the bone palette of skinned meshes in a float texture when supported
+    bool            _dualQuaternionSkinning; // blend bones as dual quaternions
 	
 	ValueMap        _valueDict;
     
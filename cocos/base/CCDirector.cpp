@@ -34,6 +34,7 @@ THE SOFTWARE.
 
 #include "2d/CCDrawingPrimitives.h"
 #include "2d/CCSpriteFrameCache.h"
+#include "2d/CCDynamicAtlasCache.h"
 #include "platform/CCFileUtils.h"
 
 #include "2d/CCActionManager.h"
@@ -697,6 +698,7 @@ void Director::purgeCachedData(void)
     if (s_SharedDirector->getOpenGLView())
     {
         SpriteFrameCache::getInstance()->removeUnusedSpriteFrames();
+        DynamicAtlasCache::getInstance()->removeUnusedSpriteFrames();
         _textureCache->removeUnusedTextures();
 
         // Note: some tests such as ActionsTest are leaking refcounted textures
@@ -1099,6 +1101,7 @@ void Director::reset()
 #endif
     AnimationCache::destroyInstance();
     SpriteFrameCache::destroyInstance();
+    DynamicAtlasCache::destroyInstance();
     GLProgramCache::destroyInstance();
     GLProgramStateCache::destroyInstance();
     FileUtils::destroyInstance();
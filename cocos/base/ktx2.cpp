@@ -0,0 +1,370 @@
+/****************************************************************************
+ Copyright (c) 2013-2017 Chukong Technologies
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+ 
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "base/ktx2.h"
+#include "base/etc1.h"
+#include "base/ZipUtils.h"
+
+#include <string.h>
+#include <stdlib.h>
+
+namespace {
+
+const uint8_t KTX2_IDENTIFIER[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+const uint32_t KTX2_HEADER_SIZE = 80;
+const uint32_t KTX2_LEVEL_INDEX_ENTRY_SIZE = 24;
+// A 32 bit dimension has at most 32 mip levels.
+const uint32_t KTX2_MAX_LEVEL_COUNT = 32;
+// Larger than any GPU samples, and small enough that no level size overflows.
+const uint32_t KTX2_MAX_DIMENSION = 16384;
+const uint32_t KTX2_SUPERCOMPRESSION_NONE = 0;
+const uint32_t KTX2_SUPERCOMPRESSION_ZLIB = 3;
+
+struct KTX2Header
+{
+    uint32_t vkFormat;
+    uint32_t typeSize;
+    uint32_t pixelWidth;
+    uint32_t pixelHeight;
+    uint32_t pixelDepth;
+    uint32_t layerCount;
+    uint32_t faceCount;
+    uint32_t levelCount;
+    uint32_t supercompressionScheme;
+};
+
+uint32_t readUint32(const uint8_t* p)
+{
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+uint64_t readUint64(const uint8_t* p)
+{
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+bool isSupportedFormat(uint32_t vkFormat)
+{
+    switch (static_cast<KTX2Format>(vkFormat))
+    {
+    case KTX2Format::R8G8B8_UNORM:
+    case KTX2Format::R8G8B8A8_UNORM:
+    case KTX2Format::BC1_RGBA_UNORM:
+    case KTX2Format::BC3_UNORM:
+    case KTX2Format::ETC2_R8G8B8_UNORM:
+        return true;
+    default:
+        return false;
+    }
+}
+
+uint64_t levelSize(KTX2Format format, uint32_t width, uint32_t height)
+{
+    uint64_t blocks = static_cast<uint64_t>((width + 3) / 4) * ((height + 3) / 4);
+    switch (format)
+    {
+    case KTX2Format::R8G8B8_UNORM:
+        return static_cast<uint64_t>(width) * height * 3;
+    case KTX2Format::R8G8B8A8_UNORM:
+        return static_cast<uint64_t>(width) * height * 4;
+    case KTX2Format::BC1_RGBA_UNORM:
+    case KTX2Format::ETC2_R8G8B8_UNORM:
+        return blocks * 8;
+    case KTX2Format::BC3_UNORM:
+        return blocks * 16;
+    default:
+        return 0;
+    }
+}
+
+uint16_t packRGB565(const uint8_t* rgb)
+{
+    uint16_t r = static_cast<uint16_t>((rgb[0] * 31 + 127) / 255);
+    uint16_t g = static_cast<uint16_t>((rgb[1] * 63 + 127) / 255);
+    uint16_t b = static_cast<uint16_t>((rgb[2] * 31 + 127) / 255);
+    return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+void unpackRGB565(uint16_t color, int* rgb)
+{
+    int r = (color >> 11) & 0x1F;
+    int g = (color >> 5) & 0x3F;
+    int b = color & 0x1F;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+void writeUint16(uint8_t* p, uint16_t value)
+{
+    p[0] = static_cast<uint8_t>(value & 0xFF);
+    p[1] = static_cast<uint8_t>(value >> 8);
+}
+
+// ETC2 encodes its T, H and planar modes as differential blocks whose base color
+// plus delta falls outside 0..31, which ETC1 decoders would read as garbage.
+bool isETC1Compatible(const uint8_t* blocks, uint64_t blockCount)
+{
+    for (uint64_t i = 0; i < blockCount; ++i)
+    {
+        const uint8_t* block = blocks + i * ETC1_ENCODED_BLOCK_SIZE;
+        if ((block[3] & 0x02) == 0)
+        {
+            continue;
+        }
+        for (int c = 0; c < 3; ++c)
+        {
+            int base = block[c] >> 3;
+            int delta = (block[c] & 0x04) ? (block[c] & 0x07) - 8 : (block[c] & 0x07);
+            if (base + delta < 0 || base + delta > 31)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool ktx2_is_valid(const uint8_t* data, ssize_t dataLen)
+{
+    if (dataLen < static_cast<ssize_t>(KTX2_HEADER_SIZE))
+    {
+        return false;
+    }
+    return memcmp(data, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) == 0;
+}
+
+bool ktx2_parse(const uint8_t* data, ssize_t dataLen, KTX2Texture* out, uint32_t maxLevels)
+{
+    if (!ktx2_is_valid(data, dataLen) || out == nullptr)
+    {
+        return false;
+    }
+
+    KTX2Header header;
+    memcpy(&header, data + sizeof(KTX2_IDENTIFIER), sizeof(header));
+
+    if (!isSupportedFormat(header.vkFormat)
+        || header.pixelWidth == 0 || header.pixelHeight == 0 || header.pixelDepth != 0
+        || header.pixelWidth > KTX2_MAX_DIMENSION || header.pixelHeight > KTX2_MAX_DIMENSION
+        || header.layerCount > 1 || header.faceCount != 1 || header.levelCount > KTX2_MAX_LEVEL_COUNT
+        || (header.supercompressionScheme != KTX2_SUPERCOMPRESSION_NONE && header.supercompressionScheme != KTX2_SUPERCOMPRESSION_ZLIB))
+    {
+        return false;
+    }
+
+    // levelCount 0 means "generate mipmaps at runtime"; the file still stores one level.
+    uint32_t levelCount = header.levelCount > 0 ? header.levelCount : 1;
+    uint64_t indexEnd = KTX2_HEADER_SIZE + static_cast<uint64_t>(levelCount) * KTX2_LEVEL_INDEX_ENTRY_SIZE;
+    if (indexEnd > static_cast<uint64_t>(dataLen))
+    {
+        return false;
+    }
+
+    out->format = static_cast<KTX2Format>(header.vkFormat);
+    out->width = header.pixelWidth;
+    out->height = header.pixelHeight;
+    out->levels.clear();
+    out->inflated.clear();
+
+    // Levels the caller cannot use are not inflated
+    uint32_t parsedLevels = levelCount < maxLevels ? levelCount : maxLevels;
+    out->inflated.reserve(parsedLevels);
+
+    for (uint32_t i = 0; i < parsedLevels; ++i)
+    {
+        const uint8_t* entry = data + KTX2_HEADER_SIZE + i * KTX2_LEVEL_INDEX_ENTRY_SIZE;
+        uint64_t byteOffset = readUint64(entry);
+        uint64_t byteLength = readUint64(entry + 8);
+        uint64_t uncompressedByteLength = readUint64(entry + 16);
+
+        if (byteOffset > static_cast<uint64_t>(dataLen) || byteLength > static_cast<uint64_t>(dataLen) - byteOffset)
+        {
+            return false;
+        }
+
+        KTX2Level level;
+        level.width = header.pixelWidth >> i ? header.pixelWidth >> i : 1;
+        level.height = header.pixelHeight >> i ? header.pixelHeight >> i : 1;
+        level.data = data + byteOffset;
+        level.length = static_cast<uint32_t>(byteLength);
+
+        if (header.supercompressionScheme == KTX2_SUPERCOMPRESSION_ZLIB)
+        {
+            unsigned char* inflated = nullptr;
+            ssize_t inflatedLen = cocos2d::ZipUtils::inflateMemoryWithHint(const_cast<uint8_t*>(level.data), static_cast<ssize_t>(byteLength),
+                                                                           &inflated, static_cast<ssize_t>(uncompressedByteLength));
+            if (inflated == nullptr || static_cast<uint64_t>(inflatedLen) != uncompressedByteLength)
+            {
+                free(inflated);
+                return false;
+            }
+            out->inflated.push_back(std::vector<uint8_t>(inflated, inflated + inflatedLen));
+            free(inflated);
+
+            level.data = out->inflated.back().data();
+            level.length = static_cast<uint32_t>(inflatedLen);
+        }
+
+        if (level.length < levelSize(out->format, level.width, level.height))
+        {
+            return false;
+        }
+
+        if (out->format == KTX2Format::ETC2_R8G8B8_UNORM
+            && !isETC1Compatible(level.data, levelSize(out->format, level.width, level.height) / ETC1_ENCODED_BLOCK_SIZE))
+        {
+            return false;
+        }
+
+        out->levels.push_back(level);
+    }
+
+    return true;
+}
+
+uint64_t ktx2_transcoded_size(uint32_t width, uint32_t height, KTX2TranscodeTarget target)
+{
+    switch (target)
+    {
+    case KTX2TranscodeTarget::ETC1:
+    case KTX2TranscodeTarget::DXT1:
+        return static_cast<uint64_t>((width + 3) / 4) * ((height + 3) / 4) * 8;
+    case KTX2TranscodeTarget::RGB888:
+    default:
+        return static_cast<uint64_t>(width) * height * 3;
+    }
+}
+
+void ktx2_encode_dxt1_block(const uint8_t* rgb, uint8_t* out)
+{
+    // Pick the endpoints as the two pixels that lie furthest apart along the
+    // bounding box diagonal. Cheap, and good enough for data that already went
+    // through ETC1, whose blocks only hold two base colors.
+    int minColor[3] = { 255, 255, 255 };
+    int maxColor[3] = { 0, 0, 0 };
+    for (int i = 0; i < 16; ++i)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            minColor[c] = rgb[i * 3 + c] < minColor[c] ? rgb[i * 3 + c] : minColor[c];
+            maxColor[c] = rgb[i * 3 + c] > maxColor[c] ? rgb[i * 3 + c] : maxColor[c];
+        }
+    }
+
+    int axis[3] = { maxColor[0] - minColor[0], maxColor[1] - minColor[1], maxColor[2] - minColor[2] };
+    int minIndex = 0, maxIndex = 0;
+    int minDot = 0x7FFFFFFF, maxDot = -0x7FFFFFFF;
+    for (int i = 0; i < 16; ++i)
+    {
+        int dot = rgb[i * 3] * axis[0] + rgb[i * 3 + 1] * axis[1] + rgb[i * 3 + 2] * axis[2];
+        if (dot < minDot) { minDot = dot; minIndex = i; }
+        if (dot > maxDot) { maxDot = dot; maxIndex = i; }
+    }
+
+    uint16_t color0 = packRGB565(rgb + maxIndex * 3);
+    uint16_t color1 = packRGB565(rgb + minIndex * 3);
+    if (color0 < color1)
+    {
+        uint16_t tmp = color0;
+        color0 = color1;
+        color1 = tmp;
+    }
+
+    writeUint16(out, color0);
+    writeUint16(out + 2, color1);
+
+    uint32_t indices = 0;
+    if (color0 != color1)
+    {
+        // color0 > color1 selects the opaque four color mode.
+        int palette[4][3];
+        unpackRGB565(color0, palette[0]);
+        unpackRGB565(color1, palette[1]);
+        for (int c = 0; c < 3; ++c)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+
+        for (int i = 0; i < 16; ++i)
+        {
+            uint32_t best = 0;
+            int bestDistance = 0x7FFFFFFF;
+            for (uint32_t p = 0; p < 4; ++p)
+            {
+                int dr = rgb[i * 3] - palette[p][0];
+                int dg = rgb[i * 3 + 1] - palette[p][1];
+                int db = rgb[i * 3 + 2] - palette[p][2];
+                int distance = dr * dr + dg * dg + db * db;
+                if (distance < bestDistance)
+                {
+                    bestDistance = distance;
+                    best = p;
+                }
+            }
+            indices |= best << (i * 2);
+        }
+    }
+
+    out[4] = static_cast<uint8_t>(indices & 0xFF);
+    out[5] = static_cast<uint8_t>((indices >> 8) & 0xFF);
+    out[6] = static_cast<uint8_t>((indices >> 16) & 0xFF);
+    out[7] = static_cast<uint8_t>((indices >> 24) & 0xFF);
+}
+
+void ktx2_transcode_etc1(const uint8_t* blocks, uint32_t width, uint32_t height,
+                         KTX2TranscodeTarget target, uint8_t* out)
+{
+    switch (target)
+    {
+    case KTX2TranscodeTarget::ETC1:
+        memcpy(out, blocks, ktx2_transcoded_size(width, height, target));
+        break;
+    case KTX2TranscodeTarget::DXT1:
+        {
+            // ETC1 and DXT1 share the 4x4 block grid, so blocks map one to one.
+            uint32_t blockCount = ((width + 3) / 4) * ((height + 3) / 4);
+            etc1_byte decoded[ETC1_DECODED_BLOCK_SIZE];
+            for (uint32_t i = 0; i < blockCount; ++i)
+            {
+                etc1_decode_block(blocks + i * ETC1_ENCODED_BLOCK_SIZE, decoded);
+                ktx2_encode_dxt1_block(decoded, out + i * 8);
+            }
+        }
+        break;
+    case KTX2TranscodeTarget::RGB888:
+    default:
+        etc1_decode_image(blocks, out, width, height, 3, width * 3);
+        break;
+    }
+}
@@ -0,0 +1,93 @@
+/****************************************************************************
+ Copyright (c) 2013-2017 Chukong Technologies
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+ 
+ http://www.cocos2d-x.org
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef COCOS2DX_PLATFORM_THIRDPARTY_KTX2_
+#define COCOS2DX_PLATFORM_THIRDPARTY_KTX2_
+/// @cond DO_NOT_SHOW
+
+#include "platform/CCStdC.h"
+#include <vector>
+
+/* Subset of the VkFormat values a KTX2 container may carry that can be loaded. */
+enum class KTX2Format
+{
+    UNDEFINED = 0,
+    R8G8B8_UNORM = 23,
+    R8G8B8A8_UNORM = 37,
+    BC1_RGBA_UNORM = 133,
+    BC3_UNORM = 137,
+    // only loaded when every block is also a valid ETC1 block
+    ETC2_R8G8B8_UNORM = 147,
+};
+
+/* Formats a universal (ETC1 compatible) payload can be transcoded into. */
+enum class KTX2TranscodeTarget
+{
+    ETC1,
+    DXT1,
+    RGB888,
+};
+
+struct KTX2Level
+{
+    const uint8_t* data;
+    uint32_t length;
+    uint32_t width;
+    uint32_t height;
+};
+
+struct KTX2Texture
+{
+    KTX2Format format;
+    uint32_t width;
+    uint32_t height;
+    std::vector<KTX2Level> levels;
+    // Owns inflated level data when the container is zlib supercompressed.
+    std::vector<std::vector<uint8_t>> inflated;
+};
+
+// Whether data starts with the KTX 2.0 file identifier.
+bool ktx2_is_valid(const uint8_t* data, ssize_t dataLen);
+
+// Parse a KTX 2.0 container. Only 2D textures (no array layers, cube faces or depth)
+// of at most 16384x16384 with supercompression NONE or ZLIB are accepted. ETC2 RGB
+// levels must be ETC1 compatible, files using the T, H or planar modes are rejected. Level pointers point into data unless
+// they had to be inflated, so data must outlive out. Levels past maxLevels are neither
+// validated nor inflated. Returns false on malformed input.
+bool ktx2_parse(const uint8_t* data, ssize_t dataLen, KTX2Texture* out, uint32_t maxLevels = 32);
+
+// Size in bytes of a width x height level once transcoded into target.
+uint64_t ktx2_transcoded_size(uint32_t width, uint32_t height, KTX2TranscodeTarget target);
+
+// Transcode one level of ETC1 blocks into target. out must hold ktx2_transcoded_size() bytes.
+// Runs on the CPU only, so it is safe to call on loader threads and without a GL context.
+void ktx2_transcode_etc1(const uint8_t* blocks, uint32_t width, uint32_t height,
+                         KTX2TranscodeTarget target, uint8_t* out);
+
+// Encode one 4x4 block of RGB888 pixels (48 bytes, row major) as a DXT1 block.
+void ktx2_encode_dxt1_block(const uint8_t* rgb, uint8_t* out);
+
+/// @endcond
+#endif /* defined(COCOS2DX_PLATFORM_THIRDPARTY_KTX2_) */
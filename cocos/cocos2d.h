@@ -118,10 +118,12 @@ THE SOFTWARE.
 #include "2d/CCDrawNode.h"
 #include "2d/CCDrawingPrimitives.h"
 #include "2d/CCFontFNT.h"
+#include "2d/CCFontGlyphCache.h"
 #include "2d/CCLabel.h"
 #include "2d/CCLabelAtlas.h"
 #include "2d/CCLabelBMFont.h"
 #include "2d/CCLabelTTF.h"
+#include "2d/CCTextShaper.h"
 #include "2d/CCLayer.h"
 #include "2d/CCMenu.h"
 #include "2d/CCMenuItem.h"
@@ -244,6 +246,8 @@ THE SOFTWARE.
 #include "2d/CCSpriteBatchNode.h"
 #include "2d/CCSpriteFrame.h"
 #include "2d/CCSpriteFrameCache.h"
+#include "2d/CCDynamicAtlasCache.h"
+#include "2d/CCSkylinePacker.h"
 
 // text_input_node
 #include "2d/CCTextFieldTTF.h"
@@ -267,7 +271,9 @@ THE SOFTWARE.
 
 //3d
 #include "3d/CCAABB.h"
+#include "3d/CCAABBTree.h"
 #include "3d/CCAnimate3D.h"
+#include "3d/CCAnimate3DScheduler.h"
 #include "3d/CCAnimation3D.h"
 #include "3d/CCAttachNode.h"
 #include "3d/CCBillBoard.h"
@@ -277,13 +283,17 @@ THE SOFTWARE.
 #include "3d/CCMotionStreak3D.h"
 #include "3d/CCMeshVertexIndexData.h"
 #include "3d/CCOBB.h"
+#include "3d/CCOcclusionBuffer.h"
 #include "3d/CCPlane.h"
 #include "3d/CCRay.h"
+#include "3d/CCSceneBVH.h"
 #include "3d/CCSkeleton3D.h"
 #include "3d/CCSkybox.h"
 #include "3d/CCSprite3D.h"
+#include "3d/CCSprite3DAsyncLoader.h"
 #include "3d/CCSprite3DMaterial.h"
 #include "3d/CCTerrain.h"
+#include "3d/CCTerrainPager.h"
 
 // vr
 #include "vr/CCVRGenericRenderer.h"
@@ -27,6 +27,7 @@ THE SOFTWARE.
 #include "platform/CCFileUtils.h"
 
 #include <stack>
+#include <algorithm>
 
 #include "base/CCData.h"
 #include "base/ccMacros.h"
@@ -537,6 +538,49 @@ bool FileUtils::writeToFile(const ValueMap& /*dict*/, const std::string &/*fullP
 
 #endif /* (CC_TARGET_PLATFORM != CC_PLATFORM_IOS) && (CC_TARGET_PLATFORM != CC_PLATFORM_MAC) */
 
+namespace
+{
+    // Only plain relative paths can be answered by the search path index.
+    bool isIndexablePath(const std::string& path)
+    {
+        return !path.empty()
+            && path[0] != '/'
+            && path.find("./") == std::string::npos
+            && path.find("//") == std::string::npos
+            && path.find('\\') == std::string::npos;
+    }
+
+    void splitFilename(const std::string& filename, std::string* dirPart, std::string* filePart)
+    {
+        size_t pos = filename.find_last_of('/');
+        if (pos != std::string::npos)
+        {
+            *dirPart = filename.substr(0, pos + 1);
+            *filePart = filename.substr(pos + 1);
+        }
+        else
+        {
+            dirPart->clear();
+            *filePart = filename;
+        }
+    }
+
+    std::string collapseSlashes(const std::string& path)
+    {
+        std::string ret;
+        ret.reserve(path.length());
+        for (auto c : path)
+        {
+            if (c == '\\')
+                c = '/';
+            if (c == '/' && !ret.empty() && ret.back() == '/')
+                continue;
+            ret.push_back(c);
+        }
+        return ret;
+    }
+}
+
 // Implement FileUtils
 FileUtils* FileUtils::s_sharedFileUtils = nullptr;
 
@@ -554,7 +598,8 @@ void FileUtils::setDelegate(FileUtils *delegate)
 }
 
 FileUtils::FileUtils()
-    : _writablePath("")
+    : _searchPathIndexEnabled(false)
+    , _writablePath("")
 {
 }
 
@@ -599,6 +644,10 @@ bool FileUtils::writeDataToFile(const Data& data, const std::string& fullPath) c
 
         fclose(fp);
 
+        // The file may have been reported as missing before
+        DECLARE_GUARD;
+        _fullPathCacheMiss.clear();
+
         return true;
     } while (0);
 
@@ -625,6 +674,7 @@ void FileUtils::purgeCachedEntries()
     DECLARE_GUARD;
     _fullPathCache.clear();
     _fullPathCacheDir.clear();
+    _fullPathCacheMiss.clear();
 }
 
 std::string FileUtils::getStringFromFile(const std::string& filename) const
@@ -836,15 +886,38 @@ std::string FileUtils::fullPathForFilename(const std::string &filename) const
         return cacheIter->second;
     }
 
+    // Already known to be missing ?
+    if (_fullPathCacheMiss.find(filename) != _fullPathCacheMiss.end())
+    {
+        return "";
+    }
+
     // Get the new file name.
     const std::string newFilename( getNewFilename(filename) );
 
+    // The index stores plain relative paths only, so names like "../a.png" are always probed on disk.
+    const bool canUseIndex = !_searchPathIndex.empty() && isIndexablePath(newFilename);
+    std::string file;
+    std::string filePath;
+    if (canUseIndex)
+    {
+        splitFilename(newFilename, &filePath, &file);
+    }
+
     std::string fullpath;
 
     for (const auto& searchIt : _searchPathArray)
     {
+        auto indexIter = canUseIndex ? _searchPathIndex.find(searchIt) : _searchPathIndex.end();
+
         for (const auto& resolutionIt : _searchResolutionsOrderArray)
         {
+            if (indexIter != _searchPathIndex.end()
+                && indexIter->second.find(filePath + resolutionIt + file) == indexIter->second.end())
+            {
+                continue;
+            }
+
             fullpath = this->getPathForFilename(newFilename, resolutionIt, searchIt);
 
             if (!fullpath.empty())
@@ -857,6 +930,18 @@ std::string FileUtils::fullPathForFilename(const std::string &filename) const
         }
     }
 
+    // Files appear under the writable path at any time (downloads, hot updates, saved images),
+    // so a miss is only remembered when none of the search paths is there.
+    const std::string writablePath = getWritablePath();
+    const bool searchesWritablePath = !writablePath.empty()
+        && std::any_of(_searchPathArray.begin(), _searchPathArray.end(), [&writablePath](const std::string& searchPath) {
+            return searchPath.compare(0, writablePath.length(), writablePath) == 0;
+        });
+    if (!searchesWritablePath)
+    {
+        _fullPathCacheMiss.insert(filename);
+    }
+
     if(isPopupNotify()){
         CCLOG("cocos2d: fullPathForFilename: No file found at %s. Possible missing file.", filename.c_str());
     }
@@ -937,6 +1022,7 @@ void FileUtils::setSearchResolutionsOrder(const std::vector<std::string>& search
 
     _fullPathCache.clear();
     _fullPathCacheDir.clear();
+    _fullPathCacheMiss.clear();
     _searchResolutionsOrderArray.clear();
     for(const auto& iter : searchResolutionsOrder)
     {
@@ -969,6 +1055,8 @@ void FileUtils::addSearchResolutionsOrder(const std::string &order,const bool fr
     if (!resOrder.empty() && resOrder[resOrder.length()-1] != '/')
         resOrder.append("/");
 
+    _fullPathCacheMiss.clear();
+
     if (front) {
         _searchResolutionsOrderArray.insert(_searchResolutionsOrderArray.begin(), resOrder);
     } else {
@@ -1013,6 +1101,7 @@ void FileUtils::setDefaultResourceRootPath(const std::string& path)
     {
         _fullPathCache.clear();
         _fullPathCacheDir.clear();
+        _fullPathCacheMiss.clear();
         _defaultResRootPath = path;
         if (!_defaultResRootPath.empty() && _defaultResRootPath[_defaultResRootPath.length()-1] != '/')
         {
@@ -1032,6 +1121,7 @@ void FileUtils::setSearchPaths(const std::vector<std::string>& searchPaths)
 
     _fullPathCache.clear();
     _fullPathCacheDir.clear();
+    _fullPathCacheMiss.clear();
     _searchPathArray.clear();
 
     for (const auto& path : _originalSearchPaths)
@@ -1060,6 +1150,8 @@ void FileUtils::setSearchPaths(const std::vector<std::string>& searchPaths)
         //CCLOG("Default root path doesn't exist, adding it.");
         _searchPathArray.push_back(_defaultResRootPath);
     }
+
+    rebuildSearchPathIndex();
 }
 
 void FileUtils::addSearchPath(const std::string &searchpath,const bool front)
@@ -1082,6 +1174,86 @@ void FileUtils::addSearchPath(const std::string &searchpath,const bool front)
         _originalSearchPaths.push_back(searchpath);
         _searchPathArray.push_back(path);
     }
+
+    _fullPathCacheMiss.clear();
+    if (_searchPathIndexEnabled)
+    {
+        indexSearchPath(path);
+    }
+}
+
+void FileUtils::setSearchPathIndexEnabled(bool enabled)
+{
+    DECLARE_GUARD;
+    if (_searchPathIndexEnabled == enabled)
+    {
+        return;
+    }
+
+    _searchPathIndexEnabled = enabled;
+    _fullPathCacheMiss.clear();
+    rebuildSearchPathIndex();
+}
+
+bool FileUtils::isSearchPathIndexEnabled() const
+{
+    DECLARE_GUARD;
+    return _searchPathIndexEnabled;
+}
+
+void FileUtils::rebuildSearchPathIndex()
+{
+    _searchPathIndex.clear();
+    if (!_searchPathIndexEnabled)
+    {
+        return;
+    }
+
+    for (const auto& searchPath : _searchPathArray)
+    {
+        indexSearchPath(searchPath);
+    }
+}
+
+void FileUtils::indexSearchPath(const std::string& searchPath)
+{
+    // Content under the writable path can change at any time (downloads, hot updates), keep probing it.
+    const std::string writablePath = getWritablePath();
+    if (searchPath.empty() || !isAbsolutePath(searchPath)
+        || (!writablePath.empty() && searchPath.compare(0, writablePath.length(), writablePath) == 0)
+        || _searchPathIndex.find(searchPath) != _searchPathIndex.end())
+    {
+        return;
+    }
+
+    std::vector<std::string> files;
+    listFilesRecursively(searchPath, &files);
+
+    // Some platforms (e.g. Android assets) can't be listed, an empty listing means "unknown" rather than "empty".
+    if (files.empty())
+    {
+        return;
+    }
+
+    const std::string root = collapseSlashes(searchPath);
+    std::unordered_set<std::string> entries;
+    entries.reserve(files.size());
+    for (const auto& file : files)
+    {
+        std::string relative = collapseSlashes(file);
+        if (relative.compare(0, root.length(), root) != 0)
+        {
+            // Unexpected layout of the listing, don't trust it.
+            return;
+        }
+        relative.erase(0, root.length());
+        if (!relative.empty() && relative.back() != '/')
+        {
+            entries.insert(std::move(relative));
+        }
+    }
+
+    _searchPathIndex.emplace(searchPath, std::move(entries));
 }
 
 void FileUtils::setFilenameLookupDictionary(const ValueMap& filenameLookupDict)
@@ -1089,6 +1261,7 @@ void FileUtils::setFilenameLookupDictionary(const ValueMap& filenameLookupDict)
     DECLARE_GUARD;
     _fullPathCache.clear();
     _fullPathCacheDir.clear();
+    _fullPathCacheMiss.clear();
     _filenameLookupDict = filenameLookupDict;
 }
 
@@ -1469,6 +1642,9 @@ bool FileUtils::renameFile(const std::string &oldfullpath, const std::string &ne
         CCLOGERROR("Fail to rename file %s to %s !Error code is %d", oldfullpath.c_str(), newfullpath.c_str(), errorCode);
         return false;
     }
+
+    DECLARE_GUARD;
+    _fullPathCacheMiss.clear();
     return true;
 }
 
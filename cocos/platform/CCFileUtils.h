@@ -29,6 +29,7 @@ THE SOFTWARE.
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <type_traits>
 #include <mutex>
 
@@ -482,6 +483,24 @@ public:
      */
     virtual const std::vector<std::string> getOriginalSearchPaths() const;
 
+    /**
+     *  Enables or disables the search path index.
+     *
+     *  When enabled, every read-only search path is listed once (when the search paths are set)
+     *  and fullPathForFilename() consults that listing instead of probing the disk for every
+     *  search path and resolution directory combination.
+     *  Search paths located under the writable path are never indexed, since their content may change at runtime.
+     *  @note Lookups answered by the index are case-sensitive. Disabled by default.
+     *  @since v3.18
+     */
+    void setSearchPathIndexEnabled(bool enabled);
+
+    /**
+     *  Checks whether the search path index is enabled.
+     *  @since v3.18
+     */
+    bool isSearchPathIndexEnabled() const;
+
     /**
      *  Gets the writable path.
      *  @return  The path that can be write/read a file in
@@ -915,6 +934,16 @@ protected:
      */
     virtual std::string fullPathForDirectory(const std::string &dirname) const;
 
+    /**
+     *  Rebuilds the file listing of the indexable search paths. The caller must hold _mutex.
+     */
+    void rebuildSearchPathIndex();
+
+    /**
+     *  Lists a single search path into _searchPathIndex. The caller must hold _mutex.
+     */
+    void indexSearchPath(const std::string& searchPath);
+
     /**
     * mutex used to protect fields. 
     */
@@ -968,6 +997,24 @@ protected:
      */
     mutable std::unordered_map<std::string, std::string> _fullPathCacheDir;
 
+    /**
+     *  The filenames which could not be found in any search path. Missing files are probed only once
+     *  until the search paths, resolution orders or the lookup dictionary change. Nothing is recorded
+     *  while a search path is under the writable path.
+     */
+    mutable std::unordered_set<std::string> _fullPathCacheMiss;
+
+    /**
+     *  Files (relative to the search path) of each indexed search path.
+     *  Search paths which are not in this map are resolved by probing the disk.
+     */
+    std::unordered_map<std::string, std::unordered_set<std::string>> _searchPathIndex;
+
+    /**
+     *  Whether the search path index is enabled.
+     */
+    bool _searchPathIndexEnabled;
+
     /**
      * Writable path.
      */
@@ -29,6 +29,7 @@ THE SOFTWARE.
 
 #include <string>
 #include <ctype.h>
+#include <climits>
 
 #include "base/CCData.h"
 #include "base/ccConfig.h" // CC_USE_JPEG, CC_USE_TIFF, CC_USE_WEBP
@@ -95,6 +96,7 @@ extern "C"
 }
 #include "base/s3tc.h"
 #include "base/atitc.h"
+#include "base/ktx2.h"
 #include "base/pvr.h"
 #include "base/TGAlib.h"
 
@@ -452,7 +454,77 @@ namespace
             png_error(png_ptr, "pngReaderCallback failed");
         }
     }
+
+    // Sets up the transforms which expand every png to 8 bit gray, gray alpha, rgb or rgba.
+    // Returns the color type of the transformed rows.
+    static png_byte pngSetupTransforms(png_structp png_ptr, png_infop info_ptr, Texture2D::PixelFormat* renderFormat)
+    {
+        png_byte bit_depth = png_get_bit_depth(png_ptr, info_ptr);
+        png_byte color_type = png_get_color_type(png_ptr, info_ptr);
+
+        // force palette images to be expanded to 24-bit RGB
+        // it may include alpha channel
+        if (color_type == PNG_COLOR_TYPE_PALETTE)
+        {
+            png_set_palette_to_rgb(png_ptr);
+        }
+        // low-bit-depth grayscale images are to be expanded to 8 bits
+        if (color_type == PNG_COLOR_TYPE_GRAY && bit_depth < 8)
+        {
+            bit_depth = 8;
+            png_set_expand_gray_1_2_4_to_8(png_ptr);
+        }
+        // expand any tRNS chunk data into a full alpha channel
+        if (png_get_valid(png_ptr, info_ptr, PNG_INFO_tRNS))
+        {
+            png_set_tRNS_to_alpha(png_ptr);
+        }  
+        // reduce images with 16-bit samples to 8 bits
+        if (bit_depth == 16)
+        {
+            png_set_strip_16(png_ptr);            
+        } 
+
+        // Expanded earlier for grayscale, now take care of palette and rgb
+        if (bit_depth < 8)
+        {
+            png_set_packing(png_ptr);
+        }
+        // update info
+        png_read_update_info(png_ptr, info_ptr);
+        color_type = png_get_color_type(png_ptr, info_ptr);
+
+        switch (color_type)
+        {
+        case PNG_COLOR_TYPE_GRAY:
+            *renderFormat = Texture2D::PixelFormat::I8;
+            break;
+        case PNG_COLOR_TYPE_GRAY_ALPHA:
+            *renderFormat = Texture2D::PixelFormat::AI88;
+            break;
+        case PNG_COLOR_TYPE_RGB:
+            *renderFormat = Texture2D::PixelFormat::RGB888;
+            break;
+        case PNG_COLOR_TYPE_RGB_ALPHA:
+            *renderFormat = Texture2D::PixelFormat::RGBA8888;
+            break;
+        default:
+            break;
+        }
+
+        return color_type;
+    }
 #endif //CC_USE_PNG
+
+    static void premultiplyAlphaRGBA8888(unsigned char* data, ssize_t pixels)
+    {
+        unsigned int* fourBytes = (unsigned int*)data;
+        for (ssize_t i = 0; i < pixels; ++i)
+        {
+            unsigned char* p = data + i * 4;
+            fourBytes[i] = CC_RGB_PREMULTIPLY_ALPHA(p[0], p[1], p[2], p[3]);
+        }
+    }
 }
 
 Texture2D::PixelFormat getDevicePixelFormat(Texture2D::PixelFormat format)
@@ -590,6 +662,9 @@ bool Image::initWithImageData(const unsigned char * data, ssize_t dataLen)
         case Format::ATITC:
             ret = initWithATITCData(unpackedData, unpackedLen);
             break;
+        case Format::KTX2:
+            ret = initWithKTX2Data(unpackedData, unpackedLen);
+            break;
         default:
             {
                 // load and detect image format
@@ -649,6 +724,11 @@ bool Image::isS3TC(const unsigned char * data, ssize_t /*dataLen*/)
     return true;
 }
 
+bool Image::isKTX2(const unsigned char *data, ssize_t dataLen)
+{
+    return ktx2_is_valid(data, dataLen);
+}
+
 bool Image::isATITC(const unsigned char *data, ssize_t /*dataLen*/)
 {
     ATITCTexHeader *header = (ATITCTexHeader *)data;
@@ -743,6 +823,11 @@ Image::Format Image::detectFormat(const unsigned char * data, ssize_t dataLen)
     {
         return Format::S3TC;
     }
+    else if (isKTX2(data, dataLen))
+    {
+        // must be checked before ATITC, both identifiers start with "«KTX"
+        return Format::KTX2;
+    }
     else if (isATITC(data, dataLen))
     {
         return Format::ATITC;
@@ -1064,60 +1149,8 @@ bool Image::initWithPngData(const unsigned char * data, ssize_t dataLen)
 
         _width = png_get_image_width(png_ptr, info_ptr);
         _height = png_get_image_height(png_ptr, info_ptr);
-        png_byte bit_depth = png_get_bit_depth(png_ptr, info_ptr);
-        png_uint_32 color_type = png_get_color_type(png_ptr, info_ptr);
-
-        //CCLOG("color type %u", color_type);
-
-        // force palette images to be expanded to 24-bit RGB
-        // it may include alpha channel
-        if (color_type == PNG_COLOR_TYPE_PALETTE)
-        {
-            png_set_palette_to_rgb(png_ptr);
-        }
-        // low-bit-depth grayscale images are to be expanded to 8 bits
-        if (color_type == PNG_COLOR_TYPE_GRAY && bit_depth < 8)
-        {
-            bit_depth = 8;
-            png_set_expand_gray_1_2_4_to_8(png_ptr);
-        }
-        // expand any tRNS chunk data into a full alpha channel
-        if (png_get_valid(png_ptr, info_ptr, PNG_INFO_tRNS))
-        {
-            png_set_tRNS_to_alpha(png_ptr);
-        }  
-        // reduce images with 16-bit samples to 8 bits
-        if (bit_depth == 16)
-        {
-            png_set_strip_16(png_ptr);            
-        } 
 
-        // Expanded earlier for grayscale, now take care of palette and rgb
-        if (bit_depth < 8)
-        {
-            png_set_packing(png_ptr);
-        }
-        // update info
-        png_read_update_info(png_ptr, info_ptr);
-        color_type = png_get_color_type(png_ptr, info_ptr);
-
-        switch (color_type)
-        {
-        case PNG_COLOR_TYPE_GRAY:
-            _renderFormat = Texture2D::PixelFormat::I8;
-            break;
-        case PNG_COLOR_TYPE_GRAY_ALPHA:
-            _renderFormat = Texture2D::PixelFormat::AI88;
-            break;
-        case PNG_COLOR_TYPE_RGB:
-            _renderFormat = Texture2D::PixelFormat::RGB888;
-            break;
-        case PNG_COLOR_TYPE_RGB_ALPHA:
-            _renderFormat = Texture2D::PixelFormat::RGBA8888;
-            break;
-        default:
-            break;
-        }
+        png_uint_32 color_type = pngSetupTransforms(png_ptr, info_ptr, &_renderFormat);
 
         // read png data
         png_size_t rowbytes;
@@ -1178,6 +1211,206 @@ bool Image::initWithPngData(const unsigned char * data, ssize_t dataLen)
 #endif //CC_USE_PNG
 }
 
+bool Image::initWithImageDataInStrips(const unsigned char * data, ssize_t dataLen, int stripHeight,
+                                      const HeaderCallback& headerCallback, const StripCallback& stripCallback)
+{
+    CCASSERT(stripHeight > 0, "Invalid strip height");
+    CCASSERT(_data == nullptr, "Image is already initialized");
+
+    if (!data || dataLen <= 0 || stripHeight <= 0)
+    {
+        return false;
+    }
+
+    _fileType = detectFormat(data, dataLen);
+    switch (_fileType)
+    {
+    case Format::PNG:
+        return initWithPngDataInStrips(data, dataLen, stripHeight, headerCallback, stripCallback);
+    case Format::JPG:
+        return initWithJpgDataInStrips(data, dataLen, stripHeight, headerCallback, stripCallback);
+    default:
+        return false;
+    }
+}
+
+bool Image::initWithJpgDataInStrips(const unsigned char * data, ssize_t dataLen, int stripHeight,
+                                    const HeaderCallback& headerCallback, const StripCallback& stripCallback)
+{
+#if CC_USE_JPEG && !CC_USE_WIC && !defined(CC_TARGET_QT5)
+    struct jpeg_decompress_struct cinfo;
+    struct MyErrorMgr jerr;
+    // modified after setjmp(), must be volatile to be released after an error
+    unsigned char* volatile strip = nullptr;
+    JSAMPROW row_pointer[1] = {0};
+
+    bool ret = false;
+    do 
+    {
+        cinfo.err = jpeg_std_error(&jerr.pub);
+        jerr.pub.error_exit = myErrorExit;
+        if (setjmp(jerr.setjmp_buffer))
+        {
+            jpeg_destroy_decompress(&cinfo);
+            break;
+        }
+
+        jpeg_create_decompress( &cinfo );
+        jpeg_mem_src(&cinfo, const_cast<unsigned char*>(data), dataLen);
+        jpeg_read_header(&cinfo, TRUE);
+
+        // we only support RGB or grayscale
+        if (cinfo.jpeg_color_space == JCS_GRAYSCALE)
+        {
+            _renderFormat = Texture2D::PixelFormat::I8;
+        }else
+        {
+            cinfo.out_color_space = JCS_RGB;
+            _renderFormat = Texture2D::PixelFormat::RGB888;
+        }
+
+        jpeg_start_decompress( &cinfo );
+
+        _width  = cinfo.output_width;
+        _height = cinfo.output_height;
+
+        if (headerCallback && !headerCallback(this))
+        {
+            jpeg_destroy_decompress( &cinfo );
+            break;
+        }
+
+        size_t rowbytes = cinfo.output_width * cinfo.output_components;
+        strip = static_cast<unsigned char*>(malloc(rowbytes * stripHeight));
+        if (!strip)
+        {
+            jpeg_destroy_decompress( &cinfo );
+            break;
+        }
+
+        bool aborted = false;
+        for (int row = 0; row < _height && !aborted; row += stripHeight)
+        {
+            int rowCount = std::min(stripHeight, _height - row);
+            for (int i = 0; i < rowCount; ++i)
+            {
+                row_pointer[0] = strip + i * rowbytes;
+                jpeg_read_scanlines(&cinfo, row_pointer, 1);
+            }
+            aborted = !stripCallback(strip, row, rowCount);
+        }
+
+        // see initWithJpgData(), jpeg_finish_decompress() isn't needed
+        jpeg_destroy_decompress( &cinfo );
+        ret = !aborted;
+    } while (0);
+
+    free(strip);
+    return ret;
+#else
+    CC_UNUSED_PARAM(data);
+    CC_UNUSED_PARAM(dataLen);
+    CC_UNUSED_PARAM(stripHeight);
+    CC_UNUSED_PARAM(headerCallback);
+    CC_UNUSED_PARAM(stripCallback);
+    return false;
+#endif // CC_USE_JPEG
+}
+
+bool Image::initWithPngDataInStrips(const unsigned char * data, ssize_t dataLen, int stripHeight,
+                                    const HeaderCallback& headerCallback, const StripCallback& stripCallback)
+{
+#if CC_USE_PNG && !CC_USE_WIC
+    bool ret = false;
+    png_structp     png_ptr     = 0;
+    png_infop       info_ptr    = 0;
+    // modified after setjmp(), must be volatile to be released after an error
+    unsigned char* volatile strip = nullptr;
+
+    do 
+    {
+        png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, 0, 0, 0);
+        CC_BREAK_IF(! png_ptr);
+
+        info_ptr = png_create_info_struct(png_ptr);
+        CC_BREAK_IF(!info_ptr);
+
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_BADA && CC_TARGET_PLATFORM != CC_PLATFORM_NACL && CC_TARGET_PLATFORM != CC_PLATFORM_TIZEN)
+        CC_BREAK_IF(setjmp(png_jmpbuf(png_ptr)));
+#endif
+
+        tImageSource imageSource;
+        imageSource.data    = (unsigned char*)data;
+        imageSource.size    = dataLen;
+        imageSource.offset  = 0;
+        png_set_read_fn(png_ptr, &imageSource, pngReadCallback);
+
+        png_read_info(png_ptr, info_ptr);
+
+        // the passes of an interlaced image span the whole image
+        CC_BREAK_IF(png_get_interlace_type(png_ptr, info_ptr) != PNG_INTERLACE_NONE);
+
+        _width = png_get_image_width(png_ptr, info_ptr);
+        _height = png_get_image_height(png_ptr, info_ptr);
+
+        png_byte color_type = pngSetupTransforms(png_ptr, info_ptr, &_renderFormat);
+
+        // same rules as initWithPngData(), applied to every strip
+        bool premultiply = false;
+        if (color_type == PNG_COLOR_TYPE_RGB_ALPHA)
+        {
+#if CC_ENABLE_PREMULTIPLIED_ALPHA != 0
+            premultiply = PNG_PREMULTIPLIED_ALPHA_ENABLED;
+            _hasPremultipliedAlpha = true;
+#else
+            _hasPremultipliedAlpha = false;
+#endif
+        }
+
+        CC_BREAK_IF(headerCallback && !headerCallback(this));
+
+        png_size_t rowbytes = png_get_rowbytes(png_ptr, info_ptr);
+        strip = static_cast<unsigned char*>(malloc(rowbytes * stripHeight));
+        CC_BREAK_IF(!strip);
+
+        bool aborted = false;
+        for (int row = 0; row < _height && !aborted; row += stripHeight)
+        {
+            int rowCount = std::min(stripHeight, _height - row);
+            for (int i = 0; i < rowCount; ++i)
+            {
+                png_read_row(png_ptr, strip + i * rowbytes, nullptr);
+            }
+
+            if (premultiply)
+            {
+                premultiplyAlphaRGBA8888(strip, (ssize_t)_width * rowCount);
+            }
+
+            aborted = !stripCallback(strip, row, rowCount);
+        }
+        CC_BREAK_IF(aborted);
+
+        png_read_end(png_ptr, nullptr);
+        ret = true;
+    } while (0);
+
+    free(strip);
+    if (png_ptr)
+    {
+        png_destroy_read_struct(&png_ptr, (info_ptr) ? &info_ptr : 0, 0);
+    }
+    return ret;
+#else
+    CC_UNUSED_PARAM(data);
+    CC_UNUSED_PARAM(dataLen);
+    CC_UNUSED_PARAM(stripHeight);
+    CC_UNUSED_PARAM(headerCallback);
+    CC_UNUSED_PARAM(stripCallback);
+    return false;
+#endif //CC_USE_PNG
+}
+
 #if CC_USE_TIFF
 namespace
 {
@@ -1983,6 +2216,135 @@ bool Image::initWithS3TCData(const unsigned char * data, ssize_t dataLen)
     return true;
 }
 
+bool Image::initWithKTX2Data(const unsigned char *data, ssize_t dataLen)
+{
+    KTX2Texture texture;
+    if (!ktx2_parse(data, dataLen, &texture, MIPMAP_MAX))
+    {
+        CCLOG("cocos2d: unsupported or malformed KTX2 data");
+        return false;
+    }
+
+    Configuration* conf = Configuration::getInstance();
+    bool supportsETC = false;
+#ifdef GL_ETC1_RGB8_OES
+    supportsETC = conf->supportsETC();
+#endif
+    bool supportsS3TC = conf->supportsS3TC();
+
+    /* pick what every level is turned into */
+
+    // the universal ETC1 payload is transcoded to whatever the GPU samples natively,
+    // and decoded on the CPU when neither ETC1 nor S3TC is available
+    KTX2TranscodeTarget target = KTX2TranscodeTarget::RGB888;
+    switch (texture.format)
+    {
+    case KTX2Format::ETC2_R8G8B8_UNORM:
+        if (supportsETC)
+        {
+            target = KTX2TranscodeTarget::ETC1;
+            _renderFormat = Texture2D::PixelFormat::ETC;
+        }
+        else if (supportsS3TC)
+        {
+            target = KTX2TranscodeTarget::DXT1;
+            _renderFormat = Texture2D::PixelFormat::S3TC_DXT1;
+        }
+        else
+        {
+            CCLOG("cocos2d: Hardware ETC1 and S3TC decoders not present. Using software decoder");
+            _renderFormat = Texture2D::PixelFormat::RGB888;
+        }
+        break;
+    case KTX2Format::BC1_RGBA_UNORM:
+        _renderFormat = supportsS3TC ? Texture2D::PixelFormat::S3TC_DXT1 : Texture2D::PixelFormat::RGBA8888;
+        break;
+    case KTX2Format::BC3_UNORM:
+        _renderFormat = supportsS3TC ? Texture2D::PixelFormat::S3TC_DXT5 : Texture2D::PixelFormat::RGBA8888;
+        break;
+    case KTX2Format::R8G8B8_UNORM:
+        _renderFormat = Texture2D::PixelFormat::RGB888;
+        break;
+    case KTX2Format::R8G8B8A8_UNORM:
+    default:
+        _renderFormat = Texture2D::PixelFormat::RGBA8888;
+        break;
+    }
+
+    _width = texture.width;
+    _height = texture.height;
+    _numberOfMipmaps = MIN(static_cast<int>(texture.levels.size()), MIPMAP_MAX);
+
+    /* calculate the dataLen */
+
+    std::vector<uint64_t> levelSizes(_numberOfMipmaps);
+    uint64_t totalSize = 0;
+    for (int i = 0; i < _numberOfMipmaps; ++i)
+    {
+        const KTX2Level& level = texture.levels[i];
+        if (texture.format == KTX2Format::ETC2_R8G8B8_UNORM)
+        {
+            levelSizes[i] = ktx2_transcoded_size(level.width, level.height, target);
+        }
+        else if (_renderFormat == Texture2D::PixelFormat::RGBA8888 && texture.format != KTX2Format::R8G8B8A8_UNORM)
+        {
+            levelSizes[i] = static_cast<uint64_t>(level.width) * level.height * 4;
+        }
+        else
+        {
+            levelSizes[i] = level.length;
+        }
+        totalSize += levelSizes[i];
+    }
+
+    // every mipmap length is an int
+    if (totalSize > INT_MAX)
+    {
+        CCLOG("cocos2d: KTX2 texture is too large");
+        return false;
+    }
+    _dataLen = static_cast<ssize_t>(totalSize);
+
+    _data = static_cast<unsigned char*>(malloc(_dataLen * sizeof(unsigned char)));
+    if (_data == nullptr)
+    {
+        _dataLen = 0;
+        return false;
+    }
+
+    /* load the mipmaps */
+
+    ssize_t offset = 0;
+    for (int i = 0; i < _numberOfMipmaps; ++i)
+    {
+        const KTX2Level& level = texture.levels[i];
+        unsigned char* dest = _data + offset;
+
+        if (texture.format == KTX2Format::ETC2_R8G8B8_UNORM)
+        {
+            ktx2_transcode_etc1(level.data, level.width, level.height, target, dest);
+        }
+        else if (texture.format == KTX2Format::BC1_RGBA_UNORM && !supportsS3TC)
+        {
+            s3tc_decode(const_cast<uint8_t*>(level.data), dest, level.width, level.height, S3TCDecodeFlag::DXT1);
+        }
+        else if (texture.format == KTX2Format::BC3_UNORM && !supportsS3TC)
+        {
+            s3tc_decode(const_cast<uint8_t*>(level.data), dest, level.width, level.height, S3TCDecodeFlag::DXT5);
+        }
+        else
+        {
+            memcpy(dest, level.data, levelSizes[i]);
+        }
+
+        _mipmaps[i].address = dest;
+        _mipmaps[i].len = static_cast<int>(levelSizes[i]);
+        offset += levelSizes[i];
+    }
+
+    return true;
+}
+
 
 bool Image::initWithATITCData(const unsigned char *data, ssize_t dataLen)
 {
@@ -2462,12 +2824,7 @@ void Image::premultipliedAlpha()
 #else
     CCASSERT(_renderFormat == Texture2D::PixelFormat::RGBA8888, "The pixel format should be RGBA8888!");
     
-    unsigned int* fourBytes = (unsigned int*)_data;
-    for(int i = 0; i < _width * _height; i++)
-    {
-        unsigned char* p = _data + i * 4;
-        fourBytes[i] = CC_RGB_PREMULTIPLY_ALPHA(p[0], p[1], p[2], p[3]);
-    }
+    premultiplyAlphaRGBA8888(_data, (ssize_t)_width * _height);
     
     _hasPremultipliedAlpha = true;
 #endif
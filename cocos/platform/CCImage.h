@@ -28,6 +28,8 @@ THE SOFTWARE.
 #define __CC_IMAGE_H__
 /// @cond DO_NOT_SHOW
 
+#include <functional>
+
 #include "base/CCRef.h"
 #include "renderer/CCTexture2D.h"
 
@@ -95,6 +97,8 @@ public:
         ATITC,
         //! TGA
         TGA,
+        //! KTX2 (universal ETC1 payload, BCn or uncompressed)
+        KTX2,
         //! Raw Data
         RAW_DATA,
         //! Unknown format
@@ -136,6 +140,23 @@ public:
     // @warning kFmtRawData only support RGBA8888
     bool initWithRawData(const unsigned char * data, ssize_t dataLen, int width, int height, int bitsPerComponent, bool preMulti = false);
 
+    /** Called once the image header is decoded, return false to stop decoding. */
+    typedef std::function<bool(Image* image)> HeaderCallback;
+    /** Receives `rowCount` decoded rows starting at `firstRow`, return false to stop decoding. */
+    typedef std::function<bool(unsigned char* rows, int firstRow, int rowCount)> StripCallback;
+
+    /**
+    @brief Decodes PNG or JPEG data strip by strip instead of into a buffer holding the whole image.
+    Width, height, render format and premultiplied alpha are known when headerCallback is invoked, getData() stays null.
+    The rows passed to stripCallback are only valid during the call.
+    @param stripHeight  the number of rows decoded at once, the last strip may be shorter.
+    @return true if the whole image was decoded. Other formats and interlaced PNG files are not supported.
+    * @js NA
+    * @lua NA
+    */
+    bool initWithImageDataInStrips(const unsigned char * data, ssize_t dataLen, int stripHeight,
+                                   const HeaderCallback& headerCallback, const StripCallback& stripCallback);
+
     // Getters
     unsigned char *   getData()               { return _data; }
     ssize_t           getDataLen()            { return _dataLen; }
@@ -168,6 +189,8 @@ protected:
 #endif
     bool initWithJpgData(const unsigned char *  data, ssize_t dataLen);
     bool initWithPngData(const unsigned char * data, ssize_t dataLen);
+    bool initWithJpgDataInStrips(const unsigned char * data, ssize_t dataLen, int stripHeight, const HeaderCallback& headerCallback, const StripCallback& stripCallback);
+    bool initWithPngDataInStrips(const unsigned char * data, ssize_t dataLen, int stripHeight, const HeaderCallback& headerCallback, const StripCallback& stripCallback);
     bool initWithTiffData(const unsigned char * data, ssize_t dataLen);
     bool initWithWebpData(const unsigned char * data, ssize_t dataLen);
     bool initWithPVRData(const unsigned char * data, ssize_t dataLen);
@@ -176,6 +199,7 @@ protected:
     bool initWithETCData(const unsigned char * data, ssize_t dataLen);
     bool initWithS3TCData(const unsigned char * data, ssize_t dataLen);
     bool initWithATITCData(const unsigned char *data, ssize_t dataLen);
+    bool initWithKTX2Data(const unsigned char *data, ssize_t dataLen);
     typedef struct sImageTGA tImageTGA;
     bool initWithTGAData(tImageTGA* tgaData);
 
@@ -231,6 +255,7 @@ protected:
     bool isEtc(const unsigned char * data, ssize_t dataLen);
     bool isS3TC(const unsigned char * data,ssize_t dataLen);
     bool isATITC(const unsigned char *data, ssize_t dataLen);
+    bool isKTX2(const unsigned char *data, ssize_t dataLen);
 };
 
 // end of platform group
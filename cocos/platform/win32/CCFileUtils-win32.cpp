@@ -395,6 +395,8 @@ bool FileUtilsWin32::renameFile(const std::string &oldfullpath, const std::strin
 
     if (MoveFile(_wOld.c_str(), _wNew.c_str()))
     {
+        std::lock_guard<std::recursive_mutex> mutexGuard(_mutex);
+        _fullPathCacheMiss.clear();
         return true;
     }
     else
@@ -47,6 +47,7 @@ void BatchCommand::init(float globalOrder, GLProgram* shader, BlendFunc blendTyp
     CCASSERT(textureAtlas, "textureAtlas cannot be null");
     
     RenderCommand::init(globalOrder, modelViewTransform, flags);
+    textureAtlas->getTexture()->markAsUsed();
     _textureID = textureAtlas->getTexture()->getName();
     _blendType = blendType;
     _shader = shader;
@@ -216,6 +216,10 @@ public:
     static const char* SHADER_NAME_LABEL_OUTLINE;
     static const char* SHADER_NAME_LABEL_DISTANCEFIELD_NORMAL;
     static const char* SHADER_NAME_LABEL_DISTANCEFIELD_GLOW;
+    /** Multi-channel distance field label, draws text, outline, glow and shadow. @since v3.18 */
+    static const char* SHADER_NAME_LABEL_MSDF;
+    /** Label glyphs batched across labels, the text color comes from the vertices. @since v3.18 */
+    static const char* SHADER_NAME_LABEL_BATCH;
 
     /**Built in shader used for 3D, support Position vertex attribute, with color specified by a uniform.*/
     static const char* SHADER_3D_POSITION;
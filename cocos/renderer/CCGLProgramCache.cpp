@@ -57,6 +57,8 @@ enum {
     kShaderType_UIGrayScale,
     kShaderType_LabelNormal,
     kShaderType_LabelOutline,
+    kShaderType_LabelMSDF,
+    kShaderType_LabelBatch,
     kShaderType_3DPosition,
     kShaderType_3DPositionTex,
     kShaderType_3DSkinPositionTex,
@@ -135,6 +137,7 @@ bool GLProgramCache::init()
     
     auto listener = EventListenerCustom::create(Configuration::CONFIG_FILE_LOADED, [this](EventCustom* /*event*/){
         reloadDefaultGLProgramsRelativeToLights();
+        reloadDefaultGLProgramsRelativeToSkinning();
     });
 #if CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID
     DataManager::onShaderLoaderEnd();
@@ -239,6 +242,14 @@ void GLProgramCache::loadDefaultGLPrograms()
     loadDefaultGLProgram(p, kShaderType_LabelOutline);
     _programs.emplace(GLProgram::SHADER_NAME_LABEL_OUTLINE, p);
 
+    p = new (std::nothrow) GLProgram();
+    loadDefaultGLProgram(p, kShaderType_LabelMSDF);
+    _programs.emplace(GLProgram::SHADER_NAME_LABEL_MSDF, p);
+
+    p = new (std::nothrow) GLProgram();
+    loadDefaultGLProgram(p, kShaderType_LabelBatch);
+    _programs.emplace(GLProgram::SHADER_NAME_LABEL_BATCH, p);
+
     p = new (std::nothrow) GLProgram();
     loadDefaultGLProgram(p, kShaderType_3DPosition);
     _programs.emplace(GLProgram::SHADER_3D_POSITION, p);
@@ -410,6 +421,14 @@ void GLProgramCache::reloadDefaultGLPrograms()
     p->reset();
     loadDefaultGLProgram(p, kShaderType_LabelOutline);
 
+    p = getGLProgram(GLProgram::SHADER_NAME_LABEL_MSDF);
+    p->reset();
+    loadDefaultGLProgram(p, kShaderType_LabelMSDF);
+
+    p = getGLProgram(GLProgram::SHADER_NAME_LABEL_BATCH);
+    p->reset();
+    loadDefaultGLProgram(p, kShaderType_LabelBatch);
+
     p = getGLProgram(GLProgram::SHADER_3D_POSITION);
     p->reset();
     loadDefaultGLProgram(p, kShaderType_3DPosition);
@@ -508,6 +527,21 @@ void GLProgramCache::reloadDefaultGLProgramsRelativeToLights()
     loadDefaultGLProgram(p, kShaderType_3DSkinPositionBumpedNormalTex);
 }
 
+void GLProgramCache::reloadDefaultGLProgramsRelativeToSkinning()
+{
+    GLProgram *p = getGLProgram(GLProgram::SHADER_3D_SKINPOSITION_TEXTURE);
+    p->reset();
+    loadDefaultGLProgram(p, kShaderType_3DSkinPositionTex);
+
+    p = getGLProgram(GLProgram::SHADER_3D_SKINPOSITION_NORMAL_TEXTURE);
+    p->reset();
+    loadDefaultGLProgram(p, kShaderType_3DSkinPositionNormalTex);
+
+    p = getGLProgram(GLProgram::SHADER_3D_SKINPOSITION_BUMPEDNORMAL_TEXTURE);
+    p->reset();
+    loadDefaultGLProgram(p, kShaderType_3DSkinPositionBumpedNormalTex);
+}
+
 void GLProgramCache::loadDefaultGLProgram(GLProgram *p, int type)
 {
     switch (type) {
@@ -564,6 +598,12 @@ void GLProgramCache::loadDefaultGLProgram(GLProgram *p, int type)
         case kShaderType_LabelOutline:
             p->initWithByteArrays(ccLabel_vert, ccLabelOutline_frag);
             break;
+        case kShaderType_LabelMSDF:
+            p->initWithByteArrays(ccLabel_vert, ccLabelMSDF_frag);
+            break;
+        case kShaderType_LabelBatch:
+            p->initWithByteArrays(ccPositionTextureColor_noMVP_vert, ccLabelBatch_frag);
+            break;
         case kShaderType_3DPosition:
             p->initWithByteArrays(cc3D_PositionTex_vert, cc3D_Color_frag);
             break;
@@ -571,7 +611,10 @@ void GLProgramCache::loadDefaultGLProgram(GLProgram *p, int type)
             p->initWithByteArrays(cc3D_PositionTex_vert, cc3D_ColorTex_frag);
             break;
         case kShaderType_3DSkinPositionTex:
-            p->initWithByteArrays(cc3D_SkinPositionTex_vert, cc3D_ColorTex_frag);
+            {
+                std::string def = getShaderMacrosForSkinning();
+                p->initWithByteArrays((def + std::string(cc3D_SkinPositionTex_vert)).c_str(), cc3D_ColorTex_frag);
+            }
             break;
         case kShaderType_3DPositionNormal:
             {
@@ -588,7 +631,8 @@ void GLProgramCache::loadDefaultGLProgram(GLProgram *p, int type)
         case kShaderType_3DSkinPositionNormalTex:
             {
                 std::string def = getShaderMacrosForLight();
-                p->initWithByteArrays((def + std::string(cc3D_SkinPositionNormalTex_vert)).c_str(), (def + std::string(cc3D_ColorNormalTex_frag)).c_str());
+                std::string skinningDef = getShaderMacrosForSkinning();
+                p->initWithByteArrays((def + skinningDef + std::string(cc3D_SkinPositionNormalTex_vert)).c_str(), (def + std::string(cc3D_ColorNormalTex_frag)).c_str());
             }
             break;
         case kShaderType_3DPositionBumpedNormalTex:
@@ -602,7 +646,8 @@ void GLProgramCache::loadDefaultGLProgram(GLProgram *p, int type)
             {
                 std::string def = getShaderMacrosForLight();
                 std::string normalMapDef = "\n#define USE_NORMAL_MAPPING 1 \n";
-                p->initWithByteArrays((def + normalMapDef + std::string(cc3D_SkinPositionNormalTex_vert)).c_str(), (def + normalMapDef + std::string(cc3D_ColorNormalTex_frag)).c_str());
+                std::string skinningDef = getShaderMacrosForSkinning();
+                p->initWithByteArrays((def + normalMapDef + skinningDef + std::string(cc3D_SkinPositionNormalTex_vert)).c_str(), (def + normalMapDef + std::string(cc3D_ColorNormalTex_frag)).c_str());
             }
             break;
         case kShaderType_3DParticleTex:
@@ -687,4 +732,16 @@ std::string GLProgramCache::getShaderMacrosForLight() const
     return std::string(def);
 }
 
+std::string GLProgramCache::getShaderMacrosForSkinning() const
+{
+    std::string def;
+    auto conf = Configuration::getInstance();
+
+    if (conf->isBonePaletteTextureEnabled())
+        def += "\n#define USE_PALETTE_TEXTURE 1 \n";
+    if (conf->isDualQuaternionSkinningEnabled())
+        def += "\n#define USE_DUAL_QUATERNION 1 \n";
+    return def;
+}
+
 NS_CC_END
@@ -95,6 +95,11 @@ public:
     /** reload default programs these are relative to light */
     void reloadDefaultGLProgramsRelativeToLights();
 
+    /** reload default programs of skinned meshes, these depend on the bone palette storage and the skinning method
+     * @since v3.18
+     */
+    void reloadDefaultGLProgramsRelativeToSkinning();
+
 private:
     /**
     @{
@@ -109,6 +114,9 @@ private:
     /**Get macro define for lights in current openGL driver.*/
     std::string getShaderMacrosForLight() const;
 
+    /**Get macro define for the bone palette storage and the skinning method of skinned meshes.*/
+    std::string getShaderMacrosForSkinning() const;
+
     /**Predefined shaders.*/
     std::unordered_map<std::string, GLProgram*> _programs;
 };
@@ -116,6 +116,12 @@ void UniformValue::apply()
     {
         switch (_uniform->type) {
             case GL_SAMPLER_2D:
+                if (_value.tex.texture)
+                {
+                    // the name changes when an evicted texture is reloaded
+                    _value.tex.texture->markAsUsed();
+                    _value.tex.textureId = _value.tex.texture->getName();
+                }
                 _glprogram->setUniformLocationWith1i(_uniform->location, _value.tex.textureUnit);
                 GL::bindTexture2DN(_value.tex.textureUnit, _value.tex.textureId);
                 break;
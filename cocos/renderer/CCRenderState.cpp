@@ -105,7 +105,10 @@ void RenderState::bind(Pass* pass)
     CC_ASSERT(pass);
 
     if (_texture)
+    {
+        _texture->markAsUsed();
         GL::bindTexture2D(_texture->getName());
+    }
 
     // Get the combined modified state bits for our RenderState hierarchy.
     long stateOverrideBits = _state ? _state->_bits : 0;
@@ -48,10 +48,7 @@ THE SOFTWARE.
 #include "renderer/ccGLStateCache.h"
 #include "renderer/CCGLProgramCache.h"
 #include "base/CCNinePatchImageParser.h"
-
-#if CC_ENABLE_CACHE_TEXTURE_DATA
-    #include "renderer/CCTextureCache.h"
-#endif
+#include "renderer/CCTextureCache.h"
 
 NS_CC_BEGIN
 
@@ -447,6 +444,9 @@ Texture2D::Texture2D()
 , _ninePatchInfo(nullptr)
 , _valid(true)
 , _alphaTexture(nullptr)
+, _lastUsedFrame(0)
+, _evicted(false)
+, _hasTexParams(false)
 {
 }
 
@@ -503,6 +503,17 @@ GLuint Texture2D::getAlphaTextureName() const
     return _alphaTexture == nullptr ? 0 : _alphaTexture->getName();
 }
 
+void Texture2D::markAsUsed()
+{
+    auto director = Director::getInstance();
+    _lastUsedFrame = director->getTotalFrames();
+
+    if (_evicted)
+    {
+        director->getTextureCache()->reloadEvictedTexture(this);
+    }
+}
+
 Size Texture2D::getContentSize() const
 {
     Size ret;
@@ -708,6 +719,7 @@ bool Texture2D::initWithMipmaps(MipmapInfo* mipmaps, int mipmapsNum, PixelFormat
 
     _hasPremultipliedAlpha = false;
     _hasMipmaps = mipmapsNum > 1;
+    _lastUsedFrame = Director::getInstance()->getTotalFrames();
 
     // shader
     setGLProgram(GLProgramCache::getInstance()->getGLProgram(GLProgram::SHADER_NAME_POSITION_TEXTURE));
@@ -816,6 +828,65 @@ bool Texture2D::initWithImage(Image *image, PixelFormat format)
     }
 }
 
+bool Texture2D::initWithImageDataInStrips(const unsigned char* data, ssize_t dataLen, PixelFormat format, int minPixels)
+{
+    // rows decoded, converted and uploaded at once
+    static const int STRIP_HEIGHT = 64;
+
+    Image image;
+    PixelFormat renderFormat = PixelFormat::NONE;
+    bool allocated = false;
+
+    auto onHeader = [&](Image* header) -> bool {
+        int maxTextureSize = Configuration::getInstance()->getMaxTextureSize();
+        if (header->getWidth() > maxTextureSize || header->getHeight() > maxTextureSize)
+        {
+            CCLOG("cocos2d: WARNING: Image (%u x %u) is bigger than the supported %u x %u", header->getWidth(), header->getHeight(), maxTextureSize, maxTextureSize);
+            return false;
+        }
+
+        renderFormat = header->getRenderFormat();
+        return header->getWidth() * header->getHeight() >= minPixels;
+    };
+
+    auto onStrip = [&](unsigned char* rows, int firstRow, int rowCount) -> bool {
+        const int width = image.getWidth();
+        const ssize_t rowsLen = (ssize_t)width * rowCount * _pixelFormatInfoTables.at(renderFormat).bpp / 8;
+
+        unsigned char* outData = nullptr;
+        ssize_t outDataLen = 0;
+        PixelFormat pixelFormat = convertDataToFormat(rows, rowsLen, renderFormat, format, &outData, &outDataLen);
+
+        bool ret = true;
+        if (!allocated)
+        {
+            // the converted format is only known once the first strip has been converted
+            MipmapInfo mipmap;
+            mipmap.len = static_cast<int>(outDataLen / rowCount * image.getHeight());
+            ret = allocated = initWithMipmaps(&mipmap, 1, pixelFormat, width, image.getHeight());
+        }
+
+        if (ret)
+        {
+            ret = updateWithData(outData, 0, firstRow, width, rowCount);
+        }
+
+        if (outData != nullptr && outData != rows)
+        {
+            free(outData);
+        }
+        return ret;
+    };
+
+    if (!image.initWithImageDataInStrips(data, dataLen, STRIP_HEIGHT, onHeader, onStrip) || !allocated)
+    {
+        return false;
+    }
+
+    _hasPremultipliedAlpha = image.hasPremultipliedAlpha();
+    return true;
+}
+
 Texture2D::PixelFormat Texture2D::convertI8ToFormat(const unsigned char* data, ssize_t dataLen, PixelFormat format, unsigned char** outData, ssize_t* outDataLen)
 {
     switch (format)
@@ -1266,6 +1337,9 @@ void Texture2D::setTexParameters(const TexParams &texParams)
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, texParams.wrapS );
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, texParams.wrapT );
 
+    _texParams = texParams;
+    _hasTexParams = true;
+
 #if CC_ENABLE_CACHE_TEXTURE_DATA
     VolatileTextureMgr::setTexParameters(this, texParams);
 #endif
@@ -1280,6 +1354,12 @@ void Texture2D::setAliasTexParameters()
 
     _antialiasEnabled = false;
 
+    if (_hasTexParams)
+    {
+        _texParams.minFilter = _hasMipmaps ? GL_NEAREST_MIPMAP_NEAREST : GL_NEAREST;
+        _texParams.magFilter = GL_NEAREST;
+    }
+
     if (_name == 0)
     {
         return;
@@ -1312,6 +1392,12 @@ void Texture2D::setAntiAliasTexParameters()
 
     _antialiasEnabled = true;
 
+    if (_hasTexParams)
+    {
+        _texParams.minFilter = _hasMipmaps ? GL_LINEAR_MIPMAP_NEAREST : GL_LINEAR;
+        _texParams.magFilter = GL_LINEAR;
+    }
+
     if (_name == 0)
     {
         return;
@@ -281,6 +281,20 @@ public:
     **/
     bool initWithImage(Image * image, PixelFormat format);
 
+    /**
+    Initializes a texture from PNG or JPEG file data, decoding and uploading it a few rows at a time.
+
+    Unlike initWithImage(), neither the whole decoded image nor its converted copy is held in memory,
+    so the peak memory of large textures is bounded by the size of a strip.
+    @param data The encoded file data.
+    @param dataLen The length of the data in bytes.
+    @param format Texture pixel formats, see initWithImage(Image*, PixelFormat).
+    @param minPixels Images with less pixels are rejected before anything is uploaded, so the caller can use initWithImage() instead.
+    @return false if the data isn't a supported PNG or JPEG image or if decoding failed.
+    @since v3.18
+    */
+    bool initWithImageDataInStrips(const unsigned char* data, ssize_t dataLen, PixelFormat format = PixelFormat::AUTO, int minPixels = 0);
+
     /** Initializes a texture from a string with dimensions, alignment, font name and font size. 
      
      @param text A null terminated string.
@@ -415,6 +429,23 @@ public:
     Texture2D* getAlphaTexture() const;
 
     GLuint getAlphaTextureName() const;
+
+    /** Records that the texture is used by the current frame.
+    If the TextureCache evicted the texture to stay within its memory budget, an asynchronous reload is requested.
+    It is called by the renderer when a command or an uniform refers to the texture.
+    @since v3.18
+    */
+    void markAsUsed();
+
+    /** Gets the last frame (see Director::getTotalFrames()) in which the texture was used or uploaded.
+    @since v3.18
+    */
+    unsigned int getLastUsedFrame() const { return _lastUsedFrame; }
+
+    /** Whether the GL texture was released by the TextureCache memory budget and not reloaded yet.
+    @since v3.18
+    */
+    bool isEvicted() const { return _evicted; }
 public:
     /** Get pixel info map, the key-value pairs is PixelFormat and PixelFormatInfo.*/
     static const PixelFormatInfoMap& getPixelFormatInfoMap();
@@ -554,6 +585,13 @@ protected:
     std::string _filePath;
 
     Texture2D* _alphaTexture;
+
+    unsigned int _lastUsedFrame;
+    bool _evicted;
+
+    /** the parameters set by setTexParameters(), restored when an evicted texture is reloaded */
+    TexParams _texParams;
+    bool _hasTexParams;
 };
 
 
@@ -32,6 +32,7 @@ THE SOFTWARE.
 #include <stack>
 #include <cctype>
 #include <list>
+#include <algorithm>
 
 #include "renderer/CCTexture2D.h"
 #include "base/ccMacros.h"
@@ -67,10 +68,28 @@ TextureCache * TextureCache::getInstance()
     return Director::getInstance()->getTextureCache();
 }
 
+namespace
+{
+    // GL memory used by a texture, mipmaps take an additional third
+    size_t textureMemorySize(Texture2D* texture)
+    {
+        if (texture->getName() == 0)
+        {
+            return 0;
+        }
+
+        size_t bytes = (size_t)texture->getPixelsWide() * texture->getPixelsHigh() * texture->getBitsPerPixelForFormat() / 8;
+        return texture->hasMipmaps() ? bytes * 4 / 3 : bytes;
+    }
+}
+
 TextureCache::TextureCache()
 : _loadingThread(nullptr)
 , _needQuit(false)
 , _asyncRefCount(0)
+, _stripUploadThreshold(1024 * 1024)
+, _memoryBudget(0)
+, _evictionGracePeriod(60)
 {
 }
 
@@ -110,7 +129,8 @@ public:
       const std::string& key )
       : filename(fn), callback(f),callbackKey( key ),
         pixelFormat(Texture2D::getDefaultAlphaPixelFormat()),
-        loadSuccess(false)
+        loadSuccess(false),
+        reloadTexture(nullptr)
     {}
 
     std::string filename;
@@ -120,6 +140,8 @@ public:
     Image imageAlpha;
     Texture2D::PixelFormat pixelFormat;
     bool loadSuccess;
+    // the evicted texture to reload, retained until the request is processed
+    Texture2D* reloadTexture;
 };
 
 /**
@@ -211,6 +233,15 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
         return;
     }
 
+    // generate async struct
+    AsyncStruct *data =
+      new (std::nothrow) AsyncStruct(fullpath, callback, callbackKey);
+
+    requestAsyncLoad(data);
+}
+
+void TextureCache::requestAsyncLoad(AsyncStruct* data)
+{
     // lazy init
     if (_loadingThread == nullptr)
     {
@@ -226,10 +257,6 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
 
     ++_asyncRefCount;
 
-    // generate async struct
-    AsyncStruct *data =
-      new (std::nothrow) AsyncStruct(fullpath, callback, callbackKey);
-    
     // add async struct into queue
     _asyncStructQueue.push_back(data);
     std::unique_lock<std::mutex> ul(_requestMutex);
@@ -313,6 +340,7 @@ void TextureCache::addImageAsyncCallBack(float /*dt*/)
 {
     Texture2D *texture = nullptr;
     AsyncStruct *asyncStruct = nullptr;
+    bool textureAdded = false;
     while (true)
     {
         // pop an AsyncStruct from response queue
@@ -336,6 +364,40 @@ void TextureCache::addImageAsyncCallBack(float /*dt*/)
             break;
         }
 
+        // reload of a texture evicted by the memory budget
+        if (asyncStruct->reloadTexture)
+        {
+            texture = asyncStruct->reloadTexture;
+            _reloadingTextures.erase(texture);
+
+            if (asyncStruct->loadSuccess && texture->isEvicted())
+            {
+                bool hadMipmaps = texture->hasMipmaps();
+                if (texture->initWithImage(&asyncStruct->image, asyncStruct->pixelFormat))
+                {
+                    if (hadMipmaps && !texture->hasMipmaps())
+                    {
+                        texture->generateMipmap();
+                    }
+                    if (texture->_hasTexParams)
+                    {
+                        texture->setTexParameters(texture->_texParams);
+                    }
+                    texture->_evicted = false;
+                    textureAdded = true;
+                }
+            }
+            else if (!asyncStruct->loadSuccess)
+            {
+                CCLOG("cocos2d: failed to reload evicted texture %s", asyncStruct->filename.c_str());
+            }
+
+            texture->release();
+            delete asyncStruct;
+            --_asyncRefCount;
+            continue;
+        }
+
         // check the image has been convert to texture or not
         auto it = _textures.find(asyncStruct->filename);
         if (it != _textures.end())
@@ -361,6 +423,7 @@ void TextureCache::addImageAsyncCallBack(float /*dt*/)
                 // cache the texture. retain it, since it is added in the map
                 _textures.emplace(asyncStruct->filename, texture);
                 texture->retain();
+                textureAdded = true;
 
                 texture->autorelease();
                 // ETC1 ALPHA supports.
@@ -389,6 +452,11 @@ void TextureCache::addImageAsyncCallBack(float /*dt*/)
         --_asyncRefCount;
     }
 
+    if (textureAdded)
+    {
+        trimToMemoryBudget();
+    }
+
     if (0 == _asyncRefCount)
     {
         Director::getInstance()->getScheduler()->unschedule(CC_SCHEDULE_SELECTOR(TextureCache::addImageAsyncCallBack), this);
@@ -417,10 +485,39 @@ Texture2D * TextureCache::addImage(const std::string &path)
         // all images are handled by UIImage except PVR extension that is handled by our own handler
         do
         {
+            // large images are uploaded while they are decoded, nine-patch images need the whole image to be parsed
+            Data data;
+            if (_stripUploadThreshold > 0 && !NinePatchImageParser::isNinePatchImage(path))
+            {
+                data = FileUtils::getInstance()->getDataFromFile(fullpath);
+                CC_BREAK_IF(data.isNull());
+
+                texture = new (std::nothrow) Texture2D();
+                if (texture && texture->initWithImageDataInStrips(data.getBytes(), data.getSize(), Texture2D::getDefaultAlphaPixelFormat(), _stripUploadThreshold))
+                {
+                    texture->_filePath = fullpath;
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+                    VolatileTextureMgr::addImageTexture(texture, fullpath);
+#endif
+                    _textures.emplace(fullpath, texture);
+                    break;
+                }
+                CC_SAFE_RELEASE_NULL(texture);
+            }
+
             image = new (std::nothrow) Image();
             CC_BREAK_IF(nullptr == image);
 
-            bool bRet = image->initWithImageFile(fullpath);
+            bool bRet = false;
+            if (data.isNull())
+            {
+                bRet = image->initWithImageFile(fullpath);
+            }
+            else
+            {
+                image->_filePath = fullpath;
+                bRet = image->initWithImageData(data.getBytes(), data.getSize());
+            }
             CC_BREAK_IF(!bRet);
 
             texture = new (std::nothrow) Texture2D();
@@ -463,6 +560,13 @@ Texture2D * TextureCache::addImage(const std::string &path)
 
     CC_SAFE_RELEASE(image);
 
+    if (texture && _memoryBudget > 0)
+    {
+        // keep the new texture out of the eviction candidates
+        texture->markAsUsed();
+        trimToMemoryBudget();
+    }
+
     return texture;
 }
 
@@ -686,14 +790,15 @@ std::string TextureCache::getCachedTextureInfo() const
         auto bytes = tex->getPixelsWide() * tex->getPixelsHigh() * bpp / 8;
         totalBytes += bytes;
         count++;
-        snprintf(buftmp, sizeof(buftmp) - 1, "\"%s\" rc=%lu id=%lu %lu x %lu @ %ld bpp => %lu KB\n",
+        snprintf(buftmp, sizeof(buftmp) - 1, "\"%s\" rc=%lu id=%lu %lu x %lu @ %ld bpp => %lu KB%s\n",
             texture.first.c_str(),
             (long)tex->getReferenceCount(),
             (long)tex->getName(),
             (long)tex->getPixelsWide(),
             (long)tex->getPixelsHigh(),
             (long)bpp,
-            (long)bytes / 1024);
+            (long)bytes / 1024,
+            tex->isEvicted() ? " (evicted)" : "");
 
         buffer += buftmp;
     }
@@ -704,6 +809,105 @@ std::string TextureCache::getCachedTextureInfo() const
     return buffer;
 }
 
+void TextureCache::setMemoryBudget(size_t bytes)
+{
+    _memoryBudget = bytes;
+    trimToMemoryBudget();
+}
+
+size_t TextureCache::getTextureMemory() const
+{
+    size_t totalBytes = 0;
+    for (auto& texture : _textures)
+    {
+        totalBytes += textureMemorySize(texture.second);
+    }
+    return totalBytes;
+}
+
+bool TextureCache::isEvictable(const std::string& key, Texture2D* texture, unsigned int frame) const
+{
+    // only textures which can be reloaded from their file are evicted, ETC1 alpha textures are left alone
+    return texture->getName() != 0
+        && !texture->getPath().empty()
+        && key == texture->getPath()
+        && texture->getAlphaTexture() == nullptr
+        && frame - texture->getLastUsedFrame() > _evictionGracePeriod;
+}
+
+int TextureCache::trimToMemoryBudget()
+{
+    if (_memoryBudget == 0)
+    {
+        return 0;
+    }
+
+    size_t totalBytes = getTextureMemory();
+    if (totalBytes <= _memoryBudget)
+    {
+        return 0;
+    }
+
+    unsigned int frame = Director::getInstance()->getTotalFrames();
+    std::vector<Texture2D*> candidates;
+    for (auto& texture : _textures)
+    {
+        if (isEvictable(texture.first, texture.second, frame))
+        {
+            candidates.push_back(texture.second);
+        }
+    }
+
+    // least recently used first
+    std::sort(candidates.begin(), candidates.end(), [](const Texture2D* a, const Texture2D* b) {
+        return a->getLastUsedFrame() < b->getLastUsedFrame();
+    });
+
+    int evicted = 0;
+    for (auto texture : candidates)
+    {
+        if (totalBytes <= _memoryBudget)
+        {
+            break;
+        }
+
+        totalBytes -= textureMemorySize(texture);
+        texture->releaseGLTexture();
+        texture->_evicted = true;
+        ++evicted;
+    }
+
+    if (totalBytes > _memoryBudget)
+    {
+        CCLOG("cocos2d: TextureCache: %lu KB of textures in use exceed the budget of %lu KB", (unsigned long)totalBytes / 1024, (unsigned long)_memoryBudget / 1024);
+    }
+
+    return evicted;
+}
+
+void TextureCache::reloadEvictedTexture(Texture2D* texture)
+{
+    // recreated in the meantime, e.g. by VolatileTextureMgr
+    if (texture->getName() != 0)
+    {
+        texture->_evicted = false;
+        return;
+    }
+
+    if (_reloadingTextures.find(texture) != _reloadingTextures.end())
+    {
+        return;
+    }
+
+    _reloadingTextures.insert(texture);
+    texture->retain();
+
+    AsyncStruct *data = new (std::nothrow) AsyncStruct(texture->getPath(), nullptr, "");
+    data->pixelFormat = texture->getPixelFormat();
+    data->reloadTexture = texture;
+    requestAsyncLoad(data);
+}
+
 void TextureCache::renameTextureWithKey(const std::string& srcName, const std::string& dstName)
 {
     std::string key = srcName;
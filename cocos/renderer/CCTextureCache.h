@@ -35,6 +35,7 @@ THE SOFTWARE.
 #include <queue>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <functional>
 
 #include "base/CCRef.h"
@@ -209,6 +210,60 @@ public:
      */
     std::string getTextureFilePath(Texture2D* texture) const;
 
+    /** Sets the size from which addImage(const std::string&) decodes PNG and JPEG files strip by strip.
+    * Such textures are uploaded while they are decoded, without holding the whole decoded image in memory.
+    * @param pixels The minimum number of pixels (width * height), 0 disables strip uploads. Default is 1024 * 1024.
+    * @since v3.18
+    */
+    void setStripUploadThreshold(int pixels) { _stripUploadThreshold = pixels; }
+
+    /** Returns the size from which PNG and JPEG files are uploaded strip by strip.
+    * @since v3.18
+    */
+    int getStripUploadThreshold() const { return _stripUploadThreshold; }
+
+    /** Sets the GL memory budget of the cached textures.
+    * When textures are added and the budget is exceeded, the least recently used textures which were loaded
+    * from a file and not used during the eviction grace period release their GL memory.
+    * The Texture2D objects stay valid, they are reloaded asynchronously the next time they are used.
+    * @param bytes The budget in bytes, 0 (the default) means unlimited.
+    * @since v3.18
+    */
+    void setMemoryBudget(size_t bytes);
+
+    /** Gets the GL memory budget of the cached textures, 0 means unlimited.
+    * @since v3.18
+    */
+    size_t getMemoryBudget() const { return _memoryBudget; }
+
+    /** Textures used within the last `frames` frames are never evicted. Default is 60.
+    * @since v3.18
+    */
+    void setEvictionGracePeriod(unsigned int frames) { _evictionGracePeriod = frames; }
+
+    /** Gets the number of frames during which a used texture can't be evicted.
+    * @since v3.18
+    */
+    unsigned int getEvictionGracePeriod() const { return _evictionGracePeriod; }
+
+    /** Returns the GL memory in bytes used by the cached textures, evicted textures are not counted.
+    * @since v3.18
+    */
+    size_t getTextureMemory() const;
+
+    /** Evicts the least recently used textures until the memory budget is met.
+    * It's called automatically when textures are added to the cache.
+    * @return The number of evicted textures.
+    * @since v3.18
+    */
+    int trimToMemoryBudget();
+
+    /** Requests an asynchronous reload of a texture evicted by the memory budget.
+    * Called by Texture2D::markAsUsed(), should not be called outside.
+    * @since v3.18
+    */
+    void reloadEvictedTexture(Texture2D* texture);
+
     /** Reload texture from a new file.
     * This function is mainly for editor, won't suggest use it in game for performance reason.
     *
@@ -223,10 +278,13 @@ public:
 private:
     void addImageAsyncCallBack(float dt);
     void loadImage();
+    bool isEvictable(const std::string& key, Texture2D* texture, unsigned int frame) const;
     void parseNinePatchImage(Image* image, Texture2D* texture, const std::string& path);
 public:
 protected:
     struct AsyncStruct;
+
+    void requestAsyncLoad(AsyncStruct* data);
     
     std::thread* _loadingThread;
 
@@ -245,6 +303,12 @@ protected:
 
     std::unordered_map<std::string, Texture2D*> _textures;
 
+    int _stripUploadThreshold;
+
+    size_t _memoryBudget;
+    unsigned int _evictionGracePeriod;
+    std::unordered_set<Texture2D*> _reloadingTextures;
+
     static std::string s_etc1AlphaFileSuffix;
 };
 
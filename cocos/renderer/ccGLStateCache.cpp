@@ -155,6 +155,7 @@ void bindTexture2D(GLuint textureId)
 
 void bindTexture2D(Texture2D* texture)
 {
+    texture->markAsUsed();
     GL::bindTexture2DN(0, texture->getName());
     auto alphaTexID = texture->getAlphaTextureName();
     if (alphaTexID > 0) {
@@ -143,9 +143,52 @@ attribute vec3 a_tangent;
 attribute vec3 a_binormal;
 #endif
 
-const int SKINNING_JOINT_COUNT = 60;
+#ifdef USE_DUAL_QUATERNION
+// a real and a dual quaternion per bone
+const int SKINNING_PALETTE_ROWS = 2;
+#else
+// a row-wise 4x3 matrix per bone
+const int SKINNING_PALETTE_ROWS = 3;
+#endif
+
 // Uniforms
+#ifdef USE_PALETTE_TEXTURE
+// one bone per line of texels, no joint limit
+#ifdef USE_DUAL_QUATERNION
+uniform sampler2D u_dualQuaternionPaletteTexture;
+#else
+uniform sampler2D u_matrixPaletteTexture;
+#endif
+uniform vec2 u_paletteTextureSize;
+
+vec4 getPaletteRow(int index)
+{
+    float bone = floor(float(index) / float(SKINNING_PALETTE_ROWS));
+    float row = float(index) - bone * float(SKINNING_PALETTE_ROWS);
+    vec2 texCoord = vec2((row + 0.5) / u_paletteTextureSize.x, (bone + 0.5) / u_paletteTextureSize.y);
+#ifdef USE_DUAL_QUATERNION
+    return texture2DLod(u_dualQuaternionPaletteTexture, texCoord, 0.0);
+#else
+    return texture2DLod(u_matrixPaletteTexture, texCoord, 0.0);
+#endif
+}
+#else
+const int SKINNING_JOINT_COUNT = 60;
+#ifdef USE_DUAL_QUATERNION
+uniform vec4 u_dualQuaternionPalette[SKINNING_JOINT_COUNT * 2];
+#else
 uniform vec4 u_matrixPalette[SKINNING_JOINT_COUNT * 3];
+#endif
+
+vec4 getPaletteRow(int index)
+{
+#ifdef USE_DUAL_QUATERNION
+    return u_dualQuaternionPalette[index];
+#else
+    return u_matrixPalette[index];
+#endif
+}
+#endif
 
 // Varyings
 varying vec2 TextureCoordOut;
@@ -173,37 +216,76 @@ varying vec3 v_normal;
 
 void getPositionAndNormal(out vec4 position, out vec3 normal, out vec3 tangent, out vec3 binormal)
 {
+#ifdef USE_DUAL_QUATERNION
+    float blendWeight = a_blendWeight[0];
+
+    int matrixIndex = int(a_blendIndex[0]) * SKINNING_PALETTE_ROWS;
+    vec4 firstReal = getPaletteRow(matrixIndex);
+    vec4 real = firstReal * blendWeight;
+    vec4 dual = getPaletteRow(matrixIndex + 1) * blendWeight;
+
+    // flip the quaternions that aren't in the hemisphere of the first one, or the blend takes the long way
+    for (int i = 1; i < 4; ++i)
+    {
+        blendWeight = a_blendWeight[i];
+        if (blendWeight > 0.0)
+        {
+            matrixIndex = int(a_blendIndex[i]) * SKINNING_PALETTE_ROWS;
+            vec4 r = getPaletteRow(matrixIndex);
+            if (dot(r, firstReal) < 0.0)
+                blendWeight = -blendWeight;
+            real += r * blendWeight;
+            dual += getPaletteRow(matrixIndex + 1) * blendWeight;
+        }
+    }
+
+    float len = length(real);
+    real /= len;
+    dual /= len;
+
+    vec3 translation = 2.0 * (real.w * dual.xyz - dual.w * real.xyz + cross(real.xyz, dual.xyz));
+    position.xyz = a_position + 2.0 * cross(real.xyz, cross(real.xyz, a_position) + real.w * a_position) + translation;
+    position.w = 1.0;
+
+#if ((MAX_DIRECTIONAL_LIGHT_NUM > 0) || (MAX_POINT_LIGHT_NUM > 0) || (MAX_SPOT_LIGHT_NUM > 0))
+    normal = a_normal + 2.0 * cross(real.xyz, cross(real.xyz, a_normal) + real.w * a_normal);
+#ifdef USE_NORMAL_MAPPING
+    tangent = a_tangent + 2.0 * cross(real.xyz, cross(real.xyz, a_tangent) + real.w * a_tangent);
+    binormal = a_binormal + 2.0 * cross(real.xyz, cross(real.xyz, a_binormal) + real.w * a_binormal);
+#endif
+#endif
+#else
     float blendWeight = a_blendWeight[0];
 
     int matrixIndex = int (a_blendIndex[0]) * 3;
-    vec4 matrixPalette1 = u_matrixPalette[matrixIndex] * blendWeight;
-    vec4 matrixPalette2 = u_matrixPalette[matrixIndex + 1] * blendWeight;
-    vec4 matrixPalette3 = u_matrixPalette[matrixIndex + 2] * blendWeight;
+    vec4 matrixPalette1 = getPaletteRow(matrixIndex) * blendWeight;
+    vec4 matrixPalette2 = getPaletteRow(matrixIndex + 1) * blendWeight;
+    vec4 matrixPalette3 = getPaletteRow(matrixIndex + 2) * blendWeight;
 
 
     blendWeight = a_blendWeight[1];
     if (blendWeight > 0.0)
     {
         matrixIndex = int(a_blendIndex[1]) * 3;
-        matrixPalette1 += u_matrixPalette[matrixIndex] * blendWeight;
-        matrixPalette2 += u_matrixPalette[matrixIndex + 1] * blendWeight;
-        matrixPalette3 += u_matrixPalette[matrixIndex + 2] * blendWeight;
+        matrixPalette1 += getPaletteRow(matrixIndex) * blendWeight;
+        matrixPalette2 += getPaletteRow(matrixIndex + 1) * blendWeight;
+        matrixPalette3 += getPaletteRow(matrixIndex + 2) * blendWeight;
 
         blendWeight = a_blendWeight[2];
         if (blendWeight > 0.0)
         {
             matrixIndex = int(a_blendIndex[2]) * 3;
-            matrixPalette1 += u_matrixPalette[matrixIndex] * blendWeight;
-            matrixPalette2 += u_matrixPalette[matrixIndex + 1] * blendWeight;
-            matrixPalette3 += u_matrixPalette[matrixIndex + 2] * blendWeight;
+            matrixPalette1 += getPaletteRow(matrixIndex) * blendWeight;
+            matrixPalette2 += getPaletteRow(matrixIndex + 1) * blendWeight;
+            matrixPalette3 += getPaletteRow(matrixIndex + 2) * blendWeight;
 
             blendWeight = a_blendWeight[3];
             if (blendWeight > 0.0)
             {
                 matrixIndex = int(a_blendIndex[3]) * 3;
-                matrixPalette1 += u_matrixPalette[matrixIndex] * blendWeight;
-                matrixPalette2 += u_matrixPalette[matrixIndex + 1] * blendWeight;
-                matrixPalette3 += u_matrixPalette[matrixIndex + 2] * blendWeight;
+                matrixPalette1 += getPaletteRow(matrixIndex) * blendWeight;
+                matrixPalette2 += getPaletteRow(matrixIndex + 1) * blendWeight;
+                matrixPalette3 += getPaletteRow(matrixIndex + 2) * blendWeight;
             }
         }
     }
@@ -230,6 +312,7 @@ void getPositionAndNormal(out vec4 position, out vec3 normal, out vec3 tangent,
     binormal.z = dot(b, matrixPalette3);
 #endif
 #endif
+#endif
 }
 
 void main()
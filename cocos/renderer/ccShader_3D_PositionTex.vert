@@ -22,46 +22,119 @@ attribute vec4 a_blendIndex;
 
 attribute vec2 a_texCoord;
 
-const int SKINNING_JOINT_COUNT = 60;
+#ifdef USE_DUAL_QUATERNION
+// a real and a dual quaternion per bone
+const int SKINNING_PALETTE_ROWS = 2;
+#else
+// a row-wise 4x3 matrix per bone
+const int SKINNING_PALETTE_ROWS = 3;
+#endif
+
 // Uniforms
+#ifdef USE_PALETTE_TEXTURE
+// one bone per line of texels, no joint limit
+#ifdef USE_DUAL_QUATERNION
+uniform sampler2D u_dualQuaternionPaletteTexture;
+#else
+uniform sampler2D u_matrixPaletteTexture;
+#endif
+uniform vec2 u_paletteTextureSize;
+
+vec4 getPaletteRow(int index)
+{
+    float bone = floor(float(index) / float(SKINNING_PALETTE_ROWS));
+    float row = float(index) - bone * float(SKINNING_PALETTE_ROWS);
+    vec2 texCoord = vec2((row + 0.5) / u_paletteTextureSize.x, (bone + 0.5) / u_paletteTextureSize.y);
+#ifdef USE_DUAL_QUATERNION
+    return texture2DLod(u_dualQuaternionPaletteTexture, texCoord, 0.0);
+#else
+    return texture2DLod(u_matrixPaletteTexture, texCoord, 0.0);
+#endif
+}
+#else
+const int SKINNING_JOINT_COUNT = 60;
+#ifdef USE_DUAL_QUATERNION
+uniform vec4 u_dualQuaternionPalette[SKINNING_JOINT_COUNT * 2];
+#else
 uniform vec4 u_matrixPalette[SKINNING_JOINT_COUNT * 3];
+#endif
+
+vec4 getPaletteRow(int index)
+{
+#ifdef USE_DUAL_QUATERNION
+    return u_dualQuaternionPalette[index];
+#else
+    return u_matrixPalette[index];
+#endif
+}
+#endif
 
 // Varyings
 varying vec2 TextureCoordOut;
 
 vec4 getPosition()
 {
+#ifdef USE_DUAL_QUATERNION
+    float blendWeight = a_blendWeight[0];
+
+    int matrixIndex = int(a_blendIndex[0]) * SKINNING_PALETTE_ROWS;
+    vec4 firstReal = getPaletteRow(matrixIndex);
+    vec4 real = firstReal * blendWeight;
+    vec4 dual = getPaletteRow(matrixIndex + 1) * blendWeight;
+
+    // flip the quaternions that aren't in the hemisphere of the first one, or the blend takes the long way
+    for (int i = 1; i < 4; ++i)
+    {
+        blendWeight = a_blendWeight[i];
+        if (blendWeight > 0.0)
+        {
+            matrixIndex = int(a_blendIndex[i]) * SKINNING_PALETTE_ROWS;
+            vec4 r = getPaletteRow(matrixIndex);
+            if (dot(r, firstReal) < 0.0)
+                blendWeight = -blendWeight;
+            real += r * blendWeight;
+            dual += getPaletteRow(matrixIndex + 1) * blendWeight;
+        }
+    }
+
+    float len = length(real);
+    real /= len;
+    dual /= len;
+
+    vec3 translation = 2.0 * (real.w * dual.xyz - dual.w * real.xyz + cross(real.xyz, dual.xyz));
+    return vec4(a_position + 2.0 * cross(real.xyz, cross(real.xyz, a_position) + real.w * a_position) + translation, 1.0);
+#else
     float blendWeight = a_blendWeight[0];
 
     int matrixIndex = int (a_blendIndex[0]) * 3;
-    vec4 matrixPalette1 = u_matrixPalette[matrixIndex] * blendWeight;
-    vec4 matrixPalette2 = u_matrixPalette[matrixIndex + 1] * blendWeight;
-    vec4 matrixPalette3 = u_matrixPalette[matrixIndex + 2] * blendWeight;
+    vec4 matrixPalette1 = getPaletteRow(matrixIndex) * blendWeight;
+    vec4 matrixPalette2 = getPaletteRow(matrixIndex + 1) * blendWeight;
+    vec4 matrixPalette3 = getPaletteRow(matrixIndex + 2) * blendWeight;
     
     
     blendWeight = a_blendWeight[1];
     if (blendWeight > 0.0)
     {
         matrixIndex = int(a_blendIndex[1]) * 3;
-        matrixPalette1 += u_matrixPalette[matrixIndex] * blendWeight;
-        matrixPalette2 += u_matrixPalette[matrixIndex + 1] * blendWeight;
-        matrixPalette3 += u_matrixPalette[matrixIndex + 2] * blendWeight;
+        matrixPalette1 += getPaletteRow(matrixIndex) * blendWeight;
+        matrixPalette2 += getPaletteRow(matrixIndex + 1) * blendWeight;
+        matrixPalette3 += getPaletteRow(matrixIndex + 2) * blendWeight;
         
         blendWeight = a_blendWeight[2];
         if (blendWeight > 0.0)
         {
             matrixIndex = int(a_blendIndex[2]) * 3;
-            matrixPalette1 += u_matrixPalette[matrixIndex] * blendWeight;
-            matrixPalette2 += u_matrixPalette[matrixIndex + 1] * blendWeight;
-            matrixPalette3 += u_matrixPalette[matrixIndex + 2] * blendWeight;
+            matrixPalette1 += getPaletteRow(matrixIndex) * blendWeight;
+            matrixPalette2 += getPaletteRow(matrixIndex + 1) * blendWeight;
+            matrixPalette3 += getPaletteRow(matrixIndex + 2) * blendWeight;
             
             blendWeight = a_blendWeight[3];
             if (blendWeight > 0.0)
             {
                 matrixIndex = int(a_blendIndex[3]) * 3;
-                matrixPalette1 += u_matrixPalette[matrixIndex] * blendWeight;
-                matrixPalette2 += u_matrixPalette[matrixIndex + 1] * blendWeight;
-                matrixPalette3 += u_matrixPalette[matrixIndex + 2] * blendWeight;
+                matrixPalette1 += getPaletteRow(matrixIndex) * blendWeight;
+                matrixPalette2 += getPaletteRow(matrixIndex + 1) * blendWeight;
+                matrixPalette3 += getPaletteRow(matrixIndex + 2) * blendWeight;
             }
         }
     }
@@ -74,6 +147,7 @@ vec4 getPosition()
     _skinnedPosition.w = position.w;
     
     return _skinnedPosition;
+#endif
 }
 
 void main()
@@ -0,0 +1,54 @@
+const char* ccLabelBatch_frag = R"(
+
+#ifdef GL_ES
+precision lowp float;
+#endif
+
+// the text color is baked into the vertex color so labels of any color share this program
+varying vec4 v_fragmentColor;
+varying vec2 v_texCoord;
+
+uniform vec4 u_effectColor;
+
+#ifdef GL_ES
+uniform lowp int u_effectType; // 0: Text, 1: Outline and text, 2: Distance field text, 3: Distance field glow
+#else
+uniform int u_effectType;
+#endif
+
+void main()
+{
+    vec4 sample = texture2D(CC_Texture0, v_texCoord);
+
+    if (u_effectType == 0)
+    {
+        gl_FragColor = vec4(v_fragmentColor.rgb, v_fragmentColor.a * sample.a);
+    }
+    else if (u_effectType == 1)
+    {
+        // the outline pass and the text pass in one, blended with SRC_ALPHA, ONE_MINUS_SRC_ALPHA
+        float fontAlpha = sample.a;
+        float outlineAlpha = u_effectColor.a * sample.r * (1.0 - fontAlpha);
+        float textAlpha = v_fragmentColor.a * fontAlpha;
+        float alpha = textAlpha + (1.0 - textAlpha) * outlineAlpha;
+        vec3 color = v_fragmentColor.rgb * textAlpha + u_effectColor.rgb * (1.0 - textAlpha) * outlineAlpha;
+        gl_FragColor = vec4(color / max(alpha, 0.001), alpha);
+    }
+    else
+    {
+        //TODO: Implementation 'fwidth' for glsl 1.0
+        float width = 0.04;
+        float alpha = smoothstep(0.5-width, 0.5+width, sample.a);
+        if (u_effectType == 2)
+        {
+            gl_FragColor = vec4(v_fragmentColor.rgb, v_fragmentColor.a * alpha);
+        }
+        else
+        {
+            float mu = smoothstep(0.5, 1.0, sqrt(sample.a));
+            vec4 color = u_effectColor*(1.0-alpha) + v_fragmentColor*alpha;
+            gl_FragColor = vec4(color.rgb, max(alpha,mu)*color.a);
+        }
+    }
+}
+)";
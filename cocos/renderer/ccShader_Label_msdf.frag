@@ -0,0 +1,57 @@
+const char* ccLabelMSDF_frag = R"(
+
+#ifdef GL_ES
+precision mediump float;
+#endif
+
+varying vec4 v_fragmentColor;
+varying vec2 v_texCoord;
+
+uniform vec4 u_effectColor;
+uniform vec4 u_textColor;
+// screen pixels between the lowest and the highest value of the distance field
+uniform float u_pxRange;
+// outline or shadow width in screen pixels
+uniform float u_effectWidth;
+
+#ifdef GL_ES
+uniform lowp int u_effectType; // 0: None (Draw text), 1: Outline, 2: Glow, 3: Shadow
+#else
+uniform int u_effectType;
+#endif
+
+float median(float r, float g, float b)
+{
+    return max(min(r, g), min(max(r, g), b));
+}
+
+void main()
+{
+    vec3 texel = texture2D(CC_Texture0, v_texCoord).rgb;
+    // signed distance to the outline in screen pixels, positive inside
+    float dist = (median(texel.r, texel.g, texel.b) - 0.5) * u_pxRange;
+    float textAlpha = clamp(dist + 0.5, 0.0, 1.0);
+
+    if (u_effectType == 0) // draw text
+    {
+        gl_FragColor = v_fragmentColor * vec4(u_textColor.rgb, u_textColor.a * textAlpha);
+    }
+    else if (u_effectType == 1) // draw text over its outline
+    {
+        float outlineAlpha = clamp(dist + u_effectWidth + 0.5, 0.0, 1.0);
+        vec4 color = mix(u_effectColor, u_textColor, textAlpha);
+        gl_FragColor = v_fragmentColor * vec4(color.rgb, color.a * outlineAlpha);
+    }
+    else if (u_effectType == 2) // draw text over its glow
+    {
+        float glowAlpha = smoothstep(-0.5 * u_pxRange, 0.0, dist);
+        vec4 color = mix(u_effectColor, u_textColor, textAlpha);
+        gl_FragColor = v_fragmentColor * vec4(color.rgb, color.a * max(textAlpha, glowAlpha));
+    }
+    else // draw shadow, outline included
+    {
+        float shadowAlpha = clamp(dist + u_effectWidth + 0.5, 0.0, 1.0);
+        gl_FragColor = v_fragmentColor * vec4(u_effectColor.rgb, u_effectColor.a * shadowAlpha);
+    }
+}
+)";
@@ -73,6 +73,8 @@ extern CC_DLL const GLchar * ccLabelDistanceFieldNormal_frag;
 extern CC_DLL const GLchar * ccLabelDistanceFieldGlow_frag;
 extern CC_DLL const GLchar * ccLabelNormal_frag;
 extern CC_DLL const GLchar * ccLabelOutline_frag;
+extern CC_DLL const GLchar * ccLabelMSDF_frag;
+extern CC_DLL const GLchar * ccLabelBatch_frag;
 
 extern CC_DLL const GLchar * ccLabel_vert;
 
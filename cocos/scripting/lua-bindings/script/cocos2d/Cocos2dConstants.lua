@@ -642,7 +642,8 @@ cc.AsyncTaskPool.TaskType =
     TASK_IO = 0,
     TASK_NETWORK = 1,
     TASK_OTHER = 2,
-    TASK_MAX_TYPE = 3,  
+    TASK_COMPUTE = 3,
+    TASK_MAX_TYPE = 4,  
 }
 
 
@@ -12,6 +12,7 @@ UIWidget.cpp \
 UILayout.cpp \
 UILayoutParameter.cpp \
 UILayoutManager.cpp \
+UILayoutScheduler.cpp \
 CocosGUI.cpp \
 UIHelper.cpp \
 UIListView.cpp \
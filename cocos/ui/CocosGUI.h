@@ -58,6 +58,7 @@ THE SOFTWARE.
 #include "ui/UIScale9Sprite.h"
 #include "ui/UIEditBox/UIEditBox.h"
 #include "ui/UILayoutComponent.h"
+#include "ui/UILayoutScheduler.h"
 #include "ui/UITabControl.h"
 #include "editor-support/cocostudio/CocosStudioExtension.h"
 
@@ -34,6 +34,7 @@ THE SOFTWARE.
 #include "2d/CCDrawingPrimitives.h"
 #include "renderer/CCRenderer.h"
 #include "ui/UILayoutManager.h"
+#include "ui/UILayoutScheduler.h"
 #include "2d/CCDrawNode.h"
 #include "2d/CCLayer.h"
 #include "2d/CCSprite.h"
@@ -77,6 +78,7 @@ _clippingParent(nullptr),
 _clippingRectDirty(true),
 _stencilStateManager(new StencilStateManager()),
 _doLayoutDirty(true),
+_doLayoutScheduled(false),
 _isInterceptTouch(false),
 _loopFocus(false),
 _passFocusToChild(true),
@@ -87,6 +89,10 @@ _isFocusPassing(false)
 
 Layout::~Layout()
 {
+    if (_doLayoutScheduled)
+    {
+        LayoutScheduler::getInstance()->unscheduleLayout(this);
+    }
     CC_SAFE_RELEASE(_clippingStencil);
     CC_SAFE_DELETE(_stencilStateManager);
 }
@@ -106,7 +112,7 @@ void Layout::onEnter()
     {
         _clippingStencil->onEnter();
     }
-    _doLayoutDirty = true;
+    markDoLayoutDirty();
     _clippingRectDirty = true;
 }
     
@@ -125,6 +131,10 @@ void Layout::onExit()
     {
         _clippingStencil->onExit();
     }
+    if (_doLayoutScheduled)
+    {
+        LayoutScheduler::getInstance()->unscheduleLayout(this);
+    }
 }
     
 void Layout::setGlobalZOrder(float globalZOrder)
@@ -181,7 +191,7 @@ void Layout::addChild(Node *child, int zOrder, int tag)
     }
     child->setGlobalZOrder(_globalZOrder);
     Widget::addChild(child, zOrder, tag);
-    _doLayoutDirty = true;
+    markDoLayoutDirty();
 }
     
 void Layout::addChild(Node* child, int zOrder, const std::string &name)
@@ -191,25 +201,25 @@ void Layout::addChild(Node* child, int zOrder, const std::string &name)
     }
     child->setGlobalZOrder(_globalZOrder);
     Widget::addChild(child, zOrder, name);
-    _doLayoutDirty = true;
+    markDoLayoutDirty();
 }
     
 void Layout::removeChild(Node *child, bool cleanup)
 {
     Widget::removeChild(child, cleanup);
-    _doLayoutDirty = true;
+    markDoLayoutDirty();
 }
     
 void Layout::removeAllChildren()
 {
     Widget::removeAllChildren();
-    _doLayoutDirty = true;
+    markDoLayoutDirty();
 }
     
 void Layout::removeAllChildrenWithCleanup(bool cleanup)
 {
     Widget::removeAllChildrenWithCleanup(cleanup);
-    _doLayoutDirty = true;
+    markDoLayoutDirty();
 }
 
 bool Layout::isClippingEnabled()const
@@ -542,7 +552,7 @@ void Layout::onSizeChanged()
 {
     Widget::onSizeChanged();
     setStencilClippingSize(_contentSize);
-    _doLayoutDirty = true;
+    markDoLayoutDirty();
     _clippingRectDirty = true;
     if (_backGroundImage)
     {
@@ -910,7 +920,7 @@ void Layout::setLayoutType(Type type)
             supplyTheLayoutParameterLackToChild(static_cast<Widget*>(child));
         }
     }
-    _doLayoutDirty = true;
+    markDoLayoutDirty();
 }
     
 
@@ -927,8 +937,17 @@ void Layout::forceDoLayout()
 }
     
 void Layout::requestDoLayout()
+{
+    markDoLayoutDirty();
+}
+
+void Layout::markDoLayoutDirty()
 {
     _doLayoutDirty = true;
+    if (_running)
+    {
+        LayoutScheduler::getInstance()->scheduleLayout(this);
+    }
 }
     
 Size Layout::getLayoutContentSize()const
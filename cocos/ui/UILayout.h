@@ -401,7 +401,7 @@ public:
     virtual void forceDoLayout();
     
     /**
-     * request to refresh widget layout
+     * request to refresh widget layout, the layout runs once before the next frame is drawn
      */
     virtual void requestDoLayout();
     
@@ -490,6 +490,9 @@ protected:
     virtual LayoutManager* createLayoutManager()override;
     virtual Size getLayoutContentSize()const override;
     virtual const Vector<Node*>& getLayoutElements()const override;
+
+    // sets the layout dirty and queues it for the next layout pass
+    void markDoLayoutDirty();
     
     //clipping
     
@@ -645,6 +648,8 @@ protected:
     CustomCommand _afterVisitCmdScissor;
     
     bool _doLayoutDirty;
+    // queued in the LayoutScheduler
+    bool _doLayoutScheduled;
     bool _isInterceptTouch;
     
     //whether enable loop focus or not
@@ -653,6 +658,8 @@ protected:
     bool _passFocusToChild;
      //when finding the next focused widget, use this variable to pass focus between layout & widget
     bool _isFocusPassing;
+
+    friend class LayoutScheduler;
 };
     
 }
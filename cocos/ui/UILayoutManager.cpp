@@ -137,7 +137,7 @@ void LinearVerticalLayoutManager::doLayout(LayoutProtocol* layout)
                 finalPosX += mg.left;
                 finalPosY -= mg.top;
                 subWidget->setPosition(finalPosX, finalPosY);
-                topBoundary = subWidget->getPosition().y - subWidget->getAnchorPoint().y * subWidget->getBoundingBox().size.height - mg.bottom;
+                topBoundary = finalPosY - ap.y * cs.height - mg.bottom;
             }
         }
     }
@@ -164,6 +164,7 @@ Vector<Widget*> RelativeLayoutManager::getAllWidgets(cocos2d::ui::LayoutProtocol
 {
     Vector<Node*> container = layout->getLayoutElements();
     Vector<Widget*> widgetChildren;
+    _relativeWidgets.clear();
     for (auto& subWidget : container)
     {
         Widget* child = dynamic_cast<Widget*>(subWidget);
@@ -173,6 +174,8 @@ Vector<Widget*> RelativeLayoutManager::getAllWidgets(cocos2d::ui::LayoutProtocol
             layoutParameter->_put = false;
             _unlayoutChildCount++;
             widgetChildren.pushBack(child);
+            // looked up once per child and pass below, the first widget with a name wins
+            _relativeWidgets.emplace(layoutParameter->getRelativeName(), std::make_pair(child, layoutParameter));
         }
     }
     return widgetChildren;
@@ -187,18 +190,11 @@ Widget* RelativeLayoutManager::getRelativeWidget(Widget* widget)
     
     if (!relativeName.empty())
     {
-        for (auto& sWidget : _widgetChildren)
+        auto iter = _relativeWidgets.find(relativeName);
+        if (iter != _relativeWidgets.end())
         {
-            if (sWidget)
-            {
-                RelativeLayoutParameter* rlayoutParameter = dynamic_cast<RelativeLayoutParameter*>(sWidget->getLayoutParameter());
-                if (rlayoutParameter &&  rlayoutParameter->getRelativeName() == relativeName)
-                {
-                    relativeWidget = sWidget;
-                    _relativeWidgetLP = rlayoutParameter;
-                    break;
-                }
-            }
+            relativeWidget = iter->second.first;
+            _relativeWidgetLP = iter->second.second;
         }
     }
     return relativeWidget;
@@ -571,6 +567,7 @@ void RelativeLayoutManager::doLayout(LayoutProtocol *layout)
 
     }
     _widgetChildren.clear();
+    _relativeWidgets.clear();
 }
 
 }
@@ -26,6 +26,8 @@
 #ifndef __cocos2d_libs__CCLayoutManager__
 #define __cocos2d_libs__CCLayoutManager__
 
+#include <string>
+#include <unordered_map>
 #include "base/CCRef.h"
 #include "base/CCVector.h"
 #include "ui/GUIExport.h"
@@ -127,6 +129,8 @@ private:
 
     ssize_t _unlayoutChildCount;
     Vector<Widget*> _widgetChildren;
+    // children by their relative name, built once per doLayout
+    std::unordered_map<std::string, std::pair<Widget*, RelativeLayoutParameter*>> _relativeWidgets;
     Widget* _widget;
     float _finalPositionX;
     float _finalPositionY;
@@ -0,0 +1,245 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#include "ui/UILayoutScheduler.h"
+#include <algorithm>
+#include "ui/UILayout.h"
+#include "base/CCDirector.h"
+#include "base/CCEventDispatcher.h"
+#include "base/CCEventListenerCustom.h"
+#include "base/CCConsole.h"
+#include "base/CCScheduler.h"
+#include "base/ccUTF8.h"
+
+NS_CC_BEGIN
+
+namespace ui {
+
+namespace
+{
+    LayoutScheduler* s_sharedLayoutScheduler = nullptr;
+
+    // layouts resizing each other back and forth would never settle, the rest is left to visit()
+    const unsigned int MAX_PASSES_PER_FRAME = 8;
+
+    const char* CONSOLE_COMMAND_NAME = "layout";
+
+    int getNodeDepth(const Node* node)
+    {
+        int depth = 0;
+        for (const Node* parent = node->getParent(); parent; parent = parent->getParent())
+        {
+            ++depth;
+        }
+        return depth;
+    }
+}
+
+LayoutScheduler* LayoutScheduler::getInstance()
+{
+    if (nullptr == s_sharedLayoutScheduler)
+    {
+        s_sharedLayoutScheduler = new (std::nothrow) LayoutScheduler();
+    }
+    return s_sharedLayoutScheduler;
+}
+
+void LayoutScheduler::destroyInstance()
+{
+    CC_SAFE_DELETE(s_sharedLayoutScheduler);
+}
+
+LayoutScheduler::LayoutScheduler()
+: _enabled(true)
+, _beforeDrawListener(nullptr)
+, _resetListener(nullptr)
+, _requestCount(0)
+, _lastFramePassCount(0)
+, _lastFrameLayoutCount(0)
+, _lastFrameRequestCount(0)
+, _maxFramePassCount(0)
+, _maxFrameLayoutCount(0)
+, _frameCount(0)
+, _totalLayoutCount(0)
+{
+    Director* director = Director::getInstance();
+    _beforeDrawListener = director->getEventDispatcher()->addCustomEventListener(Director::EVENT_BEFORE_DRAW, [this](EventCustom* /*event*/) {
+        flush();
+    });
+    _beforeDrawListener->retain();
+    // the director removes every listener when it is reset, a new scheduler is made on the next use
+    _resetListener = director->getEventDispatcher()->addCustomEventListener(Director::EVENT_RESET, [](EventCustom* /*event*/) {
+        LayoutScheduler::destroyInstance();
+    });
+    _resetListener->retain();
+
+    Console* console = director->getConsole();
+    if (console)
+    {
+        console->addCommand({CONSOLE_COMMAND_NAME, "Print the UI layout pass statistics. Args: [-h | help | reset | ]",
+            [](int fd, const std::string& args) {
+                Director::getInstance()->getScheduler()->performFunctionInCocosThread([=]() {
+                    LayoutScheduler* scheduler = LayoutScheduler::getInstance();
+                    if (args == "reset")
+                    {
+                        scheduler->resetStatistics();
+                    }
+                    Console::Utility::mydprintf(fd, "%s", scheduler->getStatisticsInfo().c_str());
+                    Console::Utility::sendPrompt(fd);
+                });
+            }});
+    }
+}
+
+LayoutScheduler::~LayoutScheduler()
+{
+    for (auto& layout : _pendingLayouts)
+    {
+        layout->_doLayoutScheduled = false;
+    }
+    Director* director = Director::getInstance();
+    director->getEventDispatcher()->removeEventListener(_beforeDrawListener);
+    director->getEventDispatcher()->removeEventListener(_resetListener);
+    CC_SAFE_RELEASE(_beforeDrawListener);
+    CC_SAFE_RELEASE(_resetListener);
+    if (director->getConsole())
+    {
+        director->getConsole()->delCommand(CONSOLE_COMMAND_NAME);
+    }
+}
+
+void LayoutScheduler::setEnabled(bool enabled)
+{
+    if (_enabled == enabled)
+    {
+        return;
+    }
+    _enabled = enabled;
+    if (!_enabled)
+    {
+        // the queued layouts are still dirty and run when visited
+        for (auto& layout : _pendingLayouts)
+        {
+            layout->_doLayoutScheduled = false;
+        }
+        _pendingLayouts.clear();
+    }
+}
+
+void LayoutScheduler::scheduleLayout(Layout* layout)
+{
+    ++_requestCount;
+    if (!_enabled || layout->_doLayoutScheduled || !layout->isRunning())
+    {
+        return;
+    }
+    layout->_doLayoutScheduled = true;
+    _pendingLayouts.push_back(layout);
+}
+
+void LayoutScheduler::unscheduleLayout(Layout* layout)
+{
+    if (!layout->_doLayoutScheduled)
+    {
+        return;
+    }
+    layout->_doLayoutScheduled = false;
+    auto iter = std::find(_pendingLayouts.begin(), _pendingLayouts.end(), layout);
+    if (iter != _pendingLayouts.end())
+    {
+        _pendingLayouts.erase(iter);
+    }
+}
+
+void LayoutScheduler::flush()
+{
+    unsigned int passCount = 0;
+    unsigned int layoutCount = 0;
+
+    std::vector<std::pair<int, Layout*>> pass;
+    while (!_pendingLayouts.empty() && passCount < MAX_PASSES_PER_FRAME)
+    {
+        ++passCount;
+
+        pass.clear();
+        pass.reserve(_pendingLayouts.size());
+        for (auto& layout : _pendingLayouts)
+        {
+            // a layout made dirty again during the pass goes to the next one
+            layout->_doLayoutScheduled = false;
+            layout->retain();
+            pass.push_back(std::make_pair(getNodeDepth(layout), layout));
+        }
+        _pendingLayouts.clear();
+
+        // parents first, so the sizes they give their children are final when the children run
+        std::stable_sort(pass.begin(), pass.end(), [](const std::pair<int, Layout*>& a, const std::pair<int, Layout*>& b) {
+            return a.first < b.first;
+        });
+
+        for (auto& entry : pass)
+        {
+            Layout* layout = entry.second;
+            if (layout->isRunning())
+            {
+                layout->doLayout();
+                ++layoutCount;
+            }
+            layout->release();
+        }
+    }
+
+    _lastFramePassCount = passCount;
+    _lastFrameLayoutCount = layoutCount;
+    _lastFrameRequestCount = _requestCount;
+    _requestCount = 0;
+    _maxFramePassCount = std::max(_maxFramePassCount, passCount);
+    _maxFrameLayoutCount = std::max(_maxFrameLayoutCount, layoutCount);
+    _totalLayoutCount += layoutCount;
+    ++_frameCount;
+}
+
+std::string LayoutScheduler::getStatisticsInfo() const
+{
+    return StringUtils::format("Layout passes: %u, layouts: %u, requests: %u in the last frame\n"
+                               "Max passes: %u, max layouts: %u, %.2f layouts per frame over %u frames\n"
+                               "Deferred layout is %s, %d layouts queued\n",
+                               _lastFramePassCount, _lastFrameLayoutCount, _lastFrameRequestCount,
+                               _maxFramePassCount, _maxFrameLayoutCount,
+                               _frameCount ? (double)_totalLayoutCount / _frameCount : 0.0, _frameCount,
+                               _enabled ? "on" : "off", (int)_pendingLayouts.size());
+}
+
+void LayoutScheduler::resetStatistics()
+{
+    _maxFramePassCount = 0;
+    _maxFrameLayoutCount = 0;
+    _frameCount = 0;
+    _totalLayoutCount = 0;
+}
+
+}
+
+NS_CC_END
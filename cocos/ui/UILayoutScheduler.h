@@ -0,0 +1,118 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+
+#ifndef __UILAYOUTSCHEDULER_H__
+#define __UILAYOUTSCHEDULER_H__
+
+#include <string>
+#include <vector>
+#include "platform/CCPlatformMacros.h"
+#include "ui/GUIExport.h"
+
+/**
+ * @addtogroup ui
+ * @{
+ */
+NS_CC_BEGIN
+
+class EventListenerCustom;
+
+namespace ui {
+
+class Layout;
+
+/**
+ * @brief Runs the layouts that became dirty during a frame in one pass before the frame is drawn.
+ *
+ * A Layout that needs to lay its children out again, because a child was added, removed or
+ * resized or because its own size changed, is queued here instead of being laid out when it
+ * is visited. Right before the scene is visited the queued layouts run parents first, so a
+ * child resized by its parent is laid out once, after the parent, in the same frame. Layouts
+ * dirtied again during the pass are run in a further pass.
+ *
+ * The `layout` console command prints the passes and layouts of the last frame.
+ * @since v3.18
+ */
+class CC_GUI_DLL LayoutScheduler
+{
+public:
+    /** Returns the shared scheduler. */
+    static LayoutScheduler* getInstance();
+    static void destroyInstance();
+
+    /**
+     * Turns deferred layout on or off. When off, layouts run when they are visited as before.
+     * On by default.
+     */
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return _enabled; }
+
+    /** Queues a running layout for the next pass. */
+    void scheduleLayout(Layout* layout);
+
+    /** Removes a layout from the queue, called when it leaves the scene. */
+    void unscheduleLayout(Layout* layout);
+
+    /** Runs the queued layouts parents first. Called before every frame is drawn. */
+    void flush();
+
+    /** Number of passes run before the last frame. */
+    unsigned int getLastFramePassCount() const { return _lastFramePassCount; }
+    /** Number of layouts run before the last frame. */
+    unsigned int getLastFrameLayoutCount() const { return _lastFrameLayoutCount; }
+    /** Number of times layouts were made dirty during the last frame, repeated requests included. */
+    unsigned int getLastFrameRequestCount() const { return _lastFrameRequestCount; }
+
+    /** A description of the statistics of the last frame and since the start. */
+    std::string getStatisticsInfo() const;
+    void resetStatistics();
+
+protected:
+    LayoutScheduler();
+    ~LayoutScheduler();
+
+    bool _enabled;
+    std::vector<Layout*> _pendingLayouts;
+    EventListenerCustom* _beforeDrawListener;
+    EventListenerCustom* _resetListener;
+
+    unsigned int _requestCount;
+    unsigned int _lastFramePassCount;
+    unsigned int _lastFrameLayoutCount;
+    unsigned int _lastFrameRequestCount;
+    unsigned int _maxFramePassCount;
+    unsigned int _maxFrameLayoutCount;
+    unsigned int _frameCount;
+    unsigned long long _totalLayoutCount;
+
+    friend class Layout;
+};
+
+}
+NS_CC_END
+// end of ui group
+/// @}
+
+#endif /* defined(__UILAYOUTSCHEDULER_H__) */
@@ -25,6 +25,7 @@ THE SOFTWARE.
 
 #include "ui/UIListView.h"
 #include "ui/UIHelper.h"
+#include "ui/UILayoutScheduler.h"
 
 NS_CC_BEGIN
 
@@ -49,7 +50,10 @@ _curSelectedIndex(-1),
 _innerContainerDoLayoutDirty(true),
 _listViewEventListener(nullptr),
 _listViewEventSelector(nullptr),
-_eventCallback(nullptr)
+_eventCallback(nullptr),
+_adapter(nullptr),
+_virtualizationMargin(0.0f),
+_firstBoundIndex(0)
 {
     this->setTouchEnabled(true);
 }
@@ -59,6 +63,8 @@ ListView::~ListView()
     _listViewEventListener = nullptr;
     _listViewEventSelector = nullptr;
     _items.clear();
+    _boundCells.clear();
+    _cellPools.clear();
     CC_SAFE_RELEASE(_model);
 }
 
@@ -113,6 +119,21 @@ void ListView::onItemListChanged()
 
 void ListView::updateInnerContainerSize()
 {
+    if (_adapter)
+    {
+        // only resize on change, setInnerContainerSize moves the container back to the top
+        ssize_t count = _cellSizes.size();
+        float trailingPadding = (_direction == Direction::HORIZONTAL) ? _rightPadding : _bottomPadding;
+        float length = (count == 0) ? 0.0f : getCellOffset(count - 1) + _cellSizes[count - 1] + trailingPadding;
+        Size innerSize = (_direction == Direction::HORIZONTAL) ? Size(MAX(length, _contentSize.width), _contentSize.height)
+                                                                : Size(_contentSize.width, MAX(length, _contentSize.height));
+        if (!innerSize.equals(_innerContainer->getContentSize()))
+        {
+            setInnerContainerSize(innerSize);
+        }
+        return;
+    }
+
     switch (_direction)
     {
         case Direction::VERTICAL:
@@ -343,6 +364,12 @@ void ListView::removeAllChildrenWithCleanup(bool cleanup)
     ScrollView::removeAllChildrenWithCleanup(cleanup);
     _curSelectedIndex = -1;
     _items.clear();
+    // the cells of a virtualized list were children too, they are created again on the next layout
+    _boundCells.clear();
+    _boundCellTypes.clear();
+    _firstBoundIndex = 0;
+    _cellPools.clear();
+    requestDoLayout();
     onItemListChanged();
 }
 
@@ -386,6 +413,10 @@ void ListView::removeAllItems()
 
 Widget* ListView::getItem(ssize_t index) const
 {
+    if (_adapter)
+    {
+        return getCell(index);
+    }
     if (index < 0 || index >= _items.size())
     {
         return nullptr;
@@ -404,6 +435,11 @@ ssize_t ListView::getIndex(Widget *item) const
     {
         return -1;
     }
+    if (_adapter)
+    {
+        ssize_t slot = _boundCells.getIndex(item);
+        return (slot < 0) ? -1 : _firstBoundIndex + slot;
+    }
     return _items.getIndex(item);
 }
 
@@ -556,6 +592,344 @@ void ListView::setDirection(Direction dir)
             break;
     }
     ScrollView::setDirection(dir);
+
+    if (_adapter)
+    {
+        // item sizes are measured along the direction
+        setLayoutType(Type::ABSOLUTE);
+        reloadData();
+    }
+}
+
+void ListView::setAdapter(ListViewAdapter* adapter)
+{
+    if (_adapter == adapter)
+    {
+        return;
+    }
+    if (_adapter)
+    {
+        removeAllCells();
+    }
+    else
+    {
+        removeAllItems();
+    }
+    _adapter = adapter;
+    _cellSizes.clear();
+    _cellOffsets.assign(1, 0.0f);
+    _curSelectedIndex = -1;
+
+    if (_adapter)
+    {
+        // cells are placed by the list view, the inner container must not lay them out
+        setLayoutType(Type::ABSOLUTE);
+        reloadData();
+    }
+    else
+    {
+        setLayoutType(_direction == Direction::HORIZONTAL ? Type::HORIZONTAL : Type::VERTICAL);
+        requestDoLayout();
+    }
+}
+
+void ListView::reloadData()
+{
+    if (nullptr == _adapter)
+    {
+        return;
+    }
+    recycleAllCells();
+
+    ssize_t count = MAX(_adapter->getItemCount(), 0);
+    _cellSizes.resize(count);
+    for (ssize_t i = 0; i < count; ++i)
+    {
+        _cellSizes[i] = _adapter->measureItem(i);
+    }
+    updateCellOffsets(0);
+
+    if (_curSelectedIndex >= count)
+    {
+        _curSelectedIndex = -1;
+    }
+    onItemListChanged();
+    requestDoLayout();
+}
+
+void ListView::notifyItemChanged(ssize_t index)
+{
+    if (nullptr == _adapter || index < 0 || index >= (ssize_t)_cellSizes.size())
+    {
+        return;
+    }
+    float size = _adapter->measureItem(index);
+    if (size != _cellSizes[index])
+    {
+        _cellSizes[index] = size;
+        updateCellOffsets(index);
+        requestDoLayout();
+    }
+
+    Widget* cell = getCell(index);
+    if (cell)
+    {
+        ssize_t slot = index - _firstBoundIndex;
+        int cellType = _adapter->getCellType(index);
+        if (cellType != _boundCellTypes[slot])
+        {
+            recycleCell(cell, _boundCellTypes[slot], index);
+            cell = dequeueCell(cellType);
+            _boundCells.replace(slot, cell);
+            _boundCellTypes[slot] = cellType;
+        }
+        else
+        {
+            _adapter->unbindCell(cell, index);
+        }
+        _adapter->bindCell(cell, index);
+        placeCell(cell, index);
+    }
+}
+
+void ListView::setVirtualizationMargin(float margin)
+{
+    if (_virtualizationMargin == margin)
+    {
+        return;
+    }
+    _virtualizationMargin = MAX(margin, 0.0f);
+    requestDoLayout();
+}
+
+Widget* ListView::getCell(ssize_t index) const
+{
+    if (nullptr == _adapter || index < _firstBoundIndex || index >= _firstBoundIndex + _boundCells.size())
+    {
+        return nullptr;
+    }
+    return _boundCells.at(index - _firstBoundIndex);
+}
+
+ssize_t ListView::getPooledCellCount() const
+{
+    ssize_t count = 0;
+    for (const auto& pool : _cellPools)
+    {
+        count += pool.second.size();
+    }
+    return count;
+}
+
+float ListView::getCellOffset(ssize_t index) const
+{
+    float leadingPadding = (_direction == Direction::HORIZONTAL) ? _leftPadding : _topPadding;
+    return leadingPadding + _cellOffsets[index] + index * _itemsMargin;
+}
+
+ssize_t ListView::findCellAtOffset(float offset) const
+{
+    // the last cell starting at or before the offset
+    ssize_t first = 0;
+    ssize_t last = (ssize_t)_cellSizes.size() - 1;
+    while (first < last)
+    {
+        ssize_t mid = (first + last + 1) / 2;
+        if (getCellOffset(mid) <= offset)
+        {
+            first = mid;
+        }
+        else
+        {
+            last = mid - 1;
+        }
+    }
+    return first;
+}
+
+void ListView::updateCellOffsets(ssize_t fromIndex)
+{
+    ssize_t count = _cellSizes.size();
+    _cellOffsets.resize(count + 1);
+    _cellOffsets[0] = 0.0f;
+    for (ssize_t i = fromIndex; i < count; ++i)
+    {
+        _cellOffsets[i + 1] = _cellOffsets[i] + _cellSizes[i];
+    }
+}
+
+void ListView::updateBoundCells()
+{
+    ssize_t count = _cellSizes.size();
+    ssize_t first = 0;
+    ssize_t last = -1;
+    if (count > 0)
+    {
+        // the view in offsets from the start of the inner container
+        float viewStart, viewEnd;
+        if (_direction == Direction::HORIZONTAL)
+        {
+            viewStart = -_innerContainer->getLeftBoundary();
+            viewEnd = viewStart + _contentSize.width;
+        }
+        else
+        {
+            viewEnd = _innerContainer->getTopBoundary();
+            viewStart = viewEnd - _contentSize.height;
+        }
+        viewStart -= _virtualizationMargin;
+        viewEnd += _virtualizationMargin;
+
+        first = findCellAtOffset(viewStart);
+        if (getCellOffset(first) + _cellSizes[first] <= viewStart)
+        {
+            ++first;
+        }
+        last = findCellAtOffset(viewEnd);
+        if (getCellOffset(last) >= viewEnd)
+        {
+            --last;
+        }
+    }
+
+    ssize_t oldFirst = _firstBoundIndex;
+    ssize_t oldLast = _firstBoundIndex + _boundCells.size() - 1;
+    for (ssize_t i = 0; i < _boundCells.size(); ++i)
+    {
+        ssize_t index = oldFirst + i;
+        if (index < first || index > last)
+        {
+            recycleCell(_boundCells.at(i), _boundCellTypes[i], index);
+        }
+    }
+
+    Vector<Widget*> cells(MAX(last - first + 1, 0));
+    std::vector<int> cellTypes;
+    cellTypes.reserve(cells.capacity());
+    for (ssize_t index = first; index <= last; ++index)
+    {
+        Widget* cell = nullptr;
+        int cellType = 0;
+        if (index >= oldFirst && index <= oldLast)
+        {
+            cell = _boundCells.at(index - oldFirst);
+            cellType = _boundCellTypes[index - oldFirst];
+        }
+        else
+        {
+            cellType = _adapter->getCellType(index);
+            cell = dequeueCell(cellType);
+            _adapter->bindCell(cell, index);
+        }
+        placeCell(cell, index);
+        cells.pushBack(cell);
+        cellTypes.push_back(cellType);
+    }
+    _boundCells = std::move(cells);
+    _boundCellTypes.swap(cellTypes);
+    _firstBoundIndex = first;
+}
+
+void ListView::placeCell(Widget* cell, ssize_t index)
+{
+    const Size& innerSize = _innerContainer->getContentSize();
+    const Size& cellSize = cell->getContentSize();
+    const Vec2& anchorPoint = cell->getAnchorPoint();
+    float start = getCellOffset(index);
+    float length = _cellSizes[index];
+
+    Vec2 position;
+    if (_direction == Direction::HORIZONTAL)
+    {
+        position.x = start + anchorPoint.x * length;
+        switch (_gravity)
+        {
+            case Gravity::BOTTOM:
+                position.y = _bottomPadding + anchorPoint.y * cellSize.height;
+                break;
+            case Gravity::CENTER_VERTICAL:
+                position.y = innerSize.height / 2 + (anchorPoint.y - 0.5f) * cellSize.height;
+                break;
+            default:
+                position.y = innerSize.height - _topPadding - (1.0f - anchorPoint.y) * cellSize.height;
+                break;
+        }
+    }
+    else
+    {
+        position.y = innerSize.height - start - (1.0f - anchorPoint.y) * length;
+        switch (_gravity)
+        {
+            case Gravity::RIGHT:
+                position.x = innerSize.width - _rightPadding - (1.0f - anchorPoint.x) * cellSize.width;
+                break;
+            case Gravity::CENTER_HORIZONTAL:
+                position.x = innerSize.width / 2 + (anchorPoint.x - 0.5f) * cellSize.width;
+                break;
+            default:
+                position.x = _leftPadding + anchorPoint.x * cellSize.width;
+                break;
+        }
+    }
+    cell->setPosition(position);
+}
+
+Widget* ListView::dequeueCell(int cellType)
+{
+    auto& pool = _cellPools[cellType];
+    if (!pool.empty())
+    {
+        // still retained by the inner container
+        Widget* cell = pool.back();
+        pool.popBack();
+        cell->setVisible(true);
+        return cell;
+    }
+    Widget* cell = _adapter->createCell(cellType);
+    CCASSERT(nullptr != cell, "ListViewAdapter::createCell must return a cell!");
+    ScrollView::addChild(cell);
+    return cell;
+}
+
+void ListView::recycleCell(Widget* cell, int cellType, ssize_t index)
+{
+    _adapter->unbindCell(cell, index);
+    // pooled cells stay in the inner container, hidden, so reusing one doesn't run onEnter/onExit
+    cell->setVisible(false);
+    _cellPools[cellType].pushBack(cell);
+}
+
+void ListView::recycleAllCells()
+{
+    for (ssize_t i = 0; i < _boundCells.size(); ++i)
+    {
+        recycleCell(_boundCells.at(i), _boundCellTypes[i], _firstBoundIndex + i);
+    }
+    _boundCells.clear();
+    _boundCellTypes.clear();
+    _firstBoundIndex = 0;
+}
+
+void ListView::removeAllCells()
+{
+    recycleAllCells();
+    for (auto& pool : _cellPools)
+    {
+        for (auto& cell : pool.second)
+        {
+            ScrollView::removeChild(cell, true);
+        }
+    }
+    _cellPools.clear();
+}
+
+void ListView::moveInnerContainer(const Vec2& deltaMove, bool canStartBounceBack)
+{
+    ScrollView::moveInnerContainer(deltaMove, canStartBounceBack);
+    if (_adapter && !_innerContainerDoLayoutDirty)
+    {
+        updateBoundCells();
+    }
 }
     
 void ListView::refreshView()
@@ -566,6 +940,10 @@ void ListView::refreshView()
 void ListView::requestDoLayout()
 {
     _innerContainerDoLayoutDirty = true;
+    if (_running)
+    {
+        LayoutScheduler::getInstance()->scheduleLayout(this);
+    }
 }
 
 void ListView::doLayout()
@@ -575,6 +953,15 @@ void ListView::doLayout()
         return;
     }
 
+    if (_adapter)
+    {
+        // only the cells in view are touched, the measurements are cached
+        updateInnerContainerSize();
+        updateBoundCells();
+        _innerContainerDoLayoutDirty = false;
+        return;
+    }
+
     ssize_t length = _items.size();
     for (int i = 0; i < length; ++i)
     {
@@ -852,16 +1239,49 @@ Vec2 ListView::calculateItemDestination(const Vec2& positionRatioInView, Widget*
     return -(itemPosition - positionInView);
 }
 
-void ListView::jumpToItem(ssize_t itemIndex, const Vec2& positionRatioInView, const Vec2& itemAnchorPoint)
+Vec2 ListView::calculateCellDestination(const Vec2& positionRatioInView, ssize_t index, const Vec2& itemAnchorPoint)
 {
-    Widget* item = getItem(itemIndex);
-    if (item == nullptr)
+    const Size& contentSize = getContentSize();
+    Vec2 positionInView(contentSize.width * positionRatioInView.x, contentSize.height * positionRatioInView.y);
+
+    // the cell may not exist, its place follows from the measurements
+    const Size& innerSize = _innerContainer->getContentSize();
+    float start = getCellOffset(index);
+    float length = _cellSizes[index];
+    Vec2 itemPosition;
+    if (_direction == Direction::HORIZONTAL)
     {
-        return;
+        itemPosition.set(start + length * itemAnchorPoint.x, innerSize.height * itemAnchorPoint.y);
     }
-    doLayout();
+    else
+    {
+        itemPosition.set(innerSize.width * itemAnchorPoint.x, innerSize.height - start - length * (1.0f - itemAnchorPoint.y));
+    }
+    return -(itemPosition - positionInView);
+}
 
-    Vec2 destination = calculateItemDestination(positionRatioInView, item, itemAnchorPoint);
+void ListView::jumpToItem(ssize_t itemIndex, const Vec2& positionRatioInView, const Vec2& itemAnchorPoint)
+{
+    Vec2 destination;
+    if (_adapter)
+    {
+        if (itemIndex < 0 || itemIndex >= (ssize_t)_cellSizes.size())
+        {
+            return;
+        }
+        doLayout();
+        destination = calculateCellDestination(positionRatioInView, itemIndex, itemAnchorPoint);
+    }
+    else
+    {
+        Widget* item = getItem(itemIndex);
+        if (item == nullptr)
+        {
+            return;
+        }
+        doLayout();
+        destination = calculateItemDestination(positionRatioInView, item, itemAnchorPoint);
+    }
     if(!_bounceEnabled)
     {
         Vec2 delta = destination - getInnerContainerPosition();
@@ -878,6 +1298,16 @@ void ListView::scrollToItem(ssize_t itemIndex, const Vec2& positionRatioInView,
 
 void ListView::scrollToItem(ssize_t itemIndex, const Vec2& positionRatioInView, const Vec2& itemAnchorPoint, float timeInSec)
 {
+    if (_adapter)
+    {
+        if (itemIndex < 0 || itemIndex >= (ssize_t)_cellSizes.size())
+        {
+            return;
+        }
+        doLayout();
+        startAutoScrollToDestination(calculateCellDestination(positionRatioInView, itemIndex, itemAnchorPoint), timeInSec, true);
+        return;
+    }
     Widget* item = getItem(itemIndex);
     if (item == nullptr)
     {
@@ -27,6 +27,8 @@ THE SOFTWARE.
 #ifndef __UILISTVIEW_H__
 #define __UILISTVIEW_H__
 
+#include <unordered_map>
+#include <vector>
 #include "ui/UIScrollView.h"
 #include "ui/GUIExport.h"
 
@@ -54,10 +56,64 @@ typedef enum
 typedef void (Ref::*SEL_ListViewEvent)(Ref*,ListViewEventType);
 #define listvieweventselector(_SELECTOR) (SEL_ListViewEvent)(&_SELECTOR)
 
+/**
+ * @brief Data source of a virtualized ListView.
+ *
+ * The ListView asks the adapter for the size of every item once and keeps the measurements,
+ * then only creates and binds the cells that are in view. Cells that scroll out are handed back
+ * to a pool of their cell type and bound again to other items.
+ * @see `ListView::setAdapter`
+ * @since v3.18
+ */
+class CC_GUI_DLL ListViewAdapter
+{
+public:
+    virtual ~ListViewAdapter() {}
+
+    /**
+     * Number of items in the list.
+     */
+    virtual ssize_t getItemCount() const = 0;
+
+    /**
+     * Type of the cell showing an item. Cells are only reused for items of the same type.
+     * @param index The item index.
+     */
+    virtual int getCellType(ssize_t index) const { return 0; }
+
+    /**
+     * Size of an item along the scroll direction: its height in a vertical list, its width in a horizontal one.
+     * The result is cached until `ListView::reloadData` or `ListView::notifyItemChanged` is called.
+     * @param index The item index.
+     */
+    virtual float measureItem(ssize_t index) const = 0;
+
+    /**
+     * Creates a new cell when the pool has none of this type left.
+     * @param cellType A type returned by `getCellType`.
+     * @return An autoreleased widget.
+     */
+    virtual Widget* createCell(int cellType) = 0;
+
+    /**
+     * Fills a cell with the content of an item before it is shown.
+     * @param cell A cell created for the item's type, possibly showing another item before.
+     * @param index The item index.
+     */
+    virtual void bindCell(Widget* cell, ssize_t index) = 0;
+
+    /**
+     * Called when a cell scrolls out of view and goes back to the pool.
+     * @param cell The cell.
+     * @param index The item it was showing.
+     */
+    virtual void unbindCell(Widget* cell, ssize_t index) {}
+};
+
 /**
  *@brief ListView is a view group that displays a list of scrollable items.
  *The list items are inserted to the list by using `addChild` or  `insertDefaultItem`.
- * @warning The list item in ListView doesn't support cell reuse at the moment, if you have a large amount of data need to be displayed, use  `TableView` instead.
+ * With an adapter set by `setAdapter`, the ListView is virtualized: items come from the adapter, only the cells in view exist and they are reused while scrolling, so large lists cost as much as the visible part.
  * ListView is a subclass of  `ScrollView`, so it shares many features of ScrollView.
  */
 class CC_GUI_DLL ListView : public ScrollView
@@ -316,6 +372,57 @@ public:
      * @see setScrollDuration(float)
      */
     float getScrollDuration() const;
+
+    /**
+     * @brief Makes the ListView virtualized, items then come from the adapter instead of the children.
+     *
+     * Items added with `pushBackCustomItem` and the like are removed. Magnetic scrolling isn't supported
+     * in this mode. The adapter isn't retained and has to outlive the ListView or be reset to nullptr.
+     * @param adapter The data source, nullptr leaves the virtualized mode.
+     * @since v3.18
+     */
+    void setAdapter(ListViewAdapter* adapter);
+    ListViewAdapter* getAdapter() const { return _adapter; }
+
+    /**
+     * @brief Measures all items again and rebinds the cells in view, after items were added, removed or changed.
+     * @since v3.18
+     */
+    void reloadData();
+
+    /**
+     * @brief Measures one item again and rebinds its cell if it is in view.
+     * @param index The item index.
+     * @since v3.18
+     */
+    void notifyItemChanged(ssize_t index);
+
+    /**
+     * @brief Sets how far beyond the view cells are kept bound, in points along the scroll direction.
+     * A margin lets the next cells be ready before they scroll in. The default is 0.
+     * @since v3.18
+     */
+    void setVirtualizationMargin(float margin);
+    float getVirtualizationMargin() const { return _virtualizationMargin; }
+
+    /**
+     * @brief Returns the cell showing an item in a virtualized ListView.
+     * @return The cell, or nullptr if the item isn't in view.
+     * @since v3.18
+     */
+    Widget* getCell(ssize_t index) const;
+
+    /**
+     * @brief Number of cells bound to items in a virtualized ListView.
+     * @since v3.18
+     */
+    ssize_t getBoundCellCount() const { return _boundCells.size(); }
+
+    /**
+     * @brief Number of cells waiting in the pools of a virtualized ListView.
+     * @since v3.18
+     */
+    ssize_t getPooledCellCount() const;
     
     //override methods
     virtual void doLayout() override;
@@ -487,6 +594,20 @@ protected:
     
     void startMagneticScroll();
     Vec2 calculateItemDestination(const Vec2& positionRatioInView, Widget* item, const Vec2& itemAnchorPoint);
+
+    virtual void moveInnerContainer(const Vec2& deltaMove, bool canStartBounceBack) override;
+
+    // virtualized mode
+    float getCellOffset(ssize_t index) const;
+    ssize_t findCellAtOffset(float offset) const;
+    void updateCellOffsets(ssize_t fromIndex);
+    void updateBoundCells();
+    void placeCell(Widget* cell, ssize_t index);
+    Widget* dequeueCell(int cellType);
+    void recycleCell(Widget* cell, int cellType, ssize_t index);
+    void recycleAllCells();
+    void removeAllCells();
+    Vec2 calculateCellDestination(const Vec2& positionRatioInView, ssize_t index, const Vec2& itemAnchorPoint);
     
 protected:
     Widget* _model;
@@ -525,6 +646,17 @@ protected:
 #pragma warning (pop)
 #endif
     ccListViewCallback _eventCallback;
+
+    ListViewAdapter* _adapter;
+    float _virtualizationMargin;
+    // measured item sizes along the scroll direction and their running sums, without margins and padding
+    std::vector<float> _cellSizes;
+    std::vector<float> _cellOffsets;
+    // cells bound to the items [_firstBoundIndex, _firstBoundIndex + _boundCells.size())
+    Vector<Widget*> _boundCells;
+    std::vector<int> _boundCellTypes;
+    ssize_t _firstBoundIndex;
+    std::unordered_map<int, Vector<Widget*>> _cellPools;
 };
 
 }
@@ -96,6 +96,11 @@ public:
         _handleOpenUrl = handleOpenUrl;
     }
 
+    void setUrl(const std::string& url)
+    {
+        _url = url;
+    }
+
 private:
     Node* _parent;      // weak ref.
     std::string _url;
@@ -884,6 +889,9 @@ const std::string RichText::KEY_ANCHOR_TEXT_GLOW_COLOR("KEY_ANCHOR_TEXT_GLOW_COL
 RichText::RichText()
     : _formatTextDirty(true)
     , _leftSpaceWidth(0.0f)
+    , _firstDirtyElement(0)
+    , _firstDirtyRow(0)
+    , _formattedWidth(-1.0f)
 {
     _defaults[KEY_VERTICAL_SPACE] = 0.0f;
     _defaults[KEY_WRAP_MODE] = static_cast<int>(WrapMode::WRAP_PER_WORD);
@@ -973,24 +981,40 @@ void RichText::initRenderer()
 void RichText::insertElement(RichElement *element, int index)
 {
     _richElements.insert(index, element);
-    _formatTextDirty = true;
+    setElementsDirty(index);
 }
     
 void RichText::pushBackElement(RichElement *element)
 {
     _richElements.pushBack(element);
-    _formatTextDirty = true;
+    setElementsDirty(_richElements.size() - 1);
 }
     
 void RichText::removeElement(int index)
 {
     _richElements.erase(index);
-    _formatTextDirty = true;
+    setElementsDirty(index);
 }
     
 void RichText::removeElement(RichElement *element)
 {
-    _richElements.eraseObject(element);
+    auto index = _richElements.getIndex(element);
+    if (index >= 0)
+    {
+        _richElements.erase(index);
+        setElementsDirty(index);
+    }
+}
+
+void RichText::removeAllElements()
+{
+    _richElements.clear();
+    setElementsDirty(0);
+}
+
+void RichText::setElementsDirty(size_t index)
+{
+    _firstDirtyElement = std::min(_firstDirtyElement, index);
     _formatTextDirty = true;
 }
 
@@ -1004,7 +1028,7 @@ void RichText::setWrapMode(RichText::WrapMode wrapMode)
     if (static_cast<RichText::WrapMode>(_defaults.at(KEY_WRAP_MODE).asInt()) != wrapMode)
     {
         _defaults[KEY_WRAP_MODE] = static_cast<int>(wrapMode);
-        _formatTextDirty = true;
+        setElementsDirty(0);
     }
 }
 
@@ -1018,7 +1042,7 @@ void RichText::setHorizontalAlignment(cocos2d::ui::RichText::HorizontalAlignment
 	if (static_cast<RichText::HorizontalAlignment>(_defaults.at(KEY_HORIZONTAL_ALIGNMENT).asInt()) != a)
 	{
 		_defaults[KEY_HORIZONTAL_ALIGNMENT] = static_cast<int>(a);
-		_formatTextDirty = true;
+		setElementsDirty(0);
 	}
 }
 
@@ -1224,9 +1248,11 @@ void RichText::setDefaults(const ValueMap& defaults)
     }
     if (defaults.find(KEY_WRAP_MODE) != defaults.end()) {
         _defaults[KEY_WRAP_MODE] = defaults.at(KEY_WRAP_MODE).asInt();
+        setElementsDirty(0);
     }
 	if (defaults.find(KEY_HORIZONTAL_ALIGNMENT) != defaults.end()) {
 		_defaults[KEY_HORIZONTAL_ALIGNMENT] = defaults.at(KEY_HORIZONTAL_ALIGNMENT).asInt();
+		setElementsDirty(0);
 	}
     if (defaults.find(KEY_FONT_COLOR_STRING) != defaults.end()) {
         _defaults[KEY_FONT_COLOR_STRING] = defaults.at(KEY_FONT_COLOR_STRING).asString();
@@ -1354,13 +1380,20 @@ void RichText::formatText()
 {
     if (_formatTextDirty)
     {
-        this->removeAllProtectedChildren();
-        _elementRenders.clear();
-        _lineHeights.clear();
+        // the lines are wrapped at the width, a new one lays out all elements again
+        if (!_ignoreSize && _customSize.width != _formattedWidth)
+        {
+            _firstDirtyElement = 0;
+        }
+        _formattedWidth = _customSize.width;
+
+        // keep the lines of the elements before the first changed one
+        const size_t firstElement = std::min(_firstDirtyElement, _elementLayouts.size());
+        recycleRenderers(firstElement);
+
         if (_ignoreSize)
         {
-            addNewLine();
-            for (ssize_t i=0, size = _richElements.size(); i<size; ++i)
+            for (ssize_t i=firstElement, size = _richElements.size(); i<size; ++i)
             {
                 RichElement* element = _richElements.at(i);
                 Node* elementRenderer = nullptr;
@@ -1369,39 +1402,13 @@ void RichText::formatText()
                     case RichElement::Type::TEXT:
                     {
                         RichElementText* elmtText = static_cast<RichElementText*>(element);
-                        Label* label;
-                        if (FileUtils::getInstance()->isFileExist(elmtText->_fontName))
-                        {
-                             label = Label::createWithTTF(elmtText->_text, elmtText->_fontName, elmtText->_fontSize);
-                        }
-                        else
-                        {
-                            label = Label::createWithSystemFont(elmtText->_text, elmtText->_fontName, elmtText->_fontSize);
-                        }
-                        if (elmtText->_flags & RichElementText::ITALICS_FLAG)
-                            label->enableItalics();
-                        if (elmtText->_flags & RichElementText::BOLD_FLAG)
-                            label->enableBold();
-                        if (elmtText->_flags & RichElementText::UNDERLINE_FLAG)
-                            label->enableUnderline();
-                        if (elmtText->_flags & RichElementText::STRIKETHROUGH_FLAG)
-                            label->enableStrikethrough();
-                        if (elmtText->_flags & RichElementText::URL_FLAG)
-                            label->addComponent(ListenerComponent::create(label, elmtText->_url,
-                                                                          std::bind(&RichText::openUrl, this, std::placeholders::_1)));
-                        if (elmtText->_flags & RichElementText::OUTLINE_FLAG) {
-                            label->enableOutline(Color4B(elmtText->_outlineColor), elmtText->_outlineSize);
-                        }
-                        if (elmtText->_flags & RichElementText::SHADOW_FLAG) {
-                            label->enableShadow(Color4B(elmtText->_shadowColor),
-                                                elmtText->_shadowOffset,
-                                                elmtText->_shadowBlurRadius);
-                        }
-                        if (elmtText->_flags & RichElementText::GLOW_FLAG) {
-                            label->enableGlow(Color4B(elmtText->_glowColor));
-                        }
-                        label->setTextColor(Color4B(elmtText->_color));
-                        elementRenderer = label;
+                        elementRenderer = createTextRenderer(elmtText->_text, elmtText->_fontName,
+                                                             FileUtils::getInstance()->isFileExist(elmtText->_fontName),
+                                                             elmtText->_fontSize, elmtText->_color, elmtText->_opacity,
+                                                             elmtText->_flags, elmtText->_url,
+                                                             elmtText->_outlineColor, elmtText->_outlineSize,
+                                                             elmtText->_shadowColor, elmtText->_shadowOffset, elmtText->_shadowBlurRadius,
+                                                             elmtText->_glowColor);
                         break;
                     }
                     case RichElement::Type::IMAGE:
@@ -1449,12 +1456,12 @@ void RichText::formatText()
                     elementRenderer->setOpacity(element->_opacity);
                     pushToContainer(elementRenderer);
                 }
+                _elementLayouts.push_back({ _elementRenders.size() - 1, static_cast<size_t>(_elementRenders.back().size()), _leftSpaceWidth });
             }
         }
         else
         {
-            addNewLine();
-            for (ssize_t i=0, size = _richElements.size(); i<size; ++i)
+            for (ssize_t i=firstElement, size = _richElements.size(); i<size; ++i)
             {
                 RichElement* element = static_cast<RichElement*>(_richElements.at(i));
                 switch (element->_type)
@@ -1489,13 +1496,143 @@ void RichText::formatText()
                     default:
                         break;
                 }
+                _elementLayouts.push_back({ _elementRenders.size() - 1, static_cast<size_t>(_elementRenders.back().size()), _leftSpaceWidth });
             }
         }
         formatRenderers();
+
+        // labels of the old lines that weren't reused
+        for (auto& pool : _textRendererPool)
+        {
+            for (auto& label : pool.second)
+                _textRendererStyles.erase(label);
+        }
+        _textRendererPool.clear();
+
+        _firstDirtyElement = _richElements.size();
         _formatTextDirty = false;
     }
 }
 
+void RichText::recycleRenderers(size_t index)
+{
+    if (index == 0)
+    {
+        for (auto& row : _elementRenders)
+        {
+            for (auto& renderer : row)
+                recycleRenderer(renderer);
+        }
+        _elementRenders.clear();
+        _lineHeights.clear();
+        _elementLayouts.clear();
+        _firstDirtyRow = 0;
+        addNewLine();
+        return;
+    }
+
+    const ElementLayout layout = _elementLayouts[index - 1];
+    for (size_t i = layout.row + 1, size = _elementRenders.size(); i < size; ++i)
+    {
+        for (auto& renderer : _elementRenders[i])
+            recycleRenderer(renderer);
+    }
+    _elementRenders.resize(layout.row + 1);
+    _lineHeights.resize(layout.row + 1);
+
+    auto& row = _elementRenders.back();
+    for (ssize_t i = layout.rendererCount, size = row.size(); i < size; ++i)
+        recycleRenderer(row.at(i));
+    row.erase(row.begin() + layout.rendererCount, row.end());
+
+    // the line may continue, so its last label gets back the whitespace the alignment trimmed
+    if (!row.empty())
+    {
+        auto trimmed = _trimmedTexts.find(row.back());
+        if (trimmed != _trimmedTexts.end())
+        {
+            static_cast<Label*>(row.back())->setString(trimmed->second);
+            _trimmedTexts.erase(trimmed);
+        }
+    }
+
+    _elementLayouts.resize(index);
+    _leftSpaceWidth = layout.leftSpaceWidth;
+    _firstDirtyRow = layout.row;
+}
+
+void RichText::recycleRenderer(Node* renderer)
+{
+    auto style = _textRendererStyles.find(renderer);
+    if (style != _textRendererStyles.end())
+    {
+        _textRendererPool[style->second].pushBack(static_cast<Label*>(renderer));
+    }
+    _trimmedTexts.erase(renderer);
+    removeProtectedChild(renderer);
+}
+
+Label* RichText::createTextRenderer(const std::string& text, const std::string& fontName, bool fileExist, float fontSize, const Color3B& color,
+                                    GLubyte opacity, uint32_t flags, const std::string& url,
+                                    const Color3B& outlineColor, int outlineSize,
+                                    const Color3B& shadowColor, const Size& shadowOffset, int shadowBlurRadius,
+                                    const Color3B& glowColor)
+{
+    // everything that can't be changed on a label once it's created
+    std::string style = StringUtils::format("%d %g %u %d,%d,%d %d %d,%d,%d %g,%g %d %d,%d,%d ",
+                                            fileExist, fontSize, flags,
+                                            outlineColor.r, outlineColor.g, outlineColor.b, outlineSize,
+                                            shadowColor.r, shadowColor.g, shadowColor.b, shadowOffset.width, shadowOffset.height, shadowBlurRadius,
+                                            glowColor.r, glowColor.g, glowColor.b);
+    style += fontName;
+
+    Label* label = nullptr;
+    auto pool = _textRendererPool.find(style);
+    if (pool != _textRendererPool.end() && !pool->second.empty())
+    {
+        label = pool->second.back();
+        label->retain();
+        pool->second.popBack();
+        label->autorelease();
+
+        label->setString(text);
+        if (flags & RichElementText::URL_FLAG)
+            static_cast<ListenerComponent*>(label->getComponent(ListenerComponent::COMPONENT_NAME))->setUrl(url);
+    }
+    else
+    {
+        label = fileExist ? Label::createWithTTF(text, fontName, fontSize)
+            : Label::createWithSystemFont(text, fontName, fontSize);
+
+        if (flags & RichElementText::ITALICS_FLAG)
+            label->enableItalics();
+        if (flags & RichElementText::BOLD_FLAG)
+            label->enableBold();
+        if (flags & RichElementText::UNDERLINE_FLAG)
+            label->enableUnderline();
+        if (flags & RichElementText::STRIKETHROUGH_FLAG)
+            label->enableStrikethrough();
+        if (flags & RichElementText::URL_FLAG)
+            label->addComponent(ListenerComponent::create(label,
+                                                          url,
+                                                          std::bind(&RichText::openUrl, this, std::placeholders::_1)));
+        if (flags & RichElementText::OUTLINE_FLAG)
+            label->enableOutline(Color4B(outlineColor), outlineSize);
+        if (flags & RichElementText::SHADOW_FLAG)
+            label->enableShadow(Color4B(shadowColor), shadowOffset, shadowBlurRadius);
+        if (flags & RichElementText::GLOW_FLAG)
+            label->enableGlow(Color4B(glowColor));
+
+        _textRendererStyles[label] = style;
+    }
+
+    label->setTextColor(Color4B(color));
+    label->setOpacity(opacity);
+    return label;
+}
+
+
+
 namespace {
     inline bool isUTF8CharWrappable(const StringUtils::StringUTF8::CharUTF8& ch)
     {
@@ -1672,30 +1809,9 @@ void RichText::handleTextRenderer(const std::string& text, const std::string& fo
             }
             ++splitParts;
 
-            Label* textRenderer = fileExist ? Label::createWithTTF(currentText, fontName, fontSize)
-                : Label::createWithSystemFont(currentText, fontName, fontSize);
-
-            if (flags & RichElementText::ITALICS_FLAG)
-                textRenderer->enableItalics();
-            if (flags & RichElementText::BOLD_FLAG)
-                textRenderer->enableBold();
-            if (flags & RichElementText::UNDERLINE_FLAG)
-                textRenderer->enableUnderline();
-            if (flags & RichElementText::STRIKETHROUGH_FLAG)
-                textRenderer->enableStrikethrough();
-            if (flags & RichElementText::URL_FLAG)
-                textRenderer->addComponent(ListenerComponent::create(textRenderer,
-                                                                     url,
-                                                                     std::bind(&RichText::openUrl, this, std::placeholders::_1)));
-            if (flags & RichElementText::OUTLINE_FLAG)
-                textRenderer->enableOutline(Color4B(outlineColor), outlineSize);
-            if (flags & RichElementText::SHADOW_FLAG)
-                textRenderer->enableShadow(Color4B(shadowColor), shadowOffset, shadowBlurRadius);
-            if (flags & RichElementText::GLOW_FLAG)
-                textRenderer->enableGlow(Color4B(glowColor));
-
-            textRenderer->setTextColor(Color4B(color));
-            textRenderer->setOpacity(opacity);
+            Label* textRenderer = createTextRenderer(currentText, fontName, fileExist, fontSize, color, opacity, flags, url,
+                                                     outlineColor, outlineSize, shadowColor, shadowOffset, shadowBlurRadius,
+                                                     glowColor);
 
             // textRendererWidth will get 0.0f, when we've got glError: 0x0501 in Label::getContentSize
             // It happens when currentText is very very long so that can't generate a texture
@@ -1730,6 +1846,10 @@ void RichText::handleTextRenderer(const std::string& text, const std::string& fo
                 textRenderer->setString(utf8Text.getAsCharSequence(0, leftLength));
                 pushToContainer(textRenderer);
             }
+            else
+            {
+                recycleRenderer(textRenderer);
+            }
 
             StringUtils::StringUTF8::CharUTF8Store& str = utf8Text.getString();
 
@@ -1807,7 +1927,8 @@ void RichText::formatRenderers()
             {
                 iter->setAnchorPoint(Vec2::ZERO);
                 iter->setPosition(nextPosX, nextPosY);
-                this->addProtectedChild(iter, 1);
+                if (iter->getParent() == nullptr)
+                    this->addProtectedChild(iter, 1);
                 Size iSize = iter->getContentSize();
                 newContentSizeWidth += iSize.width;
                 nextPosX += iSize.width;
@@ -1822,28 +1943,31 @@ void RichText::formatRenderers()
     }
     else
     {
-        // calculate real height
+        // calculate real height, the lines before the first changed one keep their height
         float newContentSizeHeight = 0.0f;
-        std::vector<float> maxHeights(_elementRenders.size());
+        _rowHeights.resize(_elementRenders.size());
         
         for (size_t i=0, size = _elementRenders.size(); i<size; i++)
         {
-            Vector<Node*>& row = _elementRenders[i];
-            float maxHeight = 0.0f;
-            for (auto& iter : row)
+            if (i >= _firstDirtyRow)
             {
-                maxHeight = std::max(iter->getContentSize().height, maxHeight);
-            }
+                Vector<Node*>& row = _elementRenders[i];
+                float maxHeight = 0.0f;
+                for (auto& iter : row)
+                {
+                    maxHeight = std::max(iter->getContentSize().height, maxHeight);
+                }
 
-            // gap for empty line, if _lineHeights[i] == 0, use current RichText's fontSize
-            if (row.empty())
-            {
-                maxHeight = (_lineHeights[i] != 0.0f ? _lineHeights[i] : fontSize);
+                // gap for empty line, if _lineHeights[i] == 0, use current RichText's fontSize
+                if (row.empty())
+                {
+                    maxHeight = (_lineHeights[i] != 0.0f ? _lineHeights[i] : fontSize);
+                }
+                _rowHeights[i] = maxHeight;
             }
-            maxHeights[i] = maxHeight;
 
             // vertical space except for first line
-            newContentSizeHeight += (i != 0 ? maxHeight + verticalSpace : maxHeight);
+            newContentSizeHeight += (i != 0 ? _rowHeights[i] + verticalSpace : _rowHeights[i]);
         }
         _customSize.height = newContentSizeHeight;
 
@@ -1853,12 +1977,23 @@ void RichText::formatRenderers()
         {
             Vector<Node*>& row = _elementRenders[i];
             float nextPosX = 0.0f;
-            nextPosY -= (i != 0 ? maxHeights[i] + verticalSpace : maxHeights[i]);
+            nextPosY -= (i != 0 ? _rowHeights[i] + verticalSpace : _rowHeights[i]);
+            if (i < _firstDirtyRow)
+            {
+                // already aligned, only the height of the text can move the line
+                for (auto& iter : row)
+                {
+                    iter->setPositionY(nextPosY);
+                }
+                continue;
+            }
+
             for (auto& iter : row)
             {
                 iter->setAnchorPoint(Vec2::ZERO);
                 iter->setPosition(nextPosX, nextPosY);
-                this->addProtectedChild(iter, 1);
+                if (iter->getParent() == nullptr)
+                    this->addProtectedChild(iter, 1);
                 nextPosX += iter->getContentSize().width;
             }
             
@@ -1866,9 +2001,6 @@ void RichText::formatRenderers()
         }
     }
     
-    _elementRenders.clear();
-    _lineHeights.clear();
-    
     if (_ignoreSize)
     {
         Size s = getVirtualRendererSize();
@@ -1927,6 +2059,7 @@ float RichText::stripTrailingWhitespace(const Vector<cocos2d::Node*>& row) {
             const auto width = label->getContentSize().width;
             const auto trimmedString = rtrim(label->getString());
             if ( label->getString() != trimmedString ) {
+                _trimmedTexts.emplace(label, label->getString());
                 label->setString(trimmedString);
                 return label->getContentSize().width - width;
             }
@@ -1958,7 +2091,7 @@ void RichText::ignoreContentAdaptWithSize(bool ignore)
 {
     if (_ignoreSize != ignore)
     {
-        _formatTextDirty = true;
+        setElementsDirty(0);
         Widget::ignoreContentAdaptWithSize(ignore);
     }
 }
@@ -26,6 +26,7 @@
 #ifndef __UIRICHTEXT_H__
 #define __UIRICHTEXT_H__
 
+#include <unordered_map>
 #include "ui/UIWidget.h"
 #include "ui/GUIExport.h"
 #include "base/CCValue.h"
@@ -341,6 +342,12 @@ protected:
 /**
  *@brief A container for displaying various RichElements.
  * We could use it to display texts with images easily.
+ *
+ * Formatting is incremental: the lines laid out by the previous formatText() are kept and
+ * only the elements from the first inserted or removed one onwards are laid out again, so
+ * appending to a long text costs as much as laying out the appended elements. Labels of the
+ * elements laid out again are reused for text of the same style. Changing the wrap mode,
+ * the alignment or the width lays out all elements again.
  */
 class CC_GUI_DLL RichText : public Widget
 {
@@ -466,6 +473,12 @@ public:
      * @param element A RichElement type.
      */
     void removeElement(RichElement* element);
+
+    /**
+     * @brief Remove all RichElements.
+     * @since v3.18
+     */
+    void removeAllElements();
     
     /**
      * @brief Set vertical space between each RichElement.
@@ -571,6 +584,24 @@ protected:
     void addNewLine();
 	void doHorizontalAlignment(const Vector<Node*>& row, float rowWidth);
 	float stripTrailingWhitespace(const Vector<Node*>& row);
+    /** Marks the elements from index onwards to be laid out again. */
+    void setElementsDirty(size_t index);
+    /** Removes the renderers laid out by the elements from index onwards, keeping their labels for reuse. */
+    void recycleRenderers(size_t index);
+    void recycleRenderer(Node* renderer);
+    Label* createTextRenderer(const std::string& text, const std::string& fontName, bool fileExist, float fontSize, const Color3B& color,
+                              GLubyte opacity, uint32_t flags, const std::string& url,
+                              const Color3B& outlineColor, int outlineSize,
+                              const Color3B& shadowColor, const Size& shadowOffset, int shadowBlurRadius,
+                              const Color3B& glowColor);
+
+    /** Where an element left the layout: its last line, the renderers in that line and the width left. */
+    struct ElementLayout
+    {
+        size_t row;
+        size_t rendererCount;
+        float leftSpaceWidth;
+    };
 
     bool _formatTextDirty;
     Vector<RichElement*> _richElements;
@@ -578,6 +609,15 @@ protected:
     std::vector<float> _lineHeights;
     float _leftSpaceWidth;
 
+    std::vector<ElementLayout> _elementLayouts;     /*!< one per element laid out by the last formatText() */
+    size_t _firstDirtyElement;                      /*!< first element to lay out again */
+    size_t _firstDirtyRow;                          /*!< first line whose renderers changed */
+    float _formattedWidth;                          /*!< the width the lines are wrapped at */
+    std::vector<float> _rowHeights;                 /*!< height of every line */
+    std::unordered_map<Node*, std::string> _textRendererStyles;     /*!< style of every label, the key of its pool */
+    std::unordered_map<std::string, Vector<Label*>> _textRendererPool; /*!< labels recycled during formatText() */
+    std::unordered_map<Node*, std::string> _trimmedTexts;          /*!< labels the alignment trimmed, with their whole text */
+
     ValueMap _defaults;             /*!< default values */
     OpenUrlHandler _handleOpenUrl;  /*!< the callback for open URL */
 };
@@ -337,6 +337,7 @@ void Scale9Sprite::setState(Scale9Sprite::State state)
                 break;
             case State::GRAY:
                 glState = GLProgramState::getOrCreateWithGLProgramName(GLProgram::SHADER_NAME_POSITION_GRAYSCALE, getTexture());
+                break;
             default:
                 break;
         }
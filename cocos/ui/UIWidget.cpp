@@ -333,6 +333,13 @@ void Widget::setContentSize(const cocos2d::Size &contentSize)
         _sizePercent.set(spx, spy);
     }
     onSizeChanged();
+
+    // the parent places its children by their size
+    Layout* parentLayout = dynamic_cast<Layout*>(_parent);
+    if (parentLayout && parentLayout->getLayoutType() != Layout::Type::ABSOLUTE)
+    {
+        parentLayout->requestDoLayout();
+    }
 }
 
 void Widget::setSize(const Size &size)
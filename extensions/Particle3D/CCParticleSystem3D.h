@@ -31,6 +31,9 @@
 #include <vector>
 #include <map>
 #include <list>
+#include <deque>
+#include <algorithm>
+#include <functional>
 
 NS_CC_BEGIN
 
@@ -59,89 +62,172 @@ struct CC_DLL Particle3D
     std::unordered_map<std::string, void*> userDefs;
 };
 
+/**
+ * Pool of preallocated data. Active data is kept in a contiguous array in activation order so that it can be
+ * walked by index and handed out in spans; free data is recycled first in, first out.
+ */
 template<typename T>
 class CC_DLL DataPool
 {
 public:
-    typedef typename std::list<T*> PoolList;
-    typedef typename std::list<T*>::iterator PoolIterator;
+    typedef typename std::vector<T*> PoolList;
+    typedef typename std::vector<T*>::iterator PoolIterator;
+    typedef typename std::deque<T*> FreeList;
 
-    DataPool(){};
+    DataPool() : _releasedIndex(0), _lockedSlots(0), _iterating(false) {};
     ~DataPool(){};
 
     T* createData(){
         if (_locked.empty()) return nullptr;
         T* p = _locked.front();
-        //_released.push_back(p);
-        //_locked.erase(_locked.begin());
-        _released.splice(_released.end(), _locked, _locked.begin());
+        _locked.pop_front();
+        _released.push_back(p);
         return p;
     }
 
+    /**
+     * Locks the data returned by the last getFirst()/getNext(). The slot is only cleared here, the active list is
+     * compacted when the iteration reaches its end.
+     */
     void lockLatestData(){
-        _locked.push_back(*_releasedIter);
-        _releasedIter = _released.erase(_releasedIter);
-        if (_releasedIter != _released.begin() && _releasedIter != _released.end())
-        {
-            --_releasedIter;
-        }
+        lockActiveData(_releasedIndex);
     }
 
     void lockData(T *data){
-        PoolIterator tempIter = _releasedIter;
-        T *ptr = getFirst();
-        while (ptr)
-        {
-            if (ptr == data) break;
-            ptr = getNext();
-        }
-        if (ptr)
-            lockLatestData();
-        _releasedIter = tempIter;
+        auto iter = std::find(_released.begin(), _released.end(), data);
+        if (iter == _released.end()) return;
+        lockActiveData(iter - _released.begin());
+        if (!_iterating)
+            compactActiveDatas();
     }
 
     void lockAllDatas(){
-        _locked.splice(_locked.end(), _released);
-        //_locked.insert(_locked.end(), _released.begin(), _released.end());
-        //_released.clear();
-        _releasedIter = _released.begin();
+        for (auto iter : _released){
+            if (iter) _locked.push_back(iter);
+        }
+        _released.clear();
+        _releasedIndex = 0;
+        _lockedSlots = 0;
+        _iterating = false;
     }
 
     T* getFirst(){
-        _releasedIter = _released.begin();
-        if (_releasedIter == _released.end()) return nullptr;
-        return *_releasedIter;
+        compactActiveDatas();
+        _releasedIndex = 0;
+        _iterating = true;
+        return seekActiveData();
     }
 
     T* getNext(){
-        if (_releasedIter == _released.end()) return nullptr;
-        ++_releasedIter;
-        if (_releasedIter == _released.end()) return nullptr;
-        return *_releasedIter;
+        if (_releasedIndex >= _released.size()) return nullptr;
+        ++_releasedIndex;
+        return seekActiveData();
+    }
+
+    /**
+     * Index based access for callers that process the active data in spans. Slots locked through
+     * lockActiveData() read as nullptr until compactActiveDatas() is called.
+     * @since v3.18
+     */
+    size_t getActiveDataSlots() const { return _released.size(); };
+    T* getActiveData(size_t index) const { return index < _released.size() ? _released[index] : nullptr; };
+    void lockActiveData(size_t index){
+        if (index >= _released.size() || !_released[index]) return;
+        _locked.push_back(_released[index]);
+        _released[index] = nullptr;
+        ++_lockedSlots;
+    }
+    void compactActiveDatas(){
+        if (!_lockedSlots) return;
+        _released.erase(std::remove(_released.begin(), _released.end(), nullptr), _released.end());
+        _lockedSlots = 0;
     }
 
     const PoolList& getActiveDataList() const { return _released; };
-    const PoolList& getUnActiveDataList() const { return _locked; };
+    const FreeList& getUnActiveDataList() const { return _locked; };
+
+    /** Number of active data, locked slots that are not compacted yet excluded. @since v3.18 */
+    size_t getActiveDataCount() const { return _released.size() - _lockedSlots; };
 
     void addData(T* data){
         _locked.push_back(data); 
     }
 
-    bool empty() const { return _released.empty(); };
+    /**
+     * Allocates count data of type U, a type derived from T, in one contiguous block owned by the pool and adds
+     * them as unactive data. They are freed by removeAllDatas(). Returns the block, nullptr if it can't be allocated.
+     * @since v3.18
+     */
+    template<typename U>
+    U* allocateDatas(size_t count){
+        if (!count) return nullptr;
+        U* block = new (std::nothrow) U[count];
+        if (!block) return nullptr;
+        const char* begin = reinterpret_cast<const char*>(block);
+        _blocks.push_back(Block{ begin, begin + count * sizeof(U), block, &deleteBlock<U> });
+        for (size_t i = 0; i < count; ++i){
+            _locked.push_back(block + i);
+        }
+        return block;
+    }
+
+    bool empty() const { return getActiveDataCount() == 0; };
 
     void removeAllDatas(){
         lockAllDatas();
         for (auto iter : _locked){
-            delete iter;
+            if (!isInBlock(iter))
+                delete iter;
         }
         _locked.clear();
+        for (auto &block : _blocks){
+            block.release(block.data);
+        }
+        _blocks.clear();
     }
 
 private:
 
-    PoolIterator _releasedIter;
+    struct Block
+    {
+        const char* begin;
+        const char* end;
+        void* data;
+        void (*release)(void*);
+    };
+
+    template<typename U>
+    static void deleteBlock(void* data){
+        delete [] static_cast<U*>(data);
+    }
+
+    bool isInBlock(const T* data) const{
+        // compared as addresses, the elements of a block of U are sizeof(U) apart
+        const char* address = reinterpret_cast<const char*>(data);
+        for (auto &block : _blocks){
+            if (!std::less<const char*>()(address, block.begin) && std::less<const char*>()(address, block.end))
+                return true;
+        }
+        return false;
+    }
+
+    T* seekActiveData(){
+        while (_releasedIndex < _released.size()){
+            if (_released[_releasedIndex]) return _released[_releasedIndex];
+            ++_releasedIndex;
+        }
+        compactActiveDatas();
+        _releasedIndex = _released.size();
+        _iterating = false;
+        return nullptr;
+    }
+
+    size_t _releasedIndex;
+    size_t _lockedSlots;
+    bool _iterating;
     PoolList _released;
-    PoolList _locked;
+    FreeList _locked;
+    std::vector<Block> _blocks;
 };
 
 typedef DataPool<Particle3D> ParticlePool;
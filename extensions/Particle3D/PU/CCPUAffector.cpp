@@ -232,4 +232,32 @@ void PUAffector::process( PUParticle3D* particle, float delta, bool firstParticl
     updatePUAffector(particle, delta);
 }
 
+void PUAffector::process( PUParticleSpan& span, float delta, bool firstParticle )
+{
+    if (span.empty())
+        return;
+
+    if (!_excludedEmitters.empty()){
+        // Excluded particles are filtered one by one
+        PUParticle3D** particles = span.getParticles();
+        for (size_t i = 0; i < span.size(); ++i){
+            process(particles[i], delta, firstParticle && i == 0);
+        }
+        return;
+    }
+
+    if (firstParticle){
+        firstParticleUpdate(span.getParticle(0), delta);
+    }
+    updatePUAffectorBatch(span, delta);
+}
+
+void PUAffector::updatePUAffectorBatch( PUParticleSpan& span, float delta )
+{
+    PUParticle3D** particles = span.getParticles();
+    for (size_t i = 0; i < span.size(); ++i){
+        updatePUAffector(particles[i], delta);
+    }
+}
+
 NS_CC_END
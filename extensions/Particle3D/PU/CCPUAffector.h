@@ -36,6 +36,7 @@
 NS_CC_BEGIN
 
 struct PUParticle3D;
+class PUParticleSpan;
 class PUParticleSystem3D;
 
 class CC_DLL PUAffector : public Particle3DAffector
@@ -62,10 +63,18 @@ public:
     virtual void unPrepare();
     virtual void preUpdateAffector(float deltaTime);
     virtual void updatePUAffector(PUParticle3D* particle, float delta);
+    /**
+     * Updates a span of alive particles. The default implementation calls updatePUAffector() for each of them,
+     * affectors with plain per particle math override it to run tight loops over the streams of the span.
+     * @since v3.18
+     */
+    virtual void updatePUAffectorBatch(PUParticleSpan& span, float delta);
     virtual void postUpdateAffector(float deltaTime);
     virtual void firstParticleUpdate(PUParticle3D *particle, float deltaTime);
     virtual void initParticleForEmission(PUParticle3D* particle);
     void process(PUParticle3D* particle, float delta, bool firstParticle);
+    /** Processes a span of alive particles, firstParticle tells whether its first one is the first one of this update. @since v3.18 */
+    void process(PUParticleSpan& span, float delta, bool firstParticle);
 
     void setLocalPosition(const Vec3 &pos) { _position = pos; };
     const Vec3 getLocalPosition() const { return _position; };
@@ -113,6 +122,12 @@ CC_CONSTRUCTOR_ACCESS:
 protected:
 
     float calculateAffectSpecialisationFactor (const PUParticle3D* particle);
+    /** Same as above for a particle given by its time fraction, as found in the streams of a span. Inline, so batch loops can hoist the test. */
+    float calculateAffectSpecialisationFactor (float timeFraction) const
+    {
+        return _affectSpecialisation == AFSP_TTL_INCREASE ? timeFraction
+            : (_affectSpecialisation == AFSP_TTL_DECREASE ? 1.0f - timeFraction : 1.0f);
+    }
     
 protected:
 
@@ -126,6 +126,61 @@ void PUColorAffector::updatePUAffector( PUParticle3D *particle, float /*deltaTim
     }
 }
 
+void PUColorAffector::updatePUAffectorBatch( PUParticleSpan &span, float /*deltaTime*/ )
+{
+    // Fast rejection
+    if (_colorMap.empty())
+        return;
+
+    // Walk flat arrays instead of the map for every particle
+    _colorTimes.clear();
+    _colorValues.clear();
+    for (auto &iter : _colorMap)
+    {
+        _colorTimes.push_back(iter.first);
+        _colorValues.push_back(iter.second);
+    }
+    size_t keys = _colorTimes.size();
+
+    PUParticleSpan::Streams &streams = span.getStreams();
+    size_t count = span.size();
+    const float *timeToLive = streams.timeToLive.data();
+    const float *totalTimeToLive = streams.totalTimeToLive.data();
+    const Vec4 *originalColors = streams.originalColors.data();
+    Vec4 *colors = streams.colors.data();
+    bool multiply = _colorOperation != CAO_SET;
+    for (size_t i = 0; i < count; ++i)
+    {
+        float timeFraction = (totalTimeToLive[i] - timeToLive[i]) / totalTimeToLive[i];
+
+        // Same lookup as findNearestColorMapIterator()
+        size_t k = 0;
+        while (k < keys && !(timeFraction < _colorTimes[k]))
+            ++k;
+        if (k > 0)
+            --k;
+
+        Vec4 color;
+        if (k + 1 < keys)
+        {
+            color = _colorValues[k] + ((_colorValues[k + 1] - _colorValues[k]) * ((timeFraction - _colorTimes[k])/(_colorTimes[k + 1] - _colorTimes[k])));
+        }
+        else
+        {
+            color = _colorValues[k];
+        }
+
+        if (multiply)
+        {
+            colors[i] = Vec4(color.x * originalColors[i].x, color.y * originalColors[i].y, color.z * originalColors[i].z, color.w * originalColors[i].w);
+        }
+        else
+        {
+            colors[i] = color;
+        }
+    }
+}
+
 PUColorAffector* PUColorAffector::create()
 {
     auto pca = new (std::nothrow) PUColorAffector();
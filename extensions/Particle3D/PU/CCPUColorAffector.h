@@ -51,6 +51,7 @@ public:
     static PUColorAffector* create();
 
     virtual void updatePUAffector(PUParticle3D *particle, float deltaTime) override;
+    virtual void updatePUAffectorBatch(PUParticleSpan &span, float deltaTime) override;
 
     /** 
     */
@@ -88,6 +89,10 @@ protected:
 
     ColorMap _colorMap;
     ColorOperation _colorOperation;
+
+    // _colorMap flattened by updatePUAffectorBatch()
+    std::vector<float> _colorTimes;
+    std::vector<Vec4> _colorValues;
 };
 NS_CC_END
 
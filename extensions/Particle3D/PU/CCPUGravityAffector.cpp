@@ -77,6 +77,30 @@ void PUGravityAffector::updatePUAffector( PUParticle3D *particle, float deltaTim
     }
 }
 
+void PUGravityAffector::updatePUAffectorBatch( PUParticleSpan &span, float deltaTime )
+{
+    // Everything but the particle mass and distance is the same for the whole span
+    float scaleVelocity = (static_cast<PUParticleSystem3D *>(_particleSystem))->getParticleSystemScaleVelocity();
+    float attraction = scaleVelocity * _gravity * _mass * deltaTime;
+
+    PUParticleSpan::Streams &streams = span.getStreams();
+    size_t count = span.size();
+    const Vec3 *positions = streams.positions.data();
+    const float *masses = streams.masses.data();
+    const float *timeFractions = streams.timeFractions.data();
+    Vec3 *directions = streams.directions.data();
+    for (size_t i = 0; i < count; ++i)
+    {
+        Vec3 distance = _derivedPosition - positions[i];
+        float length = distance.lengthSquared();
+        if (length > 0)
+        {
+            float force = attraction * masses[i] / length;
+            directions[i] += distance * (force * calculateAffectSpecialisationFactor(timeFractions[i]));
+        }
+    }
+}
+
 void PUGravityAffector::preUpdateAffector( float /*deltaTime*/ )
 {
     getDerivedPosition();
@@ -43,6 +43,7 @@ public:
 
     virtual void preUpdateAffector(float deltaTime) override;
     virtual void updatePUAffector(PUParticle3D *particle, float deltaTime) override;
+    virtual void updatePUAffectorBatch(PUParticleSpan &span, float deltaTime) override;
 
     /** 
     */
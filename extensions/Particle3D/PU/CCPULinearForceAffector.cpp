@@ -56,6 +56,28 @@ void PULinearForceAffector::updatePUAffector( PUParticle3D *particle, float /*de
 
 }
 
+void PULinearForceAffector::updatePUAffectorBatch( PUParticleSpan &span, float /*deltaTime*/ )
+{
+    PUParticleSpan::Streams &streams = span.getStreams();
+    size_t count = span.size();
+    Vec3 *directions = streams.directions.data();
+    if (_forceApplication == FA_ADD)
+    {
+        const float *timeFractions = streams.timeFractions.data();
+        for (size_t i = 0; i < count; ++i)
+        {
+            directions[i] += _scaledVector * calculateAffectSpecialisationFactor(timeFractions[i]);
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            directions[i] = (directions[i] + _forceVector) / 2;
+        }
+    }
+}
+
 PULinearForceAffector* PULinearForceAffector::create()
 {
     auto plfa = new (std::nothrow) PULinearForceAffector();
@@ -169,6 +169,102 @@ void PUParticle3D::copyBehaviours( const ParticleBehaviourList &list )
 
 //-----------------------------------------------------------------------
 
+PUParticleSpan::PUParticleSpan()
+: _streamsValid(false)
+, _streamsDirty(false)
+{
+}
+
+void PUParticleSpan::clear()
+{
+    _particles.clear();
+    _touchedParticles.clear();
+    _streamsValid = false;
+    _streamsDirty = false;
+}
+
+PUParticle3D** PUParticleSpan::getParticles()
+{
+    flush();
+    // the caller may change anything
+    _streamsValid = false;
+    return _particles.data();
+}
+
+PUParticleSpan::Streams& PUParticleSpan::getStreams()
+{
+    refreshTouchedParticles();
+    if (!_streamsValid){
+        size_t count = _particles.size();
+        _streams.positions.resize(count);
+        _streams.directions.resize(count);
+        _streams.colors.resize(count);
+        _streams.originalColors.resize(count);
+        _streams.timeToLive.resize(count);
+        _streams.totalTimeToLive.resize(count);
+        _streams.timeFractions.resize(count);
+        _streams.masses.resize(count);
+        gather(0, count);
+        _streamsValid = true;
+    }
+    // the caller may write to them
+    _streamsDirty = true;
+    return _streams;
+}
+
+PUParticle3D* PUParticleSpan::getParticle( size_t index )
+{
+    if (_streamsDirty)
+        scatter(index, index + 1);
+    if (_streamsValid)
+        _touchedParticles.push_back(index);
+    return _particles[index];
+}
+
+void PUParticleSpan::flush()
+{
+    refreshTouchedParticles();
+    if (_streamsDirty){
+        scatter(0, _particles.size());
+        _streamsDirty = false;
+    }
+}
+
+void PUParticleSpan::refreshTouchedParticles()
+{
+    for (auto index : _touchedParticles){
+        gather(index, index + 1);
+    }
+    _touchedParticles.clear();
+}
+
+void PUParticleSpan::gather( size_t begin, size_t end )
+{
+    for (size_t i = begin; i < end; ++i){
+        const PUParticle3D *particle = _particles[i];
+        _streams.positions[i] = particle->position;
+        _streams.directions[i] = particle->direction;
+        _streams.colors[i] = particle->color;
+        _streams.originalColors[i] = particle->originalColor;
+        _streams.timeToLive[i] = particle->timeToLive;
+        _streams.totalTimeToLive[i] = particle->totalTimeToLive;
+        _streams.timeFractions[i] = particle->timeFraction;
+        _streams.masses[i] = particle->mass;
+    }
+}
+
+void PUParticleSpan::scatter( size_t begin, size_t end )
+{
+    for (size_t i = begin; i < end; ++i){
+        PUParticle3D *particle = _particles[i];
+        particle->position = _streams.positions[i];
+        particle->direction = _streams.directions[i];
+        particle->color = _streams.colors[i];
+    }
+}
+
+//-----------------------------------------------------------------------
+
 const float PUParticleSystem3D::DEFAULT_WIDTH = 50;
 const float PUParticleSystem3D::DEFAULT_HEIGHT = 50;
 const float PUParticleSystem3D::DEFAULT_DEPTH = 50;
@@ -201,8 +297,8 @@ PUParticleSystem3D::~PUParticleSystem3D()
 
     _particlePool.removeAllDatas();
 
-    for (auto iter : _emittedEmitterParticlePool){
-        auto pool = iter.second;
+    for (auto &iter : _emittedEmitterParticlePool){
+        auto &pool = iter.second;
         auto lockedList = pool.getUnActiveDataList();
         for (auto iter2 : lockedList){
             static_cast<PUParticle3D *>(iter2)->particleEntityPtr->release();
@@ -210,8 +306,8 @@ PUParticleSystem3D::~PUParticleSystem3D()
         iter.second.removeAllDatas();
     }
 
-    for (auto iter : _emittedSystemParticlePool){
-        auto pool = iter.second;
+    for (auto &iter : _emittedSystemParticlePool){
+        auto &pool = iter.second;
         auto lockedList = pool.getUnActiveDataList();
         for (auto iter2 : lockedList){
             static_cast<PUParticle3D *>(iter2)->particleEntityPtr->release();
@@ -508,25 +604,25 @@ void PUParticleSystem3D::prepared()
                 PUEmitter *emitter = static_cast<PUEmitter*>(it);
                 if (emitter->getEmitsType() == PUParticle3D::PT_EMITTER){
                     PUEmitter *emitted = static_cast<PUEmitter*>(emitter->getEmitsEntityPtr());
-                    for (unsigned int i = 0; i < _emittedEmitterQuota; ++i){
-                        auto p = new (std::nothrow) PUParticle3D();
+                    auto particles = _emittedEmitterParticlePool[emitted->getName()].allocateDatas<PUParticle3D>(_emittedEmitterQuota);
+                    for (unsigned int i = 0; particles && i < _emittedEmitterQuota; ++i){
+                        auto p = particles + i;
                         p->particleType = PUParticle3D::PT_EMITTER;
                         p->particleEntityPtr = emitted->clone();
                         p->particleEntityPtr->retain();
                         p->copyBehaviours(_behaviourTemplates);
-                        _emittedEmitterParticlePool[emitted->getName()].addData(p);
                     }
                 }
                 else if (emitter->getEmitsType() == PUParticle3D::PT_TECHNIQUE){
                     PUParticleSystem3D *emitted = static_cast<PUParticleSystem3D*>(emitter->getEmitsEntityPtr());
-                    for (unsigned int i = 0; i < _emittedSystemQuota; ++i){
+                    auto particles = _emittedSystemParticlePool[emitted->getName()].allocateDatas<PUParticle3D>(_emittedSystemQuota);
+                    for (unsigned int i = 0; particles && i < _emittedSystemQuota; ++i){
                         PUParticleSystem3D *clonePS = emitted->clone();
-                        auto p = new (std::nothrow) PUParticle3D();
+                        auto p = particles + i;
                         p->particleType = PUParticle3D::PT_TECHNIQUE;
                         p->particleEntityPtr = clonePS;
                         p->particleEntityPtr->retain();
                         p->copyBehaviours(_behaviourTemplates);
-                        _emittedSystemParticlePool[emitted->getName()].addData(p);
                         clonePS->prepared();
                     }
                     //emitted->stopParticle();
@@ -534,10 +630,10 @@ void PUParticleSystem3D::prepared()
 
             }
 
-            for (unsigned int i = 0; i < _particleQuota; ++i){
-                auto p = new (std::nothrow) PUParticle3D();
-                p->copyBehaviours(_behaviourTemplates);
-                _particlePool.addData(p);
+            // the particles of a pool are allocated in one block, so walking them doesn't jump around the heap
+            auto particles = _particlePool.allocateDatas<PUParticle3D>(_particleQuota);
+            for (unsigned int i = 0; particles && i < _particleQuota; ++i){
+                particles[i].copyBehaviours(_behaviourTemplates);
             }
             _poolPrepared = true;
         }
@@ -1074,11 +1170,11 @@ void PUParticleSystem3D::copyAttributesTo(PUParticleSystem3D* system )
     system->removeAllBehaviourTemplate();
     system->removeAllListener();
     system->_particlePool.removeAllDatas();
-    for (auto iter : system->_emittedEmitterParticlePool){
+    for (auto &iter : system->_emittedEmitterParticlePool){
         iter.second.removeAllDatas();
     }
 
-    for (auto iter : system->_emittedSystemParticlePool){
+    for (auto &iter : system->_emittedSystemParticlePool){
         iter.second.removeAllDatas();
     }
 
@@ -1197,13 +1293,20 @@ void PUParticleSystem3D::draw( Renderer *renderer, const Mat4 &transform, uint32
 void PUParticleSystem3D::processParticle( ParticlePool &pool, bool &firstActiveParticle, bool &firstParticle, float elapsedTime )
 {
     Vec3 scale = getDerivedScale();
-    PUParticle3D *particle = static_cast<PUParticle3D *>(pool.getFirst());
     //Mat4 ltow = getNodeToWorldTransform();
     //Vec3 scl;
     //Quaternion rot;
     //ltow.decompose(&scl, &rot, nullptr);
-    while (particle){
 
+    // The pool is processed in stages so that each affector walks all alive particles as one span instead of
+    // being called once per particle. Every particle still goes through the steps in the same order.
+    pool.compactActiveDatas();
+    size_t count = pool.getActiveDataSlots();
+    _processedParticles.clear();
+    _activeParticles.clear();
+    for (size_t i = 0; i < count; ++i){
+        PUParticle3D *particle = static_cast<PUParticle3D *>(pool.getActiveData(i));
+        _processedParticles.push_back(particle);
         if (!isExpired(particle, elapsedTime)){
             particle->process(elapsedTime);
 
@@ -1215,12 +1318,30 @@ void PUParticleSystem3D::processParticle( ParticlePool &pool, bool &firstActiveP
                     (static_cast<PUEmitter*>(it))->updateEmitter(particle, elapsedTime);
                 }
             }
+            _activeParticles.add(particle);
+        }
+    }
 
-            for (auto& it : _affectors) {
-                if (it->isEnabled()){
-                    (static_cast<PUAffector*>(it))->process(particle, elapsedTime, firstActiveParticle);
-                }
+    if (!_activeParticles.empty()){
+        for (auto& it : _affectors) {
+            if (it->isEnabled()){
+                (static_cast<PUAffector*>(it))->process(_activeParticles, elapsedTime, firstActiveParticle);
             }
+        }
+    }
+    // what batch affectors left in the streams goes back to the particles
+    PUParticle3D **activeParticles = _activeParticles.getParticles();
+    size_t activeCount = _activeParticles.size();
+
+    size_t activeIndex = 0;
+    for (size_t i = 0; i < count; ++i){
+        PUParticle3D *particle = _processedParticles[i];
+        // An observer may have cleared the pool, e.g. by stopping the system
+        if (pool.getActiveData(i) != particle)
+            break;
+
+        if (activeIndex < activeCount && activeParticles[activeIndex] == particle){
+            ++activeIndex;
 
             if (_render)
                 static_cast<PURender *>(_render)->updateRender(particle, elapsedTime, firstActiveParticle);
@@ -1273,7 +1394,7 @@ void PUParticleSystem3D::processParticle( ParticlePool &pool, bool &firstActiveP
         }
         else{
             initParticleForExpiration(particle, elapsedTime);
-            pool.lockLatestData();
+            pool.lockActiveData(i);
         }
 
         for (auto it : _observers){
@@ -1294,8 +1415,8 @@ void PUParticleSystem3D::processParticle( ParticlePool &pool, bool &firstActiveP
 
         particle->timeToLive -= elapsedTime;
         firstParticle = false;
-        particle = static_cast<PUParticle3D *>(pool.getNext());
     }
+    pool.compactActiveDatas();
 }
 
 bool PUParticleSystem3D::makeParticleLocal( PUParticle3D* particle )
@@ -1387,11 +1508,11 @@ void PUParticleSystem3D::calulateRotationOffset( void )
 int PUParticleSystem3D::getAliveParticleCount() const
 {
     int sz = 0;
-    sz += _particlePool.getActiveDataList().size();
+    sz += _particlePool.getActiveDataCount();
 
     if (!_emittedEmitterParticlePool.empty()){
         for (auto &iter : _emittedEmitterParticlePool){
-            sz += iter.second.getActiveDataList().size();
+            sz += iter.second.getActiveDataCount();
         }
     }
 
@@ -1399,13 +1520,12 @@ int PUParticleSystem3D::getAliveParticleCount() const
         return sz;
 
     for (auto &iter : _emittedSystemParticlePool){
-        auto pool = iter.second;
-        sz += pool.getActiveDataList().size();
-        PUParticle3D *particle = static_cast<PUParticle3D *>(pool.getFirst());
-        while (particle)
+        auto &pool = iter.second;
+        sz += pool.getActiveDataCount();
+        for (auto particle : pool.getActiveDataList())
         {
-            sz += static_cast<PUParticleSystem3D*>(particle->particleEntityPtr)->getAliveParticleCount();
-            particle = static_cast<PUParticle3D *>(pool.getNext());
+            if (particle)
+                sz += static_cast<PUParticleSystem3D*>(static_cast<PUParticle3D *>(particle)->particleEntityPtr)->getAliveParticleCount();
         }
     }
     return sz;
@@ -212,6 +212,61 @@ struct CC_DLL PUParticle3D : public Particle3D
     
 };
 
+/**
+ * The alive particles of a pool handed to the affectors in one go. The fields most affectors work on are also
+ * kept in parallel arrays (streams), so that batch affectors run plain loops over contiguous floats instead of
+ * reading them through every particle. Both views are kept in sync lazily: asking for the streams copies the
+ * particles into them, asking for the particles afterwards writes positions, directions and colors back.
+ * @since v3.18
+ */
+class CC_DLL PUParticleSpan
+{
+public:
+    struct Streams
+    {
+        // read and written back
+        std::vector<Vec3> positions;
+        std::vector<Vec3> directions;
+        std::vector<Vec4> colors;
+        // read only
+        std::vector<Vec4> originalColors;
+        std::vector<float> timeToLive;
+        std::vector<float> totalTimeToLive;
+        std::vector<float> timeFractions;
+        std::vector<float> masses;
+    };
+
+    PUParticleSpan();
+
+    void clear();
+    void add(PUParticle3D* particle) { _particles.push_back(particle); }
+    size_t size() const { return _particles.size(); }
+    bool empty() const { return _particles.empty(); }
+
+    /** The particles, holding what batch affectors wrote in the streams. They may be changed freely. */
+    PUParticle3D** getParticles();
+    /** The streams, holding what was changed in the particles. Only positions, directions and colors are written back. */
+    Streams& getStreams();
+    /** A single particle, changing it doesn't make the streams of the other particles stale. */
+    PUParticle3D* getParticle(size_t index);
+    /** Copies what is left in the streams to the particles. */
+    void flush();
+
+protected:
+    void gather(size_t begin, size_t end);
+    void scatter(size_t begin, size_t end);
+    void refreshTouchedParticles();
+
+    std::vector<PUParticle3D*> _particles;
+    Streams _streams;
+    // particles handed out by getParticle() while the streams were valid
+    std::vector<size_t> _touchedParticles;
+    // the streams hold the values of the particles
+    bool _streamsValid;
+    // the streams were changed since they were copied
+    bool _streamsDirty;
+};
+
 class CC_DLL PUParticleSystem3D : public ParticleSystem3D
 {
 public:
@@ -428,6 +483,9 @@ protected:
     Quaternion                          _latestOrientation;
 
     PUParticleSystem3D *                _parentParticleSystem;
+
+    std::vector<PUParticle3D *>         _processedParticles; // Particles of the pool being processed, in pool order.
+    PUParticleSpan                      _activeParticles; // The alive ones among them, handed to the affectors as one span.
 };
 
 NS_CC_END
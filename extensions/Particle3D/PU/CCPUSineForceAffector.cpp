@@ -107,6 +107,27 @@ void PUSineForceAffector::updatePUAffector( PUParticle3D *particle, float /*delt
     }
 }
 
+void PUSineForceAffector::updatePUAffectorBatch( PUParticleSpan &span, float /*deltaTime*/ )
+{
+    PUParticleSpan::Streams &streams = span.getStreams();
+    size_t count = span.size();
+    Vec3 *directions = streams.directions.data();
+    if (_forceApplication == FA_ADD)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            directions[i] += _scaledVector;
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            directions[i] = (directions[i] + _forceVector) / 2;
+        }
+    }
+}
+
 PUSineForceAffector* PUSineForceAffector::create()
 {
     auto psfa = new (std::nothrow) PUSineForceAffector();
@@ -49,6 +49,7 @@ FileUtilsTests::FileUtilsTests()
     ADD_TEST_CASE(TestWriteDataAsync);
     ADD_TEST_CASE(TestListFiles);
     ADD_TEST_CASE(TestIsFileExistRejectFolder);
+    ADD_TEST_CASE(TestSearchPathIndex);
 }
 
 // TestResolutionDirectories
@@ -1484,3 +1485,62 @@ std::string TestIsFileExistRejectFolder::subtitle() const
 {
     return "";
 }
+
+// TestSearchPathIndex
+
+void TestSearchPathIndex::onEnter()
+{
+    FileUtilsDemo::onEnter();
+
+    auto winSize = Director::getInstance()->getWinSize();
+    auto sharedFileUtils = FileUtils::getInstance();
+
+    _defaultSearchPathArray = sharedFileUtils->getOriginalSearchPaths();
+    _defaultIndexEnabled = sharedFileUtils->isSearchPathIndexEnabled();
+
+    std::string writablePath = sharedFileUtils->getWritablePath();
+    std::string missingFile = "search_path_index.txt";
+    sharedFileUtils->removeFile(writablePath + missingFile);
+
+    std::vector<std::string> searchPaths = _defaultSearchPathArray;
+    searchPaths.insert(searchPaths.begin(), writablePath);
+    searchPaths.push_back("Misc/searchpath1");
+    sharedFileUtils->setSearchPaths(searchPaths);
+    sharedFileUtils->setSearchPathIndexEnabled(true);
+
+    // Found through the index
+    bool indexed = !sharedFileUtils->fullPathForFilename("Images/grossini.png").empty();
+    // Missing everywhere, the second lookup is answered by the negative cache
+    bool missing = sharedFileUtils->fullPathForFilename(missingFile).empty()
+        && sharedFileUtils->fullPathForFilename(missingFile).empty();
+    // Writing the file invalidates the negative cache
+    sharedFileUtils->writeStringToFile("Hello Cocos2d-x!", writablePath + missingFile);
+    bool written = !sharedFileUtils->fullPathForFilename(missingFile).empty();
+    sharedFileUtils->removeFile(writablePath + missingFile);
+
+    char buffer[200] = { 0 };
+    snprintf(buffer, 200, "indexed: %s, missing: %s, written: %s",
+        indexed ? "true" : "false", missing ? "true" : "false", written ? "true" : "false");
+
+    auto label = Label::createWithTTF(buffer, "fonts/Thonburi.ttf", 18);
+    this->addChild(label);
+    label->setPosition(winSize.width / 2, winSize.height / 2);
+}
+
+void TestSearchPathIndex::onExit()
+{
+    auto sharedFileUtils = FileUtils::getInstance();
+    sharedFileUtils->setSearchPathIndexEnabled(_defaultIndexEnabled);
+    sharedFileUtils->setSearchPaths(_defaultSearchPathArray);
+    FileUtilsDemo::onExit();
+}
+
+std::string TestSearchPathIndex::title() const
+{
+    return "FileUtils: search path index";
+}
+
+std::string TestSearchPathIndex::subtitle() const
+{
+    return "expect all to be true";
+}
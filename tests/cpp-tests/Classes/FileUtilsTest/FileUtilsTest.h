@@ -280,4 +280,18 @@ public:
     virtual std::string subtitle() const override;
 };
 
+class TestSearchPathIndex : public FileUtilsDemo
+{
+public:
+    CREATE_FUNC(TestSearchPathIndex);
+
+    virtual void onEnter() override;
+    virtual void onExit() override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+private:
+    std::vector<std::string> _defaultSearchPathArray;
+    bool _defaultIndexEnabled;
+};
+
 #endif /* __FILEUTILSTEST_H__ */
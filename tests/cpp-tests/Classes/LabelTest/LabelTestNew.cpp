@@ -26,6 +26,7 @@
 #include "../testResource.h"
 #include "renderer/CCRenderer.h"
 #include "2d/CCFontAtlasCache.h"
+#include "2d/CCFontFreeType.h"
 
 USING_NS_CC;
 using namespace ui;
@@ -141,6 +142,10 @@ NewLabelTests::NewLabelTests()
     ADD_TEST_CASE(LabelIssueLineGap);
     ADD_TEST_CASE(LabelIssue17902);
     ADD_TEST_CASE(LabelLetterColorsTest);
+    ADD_TEST_CASE(LabelTTFPrewarm);
+    ADD_TEST_CASE(LabelTTFGlyphDiskCache);
+    ADD_TEST_CASE(LabelTTFMSDF);
+    ADD_TEST_CASE(LabelTTFComplexScripts);
 };
 
 LabelFNTColorAndOpacity::LabelFNTColorAndOpacity()
@@ -3600,3 +3605,259 @@ void LabelLetterColorsTest::setLetterColors(cocos2d::Label* label, const cocos2d
             letter->setColor(color);
     }
 }
+
+//
+// LabelTTFPrewarm
+//
+namespace {
+const char* PREWARM_TEXT = "你好，欢迎来到聊天室。今天天气很好，我们一起去公园散步吧！明天见，晚安。";
+}
+
+LabelTTFPrewarm::LabelTTFPrewarm()
+{
+    auto center = VisibleRect::center();
+
+    _statusLabel = Label::createWithTTF("", "fonts/arial.ttf", 16);
+    _statusLabel->setPosition(center.x, center.y - 60);
+    addChild(_statusLabel);
+
+    TTFConfig ttfConfig("fonts/HKYuanMini.ttf", 30, GlyphCollection::DYNAMIC);
+    FontAtlasCache::unloadFontAtlasTTF(ttfConfig.fontFilePath);
+
+    _startTime = utils::gettime();
+    FontAtlasCache::prewarmFontAtlasTTF(&ttfConfig, PREWARM_TEXT);
+
+    schedule(CC_SCHEDULE_SELECTOR(LabelTTFPrewarm::checkPrewarm));
+}
+
+void LabelTTFPrewarm::checkPrewarm(float /*dt*/)
+{
+    TTFConfig ttfConfig("fonts/HKYuanMini.ttf", 30, GlyphCollection::DYNAMIC);
+    auto atlas = FontAtlasCache::getFontAtlasTTF(&ttfConfig);
+    if (atlas == nullptr || atlas->isPrewarming())
+    {
+        return;
+    }
+    unschedule(CC_SCHEDULE_SELECTOR(LabelTTFPrewarm::checkPrewarm));
+
+    // every glyph is in the atlas already, so creating the label doesn't rasterize anything
+    auto label = Label::createWithTTF(ttfConfig, PREWARM_TEXT, TextHAlignment::CENTER, VisibleRect::getVisibleRect().size.width * 0.8f);
+    label->setPosition(VisibleRect::center().x, VisibleRect::center().y + 40);
+    addChild(label);
+
+    _statusLabel->setString(StringUtils::format("prewarmed in %.1f ms, %d page(s) of %d x %d",
+                                                (utils::gettime() - _startTime) * 1000.0,
+                                                (int)atlas->getTextures().size(),
+                                                atlas->getPageWidth(),
+                                                atlas->getPageHeight()));
+}
+
+std::string LabelTTFPrewarm::title() const
+{
+    return "Glyph prewarming";
+}
+
+std::string LabelTTFPrewarm::subtitle() const
+{
+    return "Glyphs are rasterized on a worker thread before the label is shown";
+}
+
+//
+// LabelTTFGlyphDiskCache
+//
+LabelTTFGlyphDiskCache::LabelTTFGlyphDiskCache()
+: _label(nullptr)
+{
+    auto center = VisibleRect::center();
+
+    _statusLabel = Label::createWithTTF("", "fonts/arial.ttf", 14);
+    _statusLabel->setPosition(center.x, center.y - 50);
+    addChild(_statusLabel);
+
+    MenuItemFont::setFontSize(20);
+    auto reload = MenuItemFont::create("Reload font", [&](Ref*) { createLabel(); });
+    auto save = MenuItemFont::create("Save cache", [&](Ref*) {
+        FontGlyphCache::saveAll();
+        updateStatus(0.0);
+    });
+    auto clear = MenuItemFont::create("Delete cache files", [&](Ref*) {
+        FontGlyphCache::removeAllCacheFiles();
+        updateStatus(0.0);
+    });
+    auto menu = Menu::create(reload, save, clear, nullptr);
+    menu->alignItemsHorizontallyWithPadding(20);
+    menu->setPosition(center.x, VisibleRect::bottom().y + 40);
+    addChild(menu);
+}
+
+void LabelTTFGlyphDiskCache::onEnter()
+{
+    AtlasDemoNew::onEnter();
+    FontGlyphCache::setEnabled(true);
+    createLabel();
+}
+
+void LabelTTFGlyphDiskCache::onExit()
+{
+    FontGlyphCache::saveAll();
+    FontGlyphCache::setEnabled(false);
+    if (_label)
+    {
+        _label->removeFromParent();
+        _label = nullptr;
+    }
+    FontAtlasCache::unloadFontAtlasTTF("fonts/HKYuanMini.ttf");
+    AtlasDemoNew::onExit();
+}
+
+void LabelTTFGlyphDiskCache::createLabel()
+{
+    if (_label)
+    {
+        _label->removeFromParent();
+        _label = nullptr;
+    }
+
+    // drop the atlas so the font is opened again and every glyph is looked up anew
+    TTFConfig ttfConfig("fonts/HKYuanMini.ttf", 28, GlyphCollection::DYNAMIC);
+    FontAtlasCache::unloadFontAtlasTTF(ttfConfig.fontFilePath);
+
+    auto startTime = utils::gettime();
+    _label = Label::createWithTTF(ttfConfig, PREWARM_TEXT, TextHAlignment::CENTER, VisibleRect::getVisibleRect().size.width * 0.8f);
+    _label->setPosition(VisibleRect::center().x, VisibleRect::center().y + 50);
+    addChild(_label);
+    updateStatus((utils::gettime() - startTime) * 1000.0);
+}
+
+void LabelTTFGlyphDiskCache::updateStatus(double elapsedMs)
+{
+    auto atlas = _label ? _label->getFontAtlas() : nullptr;
+    auto font = atlas ? dynamic_cast<const FontFreeType*>(atlas->getFont()) : nullptr;
+    auto cache = font ? font->getGlyphCache() : nullptr;
+    if (cache == nullptr)
+    {
+        _statusLabel->setString("glyph cache unavailable");
+        return;
+    }
+
+    _statusLabel->setString(StringUtils::format("label created in %.1f ms\n%d glyph(s) read from disk, %d not saved yet",
+                                                elapsedMs,
+                                                (int)cache->getDiskGlyphCount(),
+                                                (int)cache->getPendingGlyphCount()));
+}
+
+std::string LabelTTFGlyphDiskCache::title() const
+{
+    return "On-disk glyph cache";
+}
+
+std::string LabelTTFGlyphDiskCache::subtitle() const
+{
+    return "Reload after saving: glyphs come from the cache file, not FreeType";
+}
+
+
+LabelTTFMSDF::LabelTTFMSDF()
+{
+    auto size = Director::getInstance()->getWinSize();
+    TTFConfig ttfConfig("fonts/arial.ttf", 12);
+    ttfConfig.msdfEnabled = true;
+
+    const float fontSizes[] = { 12, 20, 32, 56 };
+    float y = size.height * 0.8f;
+    for (auto fontSize : fontSizes)
+    {
+        ttfConfig.fontSize = fontSize;
+        auto label = Label::createWithTTF(ttfConfig, StringUtils::format("MSDF %d px", (int)fontSize));
+        label->setPosition(size.width * 0.3f, y);
+        addChild(label);
+        y -= fontSize + 10;
+    }
+
+    ttfConfig.fontSize = 40;
+    auto outlined = Label::createWithTTF(ttfConfig, "Outline");
+    outlined->setPosition(size.width * 0.72f, size.height * 0.7f);
+    outlined->setTextColor(Color4B::WHITE);
+    outlined->enableOutline(Color4B::BLUE, 2);
+    addChild(outlined);
+
+    auto glowing = Label::createWithTTF(ttfConfig, "Glow");
+    glowing->setPosition(size.width * 0.72f, size.height * 0.5f);
+    glowing->setTextColor(Color4B::GREEN);
+    glowing->enableGlow(Color4B::YELLOW);
+    addChild(glowing);
+
+    auto shadowed = Label::createWithTTF(ttfConfig, "Shadow");
+    shadowed->setPosition(size.width * 0.72f, size.height * 0.3f);
+    shadowed->enableShadow(Color4B::BLACK, Size(2, -2));
+    addChild(shadowed);
+
+    // zooming in stays sharp, the field is sampled instead of the bitmap
+    ttfConfig.fontSize = 16;
+    auto zoomed = Label::createWithTTF(ttfConfig, "Zoom");
+    zoomed->setPosition(size.width * 0.3f, size.height * 0.2f);
+    zoomed->enableOutline(Color4B::RED, 1);
+    zoomed->runAction(RepeatForever::create(Sequence::create(
+        ScaleTo::create(3.0f, 5.0f),
+        ScaleTo::create(3.0f, 1.0f),
+        nullptr)));
+    addChild(zoomed);
+
+    auto atlas = zoomed->getFontAtlas();
+    auto status = Label::createWithTTF(StringUtils::format("%d atlas page(s) shared by every label above",
+                                                           (int)atlas->getTextures().size()),
+                                       "fonts/arial.ttf", 14);
+    status->setPosition(size.width / 2, VisibleRect::bottom().y + 20);
+    addChild(status);
+}
+
+std::string LabelTTFMSDF::title() const
+{
+    return "Multi-channel distance field TTF";
+}
+
+std::string LabelTTFMSDF::subtitle() const
+{
+    return "One atlas for every size, outline and glow drawn by the shader";
+}
+
+LabelTTFComplexScripts::LabelTTFComplexScripts()
+{
+    auto size = Director::getInstance()->getWinSize();
+
+    const char* texts[] = {
+        u8"السلام عليكم",
+        u8"Score: مرحبا 2018 بك",
+        u8"شَكْرًا",
+        u8"שלום עולם",
+    };
+    float y = size.height * 0.8f;
+    for (auto text : texts)
+    {
+        auto label = Label::createWithTTF(text, "fonts/tahoma.ttf", 28);
+        label->setPosition(size.width / 2, y);
+        addChild(label);
+        y -= 45;
+    }
+
+    auto thai = Label::createWithTTF(u8"ภาษาไทย กินน้ำ", "fonts/Thonburi.ttf", 28);
+    thai->setPosition(size.width / 2, y);
+    addChild(thai);
+
+    // every line of a wrapped paragraph reads from right to left
+    auto paragraph = Label::createWithTTF(u8"هذا نص طويل يلتف "
+        u8"على عدة أسطر في اللعبة",
+        "fonts/tahoma.ttf", 20, Size(size.width / 3, 0), TextHAlignment::RIGHT);
+    paragraph->setPosition(size.width / 2, size.height * 0.2f);
+    addChild(paragraph);
+}
+
+std::string LabelTTFComplexScripts::title() const
+{
+    return "Arabic, Hebrew and Thai TTF";
+}
+
+std::string LabelTTFComplexScripts::subtitle() const
+{
+    return "Joined letters, right-to-left runs and centered marks";
+}
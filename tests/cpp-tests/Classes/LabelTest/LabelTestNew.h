@@ -980,6 +980,66 @@ public:
     virtual std::string subtitle() const override;
 };
 
+class LabelTTFPrewarm : public AtlasDemoNew
+{
+public:
+    CREATE_FUNC(LabelTTFPrewarm);
+
+    LabelTTFPrewarm();
+
+    void checkPrewarm(float dt);
+
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+
+private:
+    cocos2d::Label* _statusLabel;
+    double _startTime;
+};
+
+class LabelTTFGlyphDiskCache : public AtlasDemoNew
+{
+public:
+    CREATE_FUNC(LabelTTFGlyphDiskCache);
+
+    LabelTTFGlyphDiskCache();
+
+    virtual void onEnter() override;
+    virtual void onExit() override;
+
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+
+private:
+    void createLabel();
+    void updateStatus(double elapsedMs);
+
+    cocos2d::Label* _label;
+    cocos2d::Label* _statusLabel;
+};
+
+class LabelTTFMSDF : public AtlasDemoNew
+{
+public:
+    CREATE_FUNC(LabelTTFMSDF);
+
+    LabelTTFMSDF();
+
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+};
+
+class LabelTTFComplexScripts : public AtlasDemoNew
+{
+public:
+    CREATE_FUNC(LabelTTFComplexScripts);
+
+    LabelTTFComplexScripts();
+
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+};
+
 class LabelLetterColorsTest : public AtlasDemoNew {
 public:
     CREATE_FUNC(LabelLetterColorsTest);
@@ -29,6 +29,7 @@
 #include "2d/CCCameraBackgroundBrush.h"
 #include "3d/CCSprite3DMaterial.h"
 #include "3d/CCMotionStreak3D.h"
+#include "3d/CCBundle3D.h"
 
 #include "extensions/Particle3D/PU/CCPUParticleSystem3D.h"
 
@@ -42,6 +43,7 @@ Sprite3DTests::Sprite3DTests()
     ADD_TEST_CASE(Sprite3DBasicTest);
     ADD_TEST_CASE(Sprite3DHitTest);
     ADD_TEST_CASE(AsyncLoadSprite3DTest);
+    ADD_TEST_CASE(Sprite3DAsyncLoaderTest);
     // 3DEffect use custom shader which is not supported on WP8/WinRT yet. 
     ADD_TEST_CASE(Sprite3DEffectTest);
     ADD_TEST_CASE(Sprite3DUVAnimationTest);
@@ -71,6 +73,11 @@ Sprite3DTests::Sprite3DTests()
     ADD_TEST_CASE(Sprite3DPropertyTest);
     ADD_TEST_CASE(Sprite3DNormalMappingTest);
     ADD_TEST_CASE(Issue16155Test);
+    ADD_TEST_CASE(Sprite3DCrowdTest);
+    ADD_TEST_CASE(Sprite3DCompressedAnimationTest);
+    ADD_TEST_CASE(Sprite3DMappedMeshTest);
+    ADD_TEST_CASE(Sprite3DCullingTest);
+    ADD_TEST_CASE(Sprite3DOcclusionTest);
 };
 
 //------------------------------------------------------------------
@@ -891,6 +898,94 @@ void AsyncLoadSprite3DTest::asyncLoad_Callback(Sprite3D* sprite, void* param)
 }
 
 
+Sprite3DAsyncLoaderTest::Sprite3DAsyncLoaderTest()
+{
+    _paths.push_back("Sprite3DTest/boss.obj");
+    _paths.push_back("Sprite3DTest/girl.c3b");
+    _paths.push_back("Sprite3DTest/orc.c3t");
+    _paths.push_back("Sprite3DTest/orc_mapped.c3b");
+    _paths.push_back("Sprite3DTest/ReskinGirl.c3b");
+    
+    auto s = Director::getInstance()->getWinSize();
+    TTFConfig ttfConfig("fonts/arial.ttf", 15);
+    auto loadItem = MenuItemLabel::create(Label::createWithTTF(ttfConfig, "Load"), CC_CALLBACK_1(Sprite3DAsyncLoaderTest::loadAll, this));
+    auto cancelItem = MenuItemLabel::create(Label::createWithTTF(ttfConfig, "Cancel"), CC_CALLBACK_1(Sprite3DAsyncLoaderTest::cancelAll, this));
+    loadItem->setPosition(s.width * 0.4f, s.height * 0.8f);
+    cancelItem->setPosition(s.width * 0.6f, s.height * 0.8f);
+    auto menu = Menu::create(loadItem, cancelItem, nullptr);
+    menu->setPosition(Vec2::ZERO);
+    addChild(menu, 10);
+    
+    _models = Node::create();
+    addChild(_models);
+    
+    float width = s.width / _paths.size();
+    for (size_t i = 0; i < _paths.size(); ++i)
+    {
+        auto label = Label::createWithTTF(ttfConfig, "");
+        label->setPosition(width * (0.5f + i), s.height * 0.25f);
+        addChild(label);
+        _progressLabels.push_back(label);
+    }
+    
+    loadAll(nullptr);
+}
+
+Sprite3DAsyncLoaderTest::~Sprite3DAsyncLoaderTest()
+{
+    // the callbacks point to the test
+    cancelAll(nullptr);
+}
+
+void Sprite3DAsyncLoaderTest::loadAll(Ref* sender)
+{
+    cancelAll(nullptr);
+    _models->removeAllChildren();
+    Sprite3DCache::getInstance()->removeAllSprite3DData();
+    
+    auto s = Director::getInstance()->getWinSize();
+    float width = s.width / _paths.size();
+    for (size_t i = 0; i < _paths.size(); ++i)
+    {
+        auto label = _progressLabels[i];
+        auto loader = Sprite3DAsyncLoader::load(_paths[i], [this, i, width, s, label](Sprite3D* sprite) {
+            if (sprite)
+            {
+                sprite->setPosition(Vec2(width * (0.5f + i), s.height * 0.5f));
+                _models->addChild(sprite);
+            }
+            label->setString(sprite ? "Done" : "Failed");
+        });
+        loader->setProgressCallback([label](float progress) {
+            label->setString(StringUtils::format("%d%%", (int)(progress * 100)));
+        });
+        _loaders.pushBack(loader);
+    }
+}
+
+void Sprite3DAsyncLoaderTest::cancelAll(Ref* sender)
+{
+    for (auto loader : _loaders)
+    {
+        if (loader->getState() != Sprite3DAsyncLoader::State::DONE && loader->getState() != Sprite3DAsyncLoader::State::FAILED)
+        {
+            loader->cancel();
+            _progressLabels[_loaders.getIndex(loader)]->setString("Cancelled");
+        }
+    }
+    _loaders.clear();
+}
+
+std::string Sprite3DAsyncLoaderTest::title() const
+{
+    return "Testing Sprite3DAsyncLoader";
+}
+
+std::string Sprite3DAsyncLoaderTest::subtitle() const
+{
+    return "Meshes parse in parallel, the frame rate should stay smooth";
+}
+
 Sprite3DWithSkinTest::Sprite3DWithSkinTest()
 {
     auto listener = EventListenerTouchAllAtOnce::create();
@@ -2733,3 +2828,482 @@ std::string Issue16155Test::subtitle() const
 {
     return "Should not leak texture. See console";
 }
+
+//
+// Sprite3DCrowdTest
+//
+Sprite3DCrowdTest::Sprite3DCrowdTest()
+: _schedulerItem(nullptr)
+, _lodItem(nullptr)
+, _info(nullptr)
+, _beforeUpdateListener(nullptr)
+, _afterVisitListener(nullptr)
+, _frameTime(0.0f)
+, _frames(0)
+{
+    auto s = Director::getInstance()->getWinSize();
+
+    // 300 orcs receding from the default camera, so the far rows fall into the LOD levels
+    const int columns = 20;
+    const int rows = 15;
+    auto animation = Animation3D::create("Sprite3DTest/orc.c3b");
+    for (int row = 0; row < rows; ++row)
+    {
+        for (int column = 0; column < columns; ++column)
+        {
+            auto sprite = Sprite3D::create("Sprite3DTest/orc.c3b");
+            sprite->setScale(3);
+            sprite->setRotation3D(Vec3(0, 180, 0));
+            sprite->setPosition3D(Vec3(s.width * (column + 0.5f) / columns, s.height * 0.2f, -150.0f * row));
+            addChild(sprite);
+            if (animation)
+            {
+                auto animate = Animate3D::create(animation);
+                animate->setSpeed(0.8f + 0.02f * ((row * columns + column) % 20));
+                sprite->runAction(RepeatForever::create(animate));
+            }
+        }
+    }
+
+    MenuItemFont::setFontName("fonts/arial.ttf");
+    MenuItemFont::setFontSize(15);
+    _schedulerItem = MenuItemFont::create("", CC_CALLBACK_1(Sprite3DCrowdTest::switchSchedulerCallback, this));
+    _schedulerItem->setPosition(VisibleRect::left().x + 80, VisibleRect::top().y - 70);
+    _lodItem = MenuItemFont::create("", CC_CALLBACK_1(Sprite3DCrowdTest::switchLODCallback, this));
+    _lodItem->setPosition(VisibleRect::left().x + 80, VisibleRect::top().y - 90);
+    auto menu = Menu::create(_schedulerItem, _lodItem, nullptr);
+    menu->setPosition(Vec2::ZERO);
+    addChild(menu, 1);
+
+    _info = Label::createWithTTF("", "fonts/arial.ttf", 15);
+    _info->setAnchorPoint(Vec2(0, 1));
+    _info->setPosition(VisibleRect::left().x + 10, VisibleRect::top().y - 105);
+    addChild(_info, 1);
+
+    Animate3D::setLODLevels({{1000.0f, 2, 6}, {1800.0f, 4, 3}});
+    refreshMenu();
+
+    // update and visit time, which is where the bone poses are evaluated
+    auto dispatcher = Director::getInstance()->getEventDispatcher();
+    _beforeUpdateListener = dispatcher->addCustomEventListener(Director::EVENT_BEFORE_UPDATE, [this](EventCustom*) {
+        _frameStart = std::chrono::steady_clock::now();
+    });
+    _beforeUpdateListener->retain();
+    _afterVisitListener = dispatcher->addCustomEventListener(Director::EVENT_AFTER_VISIT, [this](EventCustom*) {
+        _frameTime += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - _frameStart).count();
+        if (++_frames < 30)
+            return;
+        auto scheduler = Animate3DScheduler::getInstance();
+        _info->setString(StringUtils::format("update + visit: %.2f ms\nskeletons: %d, poses: %d, threads: %d",
+            _frameTime / _frames, scheduler->getLastSkeletonCount(), scheduler->getLastPoseCount(), scheduler->getThreadCount()));
+        _frameTime = 0.0f;
+        _frames = 0;
+    });
+    _afterVisitListener->retain();
+}
+
+Sprite3DCrowdTest::~Sprite3DCrowdTest()
+{
+    auto dispatcher = Director::getInstance()->getEventDispatcher();
+    dispatcher->removeEventListener(_beforeUpdateListener);
+    dispatcher->removeEventListener(_afterVisitListener);
+    CC_SAFE_RELEASE(_beforeUpdateListener);
+    CC_SAFE_RELEASE(_afterVisitListener);
+}
+
+void Sprite3DCrowdTest::onExit()
+{
+    Sprite3DTestDemo::onExit();
+    Animate3DScheduler::getInstance()->setEnabled(true);
+    Animate3D::setLODLevels({});
+}
+
+void Sprite3DCrowdTest::switchSchedulerCallback(Ref* sender)
+{
+    auto scheduler = Animate3DScheduler::getInstance();
+    scheduler->setEnabled(!scheduler->isEnabled());
+    refreshMenu();
+}
+
+void Sprite3DCrowdTest::switchLODCallback(Ref* sender)
+{
+    if (Animate3D::getLODLevels().empty())
+        Animate3D::setLODLevels({{1000.0f, 2, 6}, {1800.0f, 4, 3}});
+    else
+        Animate3D::setLODLevels({});
+    refreshMenu();
+}
+
+void Sprite3DCrowdTest::refreshMenu()
+{
+    _schedulerItem->setString(Animate3DScheduler::getInstance()->isEnabled() ? "Worker threads: On" : "Worker threads: Off");
+    _lodItem->setString(Animate3D::getLODLevels().empty() ? "Distance LOD: Off" : "Distance LOD: On");
+}
+
+std::string Sprite3DCrowdTest::title() const
+{
+    return "Animated Crowd";
+}
+
+std::string Sprite3DCrowdTest::subtitle() const
+{
+    return "300 skinned orcs, toggle pose threads and LOD";
+}
+
+//
+// Sprite3DCompressedAnimationTest
+//
+Sprite3DCompressedAnimationTest::Sprite3DCompressedAnimationTest()
+{
+    auto s = Director::getInstance()->getWinSize();
+
+    // orc_compressed.c3b is orc.c3b through tools/c3b-animation-compressor
+    const char* fileNames[] = { "Sprite3DTest/orc.c3b", "Sprite3DTest/orc_compressed.c3b" };
+    const char* captions[] = { "Original", "Compressed" };
+    for (int i = 0; i < 2; ++i)
+    {
+        auto sprite = Sprite3D::create(fileNames[i]);
+        sprite->setScale(5);
+        sprite->setRotation3D(Vec3(0, 180, 0));
+        sprite->setPosition(Vec2(s.width * (i + 1) / 3, s.height * 0.3f));
+        addChild(sprite);
+
+        auto animation = Animation3D::create(fileNames[i]);
+        if (animation)
+            sprite->runAction(RepeatForever::create(Animate3D::create(animation)));
+
+        auto label = Label::createWithTTF(captions[i], "fonts/arial.ttf", 15);
+        label->setPosition(Vec2(s.width * (i + 1) / 3, s.height * 0.2f));
+        addChild(label);
+    }
+}
+
+std::string Sprite3DCompressedAnimationTest::title() const
+{
+    return "Compressed Animation";
+}
+
+std::string Sprite3DCompressedAnimationTest::subtitle() const
+{
+    return "Both orcs should move the same";
+}
+
+//
+// Sprite3DMappedMeshTest
+//
+Sprite3DMappedMeshTest::Sprite3DMappedMeshTest()
+{
+    auto s = Director::getInstance()->getWinSize();
+
+    // orc_mapped.c3b is orc.c3b through tools/c3b-model-converter
+    const char* fileNames[] = { "Sprite3DTest/orc.c3b", "Sprite3DTest/orc_mapped.c3b" };
+    const char* captions[] = { "Original", "Mapped" };
+    const int times = 50;
+    for (int i = 0; i < 2; ++i)
+    {
+        double milliseconds = measureLoad(fileNames[i], times);
+
+        auto sprite = Sprite3D::create(fileNames[i]);
+        sprite->setScale(5);
+        sprite->setRotation3D(Vec3(0, 180, 0));
+        sprite->setPosition(Vec2(s.width * (i + 1) / 3, s.height * 0.3f));
+        addChild(sprite);
+
+        auto animation = Animation3D::create(fileNames[i]);
+        if (animation)
+            sprite->runAction(RepeatForever::create(Animate3D::create(animation)));
+
+        auto label = Label::createWithTTF(StringUtils::format("%s\n%.3f ms per load", captions[i], milliseconds), "fonts/arial.ttf", 15);
+        label->setAlignment(TextHAlignment::CENTER);
+        label->setPosition(Vec2(s.width * (i + 1) / 3, s.height * 0.2f));
+        addChild(label);
+    }
+}
+
+double Sprite3DMappedMeshTest::measureLoad(const std::string& fileName, int times)
+{
+    auto path = FileUtils::getInstance()->fullPathForFilename(fileName);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < times; ++i)
+    {
+        // Sprite3D caches what it loads, so the bundle is used directly
+        auto bundle = Bundle3D::createBundle();
+        MeshDatas meshdatas;
+        if (bundle->load(path) && bundle->loadMeshDatas(meshdatas))
+        {
+            // the buffers are autoreleased at the end of the frame
+            for (const auto& meshdata : meshdatas.meshDatas)
+                MeshVertexData::create(*meshdata);
+        }
+        Bundle3D::destroyBundle(bundle);
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / times;
+}
+
+std::string Sprite3DMappedMeshTest::title() const
+{
+    return "Mapped Mesh";
+}
+
+std::string Sprite3DMappedMeshTest::subtitle() const
+{
+    return "Both orcs should look the same, the mapped one loads faster";
+}
+
+//
+// Sprite3DCullingTest
+//
+Sprite3DCullingTest::Sprite3DCullingTest()
+: _camera(nullptr)
+, _cullingItem(nullptr)
+, _info(nullptr)
+, _picked(nullptr)
+, _beforeDrawListener(nullptr)
+, _afterVisitListener(nullptr)
+, _angle(0.0f)
+, _drawTime(0.0f)
+, _frames(0)
+{
+    auto s = Director::getInstance()->getWinSize();
+
+    _camera = Camera::createPerspective(60, s.width / s.height, 1, 1000);
+    _camera->setCameraFlag(CameraFlag::USER1);
+    addChild(_camera);
+
+    // 20000 props on a 200 x 100 grid, the camera only sees a slice of them
+    const int columns = 200;
+    const int rows = 100;
+    const float spacing = 20.0f;
+    for (int row = 0; row < rows; ++row)
+    {
+        for (int column = 0; column < columns; ++column)
+        {
+            auto sprite = Sprite3D::create("Sprite3DTest/boss1.obj");
+            sprite->setTexture("Sprite3DTest/boss.png");
+            sprite->setPosition3D(Vec3((column - columns / 2) * spacing, 0, (row - rows / 2) * spacing));
+            sprite->setRotation3D(Vec3(0, (row * columns + column) % 360, 0));
+            sprite->setCameraMask((unsigned short)CameraFlag::USER1);
+            addChild(sprite);
+
+            // one prop in twenty keeps moving, which updates its box in the hierarchy
+            if ((row * columns + column) % 20 == 0)
+                _spinning.push_back(sprite);
+        }
+    }
+
+    MenuItemFont::setFontName("fonts/arial.ttf");
+    MenuItemFont::setFontSize(15);
+    _cullingItem = MenuItemFont::create("Culling: scene BVH", CC_CALLBACK_1(Sprite3DCullingTest::switchCullingCallback, this));
+    _cullingItem->setPosition(VisibleRect::left().x + 80, VisibleRect::top().y - 70);
+    auto menu = Menu::create(_cullingItem, nullptr);
+    menu->setPosition(Vec2::ZERO);
+    addChild(menu, 1);
+
+    _info = Label::createWithTTF("", "fonts/arial.ttf", 15);
+    _info->setAnchorPoint(Vec2(0, 1));
+    _info->setPosition(VisibleRect::left().x + 10, VisibleRect::top().y - 85);
+    addChild(_info, 1);
+
+    auto listener = EventListenerTouchAllAtOnce::create();
+    listener->onTouchesEnded = CC_CALLBACK_2(Sprite3DCullingTest::onTouchesEnded, this);
+    _eventDispatcher->addEventListenerWithSceneGraphPriority(listener, this);
+
+    // visit and render time, which is where the props are culled
+    auto dispatcher = Director::getInstance()->getEventDispatcher();
+    _beforeDrawListener = dispatcher->addCustomEventListener(Director::EVENT_BEFORE_DRAW, [this](EventCustom*) {
+        _drawStart = std::chrono::steady_clock::now();
+    });
+    _beforeDrawListener->retain();
+    _afterVisitListener = dispatcher->addCustomEventListener(Director::EVENT_AFTER_VISIT, [this](EventCustom*) {
+        _drawTime += std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - _drawStart).count();
+        if (++_frames < 30)
+            return;
+        auto bvh = getSceneBVH();
+        _info->setString(StringUtils::format("visit + render: %.2f ms\nprops in the hierarchy: %d, in the frustum: %d, tree height: %d",
+            _drawTime / _frames, bvh->getTree().getProxyCount(), bvh->getVisibleCount(), bvh->getTree().getHeight()));
+        _drawTime = 0.0f;
+        _frames = 0;
+    });
+    _afterVisitListener->retain();
+
+    scheduleUpdate();
+}
+
+Sprite3DCullingTest::~Sprite3DCullingTest()
+{
+    auto dispatcher = Director::getInstance()->getEventDispatcher();
+    dispatcher->removeEventListener(_beforeDrawListener);
+    dispatcher->removeEventListener(_afterVisitListener);
+    CC_SAFE_RELEASE(_beforeDrawListener);
+    CC_SAFE_RELEASE(_afterVisitListener);
+}
+
+void Sprite3DCullingTest::onExit()
+{
+    getSceneBVH()->setCullingEnabled(true);
+    Sprite3DTestDemo::onExit();
+}
+
+void Sprite3DCullingTest::update(float dt)
+{
+    _angle += dt * 0.2f;
+    _camera->setPosition3D(Vec3(600 * cosf(_angle), 80, 600 * sinf(_angle)));
+    _camera->lookAt(Vec3(0, 0, 0));
+
+    for (auto sprite : _spinning)
+    {
+        auto rotation = sprite->getRotation3D();
+        sprite->setRotation3D(Vec3(rotation.x, rotation.y + dt * 90, rotation.z));
+    }
+}
+
+void Sprite3DCullingTest::switchCullingCallback(Ref* sender)
+{
+    auto bvh = getSceneBVH();
+    bvh->setCullingEnabled(!bvh->isCullingEnabled());
+    _cullingItem->setString(bvh->isCullingEnabled() ? "Culling: scene BVH" : "Culling: per sprite");
+    _drawTime = 0.0f;
+    _frames = 0;
+}
+
+void Sprite3DCullingTest::onTouchesEnded(const std::vector<Touch*>& touches, Event* event)
+{
+    auto location = touches[0]->getLocationInView();
+    Vec3 nearP(location.x, location.y, -1.0f), farP(location.x, location.y, 1.0f);
+    nearP = _camera->unproject(nearP);
+    farP = _camera->unproject(farP);
+
+    // the ray query walks the same hierarchy as the culling
+    if (_picked)
+        _picked->setColor(Color3B::WHITE);
+    _picked = dynamic_cast<Sprite3D*>(getSceneBVH()->intersectRay(Ray(nearP, farP - nearP), nullptr, (unsigned short)CameraFlag::USER1));
+    if (_picked)
+        _picked->setColor(Color3B::RED);
+}
+
+std::string Sprite3DCullingTest::title() const
+{
+    return "Hierarchical Culling";
+}
+
+std::string Sprite3DCullingTest::subtitle() const
+{
+    return "20000 props, tap one to pick it with a ray";
+}
+
+//
+// Sprite3DOcclusionTest
+//
+Sprite3DOcclusionTest::Sprite3DOcclusionTest()
+: _camera(nullptr)
+, _occlusionItem(nullptr)
+, _info(nullptr)
+, _angle(0.0f)
+, _infoTime(0.0f)
+{
+    auto s = Director::getInstance()->getWinSize();
+
+    _camera = Camera::createPerspective(60, s.width / s.height, 1, 2000);
+    _camera->setCameraFlag(CameraFlag::USER1);
+    addChild(_camera);
+
+    // the box itself is its own low-poly occluder, built from its bounding box
+    static const unsigned short boxIndices[] = {
+        0, 1, 2, 0, 2, 3, 3, 2, 5, 3, 5, 4, 4, 5, 6, 4, 6, 7,
+        7, 6, 1, 7, 1, 0, 7, 0, 3, 7, 3, 4, 1, 6, 5, 1, 5, 2 };
+    std::vector<unsigned short> indices(boxIndices, boxIndices + 36);
+
+    // a 10 x 10 block city, with props in the streets between the buildings
+    const int blocks = 10;
+    const float blockSize = 100.0f;
+    for (int row = 0; row < blocks; ++row)
+    {
+        for (int column = 0; column < blocks; ++column)
+        {
+            Vec3 center((column - blocks / 2 + 0.5f) * blockSize, 0, (row - blocks / 2 + 0.5f) * blockSize);
+
+            auto building = Sprite3D::create("Sprite3DTest/box.c3t");
+            building->setTexture("Images/CyanSquare.png");
+            building->setScaleX(70.0f);
+            building->setScaleY(60.0f + 40.0f * ((row * blocks + column) % 3));
+            building->setScaleZ(70.0f);
+            building->setPosition3D(center);
+            building->setCameraMask((unsigned short)CameraFlag::USER1);
+            AABB box;
+            for (const auto& mesh : building->getMeshes())
+                box.merge(mesh->getMeshIndexData()->getAABB());
+            Vec3 corners[8];
+            box.getCorners(corners);
+            building->setOccluder(std::vector<Vec3>(corners, corners + 8), indices);
+            addChild(building);
+
+            for (int i = 0; i < 20; ++i)
+            {
+                auto sprite = Sprite3D::create("Sprite3DTest/boss1.obj");
+                sprite->setTexture("Sprite3DTest/boss.png");
+                sprite->setScale(0.5f);
+                float along = (i % 10 - 4.5f) * 9.0f;
+                float across = i < 10 ? 45.0f : -45.0f;
+                sprite->setPosition3D(center + (i % 4 < 2 ? Vec3(along, 0, across) : Vec3(across, 0, along)));
+                sprite->setCameraMask((unsigned short)CameraFlag::USER1);
+                addChild(sprite);
+            }
+        }
+    }
+
+    MenuItemFont::setFontName("fonts/arial.ttf");
+    MenuItemFont::setFontSize(15);
+    _occlusionItem = MenuItemFont::create("Occlusion culling: on", CC_CALLBACK_1(Sprite3DOcclusionTest::switchOcclusionCallback, this));
+    _occlusionItem->setPosition(VisibleRect::left().x + 80, VisibleRect::top().y - 70);
+    auto menu = Menu::create(_occlusionItem, nullptr);
+    menu->setPosition(Vec2::ZERO);
+    addChild(menu, 1);
+
+    _info = Label::createWithTTF("", "fonts/arial.ttf", 15);
+    _info->setAnchorPoint(Vec2(0, 1));
+    _info->setPosition(VisibleRect::left().x + 10, VisibleRect::top().y - 85);
+    addChild(_info, 1);
+
+    scheduleUpdate();
+}
+
+void Sprite3DOcclusionTest::onExit()
+{
+    getSceneBVH()->setOcclusionCullingEnabled(true);
+    Sprite3DTestDemo::onExit();
+}
+
+void Sprite3DOcclusionTest::update(float dt)
+{
+    // walk around the city at street level, where the buildings hide most of it
+    _angle += dt * 0.1f;
+    _camera->setPosition3D(Vec3(500 * cosf(_angle), 10, 500 * sinf(_angle)));
+    _camera->lookAt(Vec3(0, 10, 0));
+
+    _infoTime += dt;
+    if (_infoTime < 0.5f)
+        return;
+    _infoTime = 0.0f;
+    auto bvh = getSceneBVH();
+    _info->setString(StringUtils::format("visible: %d, hidden: %d, occluders drawn: %d\ndraw calls: %d",
+        bvh->getVisibleCount(), bvh->getOccludedCount(), bvh->getOccluderCount(),
+        (int)Director::getInstance()->getRenderer()->getDrawnBatches()));
+}
+
+void Sprite3DOcclusionTest::switchOcclusionCallback(Ref* sender)
+{
+    auto bvh = getSceneBVH();
+    bvh->setOcclusionCullingEnabled(!bvh->isOcclusionCullingEnabled());
+    _occlusionItem->setString(bvh->isOcclusionCullingEnabled() ? "Occlusion culling: on" : "Occlusion culling: off");
+}
+
+std::string Sprite3DOcclusionTest::title() const
+{
+    return "Occlusion Culling";
+}
+
+std::string Sprite3DOcclusionTest::subtitle() const
+{
+    return "The buildings hide the props behind them";
+}
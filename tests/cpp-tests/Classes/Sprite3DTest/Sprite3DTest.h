@@ -28,6 +28,7 @@
 
 #include "BaseTest.h"
 #include <string>
+#include <chrono>
 
 namespace cocos2d {
     class Animate3D;
@@ -215,6 +216,25 @@ protected:
     std::vector<std::string> _paths; //model paths to be loaded
 };
 
+class Sprite3DAsyncLoaderTest : public Sprite3DTestDemo
+{
+public:
+    CREATE_FUNC(Sprite3DAsyncLoaderTest);
+    Sprite3DAsyncLoaderTest();
+    virtual ~Sprite3DAsyncLoaderTest();
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    
+    void loadAll(cocos2d::Ref* sender);
+    void cancelAll(cocos2d::Ref* sender);
+    
+protected:
+    std::vector<std::string> _paths;
+    std::vector<cocos2d::Label*> _progressLabels;
+    cocos2d::Vector<cocos2d::Sprite3DAsyncLoader*> _loaders;
+    cocos2d::Node* _models;
+};
+
 class Sprite3DWithSkinTest : public Sprite3DTestDemo
 {
 public:
@@ -627,4 +647,100 @@ public:
     virtual std::string subtitle() const override;
 };
 
+class Sprite3DCrowdTest : public Sprite3DTestDemo
+{
+public:
+    CREATE_FUNC(Sprite3DCrowdTest);
+    Sprite3DCrowdTest();
+    virtual ~Sprite3DCrowdTest();
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    virtual void onExit() override;
+
+    void switchSchedulerCallback(cocos2d::Ref* sender);
+    void switchLODCallback(cocos2d::Ref* sender);
+
+protected:
+    void refreshMenu();
+
+    cocos2d::MenuItemFont* _schedulerItem;
+    cocos2d::MenuItemFont* _lodItem;
+    cocos2d::Label* _info;
+    cocos2d::EventListenerCustom* _beforeUpdateListener;
+    cocos2d::EventListenerCustom* _afterVisitListener;
+    std::chrono::steady_clock::time_point _frameStart;
+    float _frameTime;
+    int _frames;
+};
+
+class Sprite3DCompressedAnimationTest : public Sprite3DTestDemo
+{
+public:
+    CREATE_FUNC(Sprite3DCompressedAnimationTest);
+    Sprite3DCompressedAnimationTest();
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+};
+
+class Sprite3DMappedMeshTest : public Sprite3DTestDemo
+{
+public:
+    CREATE_FUNC(Sprite3DMappedMeshTest);
+    Sprite3DMappedMeshTest();
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+
+protected:
+    // average milliseconds to load the meshes of a file and upload them
+    static double measureLoad(const std::string& fileName, int times);
+};
+
+class Sprite3DCullingTest : public Sprite3DTestDemo
+{
+public:
+    CREATE_FUNC(Sprite3DCullingTest);
+    Sprite3DCullingTest();
+    virtual ~Sprite3DCullingTest();
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    virtual void onExit() override;
+    virtual void update(float dt) override;
+
+    void switchCullingCallback(cocos2d::Ref* sender);
+    void onTouchesEnded(const std::vector<cocos2d::Touch*>& touches, cocos2d::Event* event);
+
+protected:
+    cocos2d::Camera* _camera;
+    cocos2d::MenuItemFont* _cullingItem;
+    cocos2d::Label* _info;
+    cocos2d::Sprite3D* _picked;
+    std::vector<cocos2d::Sprite3D*> _spinning;
+    cocos2d::EventListenerCustom* _beforeDrawListener;
+    cocos2d::EventListenerCustom* _afterVisitListener;
+    std::chrono::steady_clock::time_point _drawStart;
+    float _angle;
+    float _drawTime;
+    int _frames;
+};
+
+class Sprite3DOcclusionTest : public Sprite3DTestDemo
+{
+public:
+    CREATE_FUNC(Sprite3DOcclusionTest);
+    Sprite3DOcclusionTest();
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    virtual void onExit() override;
+    virtual void update(float dt) override;
+
+    void switchOcclusionCallback(cocos2d::Ref* sender);
+
+protected:
+    cocos2d::Camera* _camera;
+    cocos2d::MenuItemFont* _occlusionItem;
+    cocos2d::Label* _info;
+    float _angle;
+    float _infoTime;
+};
+
 #endif
@@ -38,6 +38,7 @@ SpriteFrameCacheTests::SpriteFrameCacheTests()
     ADD_TEST_CASE(SpriteFrameCachePixelFormatTest);
     ADD_TEST_CASE(SpriteFrameCacheLoadMultipleTimes);
     ADD_TEST_CASE(SpriteFrameCacheFullCheck);
+    ADD_TEST_CASE(DynamicAtlasCacheTest);
 }
 
 SpriteFrameCachePixelFormatTest::SpriteFrameCachePixelFormatTest()
@@ -140,3 +141,59 @@ void SpriteFrameCacheFullCheck::loadSpriteFrames(const std::string &file, cocos2
     cache->addSpriteFramesWithFile(file);
     CCASSERT(cache->isSpriteFramesWithFileLoaded(file) == true, "Plist should be full after reloaded");
 }
+
+void DynamicAtlasCacheTest::onEnter()
+{
+    TestCase::onEnter();
+
+    const Size screenSize = Director::getInstance()->getWinSize();
+    auto atlasCache = DynamicAtlasCache::getInstance();
+    atlasCache->setEnabled(true);
+
+    // every sprite comes from its own file, but they should all end up on one page
+    const char* files[] = {
+        "Images/grossini_dance_01.png", "Images/grossini_dance_02.png", "Images/grossini_dance_03.png",
+        "Images/grossini_dance_04.png", "Images/grossini_dance_05.png", "Images/grossini_dance_06.png",
+        "Images/grossini_dance_07.png", "Images/grossini_dance_08.png", "Images/grossini_dance_09.png",
+        "Images/b1.png", "Images/f1.png", "Images/r1.png",
+    };
+
+    Texture2D* sharedTexture = nullptr;
+    bool sharesPage = true;
+    int column = 0;
+    for (auto file : files)
+    {
+        auto sprite = Sprite::create(file);
+        sprite->setPosition(screenSize.width * (column % 6 + 1) / 7, screenSize.height * (column < 6 ? 0.6f : 0.35f));
+        addChild(sprite);
+
+        CCASSERT(atlasCache->hasSpriteFrame(file), "Small images should be packed");
+        if (sharedTexture != nullptr && sharedTexture != sprite->getTexture())
+            sharesPage = false;
+        sharedTexture = sprite->getTexture();
+        ++column;
+    }
+
+    auto stats = atlasCache->getStats();
+    auto label = Label::createWithSystemFont(StringUtils::format("%d frames on %d page(s), %.1f%% used, sprites %s one page",
+                                                                 stats.frames,
+                                                                 stats.pages,
+                                                                 stats.pagePixels > 0 ? stats.usedPixels * 100.0f / stats.pagePixels : 0.0f,
+                                                                 sharesPage ? "share" : "do NOT share"),
+                                             "", 14);
+    label->setPosition(screenSize.width / 2, screenSize.height * 0.2f);
+    addChild(label);
+
+    log("%s", atlasCache->getCachedAtlasInfo().c_str());
+}
+
+void DynamicAtlasCacheTest::onExit()
+{
+    auto atlasCache = DynamicAtlasCache::getInstance();
+    atlasCache->setEnabled(false);
+
+    TestCase::onExit();
+    removeAllChildren();
+    atlasCache->removeUnusedSpriteFrames();
+}
+
@@ -76,4 +76,16 @@ public:
 private:
     void loadSpriteFrames(const std::string &file, cocos2d::Texture2D::PixelFormat expectedFormat);
 
-};
\ No newline at end of file
+};
+
+class DynamicAtlasCacheTest : public TestCase
+{
+public:
+    CREATE_FUNC(DynamicAtlasCacheTest);
+
+    virtual std::string title() const override { return "Dynamic atlas"; }
+    virtual std::string subtitle() const override { return "Loose images share one texture and batch"; }
+
+    virtual void onEnter() override;
+    virtual void onExit() override;
+};
@@ -31,6 +31,7 @@ TerrainTests::TerrainTests()
     ADD_TEST_CASE(TerrainSimple);
     ADD_TEST_CASE(TerrainWalkThru);
     ADD_TEST_CASE(TerrainWithLightMap);
+    ADD_TEST_CASE(TerrainStreaming);
 }
 
 Vec3 camera_offset(0, 45, 60);
@@ -397,3 +398,97 @@ void TerrainWithLightMap::onTouchesMoved(const std::vector<cocos2d::Touch*>& tou
     cameraPos+=cameraRightDir*newPos.x*0.5*delta;
     _camera->setPosition3D(cameraPos);
 }
+
+TerrainStreaming::TerrainStreaming()
+: _pager(nullptr)
+, _camera(nullptr)
+, _info(nullptr)
+, _angle(0.0f)
+{
+    Size visibleSize = Director::getInstance()->getVisibleSize();
+
+    _camera = Camera::createPerspective(60, visibleSize.width / visibleSize.height, 0.1f, 400);
+    _camera->setCameraFlag(CameraFlag::USER1);
+    addChild(_camera);
+
+    // 8 x 8 tiles of 129 x 129 pixels, 1024 x 1024 units, never loaded at once
+    const int tileSize = 129;
+    const int tiles = 8;
+    Terrain::TerrainData tileData("", "TerrainTest/Grass2.jpg", Size(32, 32), 60.0f, 1.0f);
+    tileData._detailMaps[0]._detailMapSize = 8;
+    TerrainPager::PagerData data(generateTiles(tileSize, tiles, tiles), tileSize, tiles, tiles, tileData);
+    data._loadDistance = 200;
+    data._memoryBudget = 48 * 1024 * 1024;
+    _pager = TerrainPager::create(data);
+    _pager->setCameraMask((unsigned short)CameraFlag::USER1);
+    addChild(_pager);
+
+    _info = Label::createWithTTF("", "fonts/arial.ttf", 15);
+    _info->setAnchorPoint(Vec2(0, 1));
+    _info->setPosition(VisibleRect::left().x + 10, VisibleRect::top().y - 70);
+    addChild(_info, 1);
+
+    scheduleUpdate();
+}
+
+std::string TerrainStreaming::generateTiles(int tileSize, int tilesX, int tilesY)
+{
+    auto fileUtils = FileUtils::getInstance();
+    auto directory = fileUtils->getWritablePath() + "TerrainStreaming/";
+    auto pattern = directory + "height_%d_%d.png";
+    if (fileUtils->isFileExist(StringUtils::format(pattern.c_str(), tilesX - 1, tilesY - 1)))
+        return pattern;
+
+    fileUtils->createDirectory(directory);
+    std::vector<unsigned char> pixels(tileSize * tileSize * 4, 255);
+    for (int y = 0; y < tilesY; ++y)
+    {
+        for (int x = 0; x < tilesX; ++x)
+        {
+            for (int j = 0; j < tileSize; ++j)
+            {
+                for (int i = 0; i < tileSize; ++i)
+                {
+                    // the last row and column of a tile are the first ones of the next
+                    float u = x * (tileSize - 1) + i;
+                    float v = y * (tileSize - 1) + j;
+                    float height = 0.5f + 0.3f * sinf(u * 0.013f) * cosf(v * 0.011f) + 0.15f * sinf(u * 0.041f + v * 0.037f);
+                    auto value = (unsigned char)(clampf(height, 0.0f, 1.0f) * 255);
+                    auto pixel = &pixels[(j * tileSize + i) * 4];
+                    pixel[0] = pixel[1] = pixel[2] = value;
+                }
+            }
+            auto image = new (std::nothrow) Image();
+            image->initWithRawData(pixels.data(), pixels.size(), tileSize, tileSize, 8);
+            image->saveToFile(StringUtils::format(pattern.c_str(), x, y), true);
+            image->release();
+        }
+    }
+    return pattern;
+}
+
+void TerrainStreaming::update(float dt)
+{
+    // fly around the map, the tiles ahead are loaded and the ones behind removed
+    _angle += dt * 0.05f;
+    Vec3 position(350 * cosf(_angle), 0, 350 * sinf(_angle));
+    Vec3 ahead(350 * cosf(_angle + 0.1f), 0, 350 * sinf(_angle + 0.1f));
+    position.y = _pager->getHeight(position.x, position.z) + 25;
+    ahead.y = position.y - 5;
+    _camera->setPosition3D(position);
+    _camera->lookAt(ahead);
+
+    _info->setString(StringUtils::format("tiles loaded: %d, loading: %d\nmemory: %.1f MB of %.1f MB",
+        _pager->getLoadedTileCount(), _pager->getLoadingTileCount(),
+        _pager->getMemoryUsage() / (1024.0f * 1024.0f), _pager->getMemoryBudget() / (1024.0f * 1024.0f)));
+}
+
+std::string TerrainStreaming::title() const
+{
+    return "Terrain streaming";
+}
+
+std::string TerrainStreaming::subtitle() const
+{
+    return "Tiles are loaded around the camera";
+}
@@ -28,6 +28,7 @@
 
 #include "3d/CCSprite3D.h"
 #include "3d/CCTerrain.h"
+#include "3d/CCTerrainPager.h"
 #include "2d/CCCamera.h"
 #include "2d/CCAction.h"
 
@@ -110,4 +111,23 @@ protected:
     cocos2d::Camera* _camera;
 };
 
+class TerrainStreaming : public TerrainTestDemo
+{
+public:
+    CREATE_FUNC(TerrainStreaming);
+    TerrainStreaming();
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+    virtual void update(float dt) override;
+
+protected:
+    // writes the height map tiles of a generated landscape, with shared borders
+    static std::string generateTiles(int tileSize, int tilesX, int tilesY);
+
+    cocos2d::TerrainPager* _pager;
+    cocos2d::Camera* _camera;
+    cocos2d::Label* _info;
+    float _angle;
+};
+
 #endif // !TERRAIN_TESH_H
@@ -27,6 +27,9 @@
 // local import
 #include "Texture2dTest.h"
 #include "../testResource.h"
+#include "base/etc1.h"
+#include "base/ktx2.h"
+#include "base/s3tc.h"
 
 USING_NS_CC;
 
@@ -109,6 +112,8 @@ Texture2DTests::Texture2DTests()
     ADD_TEST_CASE(TextureConvertRGBA8888);
     ADD_TEST_CASE(TextureConvertI8);
     ADD_TEST_CASE(TextureConvertAI88);
+    ADD_TEST_CASE(TextureStripUpload);
+    ADD_TEST_CASE(TextureKTX2Transcode);
 };
 
 //------------------------------------------------------------------
@@ -2345,3 +2350,170 @@ std::string TextureConvertAI88::subtitle() const
 {
     return "RGBA8888,RGB888,RGB565,A8,I8,AI88,RGBA4444,RGB5A1";
 }
+
+//------------------------------------------------------------------
+//
+// TextureStripUpload
+//
+//------------------------------------------------------------------
+void TextureStripUpload::onEnter()
+{
+    TextureDemo::onEnter();
+
+    auto s = Director::getInstance()->getWinSize();
+
+    const char* images[] = { "Images/test_image.png", "Images/test_image.jpeg" };
+    const Texture2D::PixelFormat formats[] = { Texture2D::PixelFormat::AUTO, Texture2D::PixelFormat::RGB565 };
+
+    int column = 0;
+    for (auto path : images)
+    {
+        auto data = FileUtils::getInstance()->getDataFromFile(path);
+        for (auto format : formats)
+        {
+            // top row: decoded and uploaded strip by strip, bottom row: decoded into an Image first
+            auto stripTexture = new (std::nothrow) Texture2D();
+            if (stripTexture && stripTexture->initWithImageDataInStrips(data.getBytes(), data.getSize(), format))
+            {
+                auto sprite = Sprite::createWithTexture(stripTexture);
+                sprite->setScale(0.25f);
+                sprite->setPosition(Vec2((column + 1) * s.width / 5, s.height * 2 / 3));
+                addChild(sprite);
+            }
+            CC_SAFE_RELEASE(stripTexture);
+
+            auto image = new (std::nothrow) Image();
+            auto texture = new (std::nothrow) Texture2D();
+            if (image && texture && image->initWithImageData(data.getBytes(), data.getSize()) && texture->initWithImage(image, format))
+            {
+                auto sprite = Sprite::createWithTexture(texture);
+                sprite->setScale(0.25f);
+                sprite->setPosition(Vec2((column + 1) * s.width / 5, s.height / 3));
+                addChild(sprite);
+            }
+            CC_SAFE_RELEASE(texture);
+            CC_SAFE_RELEASE(image);
+
+            ++column;
+        }
+    }
+}
+
+std::string TextureStripUpload::title() const
+{
+    return "Strip upload test";
+}
+
+std::string TextureStripUpload::subtitle() const
+{
+    return "Both rows should look the same";
+}
+
+//------------------------------------------------------------------
+//
+// TextureKTX2Transcode
+//
+//------------------------------------------------------------------
+namespace {
+
+// Builds a single level KTX2 container holding ETC1 blocks, the universal payload.
+std::vector<unsigned char> createETC1KTX2(const std::vector<unsigned char>& rgb, uint32_t width, uint32_t height)
+{
+    const unsigned char identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+    const uint32_t headerSize = 80 + 24;
+
+    uint32_t payloadSize = etc1_get_encoded_data_size(width, height);
+    std::vector<unsigned char> file(headerSize + payloadSize, 0);
+    memcpy(&file[0], identifier, sizeof(identifier));
+
+    uint32_t header[9] = { static_cast<uint32_t>(KTX2Format::ETC2_R8G8B8_UNORM), 1, width, height, 0, 0, 1, 1, 0 };
+    memcpy(&file[12], header, sizeof(header));
+
+    uint64_t level[3] = { headerSize, payloadSize, payloadSize };
+    memcpy(&file[80], level, sizeof(level));
+
+    etc1_encode_image(rgb.data(), width, height, 3, width * 3, &file[headerSize]);
+    return file;
+}
+
+} // namespace
+
+void TextureKTX2Transcode::onEnter()
+{
+    TextureDemo::onEnter();
+
+    auto s = Director::getInstance()->getWinSize();
+
+    const uint32_t width = 128;
+    const uint32_t height = 128;
+    std::vector<unsigned char> rgb(width * height * 3);
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            unsigned char* p = &rgb[(y * width + x) * 3];
+            p[0] = static_cast<unsigned char>(x * 2);
+            p[1] = static_cast<unsigned char>(y * 2);
+            p[2] = ((x / 16 + y / 16) % 2) ? 255 : 64;
+        }
+    }
+    auto file = createETC1KTX2(rgb, width, height);
+
+    // left: loaded through Image, transcoded to whatever this GPU supports
+    auto image = new (std::nothrow) Image();
+    auto texture = new (std::nothrow) Texture2D();
+    if (image && texture && image->initWithImageData(file.data(), file.size()) && texture->initWithImage(image))
+    {
+        auto sprite = Sprite::createWithTexture(texture);
+        sprite->setPosition(Vec2(s.width / 3, s.height / 2));
+        addChild(sprite);
+
+        auto label = Label::createWithTTF(texture->getStringForFormat(), "fonts/arial.ttf", 14);
+        label->setPosition(Vec2(s.width / 3, s.height / 2 - 80));
+        addChild(label);
+    }
+    CC_SAFE_RELEASE(texture);
+    CC_SAFE_RELEASE(image);
+
+    // right: the CPU fallback, plus a check that the DXT1 transcode stays close to it
+    const unsigned char* blocks = file.data() + 80 + 24;
+    std::vector<unsigned char> decoded(ktx2_transcoded_size(width, height, KTX2TranscodeTarget::RGB888));
+    ktx2_transcode_etc1(blocks, width, height, KTX2TranscodeTarget::RGB888, decoded.data());
+
+    std::vector<unsigned char> dxt1(ktx2_transcoded_size(width, height, KTX2TranscodeTarget::DXT1));
+    ktx2_transcode_etc1(blocks, width, height, KTX2TranscodeTarget::DXT1, dxt1.data());
+    std::vector<unsigned char> dxt1Decoded(width * height * 4);
+    s3tc_decode(dxt1.data(), dxt1Decoded.data(), width, height, S3TCDecodeFlag::DXT1);
+
+    int maxError = 0;
+    for (uint32_t i = 0; i < width * height; ++i)
+    {
+        for (int c = 0; c < 3; ++c)
+        {
+            maxError = std::max(maxError, std::abs(decoded[i * 3 + c] - dxt1Decoded[i * 4 + c]));
+        }
+    }
+
+    auto cpuTexture = new (std::nothrow) Texture2D();
+    if (cpuTexture && cpuTexture->initWithData(decoded.data(), decoded.size(), Texture2D::PixelFormat::RGB888, width, height, Size(width, height)))
+    {
+        auto sprite = Sprite::createWithTexture(cpuTexture);
+        sprite->setPosition(Vec2(s.width * 2 / 3, s.height / 2));
+        addChild(sprite);
+    }
+    CC_SAFE_RELEASE(cpuTexture);
+
+    auto label = Label::createWithTTF(StringUtils::format("CPU decode, DXT1 max error: %d", maxError), "fonts/arial.ttf", 14);
+    label->setPosition(Vec2(s.width * 2 / 3, s.height / 2 - 80));
+    addChild(label);
+}
+
+std::string TextureKTX2Transcode::title() const
+{
+    return "KTX2 universal texture";
+}
+
+std::string TextureKTX2Transcode::subtitle() const
+{
+    return "Both textures should look the same";
+}
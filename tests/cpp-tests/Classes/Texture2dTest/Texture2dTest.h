@@ -649,4 +649,22 @@ public:
     virtual std::string subtitle() const override;
 };
 
+class TextureStripUpload : public TextureDemo
+{
+public:
+    CREATE_FUNC(TextureStripUpload);
+    virtual void onEnter() override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+};
+
+class TextureKTX2Transcode : public TextureDemo
+{
+public:
+    CREATE_FUNC(TextureKTX2Transcode);
+    virtual void onEnter() override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+};
+
 #endif // __TEXTURE2D_TEST_H__
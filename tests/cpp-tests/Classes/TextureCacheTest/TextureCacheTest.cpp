@@ -33,6 +33,7 @@ TextureCacheTests::TextureCacheTests()
 {
     ADD_TEST_CASE(TextureCacheTest);
     ADD_TEST_CASE(TextureCacheUnbindTest);
+    ADD_TEST_CASE(TextureCacheBudgetTest);
 }
 
 TextureCacheTest::TextureCacheTest()
@@ -204,3 +205,74 @@ void TextureCacheUnbindTest::textureLoadedB(Texture2D* texture)
   s->setPosition(3 * size.width / 4, size.height / 2);
   this->addChild(s);
 }
+
+TextureCacheBudgetTest::TextureCacheBudgetTest()
+{
+    auto size = Director::getInstance()->getWinSize();
+    auto cache = Director::getInstance()->getTextureCache();
+
+    _defaultBudget = cache->getMemoryBudget();
+    _defaultGracePeriod = cache->getEvictionGracePeriod();
+
+    // half of the sprites are hidden at any time, their textures are evicted and reloaded when shown again
+    cache->setEvictionGracePeriod(10);
+
+    for (int i = 1; i <= 8; ++i)
+    {
+        auto sprite = Sprite::create(StringUtils::format("Images/grossini_dance_%02d.png", i));
+        sprite->setPosition(size.width * i / 9, size.height / 2);
+        sprite->setVisible(i % 2 == 0);
+        addChild(sprite);
+        _sprites.pushBack(sprite);
+    }
+
+    cache->setMemoryBudget(cache->getTextureMemory() / 2);
+
+    _labelInfo = Label::createWithTTF("", "fonts/arial.ttf", 15);
+    _labelInfo->setPosition(size.width / 2, size.height / 4);
+    addChild(_labelInfo);
+
+    schedule(CC_SCHEDULE_SELECTOR(TextureCacheBudgetTest::toggleSprites), 1.0f);
+    schedule(CC_SCHEDULE_SELECTOR(TextureCacheBudgetTest::updateInfo));
+}
+
+void TextureCacheBudgetTest::toggleSprites(float /*dt*/)
+{
+    for (auto sprite : _sprites)
+    {
+        sprite->setVisible(!sprite->isVisible());
+    }
+    Director::getInstance()->getTextureCache()->trimToMemoryBudget();
+}
+
+void TextureCacheBudgetTest::updateInfo(float /*dt*/)
+{
+    int evicted = 0;
+    for (auto sprite : _sprites)
+    {
+        if (sprite->getTexture()->isEvicted())
+            ++evicted;
+    }
+
+    auto cache = Director::getInstance()->getTextureCache();
+    _labelInfo->setString(StringUtils::format("%lu KB in use, budget %lu KB, %d evicted",
+        (unsigned long)cache->getTextureMemory() / 1024, (unsigned long)cache->getMemoryBudget() / 1024, evicted));
+}
+
+void TextureCacheBudgetTest::onExit()
+{
+    auto cache = Director::getInstance()->getTextureCache();
+    cache->setMemoryBudget(_defaultBudget);
+    cache->setEvictionGracePeriod(_defaultGracePeriod);
+    TestCase::onExit();
+}
+
+std::string TextureCacheBudgetTest::title() const
+{
+    return "TextureCache memory budget";
+}
+
+std::string TextureCacheBudgetTest::subtitle() const
+{
+    return "Hidden sprites are evicted and reloaded when shown";
+}
@@ -61,4 +61,25 @@ private:
     void textureLoadedB(cocos2d::Texture2D* texture);
 };
 
+class TextureCacheBudgetTest : public TestCase
+{
+public:
+    CREATE_FUNC(TextureCacheBudgetTest);
+
+    TextureCacheBudgetTest();
+
+    virtual void onExit() override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+
+private:
+    void toggleSprites(float dt);
+    void updateInfo(float dt);
+
+    cocos2d::Vector<cocos2d::Sprite*> _sprites;
+    cocos2d::Label* _labelInfo;
+    size_t _defaultBudget;
+    unsigned int _defaultGracePeriod;
+};
+
 #endif // _TEXTURECACHE_TEST_H_
@@ -42,6 +42,7 @@ UILayoutTests::UILayoutTests()
     ADD_TEST_CASE(UILayoutComponentTest);
     ADD_TEST_CASE(UILayoutComponent_Berth_Test);
     ADD_TEST_CASE(UILayoutComponent_Berth_Stretch_Test);
+    ADD_TEST_CASE(UILayoutTest_Deferred_Layout);
 }
 
 // UILayoutTest
@@ -956,3 +957,75 @@ bool UILayoutComponent_Berth_Stretch_Test::init()
     }
     return false;
 }
+
+// UILayoutTest_Deferred_Layout
+
+bool UILayoutTest_Deferred_Layout::init()
+{
+    if (!UIScene::init())
+    {
+        return false;
+    }
+    _elapsed = 0.0f;
+
+    Size widgetSize = _widget->getContentSize();
+
+    Text* alert = Text::create("Deferred Layout: nested boxes resized every frame", "fonts/Marker Felt.ttf", 20);
+    alert->setColor(Color3B(159, 168, 176));
+    alert->setPosition(Vec2(widgetSize.width / 2.0f, widgetSize.height / 2.0f - alert->getContentSize().height * 4.5f));
+    _uiLayer->addChild(alert);
+
+    _statsLabel = Text::create("", "fonts/Marker Felt.ttf", 14);
+    _statsLabel->setPosition(Vec2(widgetSize.width / 2.0f, widgetSize.height / 2.0f + 110.0f));
+    _uiLayer->addChild(_statsLabel);
+
+    // a VBox of HBoxes of VBoxes, every leaf resize dirties its box, which dirties its parent
+    VBox* root = VBox::create(Size(320, 180));
+    root->setBackGroundColorType(Layout::BackGroundColorType::SOLID);
+    root->setBackGroundColor(Color3B(40, 40, 40));
+    root->setPosition(Vec2((widgetSize.width - 320) / 2.0f, (widgetSize.height - 180) / 2.0f));
+    _uiLayer->addChild(root);
+
+    for (int row = 0; row < 3; ++row)
+    {
+        HBox* hbox = HBox::create(Size(320, 60));
+        root->addChild(hbox);
+        for (int column = 0; column < 8; ++column)
+        {
+            VBox* vbox = VBox::create(Size(40, 60));
+            hbox->addChild(vbox);
+            for (int i = 0; i < 2; ++i)
+            {
+                ImageView* leaf = ImageView::create("cocosui/switch-mask.png");
+                leaf->ignoreContentAdaptWithSize(false);
+                leaf->setScale9Enabled(true);
+                leaf->setContentSize(Size(30, 20));
+                LinearLayoutParameter* parameter = LinearLayoutParameter::create();
+                parameter->setGravity(LinearLayoutParameter::LinearGravity::CENTER_HORIZONTAL);
+                parameter->setMargin(Margin(0, 5, 0, 0));
+                leaf->setLayoutParameter(parameter);
+                vbox->addChild(leaf);
+                _leaves.pushBack(leaf);
+            }
+        }
+    }
+
+    scheduleUpdate();
+    return true;
+}
+
+void UILayoutTest_Deferred_Layout::update(float dt)
+{
+    _elapsed += dt;
+    for (ssize_t i = 0; i < _leaves.size(); ++i)
+    {
+        float height = 15.0f + 8.0f * (1.0f + sinf(_elapsed * 3.0f + i * 0.4f)) * 0.5f;
+        _leaves.at(i)->setContentSize(Size(30, height));
+    }
+
+    LayoutScheduler* scheduler = LayoutScheduler::getInstance();
+    _statsLabel->setString(StringUtils::format("passes: %u  layouts: %u  requests: %u per frame",
+                                               scheduler->getLastFramePassCount(),
+                                               scheduler->getLastFrameLayoutCount(),
+                                               scheduler->getLastFrameRequestCount()));
+}
@@ -162,4 +162,18 @@ public:
     CREATE_FUNC(UILayoutComponent_Berth_Stretch_Test);
 };
 
+class UILayoutTest_Deferred_Layout : public UIScene
+{
+public:
+    CREATE_FUNC(UILayoutTest_Deferred_Layout);
+
+    virtual bool init() override;
+    virtual void update(float dt) override;
+
+protected:
+    cocos2d::Vector<cocos2d::ui::Widget*> _leaves;
+    cocos2d::ui::Text* _statsLabel;
+    float _elapsed;
+};
+
 #endif /* defined(__TestCpp__UILayoutTest__) */
@@ -39,6 +39,7 @@ UIListViewTests::UIListViewTests()
     ADD_TEST_CASE(UIListViewTest_MagneticHorizontal);
     ADD_TEST_CASE(UIListViewTest_PaddingVertical);
     ADD_TEST_CASE(UIListViewTest_PaddingHorizontal);
+    ADD_TEST_CASE(UIListViewTest_Virtualized);
     ADD_TEST_CASE(Issue12692);
     ADD_TEST_CASE(Issue8316);
 }
@@ -1081,3 +1082,113 @@ void UIListViewTest_Padding::sliderEvent(Ref *pSender, Slider::EventType type)
         }
     }
 }
+
+// UIListViewTest_Virtualized
+
+static const ssize_t VIRTUALIZED_ITEM_COUNT = 10000;
+
+bool UIListViewTest_Virtualized::init()
+{
+    if(!UIScene::init())
+    {
+        return false;
+    }
+    _createdCellCount = 0;
+
+    Size layerSize = _uiLayer->getContentSize();
+
+    auto title = Text::create("10000 rows, only the visible ones exist", "fonts/Marker Felt.ttf", 24);
+    title->setAnchorPoint(Vec2::ANCHOR_MIDDLE);
+    title->setPosition(Vec2(layerSize / 2) + Vec2(0, title->getContentSize().height * 4.5f));
+    _uiLayer->addChild(title, 3);
+
+    _statusLabel = Text::create("", "fonts/Marker Felt.ttf", 14);
+    _statusLabel->setAnchorPoint(Vec2::ANCHOR_MIDDLE);
+    _statusLabel->setPosition(Vec2(layerSize.width / 2, layerSize.height / 4 - 20));
+    _uiLayer->addChild(_statusLabel, 3);
+
+    _listView = ListView::create();
+    _listView->setDirection(ui::ScrollView::Direction::VERTICAL);
+    _listView->setBounceEnabled(true);
+    _listView->setBackGroundImage("cocosui/green_edit.png");
+    _listView->setBackGroundImageScale9Enabled(true);
+    _listView->setContentSize(layerSize / 2);
+    _listView->setScrollBarPositionFromCorner(Vec2(7, 7));
+    _listView->setItemsMargin(2.0f);
+    _listView->setGravity(ListView::Gravity::CENTER_HORIZONTAL);
+    _listView->setAnchorPoint(Vec2::ANCHOR_MIDDLE);
+    _listView->setPosition(layerSize / 2);
+    _listView->setVirtualizationMargin(40.0f);
+    _listView->setAdapter(this);
+    _listView->addEventListener((ui::ListView::ccListViewCallback)[this](Ref*, ListView::EventType type) {
+        if (type == ListView::EventType::ON_SELECTED_ITEM_END)
+        {
+            CCLOG("select row %ld", (long)_listView->getCurSelectedIndex());
+        }
+    });
+    _uiLayer->addChild(_listView);
+
+    auto jumpButton = Button::create("cocosui/backtotoppressed.png", "cocosui/backtotopnormal.png");
+    jumpButton->setTitleText("5000");
+    jumpButton->setPosition(Vec2(layerSize.width * 0.85f, layerSize.height / 2));
+    jumpButton->addClickEventListener([this](Ref*) {
+        _listView->jumpToItem(5000, Vec2::ANCHOR_MIDDLE_TOP, Vec2::ANCHOR_MIDDLE_TOP);
+    });
+    _uiLayer->addChild(jumpButton);
+
+    scheduleUpdate();
+    return true;
+}
+
+void UIListViewTest_Virtualized::update(float dt)
+{
+    _statusLabel->setString(StringUtils::format("bound cells: %ld  pooled: %ld  created: %d",
+                                                (long)_listView->getBoundCellCount(),
+                                                (long)_listView->getPooledCellCount(),
+                                                _createdCellCount));
+}
+
+ssize_t UIListViewTest_Virtualized::getItemCount() const
+{
+    return VIRTUALIZED_ITEM_COUNT;
+}
+
+int UIListViewTest_Virtualized::getCellType(ssize_t index) const
+{
+    // every tenth row is a section header
+    return (index % 10 == 0) ? 1 : 0;
+}
+
+float UIListViewTest_Virtualized::measureItem(ssize_t index) const
+{
+    return getCellType(index) == 1 ? 40.0f : 24.0f + (index % 3) * 8.0f;
+}
+
+Widget* UIListViewTest_Virtualized::createCell(int cellType)
+{
+    ++_createdCellCount;
+    if (cellType == 1)
+    {
+        auto header = Button::create("cocosui/backtotoppressed.png", "cocosui/backtotopnormal.png");
+        header->setScale9Enabled(true);
+        header->setContentSize(Size(_listView->getContentSize().width - 20, 40));
+        return header;
+    }
+    auto row = Text::create("", "fonts/Marker Felt.ttf", 18);
+    row->setTouchEnabled(true);
+    return row;
+}
+
+void UIListViewTest_Virtualized::bindCell(Widget* cell, ssize_t index)
+{
+    if (getCellType(index) == 1)
+    {
+        static_cast<Button*>(cell)->setTitleText(StringUtils::format("Section %ld", (long)(index / 10)));
+    }
+    else
+    {
+        auto row = static_cast<Text*>(cell);
+        row->setString(StringUtils::format("row %ld", (long)index));
+        row->setFontSize(18 + (index % 3) * 4);
+    }
+}
@@ -217,4 +217,25 @@ public:
     }
 };
 
+// Test for the virtualized mode, a long list with two kinds of rows of different heights
+class UIListViewTest_Virtualized : public UIScene, public cocos2d::ui::ListViewAdapter
+{
+public:
+    CREATE_FUNC(UIListViewTest_Virtualized);
+
+    virtual bool init() override;
+    virtual void update(float dt) override;
+
+    virtual ssize_t getItemCount() const override;
+    virtual int getCellType(ssize_t index) const override;
+    virtual float measureItem(ssize_t index) const override;
+    virtual cocos2d::ui::Widget* createCell(int cellType) override;
+    virtual void bindCell(cocos2d::ui::Widget* cell, ssize_t index) override;
+
+protected:
+    cocos2d::ui::ListView* _listView;
+    cocos2d::ui::Text* _statusLabel;
+    int _createdCellCount;
+};
+
 #endif /* defined(__TestCpp__UIListViewTest__) */
@@ -49,6 +49,7 @@ UIRichTextTests::UIRichTextTests()
     ADD_TEST_CASE(UIRichTextXMLGlow);
     ADD_TEST_CASE(UIRichTextXMLExtend);
     ADD_TEST_CASE(UIRichTextXMLSpace);
+    ADD_TEST_CASE(UIRichTextChatLog);
 }
 
 
@@ -1879,3 +1880,62 @@ void UIRichTextXMLSpace::switchAlignment(Ref *sender, Widget::TouchEventType typ
         _richText->setHorizontalAlignment(alignment);
     }
 }
+
+//
+// UIRichTextChatLog
+//
+bool UIRichTextChatLog::init()
+{
+    if (UIScene::init())
+    {
+        Size widgetSize = _widget->getContentSize();
+
+        // Add the alert
+        Text *alert = Text::create("Chat log, only new lines are laid out", "fonts/Marker Felt.ttf", 30);
+        alert->setColor(Color3B(159, 168, 176));
+        alert->setPosition(Vec2(widgetSize.width / 2.0f, widgetSize.height / 2.0f - alert->getContentSize().height * 3.125));
+        _widget->addChild(alert);
+
+        _statusText = Text::create("", "fonts/Marker Felt.ttf", 16);
+        _statusText->setPosition(Vec2(widgetSize.width / 2.0f, widgetSize.height / 2.0f - alert->getContentSize().height * 4.125));
+        _widget->addChild(_statusText);
+
+        // RichText
+        _richText = RichText::create();
+        _richText->ignoreContentAdaptWithSize(false);
+        _richText->setContentSize(Size(200, 100));
+        _richText->setAnchorPoint(Vec2::ANCHOR_MIDDLE_TOP);
+        _richText->setPosition(Vec2(widgetSize.width / 2, widgetSize.height / 2 + 90));
+        _richText->setLocalZOrder(10);
+        _widget->addChild(_richText);
+
+        _lineCount = 0;
+        schedule(CC_SCHEDULE_SELECTOR(UIRichTextChatLog::addLine), 0.2f);
+
+        return true;
+    }
+    return false;
+}
+
+void UIRichTextChatLog::addLine(float dt)
+{
+    static const char* names[] = { "Alice", "Bob", "Carol" };
+    static const Color3B colors[] = { Color3B::YELLOW, Color3B::GREEN, Color3B::ORANGE };
+    const int speaker = _lineCount % 3;
+
+    // start over when the log is full, which is the only time all lines are laid out again
+    if (_lineCount > 0 && _lineCount % 10 == 0)
+    {
+        _richText->removeAllElements();
+    }
+
+    // every line is a name, a message and a new line
+    _richText->pushBackElement(RichElementText::create(0, colors[speaker], 255, StringUtils::format("%s: ", names[speaker]), "Helvetica", 10));
+    _richText->pushBackElement(RichElementText::create(0, Color3B::WHITE, 255, StringUtils::format("message %d, long enough to wrap around", _lineCount), "Helvetica", 10));
+    _richText->pushBackElement(RichElementNewLine::create(0, Color3B::WHITE, 255));
+    ++_lineCount;
+
+    auto startTime = utils::gettime();
+    _richText->formatText();
+    _statusText->setString(StringUtils::format("%d lines, formatted in %.3f ms", _lineCount, (utils::gettime() - startTime) * 1000));
+}
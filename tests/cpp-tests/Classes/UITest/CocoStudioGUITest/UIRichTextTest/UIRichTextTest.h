@@ -280,4 +280,18 @@ protected:
     cocos2d::ui::RichText* _richText;
 };
 
+class UIRichTextChatLog : public UIScene
+{
+public:
+    CREATE_FUNC(UIRichTextChatLog);
+
+    bool init() override;
+    void addLine(float dt);
+
+protected:
+    cocos2d::ui::RichText* _richText;
+    cocos2d::ui::Text* _statusText;
+    int _lineCount;
+};
+
 #endif /* defined(__TestCpp__UIRichTextTest__) */
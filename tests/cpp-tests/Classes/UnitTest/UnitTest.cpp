@@ -27,6 +27,9 @@
 #include "ui/UIHelper.h"
 #include "network/Uri.h"
 #include "base/ccUtils.h"
+#include "3d/CCMeshSkin.h"
+#include "3d/CCAnimationCurve.h"
+#include "Particle3D/CCParticleSystem3D.h"
 
 USING_NS_CC;
 using namespace cocos2d::network;
@@ -79,6 +82,12 @@ UnitTests::UnitTests()
     ADD_TEST_CASE(ParseIntegerListTest);
     ADD_TEST_CASE(ParseUriTest);
     ADD_TEST_CASE(ResizableBufferAdapterTest);
+    ADD_TEST_CASE(MeshSkinTest);
+    ADD_TEST_CASE(AnimationCurveTest);
+    ADD_TEST_CASE(AABBTreeTest);
+    ADD_TEST_CASE(OcclusionBufferTest);
+    ADD_TEST_CASE(TerrainRayTest);
+    ADD_TEST_CASE(ParticlePoolTest);
 #ifdef UNIT_TEST_FOR_OPTIMIZED_MATH_UTIL
     ADD_TEST_CASE(MathUtilTest);
 #endif
@@ -1745,4 +1754,463 @@ std::string ResizableBufferAdapterTest::subtitle() const
     return "ResiziableBufferAdapter<Data> Test";
 }
 
+// MeshSkinTest
 
+namespace
+{
+    bool isCloseTo(const Vec3& a, const Vec3& b)
+    {
+        return a.distance(b) < 0.0001f;
+    }
+
+    // palettes of the given skin matrices, as getMatrixPalette() and getDualQuaternionPalette() lay them out
+    void computePalettes(const std::vector<Mat4>& skinMatrices, std::vector<Vec4>* matrixPalette, std::vector<Vec4>* dualQuaternionPalette)
+    {
+        matrixPalette->resize(skinMatrices.size() * 3);
+        dualQuaternionPalette->resize(skinMatrices.size() * 2);
+        for (size_t i = 0; i < skinMatrices.size(); ++i)
+        {
+            MeshSkin::computeMatrixPaletteRows(skinMatrices[i], &(*matrixPalette)[i * 3]);
+            MeshSkin::computeDualQuaternionPaletteRows(skinMatrices[i], &(*dualQuaternionPalette)[i * 2]);
+        }
+    }
+}
+
+void MeshSkinTest::onEnter()
+{
+    UnitTestDemo::onEnter();
+
+    std::vector<Vec4> matrixPalette, dualQuaternionPalette;
+    const Vec3 position(1.0f, 2.0f, 3.0f);
+    const Vec3 normal(0.0f, 1.0f, 0.0f);
+    Vec3 skinnedPosition, skinnedNormal;
+
+    // identity bones leave the vertex alone
+    computePalettes({ Mat4::IDENTITY, Mat4::IDENTITY }, &matrixPalette, &dualQuaternionPalette);
+    for (bool dualQuaternion : { false, true })
+    {
+        auto palette = dualQuaternion ? dualQuaternionPalette.data() : matrixPalette.data();
+        MeshSkin::skinVertex(palette, dualQuaternion, Vec4(0, 1, 0, 0), Vec4(0.5f, 0.5f, 0, 0), position, normal, &skinnedPosition, &skinnedNormal);
+        EXPECT_TRUE(isCloseTo(skinnedPosition, position));
+        EXPECT_TRUE(isCloseTo(skinnedNormal, normal));
+    }
+
+    // a rigid bone moves the vertex like its matrix with both methods
+    Mat4 rigid;
+    Mat4::createTranslation(Vec3(10.0f, -5.0f, 2.0f), &rigid);
+    rigid.rotateY(MATH_DEG_TO_RAD(90.0f));
+    computePalettes({ Mat4::IDENTITY, rigid }, &matrixPalette, &dualQuaternionPalette);
+    Vec3 expectedPosition = position, expectedNormal = normal;
+    rigid.transformPoint(&expectedPosition);
+    rigid.transformVector(&expectedNormal);
+    for (bool dualQuaternion : { false, true })
+    {
+        auto palette = dualQuaternion ? dualQuaternionPalette.data() : matrixPalette.data();
+        MeshSkin::skinVertex(palette, dualQuaternion, Vec4(1, 0, 0, 0), Vec4(1, 0, 0, 0), position, normal, &skinnedPosition, &skinnedNormal);
+        EXPECT_TRUE(isCloseTo(skinnedPosition, expectedPosition));
+        EXPECT_TRUE(isCloseTo(skinnedNormal, expectedNormal));
+    }
+
+    // halfway between a bone and its copy twisted by 120 degrees, matrices collapse the vertex toward the axis
+    // while dual quaternions rotate it by 60 degrees
+    Mat4 twisted;
+    Mat4::createRotationX(MATH_DEG_TO_RAD(120.0f), &twisted);
+    Mat4 halfway;
+    Mat4::createRotationX(MATH_DEG_TO_RAD(60.0f), &halfway);
+    computePalettes({ Mat4::IDENTITY, twisted }, &matrixPalette, &dualQuaternionPalette);
+    const Vec3 offAxis(0.0f, 1.0f, 0.0f);
+    expectedPosition = offAxis;
+    halfway.transformPoint(&expectedPosition);
+
+    MeshSkin::skinVertex(matrixPalette.data(), false, Vec4(0, 1, 0, 0), Vec4(0.5f, 0.5f, 0, 0), offAxis, normal, &skinnedPosition, nullptr);
+    EXPECT_TRUE(std::abs(skinnedPosition.length() - 0.5f) < 0.0001f);
+    MeshSkin::skinVertex(dualQuaternionPalette.data(), true, Vec4(0, 1, 0, 0), Vec4(0.5f, 0.5f, 0, 0), offAxis, normal, &skinnedPosition, nullptr);
+    EXPECT_TRUE(isCloseTo(skinnedPosition, expectedPosition));
+    EXPECT_TRUE(std::abs(skinnedPosition.length() - 1.0f) < 0.0001f);
+
+    // a quaternion and its opposite are the same rotation, the blend must not cancel them out
+    computePalettes({ rigid, rigid }, &matrixPalette, &dualQuaternionPalette);
+    dualQuaternionPalette[2] = -dualQuaternionPalette[2];
+    dualQuaternionPalette[3] = -dualQuaternionPalette[3];
+    expectedPosition = position;
+    rigid.transformPoint(&expectedPosition);
+    MeshSkin::skinVertex(dualQuaternionPalette.data(), true, Vec4(0, 1, 0, 0), Vec4(0.5f, 0.5f, 0, 0), position, normal, &skinnedPosition, nullptr);
+    EXPECT_TRUE(isCloseTo(skinnedPosition, expectedPosition));
+}
+
+std::string MeshSkinTest::subtitle() const
+{
+    return "MeshSkin CPU Reference Skinning Test";
+}
+
+// AnimationCurveTest
+
+void AnimationCurveTest::onEnter()
+{
+    UnitTestDemo::onEnter();
+
+    // uneven key times, so a wrong key frame gives a different value
+    float keytime[] = { 0.0f, 0.1f, 0.15f, 0.4f, 0.45f, 0.7f, 1.0f };
+    float value[] = { 0.0f, 3.0f, -2.0f, 5.0f, 1.0f, 4.0f, -1.0f };
+    const int count = sizeof(keytime) / sizeof(keytime[0]);
+    auto curve = AnimationCurve<1>::create(keytime, value, count);
+
+    // the cached key index gives the same values as the binary search, playing forward, backward and jumping
+    std::vector<float> times;
+    for (int i = 0; i <= 100; ++i)
+        times.push_back(i / 100.0f);
+    for (int i = 100; i >= 0; i -= 3)
+        times.push_back(i / 100.0f);
+    for (float t : { 0.9f, 0.05f, 0.5f, 0.42f, 1.5f, -0.5f, 0.12f })
+        times.push_back(t);
+
+    for (auto type : { EvaluateType::INT_LINEAR, EvaluateType::INT_NEAR })
+    {
+        int keyIndex = 0;
+        for (float t : times)
+        {
+            float expected = 0.0f, actual = 0.0f;
+            curve->evaluate(t, &expected, type);
+            curve->evaluate(t, &actual, type, &keyIndex);
+            EXPECT_TRUE(std::abs(expected - actual) < 0.0001f);
+            EXPECT_TRUE(keyIndex >= 0 && keyIndex < count - 1);
+        }
+    }
+
+    // a stale or out of range index is only a hint
+    for (int hint : { -5, 3, count, 1000 })
+    {
+        float expected = 0.0f, actual = 0.0f;
+        int keyIndex = hint;
+        curve->evaluate(0.12f, &expected, EvaluateType::INT_LINEAR);
+        curve->evaluate(0.12f, &actual, EvaluateType::INT_LINEAR, &keyIndex);
+        EXPECT_TRUE(std::abs(expected - actual) < 0.0001f);
+        EXPECT_EQ(1, keyIndex);
+    }
+
+    // a quantized curve gives the values of a curve of its decoded keys
+    unsigned short quantized[] = { 0, 65535, 30000, 12345, 65535 };
+    float offset = -2.0f, scale = 5.0f / 65535;
+    float decodedTime[5], decodedValue[5];
+    for (int i = 0; i < 5; ++i)
+    {
+        decodedTime[i] = 0.2f + i * 0.2f;
+        decodedValue[i] = offset + quantized[i] * scale;
+    }
+    auto quantizedCurve = AnimationCurve<1>::createQuantized(0.2f, 0.2f, quantized, &offset, &scale, 5);
+    auto decodedCurve = AnimationCurve<1>::create(decodedTime, decodedValue, 5);
+    EXPECT_TRUE(std::abs(quantizedCurve->getEndTime() - 1.0f) < 0.0001f);
+    for (int i = 0; i <= 60; ++i)
+    {
+        float t = i / 50.0f, expected = 0.0f, actual = 0.0f;
+        decodedCurve->evaluate(t, &expected, EvaluateType::INT_LINEAR);
+        quantizedCurve->evaluate(t, &actual, EvaluateType::INT_LINEAR);
+        EXPECT_TRUE(std::abs(expected - actual) < 0.0001f);
+    }
+}
+
+std::string AnimationCurveTest::subtitle() const
+{
+    return "AnimationCurve Key Lookup Test";
+}
+
+// AABBTreeTest
+
+void AABBTreeTest::onEnter()
+{
+    UnitTestDemo::onEnter();
+
+    // boxes scattered over a wide flat area, like the props of a level
+    std::vector<AABB> boxes;
+    std::vector<int> proxies;
+    AABBTree tree;
+    for (int i = 0; i < 2000; ++i)
+    {
+        Vec3 center(CCRANDOM_MINUS1_1() * 500, CCRANDOM_MINUS1_1() * 50, CCRANDOM_MINUS1_1() * 500);
+        Vec3 extents(1 + CCRANDOM_0_1() * 4, 1 + CCRANDOM_0_1() * 4, 1 + CCRANDOM_0_1() * 4);
+        boxes.push_back(AABB(center - extents, center + extents));
+        proxies.push_back(tree.createProxy(boxes.back(), reinterpret_cast<void*>((intptr_t)i)));
+    }
+    EXPECT_TRUE(tree.validate());
+    EXPECT_EQ(2000, tree.getProxyCount());
+
+    // move a third of them, some inside their grown box and some far away, and remove a few
+    for (int i = 0; i < 2000; i += 3)
+    {
+        Vec3 offset = i % 2 ? Vec3(0.1f, 0, 0) : Vec3(50 + CCRANDOM_0_1() * 50, 0, CCRANDOM_MINUS1_1() * 100);
+        boxes[i]._min += offset;
+        boxes[i]._max += offset;
+        bool reinserted = tree.moveProxy(proxies[i], boxes[i]);
+        EXPECT_EQ(!(i % 2), reinserted);
+    }
+    for (int i = 0; i < 2000; i += 7)
+    {
+        tree.destroyProxy(proxies[i]);
+        proxies[i] = AABBTree::NULL_NODE;
+    }
+    EXPECT_TRUE(tree.validate());
+
+    // the frustum query finds every box Frustum::isOutOfFrustum keeps
+    auto camera = Camera::createPerspective(60, 1.5f, 1, 400);
+    camera->setPosition3D(Vec3(0, 50, 0));
+    camera->lookAt(Vec3(100, 0, 80));
+    const Frustum& frustum = camera->getFrustum();
+    std::vector<int> result;
+    tree.queryFrustum(frustum, result);
+    std::vector<bool> found(2000, false);
+    for (auto proxyId : result)
+        found[(intptr_t)tree.getUserData(proxyId)] = true;
+    for (int i = 0; i < 2000; ++i)
+    {
+        if (proxies[i] != AABBTree::NULL_NODE && !frustum.isOutOfFrustum(boxes[i]))
+            EXPECT_TRUE(found[i]);
+    }
+
+    // the ray query finds every box the ray hits
+    Ray ray(Vec3(-600, 0, 3), Vec3(1, 0, 0.01f));
+    result.clear();
+    tree.queryRay(ray, result);
+    std::fill(found.begin(), found.end(), false);
+    for (auto proxyId : result)
+        found[(intptr_t)tree.getUserData(proxyId)] = true;
+    for (int i = 0; i < 2000; ++i)
+    {
+        if (proxies[i] != AABBTree::NULL_NODE && ray.intersects(boxes[i]))
+            EXPECT_TRUE(found[i]);
+    }
+
+    for (int i = 0; i < 2000; ++i)
+    {
+        if (proxies[i] != AABBTree::NULL_NODE)
+            tree.destroyProxy(proxies[i]);
+    }
+    EXPECT_TRUE(tree.validate());
+    EXPECT_EQ(0, tree.getProxyCount());
+}
+
+std::string AABBTreeTest::subtitle() const
+{
+    return "AABBTree Query Test";
+}
+
+// OcclusionBufferTest
+
+namespace {
+    void addBoxOccluder(OcclusionBuffer& buffer, const AABB& aabb)
+    {
+        // AABB::getCorners order: front face 0-3, back face 4-7
+        static const unsigned short indices[] = {
+            0, 1, 2, 0, 2, 3, 3, 2, 5, 3, 5, 4, 4, 5, 6, 4, 6, 7,
+            7, 6, 1, 7, 1, 0, 7, 0, 3, 7, 3, 4, 1, 6, 5, 1, 5, 2 };
+        Vec3 corners[8];
+        aabb.getCorners(corners);
+        buffer.rasterize(corners, 8, indices, 36, Mat4::IDENTITY);
+    }
+}
+
+void OcclusionBufferTest::onEnter()
+{
+    UnitTestDemo::onEnter();
+
+    // camera at the origin looking down -z
+    Mat4 projection, view;
+    Mat4::createPerspective(60, 2.0f, 1, 1000, &projection);
+    Mat4::createLookAt(Vec3::ZERO, Vec3(0, 0, -1), Vec3::UNIT_Y, &view);
+
+    OcclusionBuffer buffer(256, 128);
+    buffer.clear(projection * view);
+    addBoxOccluder(buffer, AABB(Vec3(-20, -10, -52), Vec3(20, 10, -50)));
+    EXPECT_TRUE(buffer.getTriangleCount() > 0);
+
+    // hidden behind the wall
+    EXPECT_FALSE(buffer.isVisible(AABB(Vec3(-5, -5, -105), Vec3(5, 5, -95))));
+    // in front of the wall, beside it, peeking out of its edge
+    EXPECT_TRUE(buffer.isVisible(AABB(Vec3(-5, -5, -45), Vec3(5, 5, -40))));
+    EXPECT_TRUE(buffer.isVisible(AABB(Vec3(60, -5, -105), Vec3(70, 5, -95))));
+    EXPECT_TRUE(buffer.isVisible(AABB(Vec3(35, -5, -105), Vec3(45, 5, -95))));
+    // crossing the near plane is always visible
+    EXPECT_TRUE(buffer.isVisible(AABB(Vec3(-1, -1, -2), Vec3(1, 1, 2))));
+
+    // an occluder crossing the near plane is clipped, not dropped
+    buffer.clear(projection * view);
+    const Vec3 wall[] = { Vec3(-3, -50, 5), Vec3(-3, 50, 5), Vec3(-3, 50, -200), Vec3(-3, -50, -200) };
+    const unsigned short wallIndices[] = { 0, 1, 2, 0, 2, 3 };
+    buffer.rasterize(wall, 4, wallIndices, 6, Mat4::IDENTITY);
+    EXPECT_FALSE(buffer.isVisible(AABB(Vec3(-30, -5, -60), Vec3(-20, 5, -50))));
+    EXPECT_TRUE(buffer.isVisible(AABB(Vec3(20, -5, -60), Vec3(30, 5, -50))));
+}
+
+std::string OcclusionBufferTest::subtitle() const
+{
+    return "OcclusionBuffer Visibility Test";
+}
+
+// TerrainRayTest
+
+void TerrainRayTest::onEnter()
+{
+    UnitTestDemo::onEnter();
+
+    Terrain::TerrainData data("TerrainTest/heightmap16.jpg", "TerrainTest/dirt.jpg", Size(32, 32), 20.0f, 0.5f);
+    auto terrain = Terrain::create(data, Terrain::CrackFixedType::SKIRT);
+    terrain->setPosition3D(Vec3(30, -5, 10));
+    terrain->setScale(1.5f);
+    addChild(terrain);
+
+    // every triangle of the height map in the terrain space, like the chunks used to test them
+    auto size = terrain->getTerrainSize();
+    int width = (int)size.width;
+    int height = (int)size.height;
+    auto heights = terrain->getHeightData();
+    auto vertex = [&](int x, int y)
+    {
+        return Vec3(x * data._mapScale - width / 2 * data._mapScale, heights[y * width + x], y * data._mapScale - height / 2 * data._mapScale);
+    };
+    std::vector<Terrain::Triangle> triangles;
+    for (int y = 0; y < height - 1; ++y)
+    {
+        for (int x = 0; x < width - 1; ++x)
+        {
+            triangles.push_back(Terrain::Triangle(vertex(x, y), vertex(x, y + 1), vertex(x + 1, y)));
+            triangles.push_back(Terrain::Triangle(vertex(x + 1, y), vertex(x, y + 1), vertex(x + 1, y + 1)));
+        }
+    }
+
+    // slanted rays and straight down rays, some of them on the cell borders, some missing the terrain
+    auto aabb = terrain->getAABB();
+    std::vector<Ray> rays;
+    for (int i = 0; i < 200; ++i)
+    {
+        Vec3 origin(aabb._min.x + (aabb._max.x - aabb._min.x) * (CCRANDOM_0_1() * 1.4f - 0.2f), aabb._max.y + 10,
+                    aabb._min.z + (aabb._max.z - aabb._min.z) * (CCRANDOM_0_1() * 1.4f - 0.2f));
+        if (i % 3 == 0)
+            rays.push_back(Ray(origin, Vec3(0, -1, 0)));
+        else
+            rays.push_back(Ray(origin, Vec3(CCRANDOM_MINUS1_1(), -0.1f - CCRANDOM_0_1(), CCRANDOM_MINUS1_1())));
+    }
+
+    std::vector<Vec3> points;
+    std::vector<bool> hits;
+    int hitCount = terrain->getIntersectionPoints(rays, points, hits);
+    EXPECT_EQ(rays.size(), hits.size());
+    int expectedHitCount = 0;
+    auto world = terrain->getNodeToWorldTransform();
+    auto worldToTerrain = terrain->getWorldToNodeTransform();
+    for (size_t i = 0; i < rays.size(); ++i)
+    {
+        Vec3 origin = rays[i]._origin;
+        Vec3 direction = rays[i]._direction;
+        worldToTerrain.transformPoint(&origin);
+        worldToTerrain.transformVector(&direction);
+        Ray ray(origin, direction);
+        bool expectedHit = false;
+        float nearest = FLT_MAX;
+        Vec3 expectedPoint;
+        for (const auto& triangle : triangles)
+        {
+            Vec3 point;
+            float distance;
+            if (triangle.getIntersectPoint(ray, point) && (distance = (point - ray._origin).dot(ray._direction)) >= 0 && distance < nearest)
+            {
+                nearest = distance;
+                expectedPoint = point;
+                expectedHit = true;
+            }
+        }
+        world.transformPoint(&expectedPoint);
+        expectedHitCount += expectedHit;
+
+        EXPECT_EQ(expectedHit, (bool)hits[i]);
+        if (expectedHit)
+        {
+            EXPECT_TRUE(points[i].distance(expectedPoint) < 0.01f);
+        }
+
+        // a single ray finds the same point
+        Vec3 point;
+        EXPECT_EQ(expectedHit, terrain->getIntersectionPoint(rays[i], point));
+        if (expectedHit)
+        {
+            EXPECT_TRUE(point.distance(points[i]) < 0.0001f);
+        }
+    }
+    EXPECT_EQ(expectedHitCount, hitCount);
+    EXPECT_TRUE(hitCount > 0);
+
+    removeChild(terrain);
+}
+
+std::string TerrainRayTest::subtitle() const
+{
+    return "Terrain Ray Query Test";
+}
+
+// ParticlePoolTest
+
+void ParticlePoolTest::onEnter()
+{
+    UnitTestDemo::onEnter();
+
+    ParticlePool pool;
+    std::vector<Particle3D*> particles;
+    for (int i = 0; i < 10; ++i)
+    {
+        particles.push_back(new (std::nothrow) Particle3D());
+        pool.addData(particles.back());
+    }
+    EXPECT_TRUE(pool.empty());
+    for (int i = 0; i < 6; ++i)
+    {
+        EXPECT_EQ(particles[i], pool.createData());
+    }
+    EXPECT_EQ(6, (int)pool.getActiveDataCount());
+
+    // lock every other particle while iterating, the first one included
+    int visited = 0;
+    for (auto particle = pool.getFirst(); particle; particle = pool.getNext())
+    {
+        if (visited++ % 2 == 0)
+            pool.lockLatestData();
+    }
+    EXPECT_EQ(6, visited);
+    EXPECT_EQ(3, (int)pool.getActiveDataCount());
+    EXPECT_EQ(3, (int)pool.getActiveDataList().size());
+    EXPECT_EQ(particles[1], pool.getActiveDataList()[0]);
+    EXPECT_EQ(particles[3], pool.getActiveDataList()[1]);
+    EXPECT_EQ(particles[5], pool.getActiveDataList()[2]);
+
+    // free particles are reused first in, first out
+    EXPECT_EQ(particles[6], pool.createData());
+
+    // locked slots read as null until compacted
+    pool.lockActiveData(0);
+    EXPECT_EQ(4, (int)pool.getActiveDataSlots());
+    EXPECT_EQ(3, (int)pool.getActiveDataCount());
+    EXPECT_EQ(nullptr, pool.getActiveData(0));
+    pool.compactActiveDatas();
+    EXPECT_EQ(3, (int)pool.getActiveDataSlots());
+    EXPECT_EQ(particles[3], pool.getActiveData(0));
+
+    pool.lockData(particles[5]);
+    EXPECT_EQ(2, (int)pool.getActiveDataList().size());
+
+    pool.lockAllDatas();
+    EXPECT_TRUE(pool.empty());
+    EXPECT_EQ(10, (int)pool.getUnActiveDataList().size());
+    pool.removeAllDatas();
+
+    // data allocated in one block are handed out in order and freed with the block, the others one by one
+    ParticlePool blockPool;
+    Particle3D* block = blockPool.allocateDatas<Particle3D>(4);
+    EXPECT_EQ(4, (int)blockPool.getUnActiveDataList().size());
+    blockPool.addData(new (std::nothrow) Particle3D());
+    EXPECT_EQ(block, blockPool.createData());
+    EXPECT_EQ(block + 1, blockPool.createData());
+    blockPool.removeAllDatas();
+    EXPECT_TRUE(blockPool.getUnActiveDataList().empty());
+}
+
+std::string ParticlePoolTest::subtitle() const
+{
+    return "Particle3D DataPool Test";
+}
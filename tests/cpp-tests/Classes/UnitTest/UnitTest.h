@@ -112,5 +112,53 @@ public:
     virtual std::string subtitle() const override;
 };
 
+class MeshSkinTest : public UnitTestDemo
+{
+public:
+    CREATE_FUNC(MeshSkinTest);
+    virtual void onEnter() override;
+    virtual std::string subtitle() const override;
+};
+
+class AnimationCurveTest : public UnitTestDemo
+{
+public:
+    CREATE_FUNC(AnimationCurveTest);
+    virtual void onEnter() override;
+    virtual std::string subtitle() const override;
+};
+
+class AABBTreeTest : public UnitTestDemo
+{
+public:
+    CREATE_FUNC(AABBTreeTest);
+    virtual void onEnter() override;
+    virtual std::string subtitle() const override;
+};
+
+class OcclusionBufferTest : public UnitTestDemo
+{
+public:
+    CREATE_FUNC(OcclusionBufferTest);
+    virtual void onEnter() override;
+    virtual std::string subtitle() const override;
+};
+
+class TerrainRayTest : public UnitTestDemo
+{
+public:
+    CREATE_FUNC(TerrainRayTest);
+    virtual void onEnter() override;
+    virtual std::string subtitle() const override;
+};
+
+class ParticlePoolTest : public UnitTestDemo
+{
+public:
+    CREATE_FUNC(ParticlePoolTest);
+    virtual void onEnter() override;
+    virtual std::string subtitle() const override;
+};
+
 
 #endif /* __UNIT_TEST__ */
@@ -49,6 +49,14 @@ enum {
     kCaseLabelUpdate,
     kCaseLabelBMFontBigLabels,
     kCaseLabelBigLabels,
+    kCaseLabelAppendText,
+    kCaseLabelEditHeadText,
+    kCaseLabelHUDBatched,
+    kCaseLabelHUDUnbatched,
+    kCaseLabelShapedText,
+    kCaseLabelShapedTextNoCache,
+    kCaseRichTextAppendLine,
+    kCaseRichTextParseXML,
     
     kCaseCount
 };
@@ -62,6 +70,40 @@ static int _autoTestNodeCounts[] = {
 Lorem ipsum dolor sit amet, consectetur adipisicing elit, sed do eiusmod tempor incididunt ut labore et dolore magna aliqua.\
 Lorem ipsum dolor sit amet, consectetur adipisicing elit, sed do eiusmod tempor incididunt ut labore et dolore magna aliqua."
 
+// the chat log cases keep their labels between these lengths
+static const size_t kLongTextLength = 5000;
+static const size_t kLongTextMaxLength = 5500;
+
+// phrases the shaping cases cycle through, each word is shaped once with the cache
+static const char* kShapedTexts[] = {
+    u8"النقاط الحالية",
+    u8"المستوى التالي",
+    u8"الوقت المتبقي",
+    u8"أفضل نتيجة",
+};
+static const int kShapedTextCount = sizeof(kShapedTexts) / sizeof(kShapedTexts[0]);
+
+// a chat message with the tags chat windows use, parsed again every frame
+static const char* kRichTextXML =
+    "<font color='#ffff00'>Alice</font>: <b>hello</b> <i>everyone</i>, the raid starts at <u>nine</u><br/>"
+    "<font color='#00ff00'>Bob</font>: <font size='14'>ok</font>, see the <a href='http://www.cocos2d-x.org'>guide</a><br/>"
+    "<font color='#ff8000'>Carol</font>: <outline color='#000000' size='1'>on my way</outline>, "
+    "<shadow color='#000000'>bringing potions</shadow> and <del>scrolls</del><br/>"
+    "<font color='#ffff00'>Alice</font>: <small>thanks</small> <big>all</big>";
+
+static std::string makeLongText()
+{
+    std::string text;
+    text.reserve(kLongTextMaxLength);
+    while (text.length() < kLongTextLength)
+    {
+        text += LongSentencesExample;
+        text += "\n";
+    }
+    text.resize(kLongTextLength);
+    return text;
+}
+
 PerformceLabelTests::PerformceLabelTests()
 {
     _curTestCase = kCaseLabelTTFUpdate;
@@ -70,6 +112,14 @@ PerformceLabelTests::PerformceLabelTests()
     addTestCase("Label Performance Test", [](){ return LabelMainScene::create(); });
     addTestCase("LabelBMFont large text Performance", [](){ return LabelMainScene::create(); });
     addTestCase("Label large text Performance", [](){ return LabelMainScene::create(); });
+    addTestCase("Label append to 5k characters", [](){ return LabelMainScene::create(); });
+    addTestCase("Label edit head of 5k characters", [](){ return LabelMainScene::create(); });
+    addTestCase("Label HUD with batched glyphs", [](){ return LabelMainScene::create(); });
+    addTestCase("Label HUD without batched glyphs", [](){ return LabelMainScene::create(); });
+    addTestCase("Label Arabic text with shaping cache", [](){ return LabelMainScene::create(); });
+    addTestCase("Label Arabic text without shaping cache", [](){ return LabelMainScene::create(); });
+    addTestCase("RichText append chat lines", [](){ return LabelMainScene::create(); });
+    addTestCase("RichText parse XML", [](){ return LabelMainScene::create(); });
 }
 
 ////////////////////////////////////////////////////////
@@ -90,6 +140,8 @@ bool LabelMainScene::init()
     _lastRenderedCount = 0;
     _quantityNodes = 0;
     _accumulativeTime = 0.0f;
+    _frameCount = 0;
+    _layoutTime = 0.0;
 
     _labelContainer = Layer::create();
     addChild(_labelContainer);
@@ -130,6 +182,22 @@ std::string LabelMainScene::title() const
         return "Testing LabelBMFont Big Labels";
     case kCaseLabelBigLabels:
         return "Testing Label Big Labels";
+    case kCaseLabelAppendText:
+        return "Testing Label Append Text";
+    case kCaseLabelEditHeadText:
+        return "Testing Label Edit Head Text";
+    case kCaseLabelHUDBatched:
+        return "Testing Label HUD, Batched Glyphs";
+    case kCaseLabelHUDUnbatched:
+        return "Testing Label HUD, Draw Per Label";
+    case kCaseLabelShapedText:
+        return "Testing Label Shaping, Cached";
+    case kCaseLabelShapedTextNoCache:
+        return "Testing Label Shaping, Uncached";
+    case kCaseRichTextAppendLine:
+        return "Testing RichText Append Line";
+    case kCaseRichTextParseXML:
+        return "Testing RichText Parse XML";
     default:
         break;
     }
@@ -218,6 +286,69 @@ void LabelMainScene::onIncrease(Ref* sender)
             }
             break;
         }        
+    case kCaseLabelAppendText:
+    case kCaseLabelEditHeadText:
+        {
+            TTFConfig ttfConfig("fonts/arial.ttf", 12, GlyphCollection::DYNAMIC);
+            auto text = makeLongText();
+            for( int i=0;i< kNodesIncrease;i++)
+            {
+                auto label = Label::createWithTTF(ttfConfig, text, TextHAlignment::LEFT, size.width);
+                label->setAnchorPoint(Vec2::ANCHOR_BOTTOM_LEFT);
+                label->setPosition(Vec2((rand() % 50), rand()%((int)size.height/3)));
+                _labelContainer->addChild(label, 1, _quantityNodes);
+
+                _quantityNodes++;
+            }
+            break;
+        }
+    case kCaseLabelHUDBatched:
+    case kCaseLabelHUDUnbatched:
+        {
+            // small labels of different colors on one atlas page, some with a shadow
+            TTFConfig ttfConfig("fonts/arial.ttf", 18, GlyphCollection::DYNAMIC);
+            for( int i=0;i< kNodesIncrease;i++)
+            {
+                auto label = Label::createWithTTF(ttfConfig, "HP 100", TextHAlignment::LEFT);
+                label->setTextColor(Color4B(rand() % 256, rand() % 256, rand() % 256, 255));
+                if (_quantityNodes % 3 == 0)
+                {
+                    label->enableShadow();
+                }
+                label->setPosition(Vec2(rand() % (int)size.width, rand() % (int)size.height));
+                _labelContainer->addChild(label, 1, _quantityNodes);
+
+                _quantityNodes++;
+            }
+            break;
+        }
+    case kCaseLabelShapedText:
+    case kCaseLabelShapedTextNoCache:
+        {
+            TTFConfig ttfConfig("fonts/tahoma.ttf", 20, GlyphCollection::DYNAMIC);
+            for( int i=0;i< kNodesIncrease;i++)
+            {
+                auto label = Label::createWithTTF(ttfConfig, kShapedTexts[_quantityNodes % kShapedTextCount], TextHAlignment::LEFT);
+                label->setPosition(Vec2(rand() % (int)size.width, rand() % (int)size.height));
+                _labelContainer->addChild(label, 1, _quantityNodes);
+
+                _quantityNodes++;
+            }
+            break;
+        }
+    case kCaseRichTextAppendLine:
+    case kCaseRichTextParseXML:
+        {
+            for( int i=0;i< kNodesIncrease;i++)
+            {
+                auto richText = createRichText();
+                richText->setPosition(Vec2((rand() % 50), size.height - rand() % 50));
+                _labelContainer->addChild(richText, 1, _quantityNodes);
+
+                _quantityNodes++;
+            }
+            break;
+        }
     default:
         break;
     }
@@ -254,8 +385,32 @@ void LabelMainScene::updateText(float dt)
             minFrameRate = curFrameRate;
     }
 
-    if(_curTestCase > kCaseLabelUpdate)
+    if (_curTestCase == kCaseLabelBMFontBigLabels || _curTestCase == kCaseLabelBigLabels)
+        return;
+
+    if (_curTestCase == kCaseLabelAppendText || _curTestCase == kCaseLabelEditHeadText)
+    {
+        updateLongText();
         return;
+    }
+
+    if (_curTestCase == kCaseLabelHUDBatched || _curTestCase == kCaseLabelHUDUnbatched)
+    {
+        updateHUDText();
+        return;
+    }
+
+    if (_curTestCase == kCaseLabelShapedText || _curTestCase == kCaseLabelShapedTextNoCache)
+    {
+        updateShapedText();
+        return;
+    }
+
+    if (_curTestCase == kCaseRichTextAppendLine || _curTestCase == kCaseRichTextParseXML)
+    {
+        updateRichText();
+        return;
+    }
 
     _accumulativeTime += dt;
     char text[20];
@@ -287,8 +442,161 @@ void LabelMainScene::updateText(float dt)
     }
 }
 
+void LabelMainScene::updateLongText()
+{
+    // appending only lays out the last line again, while a changed first
+    // character makes the whole text be laid out, as every setString() used to
+    ++_frameCount;
+    auto letter = static_cast<char>((_frameCount % 7 == 0) ? ' ' : 'a' + _frameCount % 26);
+
+    auto startTime = utils::gettime();
+    for (const auto &child : _labelContainer->getChildren())
+    {
+        auto label = static_cast<Label*>(child);
+        auto text = label->getString();
+        if (_curTestCase == kCaseLabelAppendText)
+        {
+            if (text.length() >= kLongTextMaxLength)
+            {
+                text.resize(kLongTextLength);
+            }
+            text.push_back(letter);
+        }
+        else
+        {
+            text[0] = letter;
+        }
+        label->setString(text);
+        // lay the label out now so it's measured here and not while drawing
+        label->getContentSize();
+    }
+    _layoutTime += utils::gettime() - startTime;
+
+    if (_frameCount % 60 == 0)
+    {
+        auto infoLabel = (Label *) getChildByTag(kTagInfoLayer);
+        infoLabel->setString(StringUtils::format("%u nodes, layout %.2f ms/frame", _quantityNodes, _layoutTime * 1000.0 / 60));
+        _layoutTime = 0.0;
+    }
+}
+
+void LabelMainScene::updateHUDText()
+{
+    // the digits are already in the atlas, only the quads and the draw calls change
+    ++_frameCount;
+    auto text = StringUtils::format("HP %d", 100 - _frameCount % 100);
+    for (const auto &child : _labelContainer->getChildren())
+    {
+        static_cast<Label*>(child)->setString(text);
+    }
+
+    if (_frameCount % 60 == 0)
+    {
+        // the renderer counts the batches of the previous frame until the next one starts
+        auto batches = Director::getInstance()->getRenderer()->getDrawnBatches();
+        auto infoLabel = (Label *) getChildByTag(kTagInfoLayer);
+        infoLabel->setString(StringUtils::format("%u nodes, %d draw calls", _quantityNodes, (int)batches));
+    }
+}
+
+void LabelMainScene::updateShapedText()
+{
+    // every label gets another phrase and a new number, the number needs no shaping
+    ++_frameCount;
+    auto startTime = utils::gettime();
+    int index = _frameCount;
+    for (const auto &child : _labelContainer->getChildren())
+    {
+        auto label = static_cast<Label*>(child);
+        label->setString(StringUtils::format("%s %d", kShapedTexts[index++ % kShapedTextCount], _frameCount % 1000));
+        label->getContentSize();
+    }
+    _layoutTime += utils::gettime() - startTime;
+
+    if (_frameCount % 60 == 0)
+    {
+        auto infoLabel = (Label *) getChildByTag(kTagInfoLayer);
+        infoLabel->setString(StringUtils::format("%u nodes, layout %.2f ms/frame, %u runs shaped", _quantityNodes,
+                                                 _layoutTime * 1000.0 / 60, (unsigned)TextShaper::getCacheMisses()));
+        _layoutTime = 0.0;
+    }
+}
+
+ui::RichText* LabelMainScene::createRichText()
+{
+    auto size = Director::getInstance()->getWinSize();
+    ui::RichText* richText = nullptr;
+    if (_curTestCase == kCaseRichTextParseXML)
+    {
+        richText = ui::RichText::createWithXML(kRichTextXML);
+    }
+    else
+    {
+        richText = ui::RichText::create();
+    }
+    richText->ignoreContentAdaptWithSize(false);
+    richText->setContentSize(Size(size.width / 2, 0));
+    richText->setAnchorPoint(Vec2::ANCHOR_TOP_LEFT);
+    return richText;
+}
+
+void LabelMainScene::updateRichText()
+{
+    // appending lays out the new line only, while the XML case measures the parser alone,
+    // the rich texts on screen were parsed once and keep their lines
+    ++_frameCount;
+    auto size = Director::getInstance()->getWinSize();
+    double time = 0.0;
+    for (const auto &child : _labelContainer->getChildren())
+    {
+        auto richText = static_cast<ui::RichText*>(child);
+        if (_curTestCase == kCaseRichTextAppendLine)
+        {
+            auto startTime = utils::gettime();
+            richText->pushBackElement(ui::RichElementText::create(0, Color3B::YELLOW, 255, "Alice: ", "fonts/arial.ttf", 12));
+            richText->pushBackElement(ui::RichElementText::create(0, Color3B::WHITE, 255,
+                                                                  StringUtils::format("message %d, the raid starts at nine", _frameCount),
+                                                                  "fonts/arial.ttf", 12));
+            richText->pushBackElement(ui::RichElementNewLine::create(0, Color3B::WHITE, 255));
+            richText->formatText();
+            time += utils::gettime() - startTime;
+        }
+        else
+        {
+            auto startTime = utils::gettime();
+            ui::RichText::createWithXML(kRichTextXML);
+            time += utils::gettime() - startTime;
+        }
+    }
+    _layoutTime += time;
+
+    // a full chat log starts over, outside of the measured time
+    if (_curTestCase == kCaseRichTextAppendLine)
+    {
+        for (const auto &child : _labelContainer->getChildren())
+        {
+            if (child->getContentSize().height > size.height * 2)
+            {
+                static_cast<ui::RichText*>(child)->removeAllElements();
+            }
+        }
+    }
+
+    if (_frameCount % 60 == 0)
+    {
+        auto infoLabel = (Label *) getChildByTag(kTagInfoLayer);
+        infoLabel->setString(StringUtils::format("%u nodes, %s %.2f ms/frame", _quantityNodes,
+                                                 _curTestCase == kCaseRichTextAppendLine ? "layout" : "parse",
+                                                 _layoutTime * 1000.0 / 60));
+        _layoutTime = 0.0;
+    }
+}
+
 void LabelMainScene::onEnter()
 {
+    TextShaper::clearCache();
+    TextShaper::setCacheCapacity(_curTestCase == kCaseLabelShapedTextNoCache ? 0 : 1024);
+    Label::setGlyphBatchingEnabled(_curTestCase != kCaseLabelHUDUnbatched);
     Scene::onEnter();
     
     auto director = Director::getInstance();
@@ -309,6 +617,8 @@ void LabelMainScene::onExit()
     auto director = Director::getInstance();
     auto sched = director->getScheduler();
     sched->unscheduleAllForTarget(this);
+    Label::setGlyphBatchingEnabled(true);
+    TextShaper::setCacheCapacity(1024);
 
     Scene::onExit();
 }
@@ -365,6 +675,30 @@ void LabelMainScene::endStat(float dt)
         case kCaseLabelBigLabels:
             tf = "Label Big Labels";
             break;
+        case kCaseLabelAppendText:
+            tf = "Label Append Text";
+            break;
+        case kCaseLabelEditHeadText:
+            tf = "Label Edit Head Text";
+            break;
+        case kCaseLabelHUDBatched:
+            tf = "Label HUD Batched";
+            break;
+        case kCaseLabelHUDUnbatched:
+            tf = "Label HUD Unbatched";
+            break;
+        case kCaseLabelShapedText:
+            tf = "Label Shaping Cached";
+            break;
+        case kCaseLabelShapedTextNoCache:
+            tf = "Label Shaping Uncached";
+            break;
+        case kCaseRichTextAppendLine:
+            tf = "RichText Append Line";
+            break;
+        case kCaseRichTextParseXML:
+            tf = "RichText Parse XML";
+            break;
         default:
             tf = "unknown";
             break;
@@ -26,6 +26,7 @@
 #define __PERFORMANCE_LABEL_TEST_H__
 
 #include "BaseTest.h"
+#include "ui/UIRichText.h"
 
 DEFINE_TEST_SUITE(PerformceLabelTests);
 
@@ -43,6 +44,11 @@ public:
     void onIncrease(cocos2d::Ref* sender);
     void onDecrease(cocos2d::Ref* sender);
     void updateText(float dt);
+    void updateLongText();
+    void updateHUDText();
+    void updateShapedText();
+    void updateRichText();
+    cocos2d::ui::RichText* createRichText();
 
     virtual void onEnter() override;
     virtual void onExit() override;
@@ -59,6 +65,8 @@ private:
     int   _lastRenderedCount;
     int   _quantityNodes;
     float _accumulativeTime;
+    int   _frameCount;
+    double _layoutTime;
 
     bool  isStating;
     int   autoTestIndex;
@@ -42,9 +42,17 @@ static int autoTestParticleCounts[] = {
     200, 500, 800
 };
 
+static const int kTagUpdateInfoLabel = 2;
+static const char* kUpdateProfileName = "PUParticleSystem3D::update";
+
+static int autoTestUpdateSystemCounts[] = {
+    5, 10, 20
+};
+
 PerformceParticle3DTests::PerformceParticle3DTests()
 {
     ADD_TEST_CASE(Particle3DPerformTest);
+    ADD_TEST_CASE(Particle3DUpdatePerformTest);
 }
 
 ////////////////////////////////////////////////////////
@@ -270,3 +278,169 @@ bool Particle3DPerformTest::init()
 
     return false;
 }
+
+////////////////////////////////////////////////////////
+//
+// Particle3DUpdatePerformTest
+//
+////////////////////////////////////////////////////////
+Particle3DUpdatePerformTest::Particle3DUpdatePerformTest()
+: autoTestIndex(0)
+, _systemCount(5)
+{
+}
+
+std::string Particle3DUpdatePerformTest::title() const
+{
+    return "Particle3D Update Test";
+}
+
+std::string Particle3DUpdatePerformTest::subtitle() const
+{
+    return "Time spent updating blackHole.pu systems, see console";
+}
+
+void Particle3DUpdatePerformTest::onEnter()
+{
+    TestCase::onEnter();
+
+    Profiler::getInstance()->releaseAllTimers();
+
+    if (isAutoTesting()) {
+        autoTestIndex = 0;
+        _systemCount = autoTestUpdateSystemCounts[autoTestIndex];
+        Profile::getInstance()->testCaseBegin("Particle3DUpdateTest",
+                                              genStrVector("ParticleSystemCount", nullptr),
+                                              genStrVector("Avg", "Min", "Max", nullptr));
+    }
+
+    auto s = Director::getInstance()->getWinSize();
+
+    MenuItemFont::setFontSize(65);
+    auto decrease = MenuItemFont::create(" - ", CC_CALLBACK_1(Particle3DUpdatePerformTest::subSystemCount, this));
+    decrease->setColor(Color3B(0,200,20));
+    auto increase = MenuItemFont::create(" + ", CC_CALLBACK_1(Particle3DUpdatePerformTest::addSystemCount, this));
+    increase->setColor(Color3B(0,200,20));
+
+    auto menu = Menu::create(decrease, increase, nullptr);
+    menu->alignItemsHorizontally();
+    menu->setPosition(Vec2(s.width/2, s.height/2+15));
+    addChild(menu, 1);
+
+    auto infoLabel = Label::createWithTTF("0 Particle Systems", "fonts/Marker Felt.ttf", 30);
+    infoLabel->setColor(Color3B(0,200,20));
+    infoLabel->setPosition(Vec2(s.width/2, s.height - 90));
+    addChild(infoLabel, 1, kTagUpdateInfoLabel);
+
+    auto camera = Camera::createPerspective(30.0f, s.width / s.height, 1.0f, 1000.0f);
+    camera->setPosition3D(Vec3(0.0f, 0.0f, 150.0f));
+    camera->lookAt(Vec3(0.0f, 0.0f, 0.0f), Vec3(0.0f, 1.0f, 0.0f));
+    camera->setCameraFlag(CameraFlag::USER1);
+    addChild(camera);
+
+    createParticleSystems();
+
+    schedule(CC_SCHEDULE_SELECTOR(Particle3DUpdatePerformTest::doPerformanceTest));
+    schedule(CC_SCHEDULE_SELECTOR(Particle3DUpdatePerformTest::dumpProfilerInfo), 2.0f);
+}
+
+void Particle3DUpdatePerformTest::onExit()
+{
+    unscheduleAllCallbacks();
+    _systems.clear();
+    TestCase::onExit();
+}
+
+void Particle3DUpdatePerformTest::createParticleSystems()
+{
+    for (auto system : _systems)
+    {
+        if (system->getParent() == this)
+            system->removeFromParent();
+    }
+    _systems.clear();
+
+    for (int i = 0; i < _systemCount; ++i)
+    {
+        auto ps = PUParticleSystem3D::create("Particle3D/scripts/blackHole.pu", "Particle3D/materials/pu_mediapack_01.material");
+        ps->setCameraMask((unsigned short)CameraFlag::USER1);
+        ps->setPosition(CCRANDOM_MINUS1_1() * 50.0f, CCRANDOM_MINUS1_1() * 20.0f);
+        ps->startParticleSystem();
+        addChild(ps);
+
+        // The systems are updated from doPerformanceTest() so that only the particle work is timed
+        _systems.push_back(ps);
+        for (auto child : ps->getChildren())
+        {
+            if (dynamic_cast<PUParticleSystem3D *>(child))
+                _systems.push_back(child);
+        }
+    }
+    for (auto system : _systems)
+    {
+        system->unscheduleUpdate();
+    }
+
+    updateCountLabel();
+    Profiler::getInstance()->releaseAllTimers();
+}
+
+void Particle3DUpdatePerformTest::addSystemCount(Ref* /*sender*/)
+{
+    ++_systemCount;
+    createParticleSystems();
+}
+
+void Particle3DUpdatePerformTest::subSystemCount(Ref* /*sender*/)
+{
+    _systemCount = std::max(_systemCount - 1, 1);
+    createParticleSystems();
+}
+
+void Particle3DUpdatePerformTest::updateCountLabel()
+{
+    auto infoLabel = (Label *) getChildByTag(kTagUpdateInfoLabel);
+    char str[64] = {0};
+    sprintf(str, "%d Particle Systems", _systemCount);
+    infoLabel->setString(str);
+}
+
+void Particle3DUpdatePerformTest::doPerformanceTest(float dt)
+{
+    ProfilingBeginTimingBlock(kUpdateProfileName);
+    for (auto system : _systems)
+    {
+        system->update(dt);
+    }
+    ProfilingEndTimingBlock(kUpdateProfileName);
+}
+
+void Particle3DUpdatePerformTest::dumpProfilerInfo(float /*dt*/)
+{
+    Profiler::getInstance()->displayTimers();
+
+    if (this->isAutoTesting()) {
+        // record the test result to class Profile
+        auto timer = Profiler::getInstance()->_activeTimers.at(kUpdateProfileName);
+        if (!timer)
+            return;
+        auto numStr = genStr("%d", _systemCount);
+        auto avgStr = genStr("%ldµ", timer->_averageTime2);
+        auto minStr = genStr("%ldµ", timer->minTime);
+        auto maxStr = genStr("%ldµ", timer->maxTime);
+        Profile::getInstance()->addTestResult(genStrVector(numStr.c_str(), nullptr),
+                                              genStrVector(avgStr.c_str(), minStr.c_str(), maxStr.c_str(), nullptr));
+
+        int testsSize = sizeof(autoTestUpdateSystemCounts) / sizeof(int);
+        if (autoTestIndex >= (testsSize - 1)) {
+            this->setAutoTesting(false);
+            Profile::getInstance()->testCaseEnd();
+        }
+        else
+        {
+            autoTestIndex++;
+            _systemCount = autoTestUpdateSystemCounts[autoTestIndex];
+            createParticleSystems();
+        }
+    }
+}
@@ -71,4 +71,30 @@ public:
     virtual void doTest()override{};
 };
 
+class Particle3DUpdatePerformTest : public TestCase
+{
+public:
+    CREATE_FUNC(Particle3DUpdatePerformTest);
+
+    Particle3DUpdatePerformTest();
+
+    virtual void onEnter() override;
+    virtual void onExit() override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+
+    void addSystemCount(cocos2d::Ref* sender);
+    void subSystemCount(cocos2d::Ref* sender);
+
+protected:
+    void createParticleSystems();
+    void doPerformanceTest(float dt);
+    void dumpProfilerInfo(float dt);
+    void updateCountLabel();
+
+    std::vector<cocos2d::Node *> _systems;
+    int autoTestIndex;
+    int _systemCount;
+};
+
 #endif
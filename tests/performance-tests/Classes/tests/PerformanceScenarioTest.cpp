@@ -24,6 +24,7 @@
 
 #include "PerformanceScenarioTest.h"
 #include "Profile.h"
+#include "ui/UIScale9Sprite.h"
 
 USING_NS_CC;
 
@@ -33,6 +34,7 @@ USING_NS_CC;
 PerformceScenarioTests::PerformceScenarioTests()
 {
     ADD_TEST_CASE(ScenarioTest);
+    ADD_TEST_CASE(Scale9PanelsTest);
 }
 
 ////////////////////////////////////////////////////////
@@ -436,3 +438,170 @@ std::string ScenarioTest::title() const
 {
     return "Scenario Performance Test";
 }
+
+////////////////////////////////////////////////////////
+//
+// Scale9PanelsTest
+//
+////////////////////////////////////////////////////////
+static const int kScale9PanelCount = 500;
+
+bool Scale9PanelsTest::init()
+{
+    if (!TestCase::init())
+        return false;
+
+    _mode = Mode::SCALE9_SHARED_TEXTURE;
+    _frameCount = 0;
+    _drawStartTime = 0;
+    _drawTime = 0;
+
+    auto s = Director::getInstance()->getVisibleSize();
+    auto origin = Director::getInstance()->getVisibleOrigin();
+
+    _panelContainer = Node::create();
+    addChild(_panelContainer);
+
+    MenuItemFont::setFontSize(20);
+    auto toggle = MenuItemToggle::createWithCallback([this](Ref* sender) {
+        createPanels((Mode)static_cast<MenuItemToggle*>(sender)->getSelectedIndex());
+    },
+    MenuItemFont::create("Scale9Sprite, one texture"),
+    MenuItemFont::create("Scale9Sprite, resized every frame"),
+    MenuItemFont::create("Scale9Sprite, two textures interleaved"),
+    MenuItemFont::create("Nine sprites per panel"),
+    nullptr);
+    toggle->setAnchorPoint(Vec2(0.0f, 0.5f));
+    toggle->setPosition(Vec2(origin.x, origin.y + s.height / 2));
+
+    auto menu = Menu::create(toggle, nullptr);
+    menu->setPosition(Vec2::ZERO);
+    addChild(menu, 10);
+
+    _infoLabel = Label::createWithTTF("", "fonts/arial.ttf", 15);
+    _infoLabel->setAnchorPoint(Vec2(0.0f, 0.5f));
+    _infoLabel->setPosition(Vec2(origin.x, origin.y + s.height / 2 + 30));
+    addChild(_infoLabel, 10);
+
+    createPanels(_mode);
+    return true;
+}
+
+void Scale9PanelsTest::onEnter()
+{
+    TestCase::onEnter();
+
+    // visit and render of the whole scene, which is where the panels cost CPU time
+    _beforeDrawListener = _eventDispatcher->addCustomEventListener(Director::EVENT_BEFORE_DRAW, [this](EventCustom*) {
+        _drawStartTime = utils::gettime();
+    });
+    _afterDrawListener = _eventDispatcher->addCustomEventListener(Director::EVENT_AFTER_DRAW, [this](EventCustom*) {
+        _drawTime += utils::gettime() - _drawStartTime;
+    });
+
+    scheduleUpdate();
+}
+
+void Scale9PanelsTest::onExit()
+{
+    _eventDispatcher->removeEventListener(_beforeDrawListener);
+    _eventDispatcher->removeEventListener(_afterDrawListener);
+    unscheduleUpdate();
+
+    TestCase::onExit();
+}
+
+void Scale9PanelsTest::createPanels(Mode mode)
+{
+    _mode = mode;
+    _panelContainer->removeAllChildren();
+    _frameCount = 0;
+    _drawTime = 0;
+
+    auto s = Director::getInstance()->getVisibleSize();
+    auto origin = Director::getInstance()->getVisibleOrigin();
+
+    for (int i = 0; i < kScale9PanelCount; ++i)
+    {
+        const Size size(60 + CCRANDOM_0_1() * 80, 35 + CCRANDOM_0_1() * 50);
+        const Vec2 position = origin + Vec2(CCRANDOM_0_1() * s.width, CCRANDOM_0_1() * s.height);
+
+        if (mode == Mode::NINE_SPRITES)
+        {
+            // the slices of b1.png, with the default insets of a third of the image
+            auto texture = Director::getInstance()->getTextureCache()->addImage("Images/b1.png");
+            const Size original = texture->getContentSize();
+            const float w[3] = { original.width / 3, size.width - original.width * 2 / 3, original.width / 3 };
+            const float h[3] = { original.height / 3, size.height - original.height * 2 / 3, original.height / 3 };
+
+            auto panel = Node::create();
+            panel->setContentSize(size);
+            panel->setAnchorPoint(Vec2::ANCHOR_MIDDLE);
+            panel->setPosition(position);
+            float y = 0;
+            for (int row = 2; row >= 0; --row)
+            {
+                float x = 0;
+                for (int column = 0; column < 3; ++column)
+                {
+                    auto slice = Sprite::createWithTexture(texture, Rect(column * original.width / 3, row * original.height / 3,
+                                                                         original.width / 3, original.height / 3));
+                    slice->setAnchorPoint(Vec2::ANCHOR_BOTTOM_LEFT);
+                    slice->setPosition(x, y);
+                    slice->setScale(w[column] / (original.width / 3), h[2 - row] / (original.height / 3));
+                    panel->addChild(slice);
+                    x += w[column];
+                }
+                y += h[2 - row];
+            }
+            _panelContainer->addChild(panel);
+        }
+        else
+        {
+            const bool interleaved = mode == Mode::SCALE9_INTERLEAVED_TEXTURES && (i % 2) == 1;
+            auto panel = ui::Scale9Sprite::create(interleaved ? "Images/r1.png" : "Images/b1.png");
+            panel->setContentSize(size);
+            panel->setPosition(position);
+            _panelContainer->addChild(panel);
+        }
+    }
+}
+
+void Scale9PanelsTest::update(float dt)
+{
+    if (_mode == Mode::SCALE9_RESIZED)
+    {
+        // rebuilds the 16 vertices of every panel
+        const float t = (float)_frameCount / 30.0f;
+        int i = 0;
+        for (const auto& child : _panelContainer->getChildren())
+        {
+            child->setContentSize(Size(70 + 15 * sinf(t + i), 50 + 10 * cosf(t + i)));
+            ++i;
+        }
+    }
+
+    ++_frameCount;
+    if (_frameCount % 60 == 0)
+        updateInfo();
+}
+
+void Scale9PanelsTest::updateInfo()
+{
+    auto renderer = Director::getInstance()->getRenderer();
+    _infoLabel->setString(StringUtils::format("%d panels, %d draw calls, %d vertices, visit + render %.2f ms",
+                                              kScale9PanelCount,
+                                              (int)renderer->getDrawnBatches(),
+                                              (int)renderer->getDrawnVertices(),
+                                              _drawTime * 1000.0 / _frameCount));
+}
+
+std::string Scale9PanelsTest::title() const
+{
+    return "Scale9Sprite Panels Test";
+}
+
+std::string Scale9PanelsTest::subtitle() const
+{
+    return "500 panels, one TrianglesCommand each";
+}
@@ -86,4 +86,43 @@ private:
     float      maxFrameRate;
 };
 
+class Scale9PanelsTest : public TestCase
+{
+public:
+    CREATE_FUNC(Scale9PanelsTest);
+
+    virtual bool init() override;
+    virtual std::string title() const override;
+    virtual std::string subtitle() const override;
+
+    virtual void onEnter() override;
+    virtual void onExit() override;
+    virtual void update(float dt) override;
+
+private:
+    enum class Mode
+    {
+        // every panel is one Scale9Sprite of the same texture
+        SCALE9_SHARED_TEXTURE,
+        // same panels, resized every frame
+        SCALE9_RESIZED,
+        // every other panel uses another texture, which breaks the batches
+        SCALE9_INTERLEAVED_TEXTURES,
+        // every panel is made of nine sprites, the way Scale9Sprite used to draw
+        NINE_SPRITES,
+    };
+
+    void createPanels(Mode mode);
+    void updateInfo();
+
+    cocos2d::Node* _panelContainer;
+    cocos2d::Label* _infoLabel;
+    cocos2d::EventListenerCustom* _beforeDrawListener;
+    cocos2d::EventListenerCustom* _afterDrawListener;
+    Mode _mode;
+    unsigned int _frameCount;
+    double _drawStartTime;
+    double _drawTime;
+};
+
 #endif
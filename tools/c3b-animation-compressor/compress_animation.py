@@ -0,0 +1,311 @@
+#!/usr/bin/python
+#-*- coding: UTF-8 -*-
+# ----------------------------------------------------------------------------
+# Compress the animations of a c3b file.
+#
+# License: MIT
+# ----------------------------------------------------------------------------
+'''
+Compress the animations of a c3b file.
+
+Every curve of a bone is resampled with evenly spaced keys, as few as the error
+bounds allow, and its keys are quantized to 16 bits. The animations are written
+as compressed animation records, which Bundle3D loads instead of the original
+ones, so the evaluation finds the keys around a time in constant time.
+'''
+
+import math
+import struct
+
+from argparse import ArgumentParser
+
+BUNDLE_TYPE_ANIMATIONS = 3
+BUNDLE_TYPE_COMPRESSED_ANIMATIONS = 6
+
+ROTATION = 0x01
+SCALE = 0x02
+TRANSLATION = 0x04
+
+QUANTIZED_MAX = 65535
+
+class KnownException(Exception):
+    pass
+
+class Reader(object):
+    def __init__(self, data, offset=0):
+        self.data = data
+        self.offset = offset
+
+    def read(self, fmt):
+        values = struct.unpack_from('<' + fmt, self.data, self.offset)
+        self.offset += struct.calcsize('<' + fmt)
+        return values
+
+    def read_uint(self):
+        return self.read('I')[0]
+
+    def read_string(self):
+        length = self.read_uint()
+        value = self.data[self.offset:self.offset + length]
+        self.offset += length
+        return value
+
+def write_string(value):
+    return struct.pack('<I', len(value)) + value
+
+def parse_header(data):
+    if data[0:4] != b'C3B\0':
+        raise KnownException('not a c3b file')
+    version = struct.unpack_from('<BB', data, 4)
+    reader = Reader(data, 6)
+    refs = []
+    for i in range(reader.read_uint()):
+        ref_id = reader.read_string()
+        ref_type, offset = reader.read('II')
+        refs.append([ref_id, ref_type, offset])
+    return version, refs
+
+def parse_animations(data, offset, version):
+    '''Returns (id, total time, [(bone, {flag: [(time, value)]})]) for the animations of a record, as Bundle3D reads them.'''
+    reader = Reader(data, offset)
+    anim_num = reader.read_uint() if version in ((0, 3), (0, 4)) else 1
+    has_flags = version not in ((0, 1), (0, 2), (0, 3))
+    animations = []
+    for k in range(anim_num):
+        anim_id = reader.read_string()
+        total_time = reader.read('f')[0]
+        bones = []
+        for i in range(reader.read_uint()):
+            bone = reader.read_string()
+            curves = {ROTATION: [], SCALE: [], TRANSLATION: []}
+            for j in range(reader.read_uint()):
+                time = reader.read('f')[0]
+                flag = reader.read('B')[0] if has_flags else ROTATION | SCALE | TRANSLATION
+                if flag & ROTATION:
+                    curves[ROTATION].append((time, reader.read('ffff')))
+                if flag & SCALE:
+                    curves[SCALE].append((time, reader.read('fff')))
+                if flag & TRANSLATION:
+                    curves[TRANSLATION].append((time, reader.read('fff')))
+            bones.append((bone, curves))
+        animations.append((anim_id, total_time, bones))
+    return animations
+
+def normalize(value):
+    length = math.sqrt(sum(v * v for v in value))
+    return tuple(v / length for v in value) if length > 0 else value
+
+def lerp(a, b, t):
+    return tuple(x + (y - x) * t for x, y in zip(a, b))
+
+def evaluate(keys, time, rotation):
+    '''Value of a curve at a time, interpolated as AnimationCurve does.'''
+    if time <= keys[0][0]:
+        return keys[0][1]
+    if time >= keys[-1][0]:
+        return keys[-1][1]
+    low, high = 0, len(keys) - 1
+    while high - low > 1:
+        mid = (low + high) // 2
+        if keys[mid][0] <= time:
+            low = mid
+        else:
+            high = mid
+    t = (time - keys[low][0]) / (keys[high][0] - keys[low][0])
+    value = lerp(keys[low][1], keys[high][1], t)
+    return normalize(value) if rotation else value
+
+def distance(a, b, rotation):
+    if rotation:
+        dot = min(1.0, abs(sum(x * y for x, y in zip(a, b))))
+        return 2.0 * math.acos(dot)
+    return max(abs(x - y) for x, y in zip(a, b))
+
+def quantize(values):
+    count = len(values[0])
+    offset = [min(v[i] for v in values) for i in range(count)]
+    scale = [(max(v[i] for v in values) - offset[i]) / QUANTIZED_MAX for i in range(count)]
+    quantized = []
+    for value in values:
+        for i in range(count):
+            quantized.append(int(round((value[i] - offset[i]) / scale[i])) if scale[i] > 0 else 0)
+    return offset, scale, quantized
+
+def dequantize(offset, scale, quantized, rotation):
+    count = len(offset)
+    values = []
+    for k in range(len(quantized) // count):
+        value = tuple(offset[i] + quantized[k * count + i] * scale[i] for i in range(count))
+        values.append(normalize(value) if rotation else value)
+    return values
+
+def resample(keys, interval, rotation):
+    '''Keys of a curve every interval, quantized, with their largest error over the original keys.'''
+    start, end = keys[0][0], keys[-1][0]
+    # the last key may fall after the end of the curve, it takes the value at the end
+    key_num = int(math.ceil((end - start) / interval - 0.001)) + 1 if interval > 0 else 1
+    values = [evaluate(keys, start + interval * i, rotation) for i in range(key_num)]
+    offset, scale, quantized = quantize(values)
+    decoded = dequantize(offset, scale, quantized, rotation)
+    resampled = [(start + interval * i, decoded[i]) for i in range(key_num)]
+
+    # both curves are piecewise linear, the error is the largest at the keys of either
+    error = 0.0
+    for time in [key[0] for key in keys] + [key[0] for key in resampled if key[0] <= end]:
+        error = max(error, distance(evaluate(keys, time, rotation), evaluate(resampled, time, rotation), rotation))
+    return (start, interval if key_num > 1 else 0.0, offset, scale, quantized), error
+
+def frame_time(keys, spacing):
+    '''Time between two frames of a clip, fitted to the key times so the error doesn't add up over long clips.'''
+    start = keys[0][0]
+    frames = [round((key[0] - start) / spacing) for key in keys]
+    mean_frame = sum(frames) / float(len(frames))
+    mean_time = sum(key[0] for key in keys) / float(len(keys))
+    variance = sum((f - mean_frame) ** 2 for f in frames)
+    if variance == 0:
+        return spacing
+    return sum((f - mean_frame) * (key[0] - mean_time) for f, key in zip(frames, keys)) / variance
+
+def compress_curve(keys, rotation, tolerance):
+    '''Compresses the keys of a curve with the fewest evenly spaced keys whose error stays within tolerance.'''
+    if rotation:
+        # neighbours in the same hemisphere, so blending them takes the short way
+        flipped = [(keys[0][0], normalize(keys[0][1]))]
+        for time, value in keys[1:]:
+            value = normalize(value)
+            if sum(x * y for x, y in zip(flipped[-1][1], value)) < 0:
+                value = tuple(-v for v in value)
+            flipped.append((time, value))
+        keys = flipped
+
+    best = resample(keys, 0.0, rotation)
+    spacings = sorted(b[0] - a[0] for a, b in zip(keys, keys[1:]) if b[0] > a[0])
+    if best[1] <= tolerance or not spacings:
+        return best
+
+    # keys are resampled every few frames of the clip, so they land on the original ones where the
+    # frame rate is constant. The most frames a key can span is found by doubling, then bisecting.
+    frame = frame_time(keys, spacings[len(spacings) // 2])
+    max_frames = max(1, int((keys[-1][0] - keys[0][0]) / frame))
+    best = resample(keys, frame, rotation)
+    if best[1] > tolerance:
+        # irregular keys, sample faster than the clip until the error is low enough
+        for divisor in (2, 4, 8):
+            candidate = resample(keys, frame / divisor, rotation)
+            if candidate[1] < best[1]:
+                best = candidate
+            if best[1] <= tolerance:
+                break
+        return best
+
+    low, high = 1, 2
+    while high <= max_frames:
+        candidate = resample(keys, frame * high, rotation)
+        if candidate[1] > tolerance:
+            break
+        best, low, high = candidate, high, high * 2
+    high = min(high, max_frames + 1)
+    while high - low > 1:
+        mid = (low + high) // 2
+        candidate = resample(keys, frame * mid, rotation)
+        if candidate[1] <= tolerance:
+            best, low = candidate, mid
+        else:
+            high = mid
+    return best
+
+def write_curve(curve):
+    start, interval, offset, scale, quantized = curve
+    count = len(offset)
+    return struct.pack('<ffI', start, interval, len(quantized) // count) \
+        + struct.pack('<%df' % count, *offset) + struct.pack('<%df' % count, *scale) \
+        + struct.pack('<%dH' % len(quantized), *quantized)
+
+def compress_animation(animation, tolerances, stats):
+    anim_id, total_time, bones = animation
+    record = write_string(anim_id) + struct.pack('<fI', total_time, len(bones))
+    for bone, curves in bones:
+        flag = 0
+        body = b''
+        # same order as the key frames of the original record
+        for curve_flag in (ROTATION, SCALE, TRANSLATION):
+            keys = curves[curve_flag]
+            if not keys:
+                continue
+            flag |= curve_flag
+            curve, error = compress_curve(keys, curve_flag == ROTATION, tolerances[curve_flag])
+            if error > tolerances[curve_flag]:
+                # 16 bits are too few for the range of the curve, or its keys are too irregular
+                stats['over'].append(bone)
+            body += write_curve(curve)
+            stats['keys'] += len(keys)
+            stats['compressed_keys'] += len(curve[4]) // len(curve[2])
+            stats['error'][curve_flag] = max(stats['error'][curve_flag], error)
+        record += write_string(bone) + struct.pack('<B', flag) + body
+    return record
+
+def compress_file(src, dst, tolerances):
+    with open(src, 'rb') as f:
+        data = f.read()
+    version, refs = parse_header(data)
+
+    # a record runs to the next one
+    offsets = sorted(set([ref[2] for ref in refs] + [len(data)]))
+    def record_of(ref):
+        return data[ref[2]:offsets[offsets.index(ref[2]) + 1]]
+
+    stats = {'keys': 0, 'compressed_keys': 0, 'error': {ROTATION: 0.0, SCALE: 0.0, TRANSLATION: 0.0}, 'over': []}
+    original_size = 0
+    records = []
+    for ref in refs:
+        if ref[1] != BUNDLE_TYPE_ANIMATIONS:
+            records.append((ref[0], ref[1], record_of(ref)))
+            continue
+        original_size += len(record_of(ref))
+        animations = parse_animations(data, ref[2], version)
+        for animation in animations:
+            # Bundle3D looks compressed animations up by animation id and "animation"
+            ref_id = ref[0] if len(animations) == 1 else animation[0] + b'animation'
+            records.append((ref_id, BUNDLE_TYPE_COMPRESSED_ANIMATIONS, compress_animation(animation, tolerances, stats)))
+
+    if original_size == 0:
+        raise KnownException('%s has no animation' % src)
+
+    header = b'C3B\0' + struct.pack('<BBI', version[0], version[1], len(records))
+    table_size = len(header) + sum(len(write_string(r[0])) + 8 for r in records)
+    table = b''
+    body = b''
+    for ref_id, ref_type, record in records:
+        table += write_string(ref_id) + struct.pack('<II', ref_type, table_size + len(body))
+        body += record
+
+    with open(dst, 'wb') as f:
+        f.write(header + table + body)
+
+    compressed_size = sum(len(r[2]) for r in records if r[1] == BUNDLE_TYPE_COMPRESSED_ANIMATIONS)
+    print('%s: animations %d -> %d bytes, keys %d -> %d, file %d -> %d bytes' % (
+        src, original_size, compressed_size, stats['keys'], stats['compressed_keys'], len(data), len(header + table + body)))
+    print('  max error: rotation %.4f degrees, scale %.6f, translation %.6f' % (
+        math.degrees(stats['error'][ROTATION]), stats['error'][SCALE], stats['error'][TRANSLATION]))
+    if stats['over']:
+        print('  warning: over the error bounds: %s' % b', '.join(sorted(set(stats['over']))).decode('utf-8', 'replace'))
+
+if __name__ == '__main__':
+    parser = ArgumentParser(description='Compress the animations of a c3b file.')
+    parser.add_argument('src', help='c3b file to compress')
+    parser.add_argument('-o', '--output', help='compressed c3b file, src is overwritten by default')
+    parser.add_argument('--rotation-error', type=float, default=0.1, help='largest rotation error in degrees, 0.1 by default')
+    parser.add_argument('--scale-error', type=float, default=0.001, help='largest scale error, 0.001 by default')
+    parser.add_argument('--translation-error', type=float, default=0.001, help='largest translation error in model units, 0.001 by default')
+    args = parser.parse_args()
+
+    tolerances = {
+        ROTATION: math.radians(args.rotation_error),
+        SCALE: args.scale_error,
+        TRANSLATION: args.translation_error
+    }
+    try:
+        compress_file(args.src, args.output or args.src, tolerances)
+    except KnownException as e:
+        print(e)
+        exit(1)
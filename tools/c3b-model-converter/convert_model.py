@@ -0,0 +1,299 @@
+#!/usr/bin/python
+#-*- coding: UTF-8 -*-
+# ----------------------------------------------------------------------------
+# Convert a c3b or c3t model to a c3b file whose meshes are uploaded without parsing.
+#
+# License: MIT
+# ----------------------------------------------------------------------------
+'''
+Convert a c3b or c3t model to a c3b file whose meshes are uploaded without parsing.
+
+The meshes are written as a mapped mesh record. Its vertices and indices are laid
+out as the vertex and index buffers expect them, 16 byte aligned, and the record
+only holds their offsets from its start, so Bundle3D maps the file and uploads
+them from where they are. Nodes, materials and animations are kept.
+'''
+
+import json
+import struct
+
+from argparse import ArgumentParser
+
+BUNDLE_TYPE_NODE = 2
+BUNDLE_TYPE_ANIMATIONS = 3
+BUNDLE_TYPE_MATERIAL = 16
+BUNDLE_TYPE_MESH = 34
+BUNDLE_TYPE_MAPPED_MESH = 37
+
+ROTATION = 0x01
+SCALE = 0x02
+TRANSLATION = 0x04
+
+ALIGNMENT = 16
+
+class KnownException(Exception):
+    pass
+
+class Reader(object):
+    def __init__(self, data, offset=0):
+        self.data = data
+        self.offset = offset
+
+    def read(self, fmt):
+        values = struct.unpack_from('<' + fmt, self.data, self.offset)
+        self.offset += struct.calcsize('<' + fmt)
+        return values
+
+    def read_uint(self):
+        return self.read('I')[0]
+
+    def read_string(self):
+        length = self.read_uint()
+        value = self.data[self.offset:self.offset + length]
+        self.offset += length
+        return value
+
+    def read_block(self, size):
+        value = self.data[self.offset:self.offset + size]
+        self.offset += size
+        return value
+
+def write_string(value):
+    if not isinstance(value, bytes):
+        value = value.encode('utf-8')
+    return struct.pack('<I', len(value)) + value
+
+def padding(size):
+    return b'\0' * (-size % ALIGNMENT)
+
+def parse_header(data):
+    if data[0:4] != b'C3B\0':
+        raise KnownException('not a c3b file')
+    version = struct.unpack_from('<BB', data, 4)
+    reader = Reader(data, 6)
+    refs = []
+    for i in range(reader.read_uint()):
+        ref_id = reader.read_string()
+        ref_type, offset = reader.read('II')
+        refs.append([ref_id, ref_type, offset])
+    return version, refs
+
+def calculate_aabb(vertices, vertex_size, indices):
+    '''Bounds of the vertices a part uses, from their first three floats as Bundle3D::calculateAABB does.'''
+    if not indices:
+        return (0.0,) * 6
+    points = [vertices[i * vertex_size:i * vertex_size + 3] for i in indices]
+    return tuple(min(p[i] for p in points) for i in range(3)) + tuple(max(p[i] for p in points) for i in range(3))
+
+def parse_meshes(data, offset, version):
+    '''Returns [(attributes, vertices bytes, [(part id, indices bytes, aabb)])] for a mesh record, as Bundle3D reads it.'''
+    reader = Reader(data, offset)
+    has_aabb = version not in ((0, 3), (0, 4), (0, 5))
+    meshes = []
+    for i in range(reader.read_uint()):
+        attributes = []
+        for j in range(reader.read_uint()):
+            size = reader.read_uint()
+            attributes.append((size, reader.read_string(), reader.read_string()))
+        vertices = reader.read_block(reader.read_uint() * 4)
+        parts = []
+        for k in range(reader.read_uint()):
+            part_id = reader.read_string()
+            indices = reader.read_block(reader.read_uint() * 2)
+            if has_aabb:
+                aabb = reader.read('6f')
+            else:
+                vertex_floats = struct.unpack('<%df' % (len(vertices) // 4), vertices)
+                index_values = struct.unpack('<%dH' % (len(indices) // 2), indices)
+                aabb = calculate_aabb(vertex_floats, sum(a[0] for a in attributes), index_values)
+            parts.append((part_id, indices, aabb))
+        meshes.append((attributes, vertices, parts))
+    return meshes
+
+def json_meshes(meshes):
+    result = []
+    for mesh in meshes:
+        attributes = [(a['size'], a['type'].encode('utf-8'), a['attribute'].encode('utf-8')) for a in mesh['attributes']]
+        vertex_floats = mesh['vertices']
+        vertices = struct.pack('<%df' % len(vertex_floats), *vertex_floats)
+        parts = []
+        for part in mesh['parts']:
+            indices = struct.pack('<%dH' % len(part['indices']), *part['indices'])
+            aabb = part.get('aabb') or calculate_aabb(vertex_floats, sum(a[0] for a in attributes), part['indices'])
+            parts.append((part['id'].encode('utf-8'), indices, tuple(aabb)))
+        result.append((attributes, vertices, parts))
+    return result
+
+def write_mapped_meshes(meshes, record_offset):
+    '''Mapped mesh record starting at record_offset in the file, its vertices and indices follow the description.
+
+    Their offsets are relative to the record, so tools that move records keep it valid. They are aligned
+    in the file, which stays true as long as the record starts on a 16 byte boundary.
+    '''
+    description = struct.pack('<I', len(meshes))
+    blocks = []
+    for attributes, vertices, parts in meshes:
+        description += struct.pack('<I', len(attributes))
+        for size, attrib_type, attribute in attributes:
+            description += struct.pack('<I', size) + write_string(attrib_type) + write_string(attribute)
+        # the offsets are patched once the size of the description is known
+        description += struct.pack('<I', len(vertices) // 4)
+        blocks.append((len(description), vertices))
+        description += struct.pack('<I', 0) + struct.pack('<I', len(parts))
+        for part_id, indices, aabb in parts:
+            description += write_string(part_id) + struct.pack('<I', len(indices) // 2)
+            blocks.append((len(description), indices))
+            description += struct.pack('<I', 0) + struct.pack('<6f', *aabb)
+
+    record = bytearray(description)
+    body = padding(record_offset + len(record))
+    offset = len(record) + len(body)
+    for position, block in blocks:
+        struct.pack_into('<I', record, position, offset)
+        block = block + padding(len(block))
+        body += block
+        offset += len(block)
+    return bytes(record) + body
+
+def json_node(node):
+    record = write_string(node['id']) + struct.pack('<B', 1 if node.get('skeleton') else 0)
+    record += struct.pack('<16f', *node.get('transform', [1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1]))
+    parts = node.get('parts', [])
+    record += struct.pack('<I', len(parts))
+    for part in parts:
+        record += write_string(part['meshpartid']) + write_string(part['materialid'])
+        bones = part.get('bones', [])
+        record += struct.pack('<I', len(bones))
+        for bone in bones:
+            record += write_string(bone['node']) + struct.pack('<16f', *bone['transform'])
+        uv_mapping = part.get('uvMapping', [])
+        record += struct.pack('<I', len(uv_mapping))
+        for mapping in uv_mapping:
+            record += struct.pack('<I', len(mapping)) + struct.pack('<%dI' % len(mapping), *mapping)
+    children = node.get('children', [])
+    record += struct.pack('<I', len(children))
+    for child in children:
+        record += json_node(child)
+    return record
+
+def json_materials(materials):
+    record = struct.pack('<I', len(materials))
+    for material in materials:
+        record += write_string(material['id'])
+        # diffuse, ambient, emissive, opacity, specular, shininess as Bundle3D skips them
+        values = list(material.get('diffuse', [1, 1, 1])) + list(material.get('ambient', [1, 1, 1])) \
+            + list(material.get('emissive', [0, 0, 0])) + [material.get('opacity', 1.0)] \
+            + list(material.get('specular', [1, 1, 1])) + [material.get('shininess', 0.0)]
+        record += struct.pack('<14f', *values)
+        textures = material.get('textures', [])
+        record += struct.pack('<I', len(textures))
+        for texture in textures:
+            record += write_string(texture['id']) + write_string(texture['filename'])
+            record += struct.pack('<4f', 0.0, 0.0, 1.0, 1.0)
+            record += write_string(texture.get('type', 'DIFFUSE'))
+            record += write_string(texture.get('wrapModeU', 'REPEAT')) + write_string(texture.get('wrapModeV', 'REPEAT'))
+    return record
+
+def json_animation(animation):
+    bones = animation.get('bones', [])
+    record = write_string(animation['id']) + struct.pack('<fI', animation['length'], len(bones))
+    for bone in bones:
+        keyframes = bone.get('keyframes', [])
+        record += write_string(bone['boneId']) + struct.pack('<I', len(keyframes))
+        for key in keyframes:
+            flag = (ROTATION if 'rotation' in key else 0) | (SCALE if 'scale' in key else 0) | (TRANSLATION if 'translation' in key else 0)
+            record += struct.pack('<fB', key['keytime'], flag)
+            if 'rotation' in key:
+                record += struct.pack('<4f', *key['rotation'])
+            if 'scale' in key:
+                record += struct.pack('<3f', *key['scale'])
+            if 'translation' in key:
+                record += struct.pack('<3f', *key['translation'])
+    return record
+
+def parse_version(value):
+    major, minor = value.split('.')
+    return int(major), int(minor)
+
+def c3b_records(data):
+    version, refs = parse_header(data)
+    if version in ((0, 1), (0, 2)):
+        raise KnownException('c3b version %d.%d is too old, convert the model again with fbx-conv' % version)
+
+    # a record runs to the next one
+    offsets = sorted(set([ref[2] for ref in refs] + [len(data)]))
+    records = []
+    meshes = None
+    for ref_id, ref_type, offset in refs:
+        if ref_type == BUNDLE_TYPE_MESH:
+            if meshes is None:
+                meshes = parse_meshes(data, offset, version)
+            continue
+        records.append((ref_id, ref_type, data[offset:offsets[offsets.index(offset) + 1]]))
+    return version, records, meshes
+
+def c3t_records(data):
+    document = json.loads(data.decode('utf-8'))
+    version = parse_version(document.get('version', '0.1'))
+    if version in ((1, 2), (0, 1), (0, 2)):
+        raise KnownException('c3t version %d.%d is too old, convert the model again with fbx-conv' % version)
+    # key frames are written with their flags, which c3b files have since 0.5
+    if version < (0, 5):
+        version = (0, 5)
+
+    records = []
+    nodes = document.get('nodes', [])
+    if nodes:
+        record = struct.pack('<I', len(nodes)) + b''.join(json_node(node) for node in nodes)
+        records.append((nodes[0]['id'].encode('utf-8') + b'node', BUNDLE_TYPE_NODE, record))
+    materials = document.get('materials', [])
+    if materials:
+        records.append((materials[0]['id'].encode('utf-8') + b'material', BUNDLE_TYPE_MATERIAL, json_materials(materials)))
+    for animation in document.get('animations', []):
+        # Bundle3D looks animations up by animation id and "animation"
+        records.append((animation['id'].encode('utf-8') + b'animation', BUNDLE_TYPE_ANIMATIONS, json_animation(animation)))
+    return version, records, json_meshes(document.get('meshes', []))
+
+def convert_file(src, dst):
+    with open(src, 'rb') as f:
+        data = f.read()
+    if data[0:4] == b'C3B\0':
+        version, records, meshes = c3b_records(data)
+    else:
+        version, records, meshes = c3t_records(data)
+    if not meshes:
+        raise KnownException('%s has no mesh' % src)
+
+    # the mapped mesh goes last, after padding that aligns its vertices and indices
+    ref_num = len(records) + 1
+    header = b'C3B\0' + struct.pack('<BBI', version[0], version[1], ref_num)
+    table_size = len(header) + sum(len(write_string(r[0])) + 8 for r in records) + len(write_string(b'mesh')) + 8
+    table = b''
+    body = b''
+    for ref_id, ref_type, record in records:
+        table += write_string(ref_id) + struct.pack('<II', ref_type, table_size + len(body))
+        body += record
+    body += padding(table_size + len(body))
+    table += write_string(b'mesh') + struct.pack('<II', BUNDLE_TYPE_MAPPED_MESH, table_size + len(body))
+    body += write_mapped_meshes(meshes, table_size + len(body))
+
+    with open(dst, 'wb') as f:
+        f.write(header + table + body)
+
+    print('%s: %d meshes, %d parts, file %d -> %d bytes' % (
+        src, len(meshes), sum(len(m[2]) for m in meshes), len(data), len(header + table + body)))
+
+if __name__ == '__main__':
+    parser = ArgumentParser(description='Convert a c3b or c3t model to a c3b file whose meshes are uploaded without parsing.')
+    parser.add_argument('src', help='c3b or c3t file to convert')
+    parser.add_argument('-o', '--output', help='converted c3b file, src with the c3b extension by default')
+    args = parser.parse_args()
+
+    output = args.output
+    if not output:
+        output = (args.src[:-4] if args.src.endswith(('.c3b', '.c3t')) else args.src) + '.c3b'
+    try:
+        convert_file(args.src, output)
+    except KnownException as e:
+        print(e)
+        exit(1)